@@ -10,6 +10,7 @@
 #include <DirectXPackedVector.h>
 
 #include "Core/Window.h"
+#include "Renderer/D3D11Backend.h"
 #include "Renderer/GraphicsContext.h"
 #include "Renderer/IRenderer.h"
 
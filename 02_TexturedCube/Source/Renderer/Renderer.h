@@ -13,6 +13,7 @@
 #include "Renderer/IRenderer.h"
 #include "Renderer/GraphicsContext.h"
 #include "Renderer/DX11Types.h"
+#include "Renderer/D3D11Backend.h"
 #include "Renderer/Camera.h"
 
 using namespace DirectX;
@@ -9,6 +9,7 @@
 #include "Core/Application.h"
 #include "Core/FileIO.h"
 #include "Renderer/DX11Util.h"
+#include "Renderer/RenderStateCache.h"
 #include "Renderer/Texture.h"
 #include "Renderer/Vertex.h"
 
@@ -230,8 +231,7 @@ void Renderer::Render()
 
     cbuffer_per_view_->Upload(reinterpret_cast<uint8*>(&per_view_data_), sizeof(per_view_data_));
     static constexpr int SLOT_PER_VIEW = 1;
-    gfx::device_context->VSSetConstantBuffers(SLOT_PER_VIEW, 1, cbuffer_per_view_->buffer_.GetAddressOf());
-    gfx::device_context->PSSetConstantBuffers(SLOT_PER_VIEW, 1, cbuffer_per_view_->buffer_.GetAddressOf());
+    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.get(), SLOT_PER_VIEW);
 
     // Submit draw commands
     mesh_.Render();
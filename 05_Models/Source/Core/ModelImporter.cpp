@@ -7,6 +7,7 @@
 
 #include "Engine/World.h"
 #include "Engine/Entity.h"
+#include "Renderer/GraphicsBackend.h"
 
 SharedPtr<Entity> ModelImporter::ImportModel(const ModelDesc& scene_desc, World& world)
 {
@@ -173,12 +174,11 @@ SharedPtr<Model> ModelImporter::ProcessMesh(const ModelDesc& scene_desc, const a
     mesh.model = model.get();
     model->meshes_.push_back(mesh);
 
-    D3D11_BUFFER_DESC cbuffer_desc = {};
-    cbuffer_desc.Usage = D3D11_USAGE_DEFAULT;   // Read / Write access
-    cbuffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    cbuffer_desc.ByteWidth = sizeof(CBufferPerObject);
-    cbuffer_desc.CPUAccessFlags = 0;
-    DX11_VERIFY(gfx::device->CreateBuffer(&cbuffer_desc, nullptr, &model->cbuffer_per_object));
+    GpuBufferDesc cbuffer_desc = {};
+    cbuffer_desc.size = sizeof(CBufferPerObject);
+    cbuffer_desc.usage = GpuUsage::Default;   // Read / Write access
+    cbuffer_desc.bind_flags = GpuBind::ConstantBuffer;
+    model->cbuffer_per_object = gfx::backend->CreateBuffer(cbuffer_desc);
 
     model->index_buffer = MakeShared<IndexBuffer>(vertex_data.indices.data(), (uint32)vertex_data.indices.size());
     model->pos = MakeShared<VertexBuffer>(vertex_data.pos.data(), (uint32)vertex_data.pos.size(), sizeof(Vec3), VertexBufferSlots::POS);
@@ -12,6 +12,7 @@
 
 #include "Core/FileIO.h"
 #include "Renderer/DX11Util.h"
+#include "Renderer/RenderStateCache.h"
 #include "Renderer/Texture.h"
 #include "Renderer/Vertex.h"
 
@@ -76,9 +77,9 @@ Renderer::Renderer()
 
     // Set up cbuffer
     cbuffer_per_frame_ = MakeUnique<ConstantBuffer>((uint32) sizeof(CBufferPerFrame));
-    SetDebugName(cbuffer_per_frame_ ->buffer_.Get(), "Per Frame");
+    cbuffer_per_frame_->buffer_->SetDebugName("Per Frame");
     cbuffer_per_view_ = MakeUnique<ConstantBuffer>((uint32)sizeof(CBufferPerView));
-    SetDebugName(cbuffer_per_view_->buffer_.Get(), "Per View");
+    cbuffer_per_view_->buffer_->SetDebugName("Per View");
 
     // Set up camera
     float aspect_ratio = (float)swap_chain_desc.Width / (float)swap_chain_desc.Height;
@@ -104,7 +105,7 @@ void Renderer::Render()
     // Update per-frame cbuffer
     cbuffer_per_frame_->Upload(reinterpret_cast<uint8*>(&per_frame_data_), sizeof(CBufferPerFrame));
     static constexpr int CBUFFER_SLOT_PER_FRAME = 0;
-    gfx::SetConstantBuffer(cbuffer_per_frame_->buffer_.Get(), CBUFFER_SLOT_PER_FRAME);
+    gfx::SetConstantBuffer(cbuffer_per_frame_->buffer_.get(), CBUFFER_SLOT_PER_FRAME);
 
     // Update per-view cbuffer
     per_view_data_.mat_view = gfx::camera.GetView().Transpose(); // CPU: row major, GPU: col major! -> We have to transpose
@@ -115,7 +116,7 @@ void Renderer::Render()
 
     cbuffer_per_view_->Upload(reinterpret_cast<uint8*>(&per_view_data_), sizeof(CBufferPerView));
     static constexpr int CBUFFER_SLOT_PER_VIEW = 1;
-    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.Get(), CBUFFER_SLOT_PER_VIEW);
+    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.get(), CBUFFER_SLOT_PER_VIEW);
 
     // Forward Pass - Opaque
     {
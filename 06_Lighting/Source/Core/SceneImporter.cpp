@@ -5,6 +5,8 @@
 #include "assimp/scene.h"
 #include "assimp/GltfMaterial.h"
 
+#include "Renderer/GraphicsBackend.h"
+
 SharedPtr<Entity> SceneImporter::ImportScene(const SceneDescription& scene_desc, World& world)
 {
     LOG("Loading Scene: {}", scene_desc.path);
@@ -231,12 +233,11 @@ SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc,
     mesh.model = model.get();
     model->meshes_.push_back(mesh);
 
-    D3D11_BUFFER_DESC cbuffer_desc = {};
-    cbuffer_desc.Usage = D3D11_USAGE_DEFAULT;   // Read / Write access
-    cbuffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    cbuffer_desc.ByteWidth = sizeof(CBufferPerObject);
-    cbuffer_desc.CPUAccessFlags = 0;
-    DX11_VERIFY(gfx::device->CreateBuffer(&cbuffer_desc, nullptr, &model->cbuffer_per_object));
+    GpuBufferDesc cbuffer_desc = {};
+    cbuffer_desc.size = sizeof(CBufferPerObject);
+    cbuffer_desc.usage = GpuUsage::Default;   // Read / Write access
+    cbuffer_desc.bind_flags = GpuBind::ConstantBuffer;
+    model->cbuffer_per_object = gfx::backend->CreateBuffer(cbuffer_desc);
 
     model->index_buffer = MakeShared<IndexBuffer>(vertex_data.indices.data(), (uint32) vertex_data.indices.size());
     model->pos = MakeShared<VertexBuffer>(vertex_data.pos.data(), (uint32) vertex_data.pos.size(), sizeof(Vec3), VertexBufferSlots::POS);
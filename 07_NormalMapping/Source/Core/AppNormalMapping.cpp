@@ -5,7 +5,7 @@
 #include "spdlog/fmt/bundled/ostream.h"
 
 #include "Engine/Entity.h"
-#include "Engine/SceneImporter.h"
+#include "Core/SceneImporter.h"
 
 #include "Renderer/Renderer.h"
 
@@ -64,11 +64,11 @@ Renderer::Renderer()
 
     // Set up cbuffers
     cbuffer_per_frame_ = MakeUnique<ConstantBuffer>((uint32) sizeof(CBufferPerFrame));
-    SetDebugName(cbuffer_per_frame_ ->buffer_.Get(), "Per Frame");
+    cbuffer_per_frame_->buffer_->SetDebugName("Per Frame");
     cbuffer_per_view_ = MakeUnique<ConstantBuffer>((uint32)sizeof(CBufferPerView));
-    SetDebugName(cbuffer_per_view_->buffer_.Get(), "Per View");
+    cbuffer_per_view_->buffer_->SetDebugName("Per View");
     cbuffer_light_ = MakeUnique<ConstantBuffer>((uint32)sizeof(CBufferLight));
-    SetDebugName(cbuffer_light_->buffer_.Get(), "Light Data");
+    cbuffer_light_->buffer_->SetDebugName("Light Data");
 
     // Set up camera
     // TODO: This probably also shouldn't be in the renderer. Instead we want to grab the currently active camera from the scene
@@ -94,7 +94,7 @@ void Renderer::Render()
     // Update per-frame cbuffer
     cbuffer_per_frame_->Upload(reinterpret_cast<uint8*>(&per_frame_data_), sizeof(CBufferPerFrame));
     static constexpr int CBUFFER_SLOT_PER_FRAME = 0;
-    gfx::SetConstantBuffer(cbuffer_per_frame_->buffer_.Get(), CBUFFER_SLOT_PER_FRAME);
+    gfx::SetConstantBuffer(cbuffer_per_frame_->buffer_.get(), CBUFFER_SLOT_PER_FRAME);
 
     // Update per-view cbuffer
     per_view_data_.mat_view = gfx::camera.GetView().Transpose(); // CPU: row major, GPU: col major! -> We have to transpose
@@ -105,7 +105,7 @@ void Renderer::Render()
 
     cbuffer_per_view_->Upload(reinterpret_cast<uint8*>(&per_view_data_), sizeof(CBufferPerView));
     static constexpr int CBUFFER_SLOT_PER_VIEW = 1;
-    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.Get(), CBUFFER_SLOT_PER_VIEW);
+    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.get(), CBUFFER_SLOT_PER_VIEW);
 
     // Update scene lighting
     light_data_ = {};
@@ -129,7 +129,7 @@ void Renderer::Render()
 
     cbuffer_light_->Upload(reinterpret_cast<uint8*>(&light_data_), sizeof(CBufferLight));
     static constexpr int CBUFFER_SLOT_LIGHT_DATA = 3;
-    gfx::SetConstantBuffer(cbuffer_light_->buffer_.Get(), CBUFFER_SLOT_LIGHT_DATA);
+    gfx::SetConstantBuffer(cbuffer_light_->buffer_.get(), CBUFFER_SLOT_LIGHT_DATA);
 
     // Forward Pass - Opaque
     {
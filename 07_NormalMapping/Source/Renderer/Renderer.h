@@ -12,6 +12,7 @@
 #include "Core/Window.h"
 #include "Renderer/Camera.h"
 #include "Renderer/ConstantBufferTypes.h"
+#include "Renderer/D3D11Backend.h"
 #include "Renderer/DX11Types.h"
 #include "Renderer/GraphicsContext.h"
 #include "Renderer/IndexBuffer.h"
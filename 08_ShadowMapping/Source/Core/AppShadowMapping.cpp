@@ -4,7 +4,7 @@
 #include "SDL_events.h"
 #include "spdlog/fmt/bundled/ostream.h"
 
-#include "Engine/Entity.h"
+#include "Engine/World.h"
 
 #include "Core/SceneImporter.h"
 #include "Renderer/Renderer.h"
@@ -28,7 +28,10 @@ void AppShadowMapping::Init()
         SceneDescription scene_desc
         {
             .path = model_path,
-            .import_correction_transform = import_correction_transform
+            .import_correction_transform = import_correction_transform,
+            .stream_textures = true,
+            .compress_textures = true,
+            .vertex_format = VertexFormat::PackedQuantized
         };
         SceneImporter::ImportScene(scene_desc, world);
     }
@@ -43,7 +46,10 @@ void AppShadowMapping::Init()
         SceneDescription scene_desc
         {
             .path = model_path,
-            .import_correction_transform = import_correction_transform
+            .import_correction_transform = import_correction_transform,
+            .stream_textures = true,
+            .compress_textures = true,
+            .vertex_format = VertexFormat::PackedQuantized
         };
         SceneImporter::ImportScene(scene_desc, world);
     }
@@ -67,23 +73,21 @@ void AppShadowMapping::Init()
 
     // Lights
     {
-        SharedPtr<Entity> entity = MakeShared<Entity>();
-        entity->name_ = "DirectionalLight";
-        DirectionalLightComponent* directional_light = entity->AddComponent<DirectionalLightComponent>();
+        const EntityId entity = world.CreateEntity("DirectionalLight");
+        DirectionalLightComponent* directional_light = world.AddComponent<DirectionalLightComponent>(entity);
         directional_light->brightness_ = 0.7f;
-        entity->transform_->SetWorldRotation(Quat::FromAxisAngle(Vec3::RIGHT, MathUtils::DegToRad(66.0f)));
-        world.Add(entity);
+        world.GetComponent<TransformComponent>(entity)->SetWorldRotation(Quat::FromAxisAngle(Vec3::RIGHT, MathUtils::DegToRad(66.0f)));
     }
 
     {
-        SharedPtr<Entity> entity = MakeShared<Entity>();
-        entity->transform_->SetWorldTranslation({ 0.0f, 1.0f, -5.0f });
-        entity->transform_->SetWorldRotation(Quat::FromAxisAngle(Vec3::UP, MathUtils::DegToRad(180.0f)));
-        entity->name_ = "SpotLight";
-        SpotLightComponent* light = entity->AddComponent<SpotLightComponent>();
+        const EntityId entity = world.CreateEntity("SpotLight");
+        SpotLightComponent* light = world.AddComponent<SpotLightComponent>(entity);
         light->color_ = { 1.0f, 0.0f, 0.0f };
         light->cone_angle_ = 33.33f;
-        world.Add(entity);
+
+        TransformComponent* transform = world.GetComponent<TransformComponent>(entity);
+        transform->SetWorldTranslation({ 0.0f, 1.0f, -5.0f });
+        transform->SetWorldRotation(Quat::FromAxisAngle(Vec3::UP, MathUtils::DegToRad(180.0f)));
     }
 
     {
@@ -98,15 +102,17 @@ void AppShadowMapping::Init()
             .import_correction_transform = import_correction_transform
         };
 
-        SharedPtr<Entity> entity = SceneImporter::ImportScene(scene_desc, world);
-        entity->transform_->SetWorldTranslation({ 0.0f, 1.0f, -5.0f });
-        entity->transform_->SetWorldRotation(Quat::FromAxisAngle(Vec3::UP, MathUtils::DegToRad(180.0f)));
-        entity->name_ = "PointLight";
-        
-        PointLightComponent* light = entity->AddComponent<PointLightComponent>();
+        const EntityId entity = SceneImporter::ImportScene(scene_desc, world);
+        world.GetComponent<NameComponent>(entity)->name_ = "PointLight";
+
+        TransformComponent* transform = world.GetComponent<TransformComponent>(entity);
+        transform->SetWorldTranslation({ 0.0f, 1.0f, -5.0f });
+        transform->SetWorldRotation(Quat::FromAxisAngle(Vec3::UP, MathUtils::DegToRad(180.0f)));
+
+        PointLightComponent* light = world.AddComponent<PointLightComponent>(entity);
         light->color_ = { 0.0f, 0.0f, 1.0f };
 
-        StaticMeshComponent* mesh_component = entity->GetChild(0)->GetComponent<StaticMeshComponent>();
+        StaticMeshComponent* mesh_component = world.GetComponent<StaticMeshComponent>(world.GetChild(entity, 0));
         mesh_component->model_->materials_[0] = unlit_mat_handle;
         mesh_component->is_shadow_receiver_ = false;
     }
@@ -121,169 +127,187 @@ void AppShadowMapping::Update()
 {
     BaseApplication::Update();
 
-    for (auto entity : world.GetEntities())
-    {
-        // Update material base color for light representations
-        if(PointLightComponent* light_component = entity->GetComponent<PointLightComponent>())
+    // Update material base color for light representations
+    world.Each<PointLightComponent>([this](EntityId entity, PointLightComponent& light_component)
         {
-            if(entity->GetChild(0))
+            const EntityId mesh_entity = world.GetChild(entity, 0);
+            StaticMeshComponent* mesh_component = world.GetComponent<StaticMeshComponent>(mesh_entity);
+            if (mesh_component == nullptr)
             {
-                if(StaticMeshComponent* mesh_component = entity->GetChild(0)->GetComponent<StaticMeshComponent>())
-                {
-                    if (light_component != nullptr && mesh_component != nullptr)
-                    {
-                        Material* material = gfx::resource_manager->materials.Get(mesh_component->model_->materials_[0]);
-                        const Vec3 light_color = light_component->brightness_ * light_component->color_;
-                        material->SetParam("base_color", light_color);
-                        static Vec3 initial_scale = entity->GetChild(0)->transform_->GetWorldScaling();
-                        Vec3 scale = initial_scale * light_component->brightness_;
-                        entity->GetChild(0)->transform_->SetWorldScaling(scale);
-                        mesh_component->is_visible_ = light_component->is_enabled_;
-                    }
-                }
+                return;
             }
-        }
-    }
+
+            Material* material = gfx::resource_manager->materials.Get(mesh_component->model_->materials_[0]);
+            const Vec3 light_color = light_component.brightness_ * light_component.color_;
+            material->SetParam("base_color", light_color);
+
+            TransformComponent* mesh_transform = world.GetComponent<TransformComponent>(mesh_entity);
+            static Vec3 initial_scale = mesh_transform->GetWorldScaling();
+            Vec3 scale = initial_scale * light_component.brightness_;
+            mesh_transform->SetWorldScaling(scale);
+            mesh_component->is_visible_ = light_component.is_enabled_;
+        });
 }
 
 void AppShadowMapping::Render()
 {
-    for (auto entity : world.GetEntities())
-    {
-        StaticMeshComponent* mesh_component = entity->GetComponent<StaticMeshComponent>();
-        if(mesh_component != nullptr && mesh_component->model_ != nullptr)
+    Renderer* renderer = (Renderer*) gfx::renderer;
+    CHECK(renderer);
+
+    cull_candidates_.clear();
+    cull_bounds_.Clear();
+
+    world.Each<TransformComponent, StaticMeshComponent>([&](TransformComponent& transform, StaticMeshComponent& mesh_component)
         {
-            if (mesh_component->is_visible_)
+            if (mesh_component.model_ == nullptr || mesh_component.is_visible_ == false)
             {
-                mesh_component->model_->transform = *entity->transform_;
-                for(StaticMesh& mesh : mesh_component->model_->meshes_)
+                return;
+            }
+
+            // Only the matrix is copied, the renderer reads everything it needs from it without decomposing
+            const Mat4 world_matrix = transform.GetWorldMatrix();
+            mesh_component.model_->transform.SetWorldMatrix(world_matrix);
+            for(StaticMesh& mesh : mesh_component.model_->meshes_)
+            {
+                RenderWorkItem item;
+                item.mesh = &mesh;
+                item.sort_key = Vec3::DistanceSquared(gfx::camera.GetPosition(), transform.GetWorldTranslation());
+                // Note: For now we calculate the distance from camera to entity... This is not ideal, especially for the render order of meshes w/ transparent materials.
+                // Problems for future me, I guess :>
+                item.is_shadow_receiver = mesh_component.is_shadow_receiver_;
+
+                Material* material = gfx::resource_manager->materials.Get(mesh_component.model_->materials_[mesh.material_slot]);
+                CHECK(material != nullptr);
+
+                // Shadow casters must not be culled against the camera, they can throw shadows into the view from outside.
+                if (material->blend_state_ == BlendState::Opaque && item.is_shadow_receiver)
                 {
-                    RenderWorkItem item;
-                    item.mesh = &mesh;
-                    item.sort_key = Vec3::DistanceSquared(gfx::camera.GetPosition(), mesh_component->model_->transform.GetWorldTranslation());
-                    // Note: For now we calculate the distance from camera to entity... This is not ideal, especially for the render order of meshes w/ transparent materials.
-                    // Problems for future me, I guess :>
-                    item.is_shadow_receiver = mesh_component->is_shadow_receiver_;
-
-                    Material* material = gfx::resource_manager->materials.Get(mesh_component->model_->materials_[mesh.material_slot]);
-                    CHECK(material != nullptr);
-                    gfx::renderer->Enqueue(item, material->blend_state_);
+                    renderer->EnqueueShadowCaster(item);
                 }
+
+                cull_candidates_.push_back({ .item = item, .blend_state = material->blend_state_ });
+                cull_bounds_.Add(mesh.bounds, world_matrix);
             }
-        }
+        });
 
+    world.Each<TransformComponent, DirectionalLightComponent>([renderer](TransformComponent& transform, DirectionalLightComponent& light)
         {
-            DirectionalLightComponent* light = entity->GetComponent<DirectionalLightComponent>();
-            if (light != nullptr && light->is_enabled_)
+            if (light.is_enabled_)
             {
-                Renderer* renderer = (Renderer*) gfx::renderer;
-                CHECK(renderer);
-
-                renderer->Enqueue(DirectionalLight(entity->transform_->GetWorldForward().xyz().Normalize(), light->ambient_intensity_,
-                    light->color_, light->brightness_));
+                renderer->Enqueue(DirectionalLight(transform.GetWorldForward().xyz().Normalize(), light.ambient_intensity_,
+                    light.color_, light.brightness_));
             }
-        }
+        });
 
+    world.Each<TransformComponent, PointLightComponent>([renderer](TransformComponent& transform, PointLightComponent& light)
         {
-            PointLightComponent* light = entity->GetComponent<PointLightComponent>();
-            if (light != nullptr && light->is_enabled_)
+            if (light.is_enabled_ == false)
             {
-                Renderer* renderer = (Renderer*) gfx::renderer;
-                CHECK(renderer);
-
-                const Vec3 light_pos = entity->transform_->GetWorldTranslation();
+                return;
+            }
 
-                PointLight l;
-                l.position_ws = light_pos;
-                l.ambient_intensity = light->ambient_intensity_;
-                l.color = light->color_;
-                l.attenuation = light->attenuation_;
-                l.brightness = light->brightness_;
+            const Vec3 light_pos = transform.GetWorldTranslation();
 
-                static constexpr int32 NUM_VIEW_DIRS = 6;
-                static constexpr int32 IDX_RIGHT = 0;
-                static constexpr int32 IDX_LEFT = 1;
-                static constexpr int32 IDX_UP = 2;
-                static constexpr int32 IDX_DOWN = 3;
-                static constexpr int32 IDX_FORWARD = 4;
-                static constexpr int32 IDX_BACKWARD = 5;
-                static constexpr float ASPECT_RATIO = 1.0f;
+            PointLight l;
+            l.position_ws = light_pos;
+            l.ambient_intensity = light.ambient_intensity_;
+            l.color = light.color_;
+            l.attenuation = light.attenuation_;
+            l.brightness = light.brightness_;
 
-                const float near_z = 0.1f;
-                const float far_z = 30.0f; // TODO: Max shadow distance should be a global / per light property?
+            static constexpr int32 NUM_VIEW_DIRS = 6;
+            static constexpr int32 IDX_RIGHT = 0;
+            static constexpr int32 IDX_LEFT = 1;
+            static constexpr int32 IDX_UP = 2;
+            static constexpr int32 IDX_DOWN = 3;
+            static constexpr int32 IDX_FORWARD = 4;
+            static constexpr int32 IDX_BACKWARD = 5;
+            static constexpr float ASPECT_RATIO = 1.0f;
 
-                Mat4 light_projection = Mat4::PerspectiveFovLH(PI_DIV2, ASPECT_RATIO, near_z, far_z);
+            const float near_z = 0.1f;
+            const float far_z = 30.0f; // TODO: Max shadow distance should be a global / per light property?
+            l.range = far_z;
 
-                // Right
-                {
-                    const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::RIGHT, Vec3::UP);
-                    l.view_projections[IDX_RIGHT] = (light_view * light_projection).Transpose();
-                }
-                
-                // Left
-                {
-                    const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::LEFT, Vec3::UP);
-                    l.view_projections[IDX_LEFT] = (light_view * light_projection).Transpose();
-                }
+            Mat4 light_projection = Mat4::PerspectiveFovLH(PI_DIV2, ASPECT_RATIO, near_z, far_z);
 
-                // Up
-                {
-                    const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::UP, Vec3::BACKWARD);
-                    l.view_projections[IDX_UP] = (light_view * light_projection).Transpose();;
-                }
+            // Right
+            {
+                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::RIGHT, Vec3::UP);
+                l.view_projections[IDX_RIGHT] = (light_view * light_projection).Transpose();
+            }
+            
+            // Left
+            {
+                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::LEFT, Vec3::UP);
+                l.view_projections[IDX_LEFT] = (light_view * light_projection).Transpose();
+            }
 
-                // Down
-                {
-                    const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::DOWN, Vec3::FORWARD);
-                    l.view_projections[IDX_DOWN] = (light_view * light_projection).Transpose();
-                }
+            // Up
+            {
+                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::UP, Vec3::BACKWARD);
+                l.view_projections[IDX_UP] = (light_view * light_projection).Transpose();;
+            }
 
-                // Forward
-                {
-                    const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::FORWARD, Vec3::UP);
-                    l.view_projections[IDX_FORWARD] = (light_view * light_projection).Transpose();
-                }
+            // Down
+            {
+                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::DOWN, Vec3::FORWARD);
+                l.view_projections[IDX_DOWN] = (light_view * light_projection).Transpose();
+            }
 
-                // Backward
-                {
-                    const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::BACKWARD, Vec3::UP);
-                    l.view_projections[IDX_BACKWARD] = (light_view * light_projection).Transpose();
-                }
+            // Forward
+            {
+                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::FORWARD, Vec3::UP);
+                l.view_projections[IDX_FORWARD] = (light_view * light_projection).Transpose();
+            }
 
-                renderer->Enqueue(l);
+            // Backward
+            {
+                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + Vec3::BACKWARD, Vec3::UP);
+                l.view_projections[IDX_BACKWARD] = (light_view * light_projection).Transpose();
             }
-        }
 
+            renderer->Enqueue(l);
+        });
+
+    world.Each<TransformComponent, SpotLightComponent>([renderer](TransformComponent& transform, SpotLightComponent& light)
         {
-            SpotLightComponent* light = entity->GetComponent<SpotLightComponent>();
-            if (light != nullptr && light->is_enabled_)
+            if (light.is_enabled_ == false)
             {
-                Renderer* renderer = (Renderer*)gfx::renderer;
-                CHECK(renderer);
-
-                static constexpr float ASPECT_RATIO = 1.0f;
-
-                const Vec3 light_pos = entity->transform_->GetWorldTranslation();
-                const Vec3 light_dir = entity->transform_->GetWorldForward().xyz().Normalize();
-                const float near_z = 0.1f;
-                const float far_z = 30.0f; // TODO: Max shadow distance should be a global / per light property?
-
-                const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + light_dir, Vec3::UP);
-                const Mat4 light_projection = Mat4::PerspectiveFovLH(PI_DIV2, ASPECT_RATIO, near_z, far_z);
-                const Mat4 light_view_projection = light_view * light_projection;
-
-                renderer->Enqueue(SpotLight
-                    {
-                        .position_ws = light_pos,
-                        .ambient_intensity = light->ambient_intensity_,
-                        .color = light->color_,
-                        .attenuation = light->attenuation_,
-                        .cone_dir_ws = light_dir,
-                        .cos_cone_angle = cosf(MathUtils::DegToRad(light->cone_angle_)),
-                        .view_projection = light_view_projection.Transpose(),
-                        .brightness = light->brightness_
-                    });
+                return;
             }
+
+            static constexpr float ASPECT_RATIO = 1.0f;
+
+            const Vec3 light_pos = transform.GetWorldTranslation();
+            const Vec3 light_dir = transform.GetWorldForward().xyz().Normalize();
+            const float near_z = 0.1f;
+            const float far_z = 30.0f; // TODO: Max shadow distance should be a global / per light property?
+
+            const Mat4 light_view = Mat4::LookAt(light_pos, light_pos + light_dir, Vec3::UP);
+            const Mat4 light_projection = Mat4::PerspectiveFovLH(PI_DIV2, ASPECT_RATIO, near_z, far_z);
+            const Mat4 light_view_projection = light_view * light_projection;
+
+            renderer->Enqueue(SpotLight
+                {
+                    .position_ws = light_pos,
+                    .ambient_intensity = light.ambient_intensity_,
+                    .color = light.color_,
+                    .attenuation = light.attenuation_,
+                    .cone_dir_ws = light_dir,
+                    .cos_cone_angle = cosf(MathUtils::DegToRad(light.cone_angle_)),
+                    .view_projection = light_view_projection.Transpose(),
+                    .brightness = light.brightness_
+                });
+        });
+
+    // Camera frustum culling
+    camera_cull_stats_ = {};
+    FrustumCull(Frustum::FromViewProjection(gfx::camera.GetViewProjection()), cull_bounds_, camera_visibility_, camera_cull_stats_);
+    for (uint32 i = 0; i < (uint32) cull_candidates_.size(); ++i)
+    {
+        if (camera_visibility_.IsSet(i))
+        {
+            renderer->Enqueue(cull_candidates_[i].item, cull_candidates_[i].blend_state);
         }
     }
 
@@ -296,6 +320,14 @@ void AppShadowMapping::RenderUI()
 
     ImGui::Begin("Debug Menu");
 
+    ImGui::Text("Pipeline State");
+    ImGui::Text("Draw calls: %u (%u instances)", gfx::last_frame_stats.num_draw_calls, gfx::last_frame_stats.num_instances);
+    ImGui::Text("State changes issued: %u", gfx::last_frame_stats.num_calls_issued);
+    ImGui::Text("State changes skipped: %u", gfx::last_frame_stats.num_calls_skipped);
+    ImGui::Text("Camera culling: %u / %u meshes visible", camera_cull_stats_.num_visible, camera_cull_stats_.num_tested);
+    ImGui::Text("Entities: %u (%u archetypes)", world.GetRegistry().GetNumEntities(), world.GetRegistry().GetNumArchetypes());
+    ImGui::Text("Transforms: %u / %u recomputed", world.GetTransformStats().num_recomputed, world.GetTransformStats().num_nodes);
+
     ImGui::Text("Camera");
     Vec3 camera_pos = gfx::camera.GetPosition();
     ImGui::SliderFloat3("Position##Camera", reinterpret_cast<float*>(&camera_pos), -10.0, 10.0f,
@@ -306,65 +338,65 @@ void AppShadowMapping::RenderUI()
         0.0f, 180.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
     gfx::camera.SetFov(MathUtils::DegToRad(fov));
 
-    for (SharedPtr<Entity> e : world.GetEntities())
-    {
-        if(DirectionalLightComponent* l = e->GetComponent<DirectionalLightComponent>())
+    world.Each<NameComponent, TransformComponent, DirectionalLightComponent>([](NameComponent& name, TransformComponent& transform, DirectionalLightComponent& l)
         {
-            ImGui::Text("%s", e->name_.c_str());
-            ImGui::Checkbox("enabled", &l->is_enabled_);
+            const String& entity_name = name.name_;
+            ImGui::Text("%s", entity_name.c_str());
+            ImGui::Checkbox("enabled", &l.is_enabled_);
 
-            Vec3 world_rot = e->transform_->GetWorldRotation().ToEuler();
-            ImGui::SliderFloat3(fmt::format("Rotation##{}", e->name_).c_str(), reinterpret_cast<float*>(&world_rot), -2.0, 2.0f,
+            Vec3 world_rot = transform.GetWorldRotation().ToEuler();
+            ImGui::SliderFloat3(fmt::format("Rotation##{}", entity_name).c_str(), reinterpret_cast<float*>(&world_rot), -2.0, 2.0f,
                 "%.3f", ImGuiSliderFlags_None);
-            e->transform_->SetWorldRotation(Quat::Normalize(Quat::FromPitchYawRoll(world_rot)));
+            transform.SetWorldRotation(Quat::Normalize(Quat::FromPitchYawRoll(world_rot)));
 
-            ImGui::SliderFloat(fmt::format("Brightness##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->brightness_),
+            ImGui::SliderFloat(fmt::format("Brightness##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.brightness_),
                 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-            ImGui::ColorPicker3("LightColor", reinterpret_cast<float*>(&l->color_));
-            ImGui::SliderFloat("AmbientIntensity", reinterpret_cast<float*>(&l->ambient_intensity_), 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-        }
+            ImGui::ColorPicker3("LightColor", reinterpret_cast<float*>(&l.color_));
+            ImGui::SliderFloat("AmbientIntensity", reinterpret_cast<float*>(&l.ambient_intensity_), 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
+        });
 
-        if (PointLightComponent* l = e->GetComponent<PointLightComponent>())
+    world.Each<NameComponent, TransformComponent, PointLightComponent>([](NameComponent& name, TransformComponent& transform, PointLightComponent& l)
         {
-            ImGui::Text("%s", e->name_.c_str());
-            ImGui::Checkbox(fmt::format("is_enabled##{}", e->name_).c_str(), &l->is_enabled_);
-            Vec3 pos = e->transform_->GetWorldTranslation();
-            ImGui::SliderFloat3(fmt::format("Pos##{}", e->name_).c_str(), reinterpret_cast<float*>(&pos), -10.0f, 10.0f, "%.3f", ImGuiSliderFlags_None);
-            e->transform_->SetWorldTranslation(pos);
-            ImGui::SliderFloat(fmt::format("Brightness##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->brightness_),
+            const String& entity_name = name.name_;
+            ImGui::Text("%s", entity_name.c_str());
+            ImGui::Checkbox(fmt::format("is_enabled##{}", entity_name).c_str(), &l.is_enabled_);
+            Vec3 pos = transform.GetWorldTranslation();
+            ImGui::SliderFloat3(fmt::format("Pos##{}", entity_name).c_str(), reinterpret_cast<float*>(&pos), -10.0f, 10.0f, "%.3f", ImGuiSliderFlags_None);
+            transform.SetWorldTranslation(pos);
+            ImGui::SliderFloat(fmt::format("Brightness##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.brightness_),
                 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-            ImGui::ColorPicker3(fmt::format("Color##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->color_));
-            ImGui::SliderFloat(fmt::format("AmbientIntensity##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->ambient_intensity_),
+            ImGui::ColorPicker3(fmt::format("Color##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.color_));
+            ImGui::SliderFloat(fmt::format("AmbientIntensity##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.ambient_intensity_),
                 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-            ImGui::SliderFloat(fmt::format("Attenuation##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->attenuation_),
+            ImGui::SliderFloat(fmt::format("Attenuation##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.attenuation_),
                 0.0f, 100.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-        }
+        });
 
-        if (SpotLightComponent* l = e->GetComponent<SpotLightComponent>())
+    world.Each<NameComponent, TransformComponent, SpotLightComponent>([](NameComponent& name, TransformComponent& transform, SpotLightComponent& l)
         {
-            ImGui::Text("%s", e->name_.c_str());
-            ImGui::Checkbox(fmt::format("is_enabled##{}", e->name_).c_str(), &l->is_enabled_);
+            const String& entity_name = name.name_;
+            ImGui::Text("%s", entity_name.c_str());
+            ImGui::Checkbox(fmt::format("is_enabled##{}", entity_name).c_str(), &l.is_enabled_);
 
-            Vec3 pos = e->transform_->GetWorldTranslation();
-            ImGui::SliderFloat3(fmt::format("Pos##{}", e->name_).c_str(), reinterpret_cast<float*>(&pos), -15.0f, 15.0f, "%.3f", ImGuiSliderFlags_None);
-            e->transform_->SetWorldTranslation(pos);
+            Vec3 pos = transform.GetWorldTranslation();
+            ImGui::SliderFloat3(fmt::format("Pos##{}", entity_name).c_str(), reinterpret_cast<float*>(&pos), -15.0f, 15.0f, "%.3f", ImGuiSliderFlags_None);
+            transform.SetWorldTranslation(pos);
 
-            Vec3 world_rot = e->transform_->GetWorldRotation().ToEuler();
-            ImGui::SliderFloat3(fmt::format("Rot##{}", e->name_).c_str(), reinterpret_cast<float*>(&world_rot), -3.0, 3.0f,
+            Vec3 world_rot = transform.GetWorldRotation().ToEuler();
+            ImGui::SliderFloat3(fmt::format("Rot##{}", entity_name).c_str(), reinterpret_cast<float*>(&world_rot), -3.0, 3.0f,
                 "%.3f", ImGuiSliderFlags_None);
-            e->transform_->SetWorldRotation(Quat::Normalize(Quat::FromPitchYawRoll(world_rot)));
-            
-            ImGui::SliderFloat(fmt::format("Brightness##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->brightness_),
+            transform.SetWorldRotation(Quat::Normalize(Quat::FromPitchYawRoll(world_rot)));
+
+            ImGui::SliderFloat(fmt::format("Brightness##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.brightness_),
                 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-            ImGui::SliderFloat(fmt::format("ConeAngle##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->cone_angle_),
+            ImGui::SliderFloat(fmt::format("ConeAngle##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.cone_angle_),
                 0.01f, 90.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-            ImGui::ColorPicker3(fmt::format("Color##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->color_));
-            ImGui::SliderFloat(fmt::format("AmbientIntensity##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->ambient_intensity_),
+            ImGui::ColorPicker3(fmt::format("Color##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.color_));
+            ImGui::SliderFloat(fmt::format("AmbientIntensity##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.ambient_intensity_),
                 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-            ImGui::SliderFloat(fmt::format("Attenuation##{}", e->name_).c_str(), reinterpret_cast<float*>(&l->attenuation_),
+            ImGui::SliderFloat(fmt::format("Attenuation##{}", entity_name).c_str(), reinterpret_cast<float*>(&l.attenuation_),
                 0.0f, 100.0f, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-        }
-    }
+        });
 
     ImGui::End();
 }
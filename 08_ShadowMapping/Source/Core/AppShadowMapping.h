@@ -1,5 +1,8 @@
 #pragma once
 #include "Core/Application.h"
+#include "Renderer/Culling.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/RenderState.h"
 
 class AppShadowMapping : public BaseApplication
 {
@@ -14,4 +17,17 @@ protected:
     virtual void RenderUI() final;
 
     void HandleSDLEvent(const SDL_Event& sdl_event) final;
+
+private:
+    struct CullCandidate
+    {
+        RenderWorkItem item;
+        BlendState blend_state = BlendState::Opaque;
+    };
+
+    // Rebuilt every frame. Candidates and bounds share the same index.
+    std::vector<CullCandidate> cull_candidates_;
+    BoundsSoA cull_bounds_;
+    VisibilityBits camera_visibility_;
+    CullStats camera_cull_stats_;
 };
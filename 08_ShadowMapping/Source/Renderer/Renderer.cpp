@@ -5,9 +5,15 @@
 #include <dxgi1_3.h>
 #endif
 
+#include <chrono>
+
+#include "imgui.h"
+
 #include "Core/Application.h"
+#include "Core/JobSystem.h"
 #include "Core/FileIO.h"
 #include "Renderer/DX11Util.h"
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/Texture.h"
 #include "Renderer/Vertex.h"
 
@@ -23,43 +29,42 @@ Renderer::Renderer()
     render_target_view_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
     render_target_view_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
 
+    ComPtr<ID3D11RenderTargetView> backbuffer_color_view;
     DX11_VERIFY(gfx::device->CreateRenderTargetView(
         backbuffer.Get(), // Ptr to render target
         &render_target_view_desc,    // Ptr to D3D11_RENDER_TARGET_VIEW_DESC, nullptr to create view of entire subresource at mipmap lvl 0
-        &backbuffer_color_view_));
+        &backbuffer_color_view));
+    backbuffer_color_view_ = WrapNative<GpuRenderTargetView>(backbuffer_color_view);
 
     // Create depth/stencil buffer and view
     DX11_VERIFY(gfx::swapchain->GetDesc1(&swap_chain_desc_));
 
-    D3D11_TEXTURE2D_DESC depth_buffer_desc = {};
-    depth_buffer_desc.ArraySize = 1;
-    depth_buffer_desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-    depth_buffer_desc.CPUAccessFlags = 0; // No CPU access
-    depth_buffer_desc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-    depth_buffer_desc.Width = swap_chain_desc_.Width;
-    depth_buffer_desc.Height = swap_chain_desc_.Height;
-    depth_buffer_desc.MipLevels = 1;
-    depth_buffer_desc.SampleDesc.Count = 1;
-    depth_buffer_desc.SampleDesc.Quality = 0;
-    depth_buffer_desc.Usage = D3D11_USAGE_DEFAULT;  // Read and write access by the GPU
-
-    DX11_VERIFY(gfx::device->CreateTexture2D(&depth_buffer_desc,
-        nullptr,    // ptr to initial data
-        &depth_buffer_));
-    SetDebugName(depth_buffer_.Get(), "DEPTH BUFFER");
-
-    DX11_VERIFY(gfx::device->CreateDepthStencilView(depth_buffer_.Get(), nullptr, &backbuffer_depth_view_));
-    SetDebugName(backbuffer_depth_view_.Get(), "DEPTH VIEW");
+    GpuTextureDesc depth_buffer_desc = {};
+    depth_buffer_desc.width = swap_chain_desc_.Width;
+    depth_buffer_desc.height = swap_chain_desc_.Height;
+    depth_buffer_desc.format = GpuFormat::D24_UNorm_S8_UInt;
+    depth_buffer_desc.usage = GpuUsage::Default;  // Read and write access by the GPU
+    depth_buffer_desc.bind_flags = GpuBind::DepthStencil;
+
+    depth_buffer_ = gfx::backend->CreateTexture2D(depth_buffer_desc);
+    depth_buffer_->SetDebugName("DEPTH BUFFER");
+
+    backbuffer_depth_view_ = gfx::backend->CreateDepthStencilView(depth_buffer_.get());
+    backbuffer_depth_view_->SetDebugName("DEPTH VIEW");
 
     // Set up cbuffers
     cbuffer_per_frame_ = MakeUnique<ConstantBuffer>((uint32) sizeof(CBufferPerFrame));
-    SetDebugName(cbuffer_per_frame_ ->buffer_.Get(), "Per Frame");
+    cbuffer_per_frame_->buffer_->SetDebugName("Per Frame");
     cbuffer_per_view_ = MakeUnique<ConstantBuffer>((uint32)sizeof(CBufferPerView));
-    SetDebugName(cbuffer_per_view_->buffer_.Get(), "Per View");
+    cbuffer_per_view_->buffer_->SetDebugName("Per View");
     cbuffer_light_ = MakeUnique<ConstantBuffer>((uint32)sizeof(CBufferLight));
-    SetDebugName(cbuffer_light_->buffer_.Get(), "Light Data");
+    cbuffer_light_->buffer_->SetDebugName("Light Data");
     cbuffer_light_view_ = MakeUnique<ConstantBuffer>((uint32)sizeof(CBufferLightView));
-    SetDebugName(cbuffer_light_view_->buffer_.Get(), "Shadow Data");
+    cbuffer_light_view_->buffer_->SetDebugName("Shadow Data");
+
+    instance_buffer_ = MakeUnique<InstanceBuffer>();
+    forward_opaque_.queue = &render_queue_opaque_;
+    forward_translucent_.queue = &render_queue_translucent_;
 
     // Set up camera
     // TODO: This probably also shouldn't be in the renderer. Instead we want to grab the currently active camera from the scene
@@ -70,116 +75,98 @@ Renderer::Renderer()
     // --- Shadow Pass
     // Directional Light
     {
-        D3D11_TEXTURE2D_DESC shadow_map_desc = {};
-        shadow_map_desc.Width = SHADOW_MAP_SIZE;
-        shadow_map_desc.Height = SHADOW_MAP_SIZE;
-        shadow_map_desc.ArraySize = DirectionalLight::NUM_CASCADES;
-        shadow_map_desc.Format = DXGI_FORMAT_R32_TYPELESS;
-        shadow_map_desc.Usage = D3D11_USAGE_DEFAULT;  // Read and write access by the GPU
-        shadow_map_desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
-        shadow_map_desc.CPUAccessFlags = 0; // No CPU access
-        shadow_map_desc.MipLevels = 1;
-        shadow_map_desc.SampleDesc.Count = 1;
-        shadow_map_desc.SampleDesc.Quality = 0;
-
-        DX11_VERIFY(gfx::device->CreateTexture2D(&shadow_map_desc, nullptr, &directional_shadow_map_));
-        SetDebugName(directional_shadow_map_.Get(), "DIRECTIONAL SHADOW MAP");
+        GpuTextureDesc shadow_map_desc = {};
+        shadow_map_desc.width = SHADOW_MAP_SIZE;
+        shadow_map_desc.height = SHADOW_MAP_SIZE;
+        shadow_map_desc.array_size = DirectionalLight::NUM_CASCADES;
+        shadow_map_desc.format = GpuFormat::R32_Typeless;
+        shadow_map_desc.usage = GpuUsage::Default;  // Read and write access by the GPU
+        shadow_map_desc.bind_flags = GpuBind::DepthStencil | GpuBind::ShaderResource;
+
+        directional_shadow_map_ = gfx::backend->CreateTexture2D(shadow_map_desc);
+        directional_shadow_map_->SetDebugName("DIRECTIONAL SHADOW MAP");
 
         for (int i = 0; i<DirectionalLight::NUM_CASCADES; ++i)
         {
-            D3D11_DEPTH_STENCIL_VIEW_DESC depth_stencil_view_desc = {};
-            depth_stencil_view_desc.Format = DXGI_FORMAT_D32_FLOAT;
-            depth_stencil_view_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
-            depth_stencil_view_desc.Texture2DArray.ArraySize = 1;
-            depth_stencil_view_desc.Texture2DArray.FirstArraySlice = i;
-            depth_stencil_view_desc.Texture2DArray.MipSlice = 0;
-
-            DX11_VERIFY(gfx::device->CreateDepthStencilView(directional_shadow_map_.Get(), &depth_stencil_view_desc,
-                &directional_shadow_map_dsvs_[i]));
-            SetDebugName(directional_shadow_map_dsvs_[i].Get(), "DIRECTIONAL SHADOW MAP DSV " + i);
+            GpuViewDesc depth_stencil_view_desc = {};
+            depth_stencil_view_desc.format = GpuFormat::D32_Float;
+            depth_stencil_view_desc.dimension = GpuViewDimension::Texture2DArray;
+            depth_stencil_view_desc.array_size = 1;
+            depth_stencil_view_desc.first_array_slice = i;
+
+            directional_shadow_map_dsvs_[i] = gfx::backend->CreateDepthStencilView(directional_shadow_map_.get(), depth_stencil_view_desc);
+            directional_shadow_map_dsvs_[i]->SetDebugName(fmt::format("DIRECTIONAL SHADOW MAP DSV {}", i));
         }
 
-        D3D11_SHADER_RESOURCE_VIEW_DESC shadow_map_srv_desc = {};
-        shadow_map_srv_desc.Format = DXGI_FORMAT_R32_FLOAT;
-        shadow_map_srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
-        shadow_map_srv_desc.Texture2DArray.ArraySize = DirectionalLight::NUM_CASCADES;
-        shadow_map_srv_desc.Texture2DArray.FirstArraySlice = 0;
-        shadow_map_srv_desc.Texture2DArray.MipLevels = 1;
+        GpuViewDesc shadow_map_srv_desc = {};
+        shadow_map_srv_desc.format = GpuFormat::R32_Float;
+        shadow_map_srv_desc.dimension = GpuViewDimension::Texture2DArray;
+        shadow_map_srv_desc.array_size = DirectionalLight::NUM_CASCADES;
+        shadow_map_srv_desc.first_array_slice = 0;
 
-        DX11_VERIFY(gfx::device->CreateShaderResourceView(directional_shadow_map_.Get(), &shadow_map_srv_desc, &directional_shadow_map_srv_));
-        SetDebugName(directional_shadow_map_srv_.Get(), "DIRECTIONAL SHADOW MAP SRV");
+        directional_shadow_map_srv_ = gfx::backend->CreateShaderResourceView(directional_shadow_map_.get(), shadow_map_srv_desc);
+        directional_shadow_map_srv_->SetDebugName("DIRECTIONAL SHADOW MAP SRV");
     }
 
     // Spot Light
     {
-        D3D11_TEXTURE2D_DESC shadow_map_desc = {};
-        shadow_map_desc.ArraySize = 1;
-        shadow_map_desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
-        shadow_map_desc.CPUAccessFlags = 0; // No CPU access
-        shadow_map_desc.Format = DXGI_FORMAT_R32_TYPELESS;
-        shadow_map_desc.Width = SHADOW_MAP_SIZE;
-        shadow_map_desc.Height = SHADOW_MAP_SIZE;
-        shadow_map_desc.MipLevels = 1;
-        shadow_map_desc.SampleDesc.Count = 1;
-        shadow_map_desc.SampleDesc.Quality = 0;
-        shadow_map_desc.Usage = D3D11_USAGE_DEFAULT;  // Read and write access by the GPU
-
-        DX11_VERIFY(gfx::device->CreateTexture2D(&shadow_map_desc, nullptr, &spot_shadow_map_));
-        SetDebugName(spot_shadow_map_.Get(), "SPOT SHADOW MAP");
-
-        D3D11_DEPTH_STENCIL_VIEW_DESC depth_stencil_view_desc = {};
-        depth_stencil_view_desc.Format = DXGI_FORMAT_D32_FLOAT;
-        depth_stencil_view_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-
-        DX11_VERIFY(gfx::device->CreateDepthStencilView(spot_shadow_map_.Get(), &depth_stencil_view_desc, &spot_shadow_map_dsv_));
-        SetDebugName(spot_shadow_map_dsv_.Get(), "SPOT SHADOW MAP DEPTH STENCIL VIEW");
-
-        D3D11_SHADER_RESOURCE_VIEW_DESC shadow_map_srv_desc = {};
-        shadow_map_srv_desc.Format = DXGI_FORMAT_R32_FLOAT;
-        shadow_map_srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        shadow_map_srv_desc.Texture2D.MipLevels = 1;
-
-        DX11_VERIFY(gfx::device->CreateShaderResourceView(spot_shadow_map_.Get(), &shadow_map_srv_desc, &spot_shadow_map_srv_));
-        SetDebugName(spot_shadow_map_srv_.Get(), "SPOT SHADOW MAP SRV");
+        GpuTextureDesc shadow_map_desc = {};
+        shadow_map_desc.bind_flags = GpuBind::DepthStencil | GpuBind::ShaderResource;
+        shadow_map_desc.format = GpuFormat::R32_Typeless;
+        shadow_map_desc.width = SHADOW_MAP_SIZE;
+        shadow_map_desc.height = SHADOW_MAP_SIZE;
+        shadow_map_desc.usage = GpuUsage::Default;  // Read and write access by the GPU
+
+        spot_shadow_map_ = gfx::backend->CreateTexture2D(shadow_map_desc);
+        spot_shadow_map_->SetDebugName("SPOT SHADOW MAP");
+
+        GpuViewDesc depth_stencil_view_desc = {};
+        depth_stencil_view_desc.format = GpuFormat::D32_Float;
+        depth_stencil_view_desc.dimension = GpuViewDimension::Texture2D;
+
+        spot_shadow_map_dsv_ = gfx::backend->CreateDepthStencilView(spot_shadow_map_.get(), depth_stencil_view_desc);
+        spot_shadow_map_dsv_->SetDebugName("SPOT SHADOW MAP DEPTH STENCIL VIEW");
+
+        GpuViewDesc shadow_map_srv_desc = {};
+        shadow_map_srv_desc.format = GpuFormat::R32_Float;
+        shadow_map_srv_desc.dimension = GpuViewDimension::Texture2D;
+
+        spot_shadow_map_srv_ = gfx::backend->CreateShaderResourceView(spot_shadow_map_.get(), shadow_map_srv_desc);
+        spot_shadow_map_srv_->SetDebugName("SPOT SHADOW MAP SRV");
     }
 
     // Point Light
     {
-        D3D11_TEXTURE2D_DESC shadow_map_desc = {};
-        shadow_map_desc.ArraySize = 6;  // cube map
-        shadow_map_desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
-        shadow_map_desc.CPUAccessFlags = 0; // No CPU access
-        shadow_map_desc.Format = DXGI_FORMAT_R32_TYPELESS;
-        shadow_map_desc.Width = SHADOW_MAP_SIZE;
-        shadow_map_desc.Height = SHADOW_MAP_SIZE;
-        shadow_map_desc.MipLevels = 1;
-        shadow_map_desc.SampleDesc.Count = 1;
-        shadow_map_desc.SampleDesc.Quality = 0;
-        shadow_map_desc.Usage = D3D11_USAGE_DEFAULT;  // Read and write access by the GPU
-        shadow_map_desc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
-
-        DX11_VERIFY(gfx::device->CreateTexture2D(&shadow_map_desc, nullptr, &point_shadow_map_));
-        SetDebugName(point_shadow_map_.Get(), "POINT SHADOW MAP");
+        GpuTextureDesc shadow_map_desc = {};
+        shadow_map_desc.array_size = 6;  // cube map
+        shadow_map_desc.bind_flags = GpuBind::DepthStencil | GpuBind::ShaderResource;
+        shadow_map_desc.format = GpuFormat::R32_Typeless;
+        shadow_map_desc.width = SHADOW_MAP_SIZE;
+        shadow_map_desc.height = SHADOW_MAP_SIZE;
+        shadow_map_desc.usage = GpuUsage::Default;  // Read and write access by the GPU
+        shadow_map_desc.is_cube = true;
+
+        point_shadow_map_ = gfx::backend->CreateTexture2D(shadow_map_desc);
+        point_shadow_map_->SetDebugName("POINT SHADOW MAP");
 
         for (int i = 0; i < 6; ++i)
         {
-            D3D11_DEPTH_STENCIL_VIEW_DESC depth_stencil_view_desc = {};
-            depth_stencil_view_desc.Format = DXGI_FORMAT_D32_FLOAT;
-            depth_stencil_view_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
-            depth_stencil_view_desc.Texture2DArray.ArraySize = 1;
-            depth_stencil_view_desc.Texture2DArray.FirstArraySlice = i;
-
-            DX11_VERIFY(gfx::device->CreateDepthStencilView(point_shadow_map_.Get(), &depth_stencil_view_desc, &point_shadow_map_dsvs_[i]));
-            SetDebugName(point_shadow_map_dsvs_[i].Get(), fmt::format("POINT SHADOW MAP DEPTH STENCIL VIEW {}", i).c_str());
+            GpuViewDesc depth_stencil_view_desc = {};
+            depth_stencil_view_desc.format = GpuFormat::D32_Float;
+            depth_stencil_view_desc.dimension = GpuViewDimension::Texture2DArray;
+            depth_stencil_view_desc.array_size = 1;
+            depth_stencil_view_desc.first_array_slice = i;
+
+            point_shadow_map_dsvs_[i] = gfx::backend->CreateDepthStencilView(point_shadow_map_.get(), depth_stencil_view_desc);
+            point_shadow_map_dsvs_[i]->SetDebugName(fmt::format("POINT SHADOW MAP DEPTH STENCIL VIEW {}", i));
         }
 
-        D3D11_SHADER_RESOURCE_VIEW_DESC shadow_map_srv_desc = {};
-        shadow_map_srv_desc.Format = DXGI_FORMAT_R32_FLOAT;
-        shadow_map_srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
-        shadow_map_srv_desc.Texture2D.MipLevels = 1;
+        GpuViewDesc shadow_map_srv_desc = {};
+        shadow_map_srv_desc.format = GpuFormat::R32_Float;
+        shadow_map_srv_desc.dimension = GpuViewDimension::TextureCube;
 
-        DX11_VERIFY(gfx::device->CreateShaderResourceView(point_shadow_map_.Get(), &shadow_map_srv_desc, &point_shadow_map_srv_));
-        SetDebugName(point_shadow_map_srv_.Get(), "POINT SHADOW MAP SRV");
+        point_shadow_map_srv_ = gfx::backend->CreateShaderResourceView(point_shadow_map_.get(), shadow_map_srv_desc);
+        point_shadow_map_srv_->SetDebugName("POINT SHADOW MAP SRV");
     }
 }
 
@@ -187,38 +174,75 @@ Renderer::~Renderer()
 {
 }
 
+void LodStats::Add(const RenderQueue& queue)
+{
+    for (const RenderWorkItem& item : queue.items_)
+    {
+        num_triangles += item.mesh->num_indices / 3;
+        ++num_meshes[item.mesh->lod];
+    }
+}
+
 void Renderer::Render()
 {
     render_queue_opaque_.Sort();
     render_queue_translucent_.Sort();
+    render_queue_shadow_casters_.Sort();
+
+    forward_lod_stats_ = {};
+    forward_lod_stats_.Add(render_queue_opaque_);
+    forward_lod_stats_.Add(render_queue_translucent_);
+    shadow_lod_stats_ = {};
+    shadow_lod_stats_.Add(render_queue_shadow_casters_);
+
+    // Before anything binds the textures, streaming in or evicting mips replaces their views
+    gfx::resource_manager->texture_streamer.Update();
+    RequestTextureMips();
+
+    instance_buffer_->BeginFrame();
+    forward_instancing_stats_ = {};
+    shadow_instancing_stats_ = {};
 
     // Unbind all SRV slots - I'm just too lazy to micromanage this right now :s
-    ID3D11ShaderResourceView* null_views[] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
-    gfx::device_context->PSSetShaderResources(0, ARRAYSIZE(null_views), null_views);
+    // Goes through the state tracker, so binding the shadow maps as DSVs can't leave stale SRVs in the cache.
+    for (uint32 slot = 0; slot < 6; ++slot)
+    {
+        gfx::SetPSShaderResource(nullptr, slot);
+    }
+
+    PrepareShadowViews();
+
+    // The forward queues only hold objects which passed camera culling, their clusters are tested against the camera once more
+    const ClusterCullView camera_cluster_view
+    {
+        .frustum = Frustum::FromViewProjection(gfx::camera.GetViewProjection()),
+        .viewer = Vec4(gfx::camera.GetPosition(), 1.0f)
+    };
+    forward_opaque_.clusters.view = camera_cluster_view;
+    forward_translucent_.clusters.view = camera_cluster_view;
+
+    const auto encode_start = std::chrono::high_resolution_clock::now();
+    EncodeCommandLists();
+    const auto replay_start = std::chrono::high_resolution_clock::now();
 
     RenderShadowPass();
 
-    D3D11_VIEWPORT viewport;
-    viewport.Width = (float)swap_chain_desc_.Width;
-    viewport.Height = (float)swap_chain_desc_.Height;
-    viewport.TopLeftX = 0.0f;
-    viewport.TopLeftY = 0.0f;
-    viewport.MinDepth = 0.0f;
-    viewport.MaxDepth = 1.0f;
-    gfx::device_context->RSSetViewports(1, &viewport);
+    Viewport viewport;
+    viewport.width = (float)swap_chain_desc_.Width;
+    viewport.height = (float)swap_chain_desc_.Height;
+    gfx::SetViewport(viewport);
 
     // Bind render target views to output merger stage of pipeline
-    gfx ::device_context->OMSetRenderTargets(1, backbuffer_color_view_.GetAddressOf(), backbuffer_depth_view_.Get());
+    gfx::SetRenderTargets(backbuffer_color_view_.get(), backbuffer_depth_view_.get());
 
     // Clear backbuffer
-    gfx::device_context->ClearRenderTargetView(backbuffer_color_view_.Get(), clear_color_);
-    gfx::device_context->ClearDepthStencilView(backbuffer_depth_view_.Get(),
-        D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f /*depth clear val*/, 0 /*stencil clear val*/);
+    gfx::ClearRenderTarget(backbuffer_color_view_.get(), clear_color_);
+    gfx::ClearDepthStencil(backbuffer_depth_view_.get(), GpuClear::Depth | GpuClear::Stencil, 1.0f /*depth clear val*/, 0 /*stencil clear val*/);
 
     // Update per-frame cbuffer
     cbuffer_per_frame_->Upload(reinterpret_cast<uint8*>(&per_frame_data_), sizeof(CBufferPerFrame));
     static constexpr int CBUFFER_SLOT_PER_FRAME = 0;
-    gfx::SetConstantBuffer(cbuffer_per_frame_->buffer_.Get(), CBUFFER_SLOT_PER_FRAME);
+    gfx::SetConstantBuffer(cbuffer_per_frame_->buffer_.get(), CBUFFER_SLOT_PER_FRAME);
 
     // Update per-view cbuffer
     per_view_data_.mat_view = gfx::camera.GetView().Transpose(); // CPU: row major, GPU: col major! -> We have to transpose
@@ -229,7 +253,7 @@ void Renderer::Render()
 
     cbuffer_per_view_->Upload(reinterpret_cast<uint8*>(&per_view_data_), sizeof(CBufferPerView));
     static constexpr int CBUFFER_SLOT_PER_VIEW = 1;
-    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.Get(), CBUFFER_SLOT_PER_VIEW);
+    gfx::SetConstantBuffer(cbuffer_per_view_->buffer_.get(), CBUFFER_SLOT_PER_VIEW);
 
     // Update scene lighting
     light_data_ = {};
@@ -251,37 +275,27 @@ void Renderer::Render()
         ++light_data_.num_spot_lights;
     }
 
-    gfx::device_context->PSSetShaderResources(2, 1 /*num views*/, directional_shadow_map_srv_.GetAddressOf());
-    gfx::device_context->PSSetShaderResources(3, 1 /*num views*/, spot_shadow_map_srv_.GetAddressOf());
-    gfx::device_context->PSSetShaderResources(4, 1 /*num views*/, point_shadow_map_srv_.GetAddressOf());
+    gfx::SetPSShaderResource(directional_shadow_map_srv_.get(), 2);
+    gfx::SetPSShaderResource(spot_shadow_map_srv_.get(), 3);
+    gfx::SetPSShaderResource(point_shadow_map_srv_.get(), 4);
     cbuffer_light_->Upload(reinterpret_cast<uint8*>(&light_data_), sizeof(CBufferLight));
     static constexpr int CBUFFER_SLOT_LIGHT_DATA = 3;
-    gfx::SetConstantBuffer(cbuffer_light_->buffer_.Get(), CBUFFER_SLOT_LIGHT_DATA);
+    gfx::SetConstantBuffer(cbuffer_light_->buffer_.get(), CBUFFER_SLOT_LIGHT_DATA);
 
     // Forward Pass - Opaque
-    {
-        for (size_t idx : render_queue_opaque_.item_indices_)
-        {
-            const RenderWorkItem& item = render_queue_opaque_.items_[idx];
-            item.mesh->model->Bind();
-            item.mesh->Bind();
-            item.mesh->Render();
-        }
-    }
+    forward_opaque_.commands.Replay();
 
     // Forward Pass - Translucent
-    {
-        for (size_t idx : render_queue_translucent_.item_indices_)
-        {
-            const RenderWorkItem& item = render_queue_translucent_.items_[idx];
-            item.mesh->model->Bind();
-            item.mesh->Bind();
-            item.mesh->Render();
-        }
-    }
+    // Batches only merge neighbors in the sorted queue and instances are rasterized in order, so blending stays back to front.
+    forward_translucent_.commands.Replay();
+
+    const auto replay_end = std::chrono::high_resolution_clock::now();
+    encode_ms_ = std::chrono::duration<double, std::milli>(replay_start - encode_start).count();
+    replay_ms_ = std::chrono::duration<double, std::milli>(replay_end - replay_start).count();
 
     render_queue_opaque_.Clear();
     render_queue_translucent_.Clear();
+    render_queue_shadow_casters_.Clear();
     directional_lights_.clear();
     point_lights_.clear();
     spot_lights_.clear();
@@ -294,7 +308,7 @@ void Renderer::Enqueue(const RenderWorkItem& item, BlendState blend_state)
         case BlendState::Opaque:
             if (is_opaque_queue_enabled_)
             {
-                render_queue_opaque_.Add(item);
+                render_queue_opaque_.Add(SelectLod(item, lod_error_pixels_));
             }
             break;
         case BlendState::Additive:
@@ -302,7 +316,7 @@ void Renderer::Enqueue(const RenderWorkItem& item, BlendState blend_state)
         case BlendState::NonPremultipliedAlpha:
             if (is_translucent_queue_enabled_)
             {
-                render_queue_translucent_.Add(item);
+                render_queue_translucent_.Add(SelectLod(item, lod_error_pixels_));
             }
             break;
         default:
@@ -310,6 +324,36 @@ void Renderer::Enqueue(const RenderWorkItem& item, BlendState blend_state)
     }
 }
 
+void Renderer::EnqueueShadowCaster(const RenderWorkItem& item)
+{
+    // Casters are drawn into up to 11 shadow views, so they take a coarser LOD than the camera. The depth bias already offsets
+    // them by a few texels, which absorbs the larger simplification error.
+    render_queue_shadow_casters_.Add(SelectLod(item, shadow_lod_error_pixels_));
+}
+
+RenderWorkItem Renderer::SelectLod(const RenderWorkItem& item, float max_error_pixels) const
+{
+    RenderWorkItem lod_item = item;
+    if (is_lod_enabled_ && item.mesh != nullptr && item.mesh->num_lods > 0)
+    {
+        lod_item.mesh = item.mesh->SelectLod(CalcProjectedRadius(*item.mesh), max_error_pixels);
+    }
+    return lod_item;
+}
+
+float Renderer::CalcProjectedRadius(const StaticMesh& mesh) const
+{
+    const float pixels_per_unit = (float) swap_chain_desc_.Height / (2.0f * std::tan(gfx::camera.GetFov() * 0.5f));
+    const Mat4 world_matrix = mesh.model->transform.GetWorldMatrix();
+
+    // The rows of the world matrix are the scaled axes, reading the largest scale from them doesn't need a decomposition
+    const float max_scaling = std::sqrt(std::max({ Vec3(world_matrix._11, world_matrix._12, world_matrix._13).LengthSquared(),
+        Vec3(world_matrix._21, world_matrix._22, world_matrix._23).LengthSquared(), Vec3(world_matrix._31, world_matrix._32, world_matrix._33).LengthSquared() }));
+    const float radius = mesh.bounds.GetExtents().Length() * max_scaling;
+    const float distance = std::max((mesh.bounds.center * world_matrix - gfx::camera.GetPosition()).Length(), gfx::camera.GetNearClip());
+    return radius / distance * pixels_per_unit;
+}
+
 void Renderer::CalculateCascades(DirectionalLight& light)
 {
     static const float ratios[] = { 0.05f, 0.15f, 0.5f, 1.00f };
@@ -403,8 +447,121 @@ void Renderer::Enqueue(const PointLight& light)
     point_lights_.push_back(light);
 }
 
+void Renderer::RequestTextureMips()
+{
+    // Projected diameter of the bounding sphere. Shadow casters don't count, the shadow maps don't sample the materials' textures.
+    TextureStreamer& texture_streamer = gfx::resource_manager->texture_streamer;
+
+    for (const RenderQueue* queue : { &render_queue_opaque_, &render_queue_translucent_ })
+    {
+        for (const RenderWorkItem& item : queue->items_)
+        {
+            const StaticMesh& mesh = *item.mesh;
+            const Material* material = gfx::resource_manager->materials.Get(mesh.model->materials_[mesh.material_slot]);
+            if (material == nullptr || material->texture_parameters_.empty())
+            {
+                continue;
+            }
+
+            texture_streamer.Request(*material, 2.0f * CalcProjectedRadius(mesh));
+        }
+    }
+}
+
 void Renderer::RenderUI()
 {
+    ImGui::Begin("Renderer");
+
+    ImGui::Checkbox("Instancing", &is_instancing_enabled_);
+    ImGui::Text("Forward: %u meshes in %u draws", forward_instancing_stats_.num_items, forward_instancing_stats_.num_draw_calls);
+    ImGui::Text("Shadows: %u meshes in %u draws", shadow_instancing_stats_.num_items, shadow_instancing_stats_.num_draw_calls);
+
+    ImGui::Separator();
+    ImGui::Checkbox("Cluster culling", &is_cluster_culling_enabled_);
+    ImGui::Text("Camera: %.1f%% of %llu triangles rejected", forward_triangle_stats_.GetRejectedPercent(), forward_triangle_stats_.num_triangles);
+
+    ImGui::Separator();
+    ImGui::Checkbox("LODs", &is_lod_enabled_);
+    ImGui::SliderFloat("LOD error (px)", &lod_error_pixels_, 0.25f, 8.0f);
+    ImGui::SliderFloat("Shadow LOD error (px)", &shadow_lod_error_pixels_, 0.25f, 32.0f);
+    static_assert(StaticMesh::MAX_LODS == 4);
+    ImGui::Text("Forward: %llu triangles queued, meshes per LOD %u / %u / %u / %u", forward_lod_stats_.num_triangles,
+        forward_lod_stats_.num_meshes[0], forward_lod_stats_.num_meshes[1], forward_lod_stats_.num_meshes[2], forward_lod_stats_.num_meshes[3]);
+    ImGui::Text("Shadow casters: %llu triangles queued, meshes per LOD %u / %u / %u / %u", shadow_lod_stats_.num_triangles,
+        shadow_lod_stats_.num_meshes[0], shadow_lod_stats_.num_meshes[1], shadow_lod_stats_.num_meshes[2], shadow_lod_stats_.num_meshes[3]);
+
+    // Submitted to the GPU, after LOD selection and culling
+    ClusterCullStats shadow_triangle_stats = shadow_cull_stats_.spot_light_triangles;
+    for (const ClusterCullStats& stats : shadow_cull_stats_.cascade_triangles)
+    {
+        shadow_triangle_stats += stats;
+    }
+    for (const ClusterCullStats& stats : shadow_cull_stats_.point_light_face_triangles)
+    {
+        shadow_triangle_stats += stats;
+    }
+    ImGui::Text("Triangles drawn: %llu camera, %llu shadow views", forward_triangle_stats_.num_visible_triangles,
+        shadow_triangle_stats.num_visible_triangles);
+
+    uint32 num_commands = forward_opaque_.commands.GetNumCommands() + forward_translucent_.commands.GetNumCommands();
+    size_t num_command_bytes = forward_opaque_.commands.GetSizeBytes() + forward_translucent_.commands.GetSizeBytes();
+    for (uint32 view_idx = 0; view_idx < num_shadow_views_; ++view_idx)
+    {
+        num_commands += shadow_views_[view_idx].commands.GetNumCommands();
+        num_command_bytes += shadow_views_[view_idx].commands.GetSizeBytes();
+    }
+
+    ImGui::Separator();
+    ImGui::Checkbox("Parallel encoding", &is_parallel_encoding_enabled_);
+    ImGui::Text("Command lists: %u, %u commands (%.1f KiB)", num_shadow_views_ + 2, num_commands, (double) num_command_bytes / 1024.0);
+    ImGui::Text("Encode: %.3f ms, Replay: %.3f ms", encode_ms_, replay_ms_);
+
+    ImGui::Separator();
+    ImGui::Text("Shadow casters: %u", (uint32) render_queue_shadow_casters_.items_.size());
+    for (uint32 cascade_idx = 0; cascade_idx < DirectionalLight::NUM_CASCADES; ++cascade_idx)
+    {
+        const CullStats& stats = shadow_cull_stats_.cascades[cascade_idx];
+        const ClusterCullStats& triangle_stats = shadow_cull_stats_.cascade_triangles[cascade_idx];
+        ImGui::Text("Cascade %u: %u / %u drawn, %.1f%% triangles rejected", cascade_idx, stats.num_visible, stats.num_tested,
+            triangle_stats.GetRejectedPercent());
+    }
+
+    ImGui::Text("Spot lights: %u / %u drawn, %.1f%% triangles rejected", shadow_cull_stats_.spot_lights.num_visible,
+        shadow_cull_stats_.spot_lights.num_tested, shadow_cull_stats_.spot_light_triangles.GetRejectedPercent());
+
+    for (uint32 face_idx = 0; face_idx < 6; ++face_idx)
+    {
+        const CullStats& stats = shadow_cull_stats_.point_light_faces[face_idx];
+        const ClusterCullStats& triangle_stats = shadow_cull_stats_.point_light_face_triangles[face_idx];
+        ImGui::Text("Point light face %u: %u / %u drawn, %.1f%% triangles rejected", face_idx, stats.num_visible, stats.num_tested,
+            triangle_stats.GetRejectedPercent());
+    }
+
+    uint64 texture_bytes = 0;
+    gfx::resource_manager->textures.ForEach([&texture_bytes](const Texture& texture)
+    {
+        texture_bytes += texture.GetResidentBytes();
+    });
+
+    ImGui::Separator();
+    ImGui::Text("Textures: %u (%.1f MiB)", (uint32) gfx::resource_manager->textures.Size(), (double) texture_bytes / (1024.0 * 1024.0));
+
+    TextureStreamer& texture_streamer = gfx::resource_manager->texture_streamer;
+    const TextureStreamingStats& streaming_stats = texture_streamer.GetStats();
+    int32 budget_mib = (int32) (texture_streamer.GetBudget() / (1024 * 1024));
+    if (ImGui::SliderInt("Texture budget (MiB)", &budget_mib, 16, 1024))
+    {
+        texture_streamer.SetBudget((uint64) budget_mib * 1024 * 1024);
+    }
+    ImGui::Text("Streamed: %u textures, %u requested, %u loading", streaming_stats.num_textures, streaming_stats.num_requested,
+        streaming_stats.num_pending_loads);
+    ImGui::Text("Resident: %.1f MiB, Requested: %.1f MiB", (double) streaming_stats.resident_bytes / (1024.0 * 1024.0),
+        (double) streaming_stats.requested_bytes / (1024.0 * 1024.0));
+    ImGui::Text("Mips loaded: %llu, evicted: %llu", streaming_stats.num_loaded_mips, streaming_stats.num_evicted_mips);
+    ImGui::Text("Materials: %u", (uint32) gfx::resource_manager->materials.Size());
+    ImGui::Text("Shaders: %u VS, %u PS", (uint32) gfx::resource_manager->vertex_shaders.Size(), (uint32) gfx::resource_manager->pixel_shaders.Size());
+
+    ImGui::End();
 }
 
 void Renderer::RenderForwardPass()
@@ -412,151 +569,224 @@ void Renderer::RenderForwardPass()
 
 }
 
-void Renderer::RenderShadowPass()
+void Renderer::EncodeForwardQueue(ForwardQueuePass& pass) const
 {
-    for (const DirectionalLight& light : directional_lights_)
+    pass.commands.Reset();
+
+    pass.item_world_matrices.clear();
+    for (const RenderWorkItem& item : pass.queue->items_)
     {
-        for (uint32 cascade_idx = 0; cascade_idx < DirectionalLight::NUM_CASCADES; ++cascade_idx)
+        pass.item_world_matrices.push_back(item.mesh->model->GetVertexWorldMatrix().Transpose());
+    }
+
+    pass.batches.Build(*pass.queue, pass.item_world_matrices, is_instancing_enabled_ ? InstanceBatchMode::Forward : InstanceBatchMode::Disabled);
+
+    if (is_instancing_enabled_ && pass.batches.batches_.empty() == false)
+    {
+        pass.commands.UploadInstances(instance_buffer_.get(), pass.batches.world_matrices_);
+    }
+
+    pass.clusters.stats = {};
+    for (const InstanceBatch& batch : pass.batches.batches_)
+    {
+        const StaticMesh& mesh = *batch.mesh;
+        const Material* material = gfx::resource_manager->materials.Get(mesh.model->materials_[mesh.material_slot]);
+        pass.clusters.view.culled_faces = material != nullptr ? GetCulledFaces(material->rasterizer_state_) : CulledFaces::None;
+
+        const std::span<const ClusterRange> ranges = CullBatchClusters(pass.batches, batch, is_cluster_culling_enabled_, pass.clusters);
+        if (ranges.empty())
         {
-            D3D11_VIEWPORT viewport;
-            viewport.Width = (float) SHADOW_MAP_SIZE;
-            viewport.Height = (float) SHADOW_MAP_SIZE;
-            viewport.TopLeftX = 0.0f;
-            viewport.TopLeftY = 0.0f;
-            viewport.MinDepth = 0.0f;
-            viewport.MaxDepth = 1.0f;
-            gfx::device_context->RSSetViewports(1, &viewport);
-            gfx::SetRasterizerState(RasterizerState::Pancaking);
-
-            gfx::device_context->OMSetRenderTargets(0, nullptr, directional_shadow_map_dsvs_[cascade_idx].Get());
-            gfx::device_context->ClearDepthStencilView(directional_shadow_map_dsvs_[cascade_idx].Get(),
-                D3D11_CLEAR_DEPTH, 1.0f /*depth clear val*/, 0 /*stencil clear val*/);
-
-            light_view_data_.view_projection = light.view_projections[cascade_idx];
-            cbuffer_light_view_->Upload(reinterpret_cast<uint8*>(&light_view_data_), sizeof(CBufferLightView));
-            static constexpr int CBUFFER_SLOT_SHADOW_DATA = 1;
-            gfx::SetConstantBuffer(cbuffer_light_view_->buffer_.Get(), CBUFFER_SLOT_SHADOW_DATA);
-
-            static VertexShaderDesc vs_depth_desc = {
-                .path = "assets/shaders/depth_map_vs.hlsl",
-            };
-
-            static Handle<VertexShader> vs_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_desc);
-            VertexShader* vs = gfx::resource_manager->vertex_shaders.Get(vs_handle);
-            vs->Bind();
-            gfx::SetPixelShader(nullptr);
-
-            // Submit draw calls
+            continue;
+        }
+
+        if (batch.is_instanced)
+        {
+            pass.commands.BindMesh(&mesh, true);
+            for (const ClusterRange& range : ranges)
             {
-                for (size_t idx : render_queue_opaque_.item_indices_)
-                {
-                    const RenderWorkItem& item = render_queue_opaque_.items_[idx];
-                    if (item.is_shadow_receiver)
-                    {
-                        item.mesh->model->Bind();
-                        item.mesh->index_buffer->Bind();
-                        item.mesh->pos->Bind();
-                        item.mesh->Render();
-                    }
-                }
+                pass.commands.DrawIndexedInstanced(range.num_indices, batch.num_instances, mesh.start_idx + range.first_index, mesh.offset,
+                    batch.first_instance);
             }
         }
+        else
+        {
+            pass.commands.BindObjectConstants(mesh.model);
+            pass.commands.BindMesh(&mesh);
+            for (const ClusterRange& range : ranges)
+            {
+                pass.commands.DrawIndexed(range.num_indices, mesh.start_idx + range.first_index, mesh.offset);
+            }
+        }
+    }
+}
+
+ShadowView& Renderer::AddShadowView(GpuDepthStencilView* dsv, RasterizerState rasterizer_state, const Mat4& view_projection,
+    const Vec4& viewer, CullStats& cull_stats, ClusterCullStats& triangle_stats)
+{
+    if (num_shadow_views_ == shadow_views_.size())
+    {
+        shadow_views_.emplace_back();
+    }
+
+    ShadowView& view = shadow_views_[num_shadow_views_++];
+    view.dsv = dsv;
+    view.rasterizer_state = rasterizer_state;
+    view.light_view_data = {};
+    view.light_view_data.view_projection = view_projection;
+    view.frustum = Frustum::FromViewProjection(view_projection.Transpose());
+    view.candidates = nullptr;
+    view.cull_stats = &cull_stats;
+    view.triangle_stats = &triangle_stats;
+    view.clusters.view = ClusterCullView
+    {
+        .frustum = view.frustum,
+        .viewer = viewer,
+        .culled_faces = GetCulledFaces(rasterizer_state)
+    };
+    return view;
+}
+
+void Renderer::PrepareShadowViews()
+{
+    // World space bounds of all casters, indexed like the items of the caster queue and shared by all shadow views
+    shadow_caster_bounds_.Clear();
+    shadow_caster_world_matrices_.clear();
+    for (const RenderWorkItem& item : render_queue_shadow_casters_.items_)
+    {
+        const Model& model = *item.mesh->model;
+        shadow_caster_bounds_.Add(item.mesh->bounds, model.transform.GetWorldMatrix());
+        shadow_caster_world_matrices_.push_back(model.GetVertexWorldMatrix().Transpose());
+    }
+    shadow_cull_stats_ = {};
+
+    // Resolved here, looking up (and compiling) shaders is not safe on the encoding jobs
+    static const VertexShaderDesc vs_depth_desc = {
+        .path = "assets/shaders/depth_map_vs.hlsl",
+    };
+    static const VertexShaderDesc vs_depth_instanced_desc = {
+        .path = "assets/shaders/depth_map_vs.hlsl",
+        .defines = { { .name = "INSTANCED", .value = "1" } }
+    };
+    static const VertexShaderDesc vs_depth_quantized_desc = {
+        .path = "assets/shaders/depth_map_vs.hlsl",
+        .defines = { { .name = "QUANTIZED_POSITIONS", .value = "1" } }
+    };
+    static const VertexShaderDesc vs_depth_quantized_instanced_desc = {
+        .path = "assets/shaders/depth_map_vs.hlsl",
+        .defines = { { .name = "INSTANCED", .value = "1" }, { .name = "QUANTIZED_POSITIONS", .value = "1" } }
+    };
+
+    static Handle<VertexShader> vs_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_desc);
+    static Handle<VertexShader> vs_instanced_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_instanced_desc);
+    static Handle<VertexShader> vs_quantized_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_quantized_desc);
+    static Handle<VertexShader> vs_quantized_instanced_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_quantized_instanced_desc);
+    const VertexShader* vs = gfx::resource_manager->vertex_shaders.Get(is_instancing_enabled_ ? vs_instanced_handle : vs_handle);
+    const VertexShader* vs_quantized = gfx::resource_manager->vertex_shaders.Get(is_instancing_enabled_ ? vs_quantized_instanced_handle : vs_quantized_handle);
+
+    shadow_pass_ = ShadowPass
+    {
+        .casters = &render_queue_shadow_casters_,
+        .caster_bounds = &shadow_caster_bounds_,
+        .caster_world_matrices = shadow_caster_world_matrices_,
+        .cbuffer_light_view = cbuffer_light_view_.get(),
+        .instance_buffer = instance_buffer_.get(),
+        .depth_vs = { vs->GetNativePtr().get(), vs_quantized->GetNativePtr().get() },
+        .depth_input_layouts = { vs->GetInputLayout().get(), vs_quantized->GetInputLayout().get() },
+        .shadow_map_size = SHADOW_MAP_SIZE,
+        .is_instancing_enabled = is_instancing_enabled_,
+        .is_cluster_culling_enabled = is_cluster_culling_enabled_
+    };
+
+    num_shadow_views_ = 0;
+
+    for (const DirectionalLight& light : directional_lights_)
+    {
+        for (uint32 cascade_idx = 0; cascade_idx < DirectionalLight::NUM_CASCADES; ++cascade_idx)
+        {
+            // Orthographic, so the viewer is the direction towards the light
+            ShadowView& view = AddShadowView(directional_shadow_map_dsvs_[cascade_idx].get(), RasterizerState::Pancaking,
+                light.view_projections[cascade_idx], Vec4(-light.direction_ws, 0.0f),
+                shadow_cull_stats_.cascades[cascade_idx], shadow_cull_stats_.cascade_triangles[cascade_idx]);
+
+            // The ortho volume only starts at the shadow camera. With pancaking, casters between the light and the near plane
+            // are still rendered, so the volume is extended towards the light by ignoring the near plane.
+            view.frustum.DisablePlane(Frustum::NEAR_PLANE);
+            view.clusters.view.frustum.DisablePlane(Frustum::NEAR_PLANE);
+        }
     }
 
+    // Culling with the back faces is an easy fix for shadow acne. Alternative (or additionally): Add bias
+    // See: http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-16-shadow-mapping/
     for (const SpotLight& light : spot_lights_)
     {
-        D3D11_VIEWPORT viewport;
-        viewport.Width = (float)SHADOW_MAP_SIZE;
-        viewport.Height = (float)SHADOW_MAP_SIZE;
-        viewport.TopLeftX = 0.0f;
-        viewport.TopLeftY = 0.0f;
-        viewport.MinDepth = 0.0f;
-        viewport.MaxDepth = 1.0f;
-        gfx::device_context->RSSetViewports(1, &viewport);
-        gfx::SetRasterizerState(RasterizerState::CullClockwise);    // Easy fix for shadow acne.
-                                                                    // Alternative (or additionally): Add bias
-                                                                    // See: http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-16-shadow-mapping/
-
-        gfx::device_context->OMSetRenderTargets(0, nullptr, spot_shadow_map_dsv_.Get());
-        gfx::device_context->ClearDepthStencilView(spot_shadow_map_dsv_.Get(),
-            D3D11_CLEAR_DEPTH, 1.0f /*depth clear val*/, 0 /*stencil clear val*/);
-
-        light_view_data_.view_projection = light.view_projection;
-        cbuffer_light_view_->Upload(reinterpret_cast<uint8*>(&light_view_data_), sizeof(CBufferLightView));
-        static constexpr int CBUFFER_SLOT_SHADOW_DATA = 1;
-        gfx::SetConstantBuffer(cbuffer_light_view_->buffer_.Get(), CBUFFER_SLOT_SHADOW_DATA);
-
-        static VertexShaderDesc vs_depth_desc = {
-            .path = "assets/shaders/depth_map_vs.hlsl",
-        };
-        static Handle<VertexShader> vs_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_desc);
-        VertexShader* vs = gfx::resource_manager->vertex_shaders.Get(vs_handle);
-        vs->Bind();
-        gfx::SetPixelShader(nullptr);
+        AddShadowView(spot_shadow_map_dsv_.get(), RasterizerState::CullClockwise, light.view_projection, Vec4(light.position_ws, 1.0f),
+            shadow_cull_stats_.spot_lights, shadow_cull_stats_.spot_light_triangles);
+    }
+
+    point_light_range_visibility_.resize(point_lights_.size());
+    for (uint32 light_idx = 0; light_idx < (uint32) point_lights_.size(); ++light_idx)
+    {
+        const PointLight& light = point_lights_[light_idx];
+
+        // Shared by all faces, the face frusta alone would also accept casters in their far corners
+        SphereCull(Sphere(light.position_ws, light.range), shadow_caster_bounds_, point_light_range_visibility_[light_idx]);
 
-        // Submit draw calls
+        for (uint32 face_idx = 0; face_idx < 6; ++face_idx)
         {
-            for (size_t idx : render_queue_opaque_.item_indices_)
-            {
-                const RenderWorkItem& item = render_queue_opaque_.items_[idx];
-                if(item.is_shadow_receiver)
-                {
-                    item.mesh->model->Bind();
-                    item.mesh->index_buffer->Bind();
-                    item.mesh->pos->Bind();
-                    item.mesh->Render();
-                }
-            }
+            ShadowView& view = AddShadowView(point_shadow_map_dsvs_[face_idx].get(), RasterizerState::CullClockwise,
+                light.view_projections[face_idx], Vec4(light.position_ws, 1.0f), shadow_cull_stats_.point_light_faces[face_idx],
+                shadow_cull_stats_.point_light_face_triangles[face_idx]);
+            view.candidates = &point_light_range_visibility_[light_idx];
         }
     }
+}
 
-    for (const PointLight& light : point_lights_)
+void Renderer::EncodeCommandLists()
+{
+    // Encoding only reads the queues, the caster bounds and the views' own data. Anything that touches the device
+    // (uploads, instance buffer allocations, material binds) is recorded and happens during the replay.
+    if (is_parallel_encoding_enabled_)
     {
-        for (int i = 0; i < 6; ++i)
+        JobCounter counter;
+        for (uint32 view_idx = 0; view_idx < num_shadow_views_; ++view_idx)
         {
-            D3D11_VIEWPORT viewport;
-            viewport.Width = (float) SHADOW_MAP_SIZE;
-            viewport.Height = (float) SHADOW_MAP_SIZE;
-            viewport.TopLeftX = 0.0f;
-            viewport.TopLeftY = 0.0f;
-            viewport.MinDepth = 0.0f;
-            viewport.MaxDepth = 1.0f;
-            gfx::device_context->RSSetViewports(1, &viewport);
-            gfx::SetRasterizerState(RasterizerState::CullClockwise);
-
-            gfx::device_context->OMSetRenderTargets(0, nullptr, point_shadow_map_dsvs_[i].Get());
-            gfx::device_context->ClearDepthStencilView(point_shadow_map_dsvs_[i].Get(),
-                D3D11_CLEAR_DEPTH, 1.0f /*depth clear val*/, 0 /*stencil clear val*/);
-
-            light_view_data_.view_projection = light.view_projections[i];
-            cbuffer_light_view_->Upload(reinterpret_cast<uint8*>(&light_view_data_), sizeof(CBufferLightView));
-            static constexpr int CBUFFER_SLOT_SHADOW_DATA = 1;
-            gfx::SetConstantBuffer(cbuffer_light_view_->buffer_.Get(), CBUFFER_SLOT_SHADOW_DATA);
-
-            static VertexShaderDesc vs_depth_desc = {
-                .path = "assets/shaders/depth_map_vs.hlsl",
-            };
-
-            static Handle<VertexShader> vs_handle = gfx::resource_manager->vertex_shaders.GetHandle(vs_depth_desc);
-            VertexShader* vs = gfx::resource_manager->vertex_shaders.Get(vs_handle);
-            vs->Bind();
-            gfx::SetPixelShader(nullptr);
-
-            // Submit draw calls
-            {
-                for (size_t idx : render_queue_opaque_.item_indices_)
-                {
-                    const RenderWorkItem& item = render_queue_opaque_.items_[idx];
-                    if (item.is_shadow_receiver)
-                    {
-                        item.mesh->model->Bind();
-                        item.mesh->index_buffer->Bind();
-                        item.mesh->pos->Bind();
-                        item.mesh->Render();
-                    }
-                }
-            }
+            ShadowView* view = &shadow_views_[view_idx];
+            jobs::Run([this, view]() { EncodeShadowView(*view, shadow_pass_); }, &counter);
         }
+        jobs::Run([this]() { EncodeForwardQueue(forward_opaque_); }, &counter);
+        jobs::Run([this]() { EncodeForwardQueue(forward_translucent_); }, &counter);
+        jobs::Wait(counter);
+    }
+    else
+    {
+        for (uint32 view_idx = 0; view_idx < num_shadow_views_; ++view_idx)
+        {
+            EncodeShadowView(shadow_views_[view_idx], shadow_pass_);
+        }
+        EncodeForwardQueue(forward_opaque_);
+        EncodeForwardQueue(forward_translucent_);
+    }
+
+    for (uint32 view_idx = 0; view_idx < num_shadow_views_; ++view_idx)
+    {
+        const ShadowView& view = shadow_views_[view_idx];
+        view.cull_stats->num_tested += view.view_cull_stats.num_tested;
+        view.cull_stats->num_visible += view.view_cull_stats.num_visible;
+        *view.triangle_stats += view.clusters.stats;
+        shadow_instancing_stats_ += view.batches.GetStats();
+    }
+
+    forward_instancing_stats_ += forward_opaque_.batches.GetStats();
+    forward_instancing_stats_ += forward_translucent_.batches.GetStats();
+    forward_triangle_stats_ = forward_opaque_.clusters.stats;
+    forward_triangle_stats_ += forward_translucent_.clusters.stats;
+}
+
+void Renderer::RenderShadowPass()
+{
+    for (uint32 view_idx = 0; view_idx < num_shadow_views_; ++view_idx)
+    {
+        shadow_views_[view_idx].commands.Replay();
     }
 }
 
@@ -11,14 +11,20 @@
 
 #include "Core/Window.h"
 #include "Renderer/Camera.h"
+#include "Renderer/ClusterCulling.h"
+#include "Renderer/CommandList.h"
 #include "Renderer/ConstantBufferTypes.h"
+#include "Renderer/Culling.h"
+#include "Renderer/D3D11Backend.h"
 #include "Renderer/DX11Types.h"
 #include "Renderer/GraphicsContext.h"
 #include "Renderer/IndexBuffer.h"
+#include "Renderer/Instancing.h"
 #include "Renderer/IRenderer.h"
 #include "Renderer/Material.h"
 #include "Renderer/Mesh.h"
 #include "Renderer/Shader.h"
+#include "Renderer/ShadowPass.h"
 #include "Renderer/VertexBuffer.h"
 
 struct Model;
@@ -47,7 +53,7 @@ struct PointLight
     float attenuation;
     Mat4 view_projections[6];
     float brightness;
-    float padding_0;
+    float range;    // Far plane of the shadow views
     float padding_1;
     float padding_2;
 };
@@ -79,11 +85,36 @@ struct CBufferLight
     SpotLight spot_lights[MAX_SPOT_LIGHTS];
 };
 
-DECLSPEC_ALIGN(16) 
-struct CBufferLightView
+struct ShadowCullStats
 {
-    Mat4 view;
-    Mat4 view_projection;
+    CullStats cascades[DirectionalLight::NUM_CASCADES];
+    CullStats spot_lights;
+    CullStats point_light_faces[6];
+
+    // Triangles of the casters which passed object culling, see CullClusters()
+    ClusterCullStats cascade_triangles[DirectionalLight::NUM_CASCADES];
+    ClusterCullStats spot_light_triangles;
+    ClusterCullStats point_light_face_triangles[6];
+};
+
+struct LodStats
+{
+    uint64 num_triangles = 0;                       // Of the selected LODs
+    uint32 num_meshes[StaticMesh::MAX_LODS] = {};   // Per LOD
+
+    void Add(const RenderQueue& queue);
+};
+
+/**
+ * Opaque or translucent queue of the forward pass, encoded into its own command list by a job.
+ */
+struct ForwardQueuePass
+{
+    const RenderQueue* queue = nullptr;
+    std::vector<Mat4> item_world_matrices;  // Transposed, indexed like the items of the queue
+    InstanceBatchList batches;
+    ClusterCullContext clusters;            // Culled faces are taken from the material of each batch
+    CommandList commands;
 };
 
 class Renderer : public IRenderer
@@ -97,6 +128,9 @@ public:
     virtual void Render() final;
 
     virtual void Enqueue(const RenderWorkItem& item, BlendState blend_state) final;
+
+    // Casters are not culled against the camera, so they are queued separately from the opaque geometry.
+    void EnqueueShadowCaster(const RenderWorkItem& item);
     
     void Enqueue(const DirectionalLight& light);
 
@@ -111,11 +145,23 @@ public:
 
 private:
     static void CalculateCascades(DirectionalLight& light);
+    void PrepareShadowViews();
+    ShadowView& AddShadowView(GpuDepthStencilView* dsv, RasterizerState rasterizer_state, const Mat4& view_projection,
+        const Vec4& viewer, CullStats& cull_stats, ClusterCullStats& triangle_stats);
+    void EncodeCommandLists();
+    void EncodeForwardQueue(ForwardQueuePass& pass) const;
+
+    // Requests the texture mips the queued meshes need at their size on screen. Streamed in by the next frame's update.
+    void RequestTextureMips();
+
+    // Radius of the mesh's bounding sphere on screen, in pixels
+    float CalcProjectedRadius(const StaticMesh& mesh) const;
+    RenderWorkItem SelectLod(const RenderWorkItem& item, float max_error_pixels) const;
 
-    ComPtr<ID3D11RenderTargetView> backbuffer_color_view_ = nullptr;   // Views for "output" of the swapchain
-    ComPtr<ID3D11DepthStencilView> backbuffer_depth_view_ = nullptr;
+    SharedPtr<GpuRenderTargetView> backbuffer_color_view_ = nullptr;   // Views for "output" of the swapchain
+    SharedPtr<GpuDepthStencilView> backbuffer_depth_view_ = nullptr;
 
-    ComPtr<ID3D11Texture2D> depth_buffer_ = nullptr;
+    SharedPtr<GpuTexture> depth_buffer_ = nullptr;
 
     // Pipeline configuration
     ComPtr<ID3D11DepthStencilState> depth_stencil_state_ = nullptr;
@@ -134,8 +180,7 @@ private:
     UniquePtr<ConstantBuffer> cbuffer_per_view_;
     CBufferLight light_data_;
     UniquePtr<ConstantBuffer> cbuffer_light_;
-    CBufferLightView light_view_data_;
-    UniquePtr<ConstantBuffer> cbuffer_light_view_;
+    UniquePtr<ConstantBuffer> cbuffer_light_view_;  // Updated by the command list of each shadow view
 
     ComPtr<ID3D11Texture2D> texture_ = nullptr;
     ComPtr<ID3D11ShaderResourceView> texture_srv_ = nullptr;
@@ -145,23 +190,57 @@ private:
     bool is_translucent_queue_enabled_ = true;
     RenderQueue render_queue_opaque_ = RenderQueue(RenderQueueSortType::FrontToBack);
     RenderQueue render_queue_translucent_ = RenderQueue(RenderQueueSortType::BackToFront);
+    RenderQueue render_queue_shadow_casters_ = RenderQueue(RenderQueueSortType::FrontToBack);
+    BoundsSoA shadow_caster_bounds_;
+    std::vector<VisibilityBits> point_light_range_visibility_;
+    ShadowCullStats shadow_cull_stats_;
+
+    // Runs of identical meshes in the sorted queues are merged into instanced draw calls
+    bool is_instancing_enabled_ = true;
+    UniquePtr<InstanceBuffer> instance_buffer_;
+    std::vector<Mat4> shadow_caster_world_matrices_;    // Transposed, shared by all shadow views
+    InstancingStats forward_instancing_stats_;
+    InstancingStats shadow_instancing_stats_;
+
+    // Clusters of the visible meshes are culled per view, only the index ranges of the remaining ones are drawn
+    bool is_cluster_culling_enabled_ = true;
+    ClusterCullStats forward_triangle_stats_;
+
+    // LODs are selected on enqueue, by how many pixels their error covers at the mesh's size on screen. Shadow casters go by
+    // their size on screen as well, but tolerate more: shadow maps rarely match the screen resolution and get filtered anyway.
+    bool is_lod_enabled_ = true;
+    float lod_error_pixels_ = 1.0f;
+    float shadow_lod_error_pixels_ = 4.0f;
+    LodStats forward_lod_stats_;
+    LodStats shadow_lod_stats_;
+
+    // Every shadow view and both forward queues are encoded by their own job, then replayed in a fixed order on the main thread.
+    // Views are reused between frames, so their command lists and visibility keep their memory.
+    bool is_parallel_encoding_enabled_ = true;
+    std::vector<ShadowView> shadow_views_;
+    uint32 num_shadow_views_ = 0;
+    ForwardQueuePass forward_opaque_;
+    ForwardQueuePass forward_translucent_;
+    ShadowPass shadow_pass_;
+    double encode_ms_ = 0.0;
+    double replay_ms_ = 0.0;
 
     std::vector<DirectionalLight> directional_lights_;
     std::vector<PointLight> point_lights_;
     std::vector<SpotLight> spot_lights_;
 
     static inline constexpr uint32 SHADOW_MAP_SIZE = 4096;
-    ComPtr<ID3D11Texture2D> directional_shadow_map_ = nullptr;
-    ComPtr<ID3D11DepthStencilView> directional_shadow_map_dsvs_[4];
-    ComPtr<ID3D11ShaderResourceView> directional_shadow_map_srv_ = {};
+    SharedPtr<GpuTexture> directional_shadow_map_ = nullptr;
+    SharedPtr<GpuDepthStencilView> directional_shadow_map_dsvs_[4];
+    SharedPtr<GpuShaderResourceView> directional_shadow_map_srv_ = {};
 
-    ComPtr<ID3D11Texture2D> spot_shadow_map_ = nullptr;
-    ComPtr<ID3D11DepthStencilView> spot_shadow_map_dsv_ = nullptr;
-    ComPtr<ID3D11ShaderResourceView> spot_shadow_map_srv_ = nullptr;
+    SharedPtr<GpuTexture> spot_shadow_map_ = nullptr;
+    SharedPtr<GpuDepthStencilView> spot_shadow_map_dsv_ = nullptr;
+    SharedPtr<GpuShaderResourceView> spot_shadow_map_srv_ = nullptr;
 
-    ComPtr<ID3D11Texture2D> point_shadow_map_ = nullptr;
-    ComPtr<ID3D11DepthStencilView> point_shadow_map_dsvs_[6] = {};
-    ComPtr<ID3D11ShaderResourceView> point_shadow_map_srv_ = nullptr;
+    SharedPtr<GpuTexture> point_shadow_map_ = nullptr;
+    SharedPtr<GpuDepthStencilView> point_shadow_map_dsvs_[6] = {};
+    SharedPtr<GpuShaderResourceView> point_shadow_map_srv_ = nullptr;
 };
 
 IRenderer* CreateRenderer();
@@ -0,0 +1,16 @@
+#pragma once
+
+// Creates 1k, 10k, ... up to max_entities entities and compares the per frame cost of
+// component lookups through Entity with queries on the World's entity registry.
+void RunEntityBenchmark(uint32 max_entities);
+
+// Builds transform trees of 1k, 10k, ... up to max_nodes nodes and compares the recursive Transform update (immediate and deferred)
+// with the flattened TransformHierarchy, once for moving the root only and once for animating every node.
+void RunTransformBenchmark(uint32 max_nodes);
+
+// Sorts, batches and submits 1k, 10k, ... up to max_items cubes through the headless graphics context, once with a draw call per item
+// and once instanced. Reports the CPU cost of each step and the state changes and uploads which reached the recording backend.
+// Afterwards compares culling and encoding the command lists of 11 shadow views serially and on the job system, with the same
+// EncodeShadowView() as the shadow mapping sample. The shadow maps and the depth shader are created through the recording backend,
+// the replayed shadow pass is checked against the culling results in every build configuration.
+void RunSubmissionBenchmark(uint32 max_items);
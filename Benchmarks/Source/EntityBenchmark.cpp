@@ -0,0 +1,153 @@
+#include "Benchmarks.h"
+
+#include <chrono>
+
+#include "Core/JobSystem.h"
+#include "Engine/Entity.h"
+#include "Engine/World.h"
+
+namespace
+{
+    // Every n-th entity is a light, the rest are meshes. Roughly the mix of a imported scene.
+    constexpr uint32 LIGHT_INTERVAL = 100;
+
+    // Enough frames for a stable average, without taking forever at 1M entities
+    constexpr uint64 ENTITY_FRAMES_BUDGET = 10'000'000;
+    constexpr uint32 MIN_FRAMES = 3;
+    constexpr uint32 MAX_FRAMES = 100;
+
+    const Vec3 CAMERA_POSITION = { 0.0f, 1.0f, -5.0f };
+
+    struct SortKeyComponent
+    {
+        float value = 0.0f;
+    };
+
+    Vec3 GetEntityPosition(uint32 idx)
+    {
+        return { (float) (idx % 1000), 0.0f, (float) (idx / 1000) };
+    }
+
+    template<typename Func>
+    double MeasureFrameTime(uint32 num_frames, Func&& frame)
+    {
+        frame();    // Warm up caches
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32 i = 0; i < num_frames; ++i)
+        {
+            frame();
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double, std::milli>(end - start).count() / num_frames;
+    }
+
+    // Same access pattern as the Render() of the samples: Look up every component type per entity
+    double RunLegacy(uint32 num_entities, uint32 num_frames)
+    {
+        std::vector<SharedPtr<Entity>> entities;
+        entities.reserve(num_entities);
+        for (uint32 i = 0; i < num_entities; ++i)
+        {
+            SharedPtr<Entity> entity = MakeShared<Entity>();
+            entity->transform_->SetWorldTranslation(GetEntityPosition(i));
+            if (i % LIGHT_INTERVAL == 0)
+            {
+                entity->AddComponent<PointLightComponent>();
+            }
+            else
+            {
+                entity->AddComponent<StaticMeshComponent>();
+            }
+            entities.push_back(entity);
+        }
+
+        std::vector<float> sort_keys(num_entities);
+        uint32 num_lights = 0;
+        return MeasureFrameTime(num_frames, [&]()
+            {
+                num_lights = 0;
+                for (uint32 i = 0; i < num_entities; ++i)
+                {
+                    Entity* entity = entities[i].get();
+                    if (StaticMeshComponent* mesh = entity->GetComponent<StaticMeshComponent>(); mesh != nullptr && mesh->is_visible_)
+                    {
+                        sort_keys[i] = Vec3::DistanceSquared(CAMERA_POSITION, entity->transform_->GetWorldTranslation());
+                    }
+
+                    num_lights += entity->GetComponent<DirectionalLightComponent>() != nullptr;
+                    num_lights += entity->GetComponent<PointLightComponent>() != nullptr;
+                    num_lights += entity->GetComponent<SpotLightComponent>() != nullptr;
+                }
+            });
+    }
+
+    double RunRegistry(uint32 num_entities, uint32 num_frames, bool is_parallel)
+    {
+        UniquePtr<World> world = MakeUnique<World>();
+        for (uint32 i = 0; i < num_entities; ++i)
+        {
+            const EntityId entity = world->CreateEntity();
+            world->GetComponent<TransformComponent>(entity)->SetWorldTranslation(GetEntityPosition(i));
+            if (i % LIGHT_INTERVAL == 0)
+            {
+                world->AddComponent<PointLightComponent>(entity);
+            }
+            else
+            {
+                world->AddComponent<StaticMeshComponent>(entity);
+                world->AddComponent<SortKeyComponent>(entity);
+            }
+        }
+
+        // Resolve the transforms up front, the queries below read them from worker threads
+        world->FlushTransforms();
+
+        auto update_sort_key = [](TransformComponent& transform, StaticMeshComponent& mesh, SortKeyComponent& sort_key)
+        {
+            if (mesh.is_visible_)
+            {
+                sort_key.value = Vec3::DistanceSquared(CAMERA_POSITION, transform.GetWorldTranslation());
+            }
+        };
+
+        uint32 num_lights = 0;
+        auto count_light = [&num_lights](auto&) { ++num_lights; };
+
+        return MeasureFrameTime(num_frames, [&]()
+            {
+                if (is_parallel)
+                {
+                    world->ParallelEach<TransformComponent, StaticMeshComponent, SortKeyComponent>(update_sort_key);
+                }
+                else
+                {
+                    world->Each<TransformComponent, StaticMeshComponent, SortKeyComponent>(update_sort_key);
+                }
+
+                num_lights = 0;
+                world->Each<DirectionalLightComponent>(count_light);
+                world->Each<PointLightComponent>(count_light);
+                world->Each<SpotLightComponent>(count_light);
+            });
+    }
+}
+
+void RunEntityBenchmark(uint32 max_entities)
+{
+    LOG("Entity benchmark: {} threads", jobs::GetNumThreads());
+    LOG("{:>10} | {:>12} | {:>12} | {:>12} | {:>8}", "Entities", "Entity [ms]", "Each [ms]", "Parallel [ms]", "Speedup");
+
+    for (uint32 num_entities = 1000; num_entities <= max_entities; num_entities *= 10)
+    {
+        const uint32 num_frames = (uint32) std::clamp<uint64>(ENTITY_FRAMES_BUDGET / num_entities, MIN_FRAMES, MAX_FRAMES);
+
+        const double legacy_ms = RunLegacy(num_entities, num_frames);
+        const double each_ms = RunRegistry(num_entities, num_frames, false);
+        const double parallel_ms = RunRegistry(num_entities, num_frames, true);
+
+        LOG("{:>10} | {:>12.3f} | {:>12.3f} | {:>12.3f} | {:>7.1f}x", num_entities, legacy_ms, each_ms, parallel_ms,
+            legacy_ms / std::min(each_ms, parallel_ms));
+    }
+}
@@ -0,0 +1,25 @@
+#include "AppCore.h"
+#include "Benchmarks.h"
+#include "Core/JobSystem.h"
+
+namespace
+{
+    constexpr uint32 DEFAULT_MAX_ENTITIES = 1'000'000;
+    constexpr uint32 MAX_TRANSFORM_NODES = 100'000;
+    constexpr uint32 MAX_SUBMISSION_ITEMS = 100'000;
+}
+
+// Usage: Benchmarks [max entities]
+int main(int argc, char** argv)
+{
+    Log::Init();
+    jobs::Init();
+
+    const uint32 max_entities = argc > 1 ? (uint32) std::stoul(argv[1]) : DEFAULT_MAX_ENTITIES;
+    RunEntityBenchmark(max_entities);
+    RunTransformBenchmark(std::min(max_entities, MAX_TRANSFORM_NODES));
+    RunSubmissionBenchmark(std::min(max_entities, MAX_SUBMISSION_ITEMS));
+
+    jobs::Shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,493 @@
+#include "Benchmarks.h"
+
+// gfx::InitHeadless() lives next to gfx::Init(), which pulls in the D3D11 imports
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+#include <chrono>
+#include <cstdlib>
+
+#include "Core/JobSystem.h"
+#include "Renderer/CommandList.h"
+#include "Renderer/ConstantBuffer.h"
+#include "Renderer/Culling.h"
+#include "Renderer/GraphicsContext.h"
+#include "Renderer/Instancing.h"
+#include "Renderer/IRenderer.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/MeshOptimization.h"
+#include "Renderer/NullGraphicsBackend.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/Shader.h"
+#include "Renderer/ShadowPass.h"
+
+// Unlike CHECK also active in release builds, which are the ones the numbers are taken from
+#define BENCHMARK_CHECK(Expression)\
+    if (!(Expression)) { LOG_ERROR("Benchmark check '{}' failed at {}:{}", #Expression, __FILE__, __LINE__); std::abort(); }
+
+// Referenced by gfx::Init(). The benchmarks only use the headless context, which never creates a renderer.
+IRenderer* CreateRenderer()
+{
+    return nullptr;
+}
+
+namespace
+{
+    // Distinct meshes, the items reference them round robin. Roughly the number of unique meshes of a imported scene.
+    constexpr uint32 NUM_GEOMETRIES = 64;
+    constexpr uint32 NUM_FRAMES = 10;
+
+    // 4 cascades, a spot light and the 6 faces of a point light, like the shadow mapping sample
+    constexpr uint32 NUM_SHADOW_VIEWS = 11;
+    constexpr uint32 SHADOW_MAP_SIZE = 1024;
+
+    const Vec3 CAMERA_POSITION = { 0.0f, 1.0f, -5.0f };
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double ToMilliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    struct SubmissionResult
+    {
+        double sort_ms = 0.0;
+        double batch_ms = 0.0;
+        double submit_ms = 0.0;
+        gfx::PipelineStats stats;
+        uint32 num_commands = 0;
+        uint32 num_uploads = 0;
+    };
+
+    // Models without materials, so only buffers are bound. Every face of the cubes is a cluster, so the shadow views
+    // can reject the ones facing away.
+    std::vector<SharedPtr<Model>> CreateModels(uint32 num_items)
+    {
+        const CubeMeshData cube;
+        std::vector<uint32> indices(cube.vertex_indices.begin(), cube.vertex_indices.end());
+        const SharedPtr<const std::vector<MeshCluster>> clusters =
+            MakeShared<const std::vector<MeshCluster>>(BuildClusters(indices, cube.vertex_pos, 2));
+
+        std::vector<SharedPtr<Model>> geometries;
+        for (uint32 i = 0; i < NUM_GEOMETRIES; ++i)
+        {
+            SharedPtr<Model> model = MakeShared<Model>();
+            model->index_buffer = MakeShared<IndexBuffer>(indices.data(), (uint32) indices.size());
+            model->pos = MakeShared<VertexBuffer>(cube.vertex_pos.data(), (uint32) cube.vertex_pos.size(), sizeof(Vec3), VertexBufferSlots::POS);
+            model->clusters = clusters;
+            model->materials_.push_back(Handle<Material>());
+
+            StaticMesh mesh;
+            mesh.num_indices = (uint32) indices.size();
+            mesh.bounds = Box(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+            mesh.index_buffer = model->index_buffer;
+            mesh.pos = model->pos;
+            mesh.clusters = *clusters;
+            mesh.model = model.get();
+            model->meshes_.push_back(mesh);
+
+            geometries.push_back(model);
+        }
+
+        std::vector<SharedPtr<Model>> models;
+        models.reserve(num_items);
+        for (uint32 i = 0; i < num_items; ++i)
+        {
+            SharedPtr<Model> model = geometries[i % NUM_GEOMETRIES]->CreateInstance();
+            model->transform.SetWorldTranslation({ (float) (i % 1000), 0.0f, (float) (i / 1000) });
+            models.push_back(model);
+        }
+
+        return models;
+    }
+
+    // Same steps as Renderer::RenderForwardQueue() of the shadow mapping sample
+    SubmissionResult Run(const std::vector<SharedPtr<Model>>& models, InstanceBatchMode mode, NullGraphicsBackend& backend)
+    {
+        RenderQueue queue(RenderQueueSortType::FrontToBack);
+        InstanceBatchList batches;
+        InstanceBuffer instance_buffer((uint32) models.size());
+        std::vector<Mat4> item_world_matrices;
+
+        SubmissionResult result;
+        auto frame = [&]()
+            {
+                const auto start = Clock::now();
+
+                for (const SharedPtr<Model>& model : models)
+                {
+                    queue.Add(RenderWorkItem
+                        {
+                            .sort_key = Vec3::DistanceSquared(CAMERA_POSITION, model->transform.GetWorldTranslation()),
+                            .mesh = &model->meshes_[0]
+                        });
+                }
+                queue.Sort();
+
+                const auto sorted = Clock::now();
+
+                item_world_matrices.clear();
+                for (const RenderWorkItem& item : queue.items_)
+                {
+                    item_world_matrices.push_back(item.mesh->model->transform.GetWorldMatrix().Transpose());
+                }
+                batches.Build(queue, item_world_matrices, mode);
+
+                const auto batched = Clock::now();
+
+                uint32 first_instance = 0;
+                if (mode != InstanceBatchMode::Disabled && batches.batches_.empty() == false)
+                {
+                    first_instance = instance_buffer.Allocate(batches.world_matrices_);
+                    instance_buffer.Bind();
+                }
+
+                for (const InstanceBatch& batch : batches.batches_)
+                {
+                    if (batch.is_instanced)
+                    {
+                        batch.mesh->Bind(true);
+                        batch.mesh->RenderInstanced(first_instance + batch.first_instance, batch.num_instances);
+                    }
+                    else
+                    {
+                        batch.mesh->model->Bind();
+                        batch.mesh->Bind();
+                        batch.mesh->Render();
+                    }
+                }
+
+                const auto submitted = Clock::now();
+
+                result.sort_ms += ToMilliseconds(sorted - start);
+                result.batch_ms += ToMilliseconds(batched - sorted);
+                result.submit_ms += ToMilliseconds(submitted - batched);
+
+                queue.Clear();
+                instance_buffer.BeginFrame();
+                gfx::EndFrame();
+            };
+
+        // Warm up caches, also binds the state which stays the same between frames
+        backend.SetRecording(false);
+        frame();
+        result = SubmissionResult();
+
+        for (uint32 i = 0; i < NUM_FRAMES; ++i)
+        {
+            frame();
+        }
+
+        result.sort_ms /= NUM_FRAMES;
+        result.batch_ms /= NUM_FRAMES;
+        result.submit_ms /= NUM_FRAMES;
+
+        // Record a single frame and check that everything which was counted also reached the backend
+        backend.Reset();
+        backend.SetRecording(true);
+        frame();
+
+        result.stats = gfx::last_frame_stats;
+        result.num_commands = (uint32) backend.GetCommands().size();
+        result.num_uploads = backend.GetNumCommands(RecordedCommandType::Map) + backend.GetNumCommands(RecordedCommandType::UpdateBuffer);
+
+        BENCHMARK_CHECK(backend.GetNumDrawCalls() == result.stats.num_draw_calls);
+        BENCHMARK_CHECK(backend.GetNumInstances() == result.stats.num_instances);
+        BENCHMARK_CHECK(result.stats.num_instances == (uint32) models.size());
+
+        backend.Reset();
+        gfx::InvalidatePipelineState();
+        return result;
+    }
+
+    // Created through the backend like the shadow maps and depth shaders of the shadow mapping sample
+    struct ShadowPassResources
+    {
+        SharedPtr<GpuTexture> shadow_maps;    // One slice per view
+        std::vector<SharedPtr<GpuDepthStencilView>> dsvs;
+        UniquePtr<ConstantBuffer> cbuffer_light_view;
+        GpuVertexShader* depth_vs[2] = {};   // Float and quantized positions
+        GpuInputLayout* depth_input_layouts[2] = {};
+    };
+
+    ShadowPassResources CreateShadowPassResources()
+    {
+        ShadowPassResources resources;
+
+        GpuTextureDesc shadow_map_desc = {};
+        shadow_map_desc.width = SHADOW_MAP_SIZE;
+        shadow_map_desc.height = SHADOW_MAP_SIZE;
+        shadow_map_desc.array_size = NUM_SHADOW_VIEWS;
+        shadow_map_desc.format = GpuFormat::R32_Typeless;
+        shadow_map_desc.usage = GpuUsage::Default;
+        shadow_map_desc.bind_flags = GpuBind::DepthStencil | GpuBind::ShaderResource;
+        resources.shadow_maps = gfx::backend->CreateTexture2D(shadow_map_desc);
+
+        for (uint32 i = 0; i < NUM_SHADOW_VIEWS; ++i)
+        {
+            GpuViewDesc depth_stencil_view_desc = {};
+            depth_stencil_view_desc.format = GpuFormat::D32_Float;
+            depth_stencil_view_desc.dimension = GpuViewDimension::Texture2DArray;
+            depth_stencil_view_desc.array_size = 1;
+            depth_stencil_view_desc.first_array_slice = i;
+            resources.dsvs.push_back(gfx::backend->CreateDepthStencilView(resources.shadow_maps.get(), depth_stencil_view_desc));
+        }
+
+        resources.cbuffer_light_view = MakeUnique<ConstantBuffer>((uint32) sizeof(CBufferLightView));
+
+        // Compiled (or taken from the shader archive) and reflected like with a device, only the created shaders are null objects
+        const VertexShaderDesc vs_depth_instanced_desc = {
+            .path = "assets/shaders/depth_map_vs.hlsl",
+            .defines = { { .name = "INSTANCED", .value = "1" } }
+        };
+        const VertexShaderDesc vs_depth_quantized_instanced_desc = {
+            .path = "assets/shaders/depth_map_vs.hlsl",
+            .defines = { { .name = "INSTANCED", .value = "1" }, { .name = "QUANTIZED_POSITIONS", .value = "1" } }
+        };
+        const VertexShaderDesc* descs[2] = { &vs_depth_instanced_desc, &vs_depth_quantized_instanced_desc };
+        for (uint32 variant = 0; variant < 2; ++variant)
+        {
+            const Handle<VertexShader> vs_handle = gfx::resource_manager->vertex_shaders.GetHandle(*descs[variant]);
+            const VertexShader* vs = gfx::resource_manager->vertex_shaders.Get(vs_handle);
+            resources.depth_vs[variant] = vs->GetNativePtr().get();
+            resources.depth_input_layouts[variant] = vs->GetInputLayout().get();
+        }
+
+        return resources;
+    }
+
+    // Views look into different directions from the center of the grid, so each one sees a different part of the items.
+    // Set up like the spot light views of the shadow mapping sample.
+    std::vector<ShadowView> CreateShadowViews(uint32 num_items, const ShadowPassResources& resources)
+    {
+        const Vec3 center = { 500.0f, 50.0f, (float) (num_items / 2000) };
+
+        std::vector<ShadowView> views(NUM_SHADOW_VIEWS);
+        for (uint32 i = 0; i < NUM_SHADOW_VIEWS; ++i)
+        {
+            const float angle = MathUtils::DegToRad(360.0f * i / NUM_SHADOW_VIEWS);
+            const Vec3 target = center + Vec3(std::cos(angle), -0.5f, std::sin(angle));
+            const Mat4 view_projection = Mat4::LookAt(center, target, Vec3::UP) *
+                Mat4::PerspectiveFovLH(MathUtils::DegToRad(90.0f), 1.0f, 0.1f, 1000.0f);
+
+            ShadowView& view = views[i];
+            view.dsv = resources.dsvs[i].get();
+            view.rasterizer_state = RasterizerState::CullClockwise;
+            view.light_view_data.view_projection = view_projection.Transpose();
+            view.frustum = Frustum::FromViewProjection(view_projection);
+            view.clusters.view = ClusterCullView
+            {
+                .frustum = view.frustum,
+                .viewer = Vec4(center, 1.0f),
+                .culled_faces = GetCulledFaces(view.rasterizer_state)
+            };
+        }
+
+        return views;
+    }
+
+    // Checks the commands which reached the backend while replaying the views: Every view binds and clears its own shadow map,
+    // and the clusters which survived culling are drawn into it with the depth shader and without a pixel shader.
+    void CheckShadowPass(const std::vector<ShadowView>& views, const ShadowPassResources& resources, const NullGraphicsBackend& backend,
+        uint32 num_item_triangles)
+    {
+        BENCHMARK_CHECK(backend.GetNumCommands(RecordedCommandType::SetRenderTargets) == NUM_SHADOW_VIEWS);
+        BENCHMARK_CHECK(backend.GetNumCommands(RecordedCommandType::ClearDepthStencil) == NUM_SHADOW_VIEWS);
+
+        // The pipeline state was invalidated before the replay, so everything the views need was bound by them
+        const void* bound_dsv = nullptr;
+        const void* bound_vs = nullptr;
+        const void* bound_ps = nullptr;
+        std::vector<uint64> num_triangles(NUM_SHADOW_VIEWS, 0);
+        for (const RecordedCommand& command : backend.GetCommands())
+        {
+            switch (command.type)
+            {
+            case RecordedCommandType::SetRenderTargets:
+                BENCHMARK_CHECK(command.resource == nullptr);   // Shadow views are depth only
+                bound_dsv = command.depth_stencil_view;
+                break;
+            case RecordedCommandType::ClearDepthStencil:
+                BENCHMARK_CHECK(command.resource == bound_dsv && (command.args[0] & GpuClear::Depth) != 0);
+                break;
+            case RecordedCommandType::SetVertexShader:
+                bound_vs = command.resource;
+                break;
+            case RecordedCommandType::SetPixelShader:
+                bound_ps = command.resource;
+                break;
+            case RecordedCommandType::DrawIndexed:
+            case RecordedCommandType::DrawIndexedInstanced:
+            {
+                // The cubes have float positions
+                BENCHMARK_CHECK(bound_vs == resources.depth_vs[0] && bound_ps == nullptr);
+
+                const auto it = std::find_if(resources.dsvs.begin(), resources.dsvs.end(),
+                    [bound_dsv](const SharedPtr<GpuDepthStencilView>& dsv) { return dsv.get() == bound_dsv; });
+                BENCHMARK_CHECK(it != resources.dsvs.end());
+                const uint64 num_instances = command.type == RecordedCommandType::DrawIndexed ? 1 : command.args[1];
+                num_triangles[it - resources.dsvs.begin()] += command.args[0] / 3 * num_instances;
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        // Clusters are only tested for the items which passed object culling, and only the visible ones were drawn
+        for (uint32 i = 0; i < NUM_SHADOW_VIEWS; ++i)
+        {
+            BENCHMARK_CHECK(views[i].clusters.stats.num_triangles == (uint64) views[i].view_cull_stats.num_visible * num_item_triangles);
+            BENCHMARK_CHECK(num_triangles[i] == views[i].clusters.stats.num_visible_triangles);
+        }
+    }
+
+    struct EncodeResult
+    {
+        double serial_ms = 0.0;
+        double parallel_ms = 0.0;
+        double replay_ms = 0.0;
+        uint32 num_draw_calls = 0;
+        uint32 num_commands = 0;
+        float rejected_triangles_percent = 0.0f;
+    };
+
+    EncodeResult RunShadowViews(const std::vector<SharedPtr<Model>>& models, NullGraphicsBackend& backend)
+    {
+        RenderQueue queue(RenderQueueSortType::FrontToBack);
+        for (const SharedPtr<Model>& model : models)
+        {
+            queue.Add(RenderWorkItem{ .mesh = &model->meshes_[0] });
+        }
+        queue.Sort();
+
+        BoundsSoA bounds;
+        std::vector<Mat4> world_matrices;
+        for (const RenderWorkItem& item : queue.items_)
+        {
+            const Mat4 world_matrix = item.mesh->model->transform.GetWorldMatrix();
+            bounds.Add(item.mesh->bounds, world_matrix);
+            world_matrices.push_back(world_matrix.Transpose());
+        }
+
+        const ShadowPassResources resources = CreateShadowPassResources();
+        std::vector<ShadowView> views = CreateShadowViews((uint32) models.size(), resources);
+        InstanceBuffer instance_buffer((uint32) models.size() * NUM_SHADOW_VIEWS);
+
+        const ShadowPass pass
+        {
+            .casters = &queue,
+            .caster_bounds = &bounds,
+            .caster_world_matrices = world_matrices,
+            .cbuffer_light_view = resources.cbuffer_light_view.get(),
+            .instance_buffer = &instance_buffer,
+            .depth_vs = { resources.depth_vs[0], resources.depth_vs[1] },
+            .depth_input_layouts = { resources.depth_input_layouts[0], resources.depth_input_layouts[1] },
+            .shadow_map_size = SHADOW_MAP_SIZE
+        };
+
+        auto encode = [&](bool is_parallel)
+            {
+                const auto start = Clock::now();
+                for (uint32 frame = 0; frame < NUM_FRAMES; ++frame)
+                {
+                    if (is_parallel)
+                    {
+                        JobCounter counter;
+                        for (ShadowView& view : views)
+                        {
+                            jobs::Run([&pass, view = &view]() { EncodeShadowView(*view, pass); }, &counter);
+                        }
+                        jobs::Wait(counter);
+                    }
+                    else
+                    {
+                        for (ShadowView& view : views)
+                        {
+                            EncodeShadowView(view, pass);
+                        }
+                    }
+                }
+                return ToMilliseconds(Clock::now() - start) / NUM_FRAMES;
+            };
+
+        EncodeResult result;
+        encode(false);  // Warm up, the lists and batches keep their memory afterwards
+        result.serial_ms = encode(false);
+        result.parallel_ms = encode(true);
+
+        // The replay is timed without recording, the recorded one runs afterwards from an invalidated state
+        auto replay = [&]()
+            {
+                for (const ShadowView& view : views)
+                {
+                    view.commands.Replay();
+                }
+                instance_buffer.BeginFrame();
+                gfx::EndFrame();
+            };
+
+        backend.SetRecording(false);
+        const auto replay_start = Clock::now();
+        replay();
+        result.replay_ms = ToMilliseconds(Clock::now() - replay_start);
+
+        result.num_draw_calls = gfx::last_frame_stats.num_draw_calls;
+        ClusterCullStats triangle_stats;
+        for (const ShadowView& view : views)
+        {
+            result.num_commands += view.commands.GetNumCommands();
+            triangle_stats += view.clusters.stats;
+        }
+        result.rejected_triangles_percent = triangle_stats.GetRejectedPercent();
+
+        backend.Reset();
+        backend.SetRecording(true);
+        gfx::InvalidatePipelineState();
+        replay();
+        CheckShadowPass(views, resources, backend, models[0]->meshes_[0].num_indices / 3);
+
+        backend.Reset();
+        gfx::InvalidatePipelineState();
+        return result;
+    }
+}
+
+void RunSubmissionBenchmark(uint32 max_items)
+{
+    NullGraphicsBackend* backend = gfx::InitHeadless();
+
+    LOG("Submission benchmark: {} meshes, headless", NUM_GEOMETRIES);
+    LOG("{:>10} | {:>9} | {:>9} | {:>10} | {:>11} | {:>8} | {:>8} | {:>8} | {:>8} | {:>8}", "Items", "Mode", "Sort [ms]", "Batch [ms]",
+        "Submit [ms]", "Draws", "Issued", "Skipped", "Uploads", "Commands");
+
+    for (uint32 num_items = 1000; num_items <= max_items; num_items *= 10)
+    {
+        const std::vector<SharedPtr<Model>> models = CreateModels(num_items);
+
+        for (InstanceBatchMode mode : { InstanceBatchMode::Disabled, InstanceBatchMode::DepthOnly })
+        {
+            const SubmissionResult result = Run(models, mode, *backend);
+            LOG("{:>10} | {:>9} | {:>9.3f} | {:>10.3f} | {:>11.3f} | {:>8} | {:>8} | {:>8} | {:>8} | {:>8}", num_items,
+                mode == InstanceBatchMode::Disabled ? "Single" : "Instanced", result.sort_ms, result.batch_ms, result.submit_ms,
+                result.stats.num_draw_calls, result.stats.num_calls_issued, result.stats.num_calls_skipped, result.num_uploads,
+                result.num_commands);
+        }
+    }
+
+    LOG("Shadow view encoding: {} views, {} threads", NUM_SHADOW_VIEWS, jobs::GetNumThreads());
+    LOG("{:>10} | {:>11} | {:>13} | {:>8} | {:>11} | {:>8} | {:>8} | {:>12}", "Items", "Serial [ms]", "Parallel [ms]", "Speedup",
+        "Replay [ms]", "Draws", "Commands", "Rejected [%]");
+
+    for (uint32 num_items = 1000; num_items <= max_items; num_items *= 10)
+    {
+        const EncodeResult result = RunShadowViews(CreateModels(num_items), *backend);
+        LOG("{:>10} | {:>11.3f} | {:>13.3f} | {:>7.1f}x | {:>11.3f} | {:>8} | {:>8} | {:>12.1f}", num_items, result.serial_ms,
+            result.parallel_ms, result.serial_ms / result.parallel_ms, result.replay_ms, result.num_draw_calls, result.num_commands,
+            result.rejected_triangles_percent);
+    }
+
+    gfx::ShutdownHeadless();
+}
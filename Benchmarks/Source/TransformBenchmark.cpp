@@ -0,0 +1,120 @@
+#include "Benchmarks.h"
+
+#include <chrono>
+
+#include "Engine/Transform.h"
+#include "Engine/TransformHierarchy.h"
+
+namespace
+{
+    // Wide and shallow, like the node tree of an imported scene
+    constexpr uint32 CHILDREN_PER_NODE = 8;
+    constexpr uint32 NUM_FRAMES = 10;
+
+    Vec3 GetNodeTranslation(uint32 idx)
+    {
+        return { (float) (idx % 7), (float) (idx % 5), (float) (idx % 3) };
+    }
+
+    Quat GetNodeRotation(uint32 idx, uint32 frame)
+    {
+        return Quat::FromAxisAngle(Vec3::UP, MathUtils::DegToRad((float) ((idx + frame) % 360)));
+    }
+
+    template<typename Func>
+    double MeasureFrameTime(Func&& frame)
+    {
+        frame(0);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32 i = 1; i <= NUM_FRAMES; ++i)
+        {
+            frame(i);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double, std::milli>(end - start).count() / NUM_FRAMES;
+    }
+
+    // Node i is a child of node (i - 1) / CHILDREN_PER_NODE
+    std::pair<double, double> RunLegacy(uint32 num_nodes, TransformUpdateMode mode)
+    {
+        std::vector<Transform> transforms(num_nodes);
+        for (uint32 i = 0; i < num_nodes; ++i)
+        {
+            transforms[i].SetUpdateMode(mode);
+            transforms[i].SetLocalTranslation(GetNodeTranslation(i));
+            if (i > 0)
+            {
+                transforms[(i - 1) / CHILDREN_PER_NODE].AddChild(&transforms[i]);
+            }
+        }
+
+        const double move_root_ms = MeasureFrameTime([&](uint32 frame)
+            {
+                transforms[0].SetLocalTranslation(GetNodeTranslation(frame));
+                transforms[0].Flush();
+            });
+
+        const double animate_all_ms = MeasureFrameTime([&](uint32 frame)
+            {
+                for (uint32 i = 0; i < num_nodes; ++i)
+                {
+                    transforms[i].SetLocalRotation(GetNodeRotation(i, frame));
+                }
+                transforms[0].Flush();
+            });
+
+        return { move_root_ms, animate_all_ms };
+    }
+
+    std::pair<double, double> RunHierarchy(uint32 num_nodes)
+    {
+        TransformHierarchy hierarchy;
+        std::vector<TransformId> ids(num_nodes);
+        for (uint32 i = 0; i < num_nodes; ++i)
+        {
+            ids[i] = hierarchy.Create();
+            hierarchy.SetLocalTranslation(ids[i], GetNodeTranslation(i));
+            if (i > 0)
+            {
+                hierarchy.SetParent(ids[i], ids[(i - 1) / CHILDREN_PER_NODE]);
+            }
+        }
+        hierarchy.Update();
+
+        const double move_root_ms = MeasureFrameTime([&](uint32 frame)
+            {
+                hierarchy.SetLocalTranslation(ids[0], GetNodeTranslation(frame));
+                hierarchy.Update();
+            });
+
+        const double animate_all_ms = MeasureFrameTime([&](uint32 frame)
+            {
+                for (uint32 i = 0; i < num_nodes; ++i)
+                {
+                    hierarchy.SetLocalRotation(ids[i], GetNodeRotation(i, frame));
+                }
+                hierarchy.Update();
+            });
+
+        return { move_root_ms, animate_all_ms };
+    }
+}
+
+void RunTransformBenchmark(uint32 max_nodes)
+{
+    LOG("Transform benchmark: {} children per node", CHILDREN_PER_NODE);
+    LOG("{:>10} | {:>36} | {:>36}", "", "Move root [ms]", "Animate all [ms]");
+    LOG("{:>10} | {:>10} {:>10} {:>10} | {:>10} {:>10} {:>10}", "Nodes", "Immediate", "Deferred", "Flat", "Immediate", "Deferred", "Flat");
+
+    for (uint32 num_nodes = 1000; num_nodes <= max_nodes; num_nodes *= 10)
+    {
+        const auto [immediate_move_ms, immediate_animate_ms] = RunLegacy(num_nodes, TransformUpdateMode::Immediate);
+        const auto [deferred_move_ms, deferred_animate_ms] = RunLegacy(num_nodes, TransformUpdateMode::Deferred);
+        const auto [flat_move_ms, flat_animate_ms] = RunHierarchy(num_nodes);
+
+        LOG("{:>10} | {:>10.3f} {:>10.3f} {:>10.3f} | {:>10.3f} {:>10.3f} {:>10.3f}", num_nodes,
+            immediate_move_ms, deferred_move_ms, flat_move_ms, immediate_animate_ms, deferred_animate_ms, flat_animate_ms);
+    }
+}
@@ -9,6 +9,7 @@
 #include "Engine/Input.h"
 #include "Renderer/IRenderer.h"
 #include "Renderer/GraphicsContext.h"
+#include "Renderer/ShaderCache.h"
 
 void BaseApplication::Run()
 {
@@ -38,6 +39,8 @@ void BaseApplication::Init()
     LOG("Initializing application: {}", application_name_);
     instance_ = this;
 
+    jobs::Init(job_config_);
+
     SDL_Init(SDL_INIT_VIDEO);
     InitWindow();
 
@@ -48,10 +51,14 @@ void BaseApplication::MainLoop()
 {
     LOG("Entering Main Loop...");
 
+    // Everything loaded during startup has been compiled by now
+    ShaderCache::LogStats();
+
     while (window_ != nullptr && window_->GetIsClosed() == false)
     {
         tick_timer_.Update();
         Update();
+        world.FlushTransforms();
         Render();
 
         if (input::IsKeyDown(SDL_KeyCode::SDLK_ESCAPE))
@@ -67,6 +74,7 @@ void BaseApplication::Cleanup()
     gfx::Shutdown();
     DestroyWindow();
     SDL_Quit();
+    jobs::Shutdown();
 }
 
 void BaseApplication::InitWindow()
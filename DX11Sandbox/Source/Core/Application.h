@@ -1,4 +1,5 @@
 #pragma once
+#include "Core/JobSystem.h"
 #include "Core/TickTimer.h"
 #include "Core/Window.h"
 #include "Engine/World.h"
@@ -35,6 +36,7 @@ protected:
     std::string application_name_;
     Window* window_ = nullptr;
     TickTimer tick_timer_;
+    jobs::Config job_config_;
 
 private:
     static inline BaseApplication* instance_ = nullptr;
@@ -0,0 +1,226 @@
+#pragma once
+#include <atomic>
+
+#include "Core/Handle.h"
+
+/**
+ * Handle based pool which can be used from any thread.
+ *
+ * Elements live in fixed size pages which are never moved or freed while the pool exists, so pointers returned by Get()
+ * stay valid until the element itself gets destroyed. Free slots form a lock-free (Treiber) stack. Its head packs the slot index
+ * and an ABA tag into a single 64 bit word, which gets bumped by every push and pop. Each slot packs its generation and alive
+ * flag into one atomic word as well, so Destroy() only succeeds for the generation of the handle it got.
+ *
+ * Create, Get and Destroy of different elements may run concurrently. Destroying an element while another thread still
+ * accesses it is not safe, same as with any other pool.
+ */
+template<typename T, typename U>
+class ConcurrentPool
+{
+public:
+    static constexpr uint32 PAGE_SIZE = 256;
+    static constexpr uint32 MAX_PAGES = 1024;
+    static constexpr uint32 CAPACITY = PAGE_SIZE * MAX_PAGES;
+
+    ConcurrentPool() = default;
+
+    ~ConcurrentPool()
+    {
+        for (uint32 page_idx = 0; page_idx < MAX_PAGES; ++page_idx)
+        {
+            Slot* page = pages_[page_idx].load(std::memory_order_acquire);
+            if (page == nullptr)
+            {
+                continue;
+            }
+
+            for (uint32 i = 0; i < PAGE_SIZE; ++i)
+            {
+                if (IsAlive(page[i].state.load(std::memory_order_relaxed)))
+                {
+                    page[i].GetElement()->~T();
+                }
+            }
+            delete[] page;
+        }
+    }
+
+    ConcurrentPool(const ConcurrentPool&) = delete;
+    ConcurrentPool& operator=(const ConcurrentPool&) = delete;
+
+    template<typename... Args>
+    Handle<U> Create(Args&&... args)
+    {
+        uint32 slot_idx = PopFreeSlot();
+        if (slot_idx == INVALID_INDEX)
+        {
+            slot_idx = num_slots_.fetch_add(1, std::memory_order_relaxed);
+            CHECK_MSG(slot_idx < CAPACITY, "ConcurrentPool is out of slots");
+            AllocatePage(slot_idx / PAGE_SIZE);
+        }
+
+        Slot& slot = GetSlot(slot_idx);
+        const uint64 state = slot.state.load(std::memory_order_relaxed);
+        const uint32 generation = GetGeneration(state);
+        CHECK(generation != Handle<U>::INVALID_GENERATION);
+        CHECK(IsAlive(state) == false);
+
+        new (slot.storage) T(std::forward<Args>(args)...);
+        slot.state.store(PackState(generation, true), std::memory_order_release);
+        num_alive_.fetch_add(1, std::memory_order_relaxed);
+
+        return Handle<U>(slot_idx, generation);
+    }
+
+    T* Get(Handle<U> handle) const
+    {
+        if (handle.generation_ == Handle<U>::INVALID_GENERATION || handle.index_ >= num_slots_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        Slot* page = pages_[handle.index_ / PAGE_SIZE].load(std::memory_order_acquire);
+        if (page == nullptr)
+        {
+            // Slot was reserved, but its page is still being allocated
+            return nullptr;
+        }
+
+        Slot& slot = page[handle.index_ % PAGE_SIZE];
+        if (slot.state.load(std::memory_order_acquire) == PackState(handle.generation_, true))
+        {
+            return slot.GetElement();
+        }
+        return nullptr;
+    }
+
+    void Destroy(Handle<U> handle)
+    {
+        CHECK(handle.IsValid());
+        if (Get(handle) == nullptr)
+        {
+            return;
+        }
+
+        // Kills the element and bumps the generation in one step. Fails if somebody else destroyed it first, also if the slot
+        // was reused in the meantime: the new element has a different generation, so a stale handle can't destroy it.
+        Slot& slot = GetSlot(handle.index_);
+        uint64 expected = PackState(handle.generation_, true);
+        const uint32 next_generation = handle.generation_ + 1;
+        if (slot.state.compare_exchange_strong(expected, PackState(next_generation, false), std::memory_order_acq_rel) == false)
+        {
+            return;
+        }
+
+        slot.GetElement()->~T();
+        num_alive_.fetch_sub(1, std::memory_order_relaxed);
+
+        // Retire slots which ran out of generations instead of handing out the invalid generation
+        if (next_generation != Handle<U>::INVALID_GENERATION)
+        {
+            PushFreeSlot(handle.index_);
+        }
+    }
+
+    // Visits every live element. Elements created or destroyed concurrently may or may not be visited.
+    template<typename Func>
+    void ForEach(Func&& func) const
+    {
+        const uint32 num_slots = std::min(num_slots_.load(std::memory_order_acquire), CAPACITY);
+        for (uint32 slot_idx = 0; slot_idx < num_slots; ++slot_idx)
+        {
+            Slot* page = pages_[slot_idx / PAGE_SIZE].load(std::memory_order_acquire);
+            if (page == nullptr)
+            {
+                // Skip the rest of a page which is still being allocated
+                slot_idx += PAGE_SIZE - 1 - slot_idx % PAGE_SIZE;
+                continue;
+            }
+
+            Slot& slot = page[slot_idx % PAGE_SIZE];
+            if (IsAlive(slot.state.load(std::memory_order_acquire)))
+            {
+                func(*slot.GetElement());
+            }
+        }
+    }
+
+    size_t Size() const { return num_alive_.load(std::memory_order_relaxed); }
+    bool IsEmpty() const { return Size() == 0; }
+
+private:
+    static constexpr uint32 INVALID_INDEX = 0xffffffff;
+
+    static constexpr uint64 PackState(uint32 generation, bool is_alive) { return ((uint64) generation << 32) | (is_alive ? 1 : 0); }
+    static uint32 GetGeneration(uint64 state) { return (uint32) (state >> 32); }
+    static bool IsAlive(uint64 state) { return (state & 1) != 0; }
+
+    struct Slot
+    {
+        T* GetElement() { return std::launder(reinterpret_cast<T*>(storage)); }
+
+        std::atomic<uint64> state = PackState(0, false);   // Generation and alive flag, see PackState()
+        std::atomic<uint32> next_free = INVALID_INDEX;
+        alignas(T) uint8 storage[sizeof(T)];
+    };
+
+    static uint64 PackFreeHead(uint32 tag, uint32 slot_idx) { return ((uint64) tag << 32) | slot_idx; }
+    static uint32 GetFreeHeadTag(uint64 head) { return (uint32) (head >> 32); }
+    static uint32 GetFreeHeadIndex(uint64 head) { return (uint32) head; }
+
+    Slot& GetSlot(uint32 slot_idx) const
+    {
+        Slot* page = pages_[slot_idx / PAGE_SIZE].load(std::memory_order_acquire);
+        CHECK(page != nullptr);
+        return page[slot_idx % PAGE_SIZE];
+    }
+
+    void AllocatePage(uint32 page_idx)
+    {
+        if (pages_[page_idx].load(std::memory_order_acquire) != nullptr)
+        {
+            return;
+        }
+
+        // Several threads may race for the same page. The loser throws its allocation away.
+        Slot* new_page = new Slot[PAGE_SIZE];
+        Slot* expected = nullptr;
+        if (pages_[page_idx].compare_exchange_strong(expected, new_page, std::memory_order_acq_rel) == false)
+        {
+            delete[] new_page;
+        }
+    }
+
+    uint32 PopFreeSlot()
+    {
+        uint64 head = free_head_.load(std::memory_order_acquire);
+        while (GetFreeHeadIndex(head) != INVALID_INDEX)
+        {
+            // Slots are never freed, so reading next_free is fine even if another thread popped the slot in the meantime.
+            // The tag makes the CAS fail in that case.
+            const uint32 slot_idx = GetFreeHeadIndex(head);
+            const uint32 next_idx = GetSlot(slot_idx).next_free.load(std::memory_order_relaxed);
+            const uint64 new_head = PackFreeHead(GetFreeHeadTag(head) + 1, next_idx);
+            if (free_head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                return slot_idx;
+            }
+        }
+        return INVALID_INDEX;
+    }
+
+    void PushFreeSlot(uint32 slot_idx)
+    {
+        Slot& slot = GetSlot(slot_idx);
+        uint64 head = free_head_.load(std::memory_order_relaxed);
+        do
+        {
+            slot.next_free.store(GetFreeHeadIndex(head), std::memory_order_relaxed);
+        } while (free_head_.compare_exchange_weak(head, PackFreeHead(GetFreeHeadTag(head) + 1, slot_idx), std::memory_order_release, std::memory_order_relaxed) == false);
+    }
+
+    std::atomic<Slot*> pages_[MAX_PAGES] = {};
+    std::atomic<uint32> num_slots_ = 0;
+    std::atomic<uint32> num_alive_ = 0;
+    std::atomic<uint64> free_head_ = PackFreeHead(0, INVALID_INDEX);
+};
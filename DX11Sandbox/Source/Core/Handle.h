@@ -8,11 +8,12 @@ template<typename T>
 class Handle
 {
     template<typename, typename>
-    friend class Pool;
+    friend class ConcurrentPool;
 
 public:
     Handle() : index_(0), generation_(INVALID_GENERATION) {};
     bool IsValid() const { return generation_ != Handle::INVALID_GENERATION; }
+    uint32 GetIndex() const { return index_; }
 
     bool operator<(const Handle other) const { return id_ < other.id_; }
     bool operator>(const Handle other) const { return id_ > other.id_; }
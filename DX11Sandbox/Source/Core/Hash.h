@@ -1,4 +1,5 @@
 #pragma once
+#include <cstring>
 #include <type_traits>
 #include <functional>
 
@@ -33,6 +34,30 @@ struct Hash
         return hash_;
     }
 
+    // 64 bit FNV-1a over 8 byte words. Not cryptographic, only meant to detect changed file contents.
+    static uint64 HashBytes(const void* data, size_t size, uint64 seed = 0xcbf29ce484222325ull)
+    {
+        static constexpr uint64 PRIME = 0x100000001b3ull;
+
+        const uint8* bytes = (const uint8*) data;
+        uint64 hash = seed;
+
+        size_t i = 0;
+        for (; i + sizeof(uint64) <= size; i += sizeof(uint64))
+        {
+            uint64 word;
+            std::memcpy(&word, bytes + i, sizeof(uint64));
+            hash = (hash ^ word) * PRIME;
+        }
+
+        for (; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * PRIME;
+        }
+
+        return hash;
+    }
+
     // Convenient hash enable - See https://stackoverflow.com/questions/2590677/how-do-i-combine-hash-values-in-c0x
     inline static void HashCombine(std::size_t& seed) {}
 
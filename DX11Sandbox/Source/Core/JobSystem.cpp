@@ -0,0 +1,369 @@
+#include "Core/JobSystem.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace
+{
+    struct Job
+    {
+        jobs::JobFunction func;
+        JobCounter* counter = nullptr;
+    };
+
+    /**
+     * Chase-Lev work stealing deque with a fixed capacity.
+     * Only the owning thread pushes and pops at the bottom, any thread may steal from the top.
+     * See: "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+     */
+    class WorkStealingQueue
+    {
+    public:
+        static constexpr int64 CAPACITY = 4096;
+        static constexpr int64 MASK = CAPACITY - 1;
+        static_assert((CAPACITY & MASK) == 0, "Capacity has to be a power of two");
+
+        // Owner only. Returns false if the queue is full.
+        bool Push(Job* job)
+        {
+            const int64 bottom = bottom_.load(std::memory_order_relaxed);
+            const int64 top = top_.load(std::memory_order_acquire);
+            if (bottom - top >= CAPACITY)
+            {
+                return false;
+            }
+
+            buffer_[bottom & MASK].store(job, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Owner only. LIFO, so recently pushed (cache-warm) jobs run first.
+        Job* Pop()
+        {
+            const int64 bottom = bottom_.load(std::memory_order_relaxed) - 1;
+            bottom_.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64 top = top_.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                // Empty
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Job* job = buffer_[bottom & MASK].load(std::memory_order_relaxed);
+            if (top == bottom)
+            {
+                // Last element -> race against thieves
+                if (top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) == false)
+                {
+                    job = nullptr;
+                }
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return job;
+        }
+
+        // Any thread. FIFO.
+        Job* Steal()
+        {
+            int64 top = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64 bottom = bottom_.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+            {
+                return nullptr;
+            }
+
+            Job* job = buffer_[top & MASK].load(std::memory_order_relaxed);
+            if (top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) == false)
+            {
+                // Lost against another thief or the owner
+                return nullptr;
+            }
+
+            return job;
+        }
+
+    private:
+        alignas(64) std::atomic<int64> top_ = 0;
+        alignas(64) std::atomic<int64> bottom_ = 0;
+        std::atomic<Job*> buffer_[CAPACITY] = {};
+    };
+
+    struct JobSystemState
+    {
+        jobs::Config config;
+
+        // Index 0 belongs to the main thread, the others to the workers
+        std::vector<UniquePtr<WorkStealingQueue>> queues;
+        std::vector<std::thread> workers;
+
+        // Bumped whenever a job was pushed. Idle workers sleep on it.
+        std::atomic<uint32> wake_generation = 0;
+        std::atomic<uint32> num_sleeping_workers = 0;
+        std::atomic<bool> is_running = false;
+    };
+
+    JobSystemState* state = nullptr;
+
+    // Index of the queue owned by the current thread. -1 for threads which are unknown to the job system.
+    thread_local int32 thread_queue_idx = -1;
+
+    void Execute(Job* job)
+    {
+        job->func();
+        if (job->counter != nullptr)
+        {
+            job->counter->value.fetch_sub(1, std::memory_order_release);
+        }
+        delete job;
+    }
+
+    Job* FindJob(uint32 queue_idx, std::minstd_rand& rng)
+    {
+        if (Job* job = state->queues[queue_idx]->Pop())
+        {
+            return job;
+        }
+
+        // Start at a random victim so thieves don't all hammer the same queue
+        const uint32 num_queues = (uint32) state->queues.size();
+        const uint32 first_victim = (uint32) rng() % num_queues;
+        for (uint32 i = 0; i < num_queues; ++i)
+        {
+            const uint32 victim_idx = (first_victim + i) % num_queues;
+            if (victim_idx == queue_idx)
+            {
+                continue;
+            }
+
+            if (Job* job = state->queues[victim_idx]->Steal())
+            {
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void WorkerMain(uint32 queue_idx)
+    {
+        thread_queue_idx = (int32) queue_idx;
+        std::minstd_rand rng(queue_idx);
+
+        while (state->is_running.load(std::memory_order_acquire))
+        {
+            // Read the generation before looking for work. If a job gets pushed afterwards, wait() returns immediately.
+            const uint32 generation = state->wake_generation.load(std::memory_order_acquire);
+
+            if (Job* job = FindJob(queue_idx, rng))
+            {
+                Execute(job);
+                continue;
+            }
+
+            state->num_sleeping_workers.fetch_add(1);
+            state->wake_generation.wait(generation);
+            state->num_sleeping_workers.fetch_sub(1);
+        }
+    }
+
+    void WakeWorkers(bool wake_all)
+    {
+        state->wake_generation.fetch_add(1);
+
+        // Skip the syscall if everybody is busy anyway
+        if (wake_all)
+        {
+            state->wake_generation.notify_all();
+        }
+        else if (state->num_sleeping_workers.load() > 0)
+        {
+            state->wake_generation.notify_one();
+        }
+    }
+}
+
+namespace jobs
+{
+    void Init(const Config& config)
+    {
+        CHECK(IsValid() == false);
+
+        state = new JobSystemState();
+        state->config = config;
+
+        uint32 num_workers = config.num_workers;
+        if (num_workers == 0)
+        {
+            num_workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        }
+
+        if (config.is_single_threaded)
+        {
+            num_workers = 0;
+        }
+
+        LOG("Initializing job system with {} worker threads{}", num_workers, config.is_single_threaded ? " (single threaded)" : "");
+
+        for (uint32 i = 0; i < num_workers + 1; ++i)
+        {
+            state->queues.push_back(MakeUnique<WorkStealingQueue>());
+        }
+
+        thread_queue_idx = 0;
+        state->is_running = true;
+        for (uint32 i = 1; i < num_workers + 1; ++i)
+        {
+            state->workers.emplace_back(WorkerMain, i);
+        }
+
+        if (config.run_benchmark)
+        {
+            static constexpr uint32 NUM_BENCHMARK_JOBS = 100000;
+            LOG("Job system scheduling overhead: {:.1f} ns per job", MeasureSchedulingOverhead(NUM_BENCHMARK_JOBS));
+        }
+    }
+
+    void Shutdown()
+    {
+        CHECK(IsValid());
+        LOG("Shutting down job system");
+
+        state->is_running = false;
+        WakeWorkers(true);
+        for (std::thread& worker : state->workers)
+        {
+            worker.join();
+        }
+
+        // Don't leak jobs which were never picked up
+        for (UniquePtr<WorkStealingQueue>& queue : state->queues)
+        {
+            while (Job* job = queue->Steal())
+            {
+                Execute(job);
+            }
+        }
+
+        delete state;
+        state = nullptr;
+        thread_queue_idx = -1;
+    }
+
+    bool IsValid()
+    {
+        return state != nullptr;
+    }
+
+    bool IsSingleThreaded()
+    {
+        return state == nullptr || state->workers.empty();
+    }
+
+    uint32 GetNumThreads()
+    {
+        return state != nullptr ? (uint32) state->queues.size() : 1;
+    }
+
+    void Run(JobFunction job, JobCounter* counter)
+    {
+        if (IsSingleThreaded() || thread_queue_idx < 0)
+        {
+            // Deterministic mode, or a thread without its own queue (e.g. std::async). Just run inline.
+            job();
+            return;
+        }
+
+        if (counter != nullptr)
+        {
+            counter->value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Job* new_job = new Job{ .func = std::move(job), .counter = counter };
+        if (state->queues[thread_queue_idx]->Push(new_job) == false)
+        {
+            // Queue is full, so the workers are busy anyway
+            Execute(new_job);
+            return;
+        }
+
+        WakeWorkers(false);
+    }
+
+    void Wait(const JobCounter& counter)
+    {
+        if (counter.IsDone())
+        {
+            return;
+        }
+
+        CHECK_MSG(thread_queue_idx >= 0, "Only threads owned by the job system may wait on counters");
+        std::minstd_rand rng(thread_queue_idx);
+
+        while (counter.IsDone() == false)
+        {
+            if (Job* job = FindJob(thread_queue_idx, rng))
+            {
+                Execute(job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void ParallelFor(uint32 count, uint32 grain_size, const RangeFunction& func)
+    {
+        CHECK(grain_size > 0);
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (count <= grain_size || IsSingleThreaded())
+        {
+            for (uint32 begin = 0; begin < count; begin += grain_size)
+            {
+                func(begin, std::min(begin + grain_size, count));
+            }
+            return;
+        }
+
+        JobCounter counter;
+        for (uint32 begin = grain_size; begin < count; begin += grain_size)
+        {
+            const uint32 end = std::min(begin + grain_size, count);
+            Run([&func, begin, end]() { func(begin, end); }, &counter);
+        }
+
+        // The calling thread takes the first chunk itself instead of idling
+        func(0, grain_size);
+        Wait(counter);
+    }
+
+    double MeasureSchedulingOverhead(uint32 num_jobs)
+    {
+        CHECK(num_jobs > 0);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        JobCounter counter;
+        for (uint32 i = 0; i < num_jobs; ++i)
+        {
+            Run([]() {}, &counter);
+        }
+        Wait(counter);
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / (double) num_jobs;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+
+/**
+ * Counts outstanding jobs. Pass it to jobs::Run and block on it with jobs::Wait.
+ * A counter can be reused once it reached zero.
+ */
+struct JobCounter
+{
+    bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+
+    std::atomic<uint32> value = 0;
+};
+
+namespace jobs
+{
+    using JobFunction = std::function<void()>;
+    using RangeFunction = std::function<void(uint32 begin, uint32 end)>;
+
+    struct Config
+    {
+        // 0 -> one worker per hardware thread, minus the main thread
+        uint32 num_workers = 0;
+
+        // Runs every job inline on the calling thread, in submission order. Useful to get reproducible results while debugging.
+        bool is_single_threaded = false;
+
+        // Logs the scheduling overhead per job after startup
+        bool run_benchmark = false;
+    };
+
+    void Init(const Config& config = Config());
+    void Shutdown();
+    bool IsValid();
+
+    bool IsSingleThreaded();
+
+    // Number of threads executing jobs, including the main thread.
+    uint32 GetNumThreads();
+
+    // Increments the counter (if any) and schedules the job. The counter is decremented once the job finished.
+    void Run(JobFunction job, JobCounter* counter = nullptr);
+
+    // Blocks until the counter reaches zero. The calling thread executes pending jobs in the meantime.
+    void Wait(const JobCounter& counter);
+
+    // Splits [0, count) into chunks of grain_size elements and processes them in parallel. Returns when all chunks are done.
+    void ParallelFor(uint32 count, uint32 grain_size, const RangeFunction& func);
+
+    // Schedules num_jobs empty jobs and returns the average wall time per job in nanoseconds.
+    double MeasureSchedulingOverhead(uint32 num_jobs);
+}
@@ -0,0 +1,91 @@
+#include "Core/MappedFile.h"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(file_handle_, other.file_handle_);
+        std::swap(mapping_handle_, other.mapping_handle_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+    }
+
+    return *this;
+}
+
+bool MappedFile::Open(const String& file_path)
+{
+    Close();
+
+    HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    file_handle_ = file;
+
+    LARGE_INTEGER file_size = {};
+    if (GetFileSizeEx(file, &file_size) == false || file_size.QuadPart == 0)
+    {
+        // Empty files can't be mapped
+        Close();
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+    mapping_handle_ = mapping;
+
+    data_ = (const uint8*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data_ == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    size_ = (size_t) file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data_ != nullptr)
+    {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+
+    if (mapping_handle_ != nullptr)
+    {
+        CloseHandle(mapping_handle_);
+        mapping_handle_ = nullptr;
+    }
+
+    if (file_handle_ != nullptr)
+    {
+        CloseHandle(file_handle_);
+        file_handle_ = nullptr;
+    }
+
+    size_ = 0;
+}
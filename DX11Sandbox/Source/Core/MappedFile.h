@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * Read-only view of a whole file, mapped into the address space of the process.
+ * Pages are only read from disk on first access, so mapping a file is cheap and its contents never get copied.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Returns false if the file does not exist, is empty or could not be mapped.
+    bool Open(const String& file_path);
+    void Close();
+
+    bool IsValid() const { return data_ != nullptr; }
+    const uint8* GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+
+private:
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+    const uint8* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -413,17 +413,23 @@ Quat Quat::Lerp(const Quat& a, const Quat& b, float t)
 //////////////////////////////////////////////////////////////////////////
 
 Box::Box(float in_min_x, float in_max_x, float in_min_y, float in_max_y, float in_min_z, float in_max_z) :
-    min_x(in_min_x), max_x(in_min_x),
-    min_y(in_min_y), max_y(in_min_y),
-    min_z(in_min_z), max_z(in_min_z)
+    min_x(in_min_x), max_x(in_max_x),
+    min_y(in_min_y), max_y(in_max_y),
+    min_z(in_min_z), max_z(in_max_z)
 {
     center = CalculateCenter();
 }
 
 Box::Box(const std::vector<Vec3>& points)
+    : Box(points.data(), points.size())
 {
-    for (const Vec3& p : points)
+}
+
+Box::Box(const Vec3* points, size_t num_points)
+{
+    for (size_t i = 0; i < num_points; ++i)
     {
+        const Vec3& p = points[i];
         min_x = std::min(p.x, min_x);
         max_x = std::max(p.x, max_x);
         min_y = std::min(p.y, min_y);
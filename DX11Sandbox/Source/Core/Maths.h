@@ -437,17 +437,21 @@ Mat4 operator* (const Mat4& mat_a, const Mat4& mat_b);
 
 struct Box
 {
-    Box();
+    Box() = default;
 
     Box(float in_min_x, float in_max_x,
         float in_min_y, float in_max_y,
         float in_min_z, float in_max_z);
 
     Box(const std::vector<Vec3>& points);
+    Box(const Vec3* points, size_t num_points);
 
     float getWidth() { return std::abs(max_x - min_x); }
     float getHeight() { return std::abs(max_y - min_y); }
-    float getDepth() { return std::abs(max_z - min_y); }
+    float getDepth() { return std::abs(max_z - min_z); }
+
+    Vec3 GetExtents() const { return { (max_x - min_x) * 0.5f, (max_y - min_y) * 0.5f, (max_z - min_z) * 0.5f }; }
+    bool IsValid() const { return min_x <= max_x && min_y <= max_y && min_z <= max_z; }
 
     Vec3 center = Vec3::ZERO;
     float min_x = std::numeric_limits<float>::max();
@@ -1,6 +1,76 @@
 #include "Component.h"
 
-void TransformComponent::Update()
+void TransformComponent::SetLocalTransform(const Transform& t)
 {
-    RecalculateTransform();
+    hierarchy_->SetLocalTransform(id_, t.GetLocalScaling(), t.GetLocalRotation(), t.GetLocalTranslation());
+}
+
+void TransformComponent::SetLocalScaling(const Vec3& scaling)
+{
+    hierarchy_->SetLocalScaling(id_, scaling);
+}
+
+void TransformComponent::SetLocalRotation(const Quat& rotation)
+{
+    hierarchy_->SetLocalRotation(id_, rotation);
+}
+
+void TransformComponent::SetLocalTranslation(const Vec3& translation)
+{
+    hierarchy_->SetLocalTranslation(id_, translation);
+}
+
+void TransformComponent::SetWorldScaling(const Vec3& scaling)
+{
+    hierarchy_->SetWorldScaling(id_, scaling);
+}
+
+void TransformComponent::SetWorldRotation(const Quat& rotation)
+{
+    hierarchy_->SetWorldRotation(id_, rotation);
+}
+
+void TransformComponent::SetWorldTranslation(const Vec3& translation)
+{
+    hierarchy_->SetWorldTranslation(id_, translation);
+}
+
+Vec3 TransformComponent::GetLocalScaling() const
+{
+    return hierarchy_->GetLocalScaling(id_);
+}
+
+Quat TransformComponent::GetLocalRotation() const
+{
+    return hierarchy_->GetLocalRotation(id_);
+}
+
+Vec3 TransformComponent::GetLocalTranslation() const
+{
+    return hierarchy_->GetLocalTranslation(id_);
+}
+
+Vec3 TransformComponent::GetWorldScaling() const
+{
+    return hierarchy_->GetWorldScaling(id_);
+}
+
+Quat TransformComponent::GetWorldRotation() const
+{
+    return hierarchy_->GetWorldRotation(id_);
+}
+
+Vec3 TransformComponent::GetWorldTranslation() const
+{
+    return hierarchy_->GetWorldTranslation(id_);
+}
+
+Mat4 TransformComponent::GetWorldMatrix() const
+{
+    return hierarchy_->GetWorldMatrix(id_);
+}
+
+Vec4 TransformComponent::GetWorldForward() const
+{
+    return hierarchy_->GetWorldForward(id_);
 }
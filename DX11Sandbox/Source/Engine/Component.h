@@ -1,5 +1,7 @@
 #pragma once
+#include "Engine/EntityRegistry.h"
 #include "Engine/Transform.h"
+#include "Engine/TransformHierarchy.h"
 #include "Renderer/Mesh.h"
 
 enum class ComponentType : uint32
@@ -30,10 +32,14 @@ public:
     virtual ComponentType GetType() const final { return T; };
 };
 
-class TransformComponent : public BaseComponent<ComponentType::Transform>, public Transform
+// Transform of the heap allocated Entity class. Deferred, World::FlushTransforms() recomputes it once per frame.
+class EntityTransformComponent : public BaseComponent<ComponentType::Transform>, public Transform
 {
 public:
-    void Update() override;
+    EntityTransformComponent()
+    {
+        SetUpdateMode(TransformUpdateMode::Deferred);
+    }
 };
 
 class StaticMeshComponent : public BaseComponent<ComponentType::StaticMesh>
@@ -86,3 +92,53 @@ public:
     float cone_angle_ = 45.0f;
     float attenuation_ = 1.0f;
 };
+
+// Components below are only used by World's entity registry. They don't need the IComponent interface.
+
+class NameComponent
+{
+public:
+    String name_;
+};
+
+/**
+ * Handle to a node of the world's TransformHierarchy. The transform data itself lives in the hierarchy's arrays.
+ */
+class TransformComponent
+{
+public:
+    TransformComponent(TransformHierarchy* hierarchy, TransformId id)
+        : hierarchy_(hierarchy), id_(id)
+    {
+    }
+
+    void SetLocalTransform(const Transform& t);
+    void SetLocalScaling(const Vec3& scaling);
+    void SetLocalRotation(const Quat& rotation);
+    void SetLocalTranslation(const Vec3& translation);
+    void SetWorldScaling(const Vec3& scaling);
+    void SetWorldRotation(const Quat& rotation);
+    void SetWorldTranslation(const Vec3& translation);
+
+    Vec3 GetLocalScaling() const;
+    Quat GetLocalRotation() const;
+    Vec3 GetLocalTranslation() const;
+    Vec3 GetWorldScaling() const;
+    Quat GetWorldRotation() const;
+    Vec3 GetWorldTranslation() const;
+    Mat4 GetWorldMatrix() const;
+    Vec4 GetWorldForward() const;
+
+    TransformId GetId() const { return id_; }
+
+private:
+    TransformHierarchy* hierarchy_ = nullptr;
+    TransformId id_;
+};
+
+class HierarchyComponent
+{
+public:
+    EntityId parent_;
+    std::vector<EntityId> children_;
+};
@@ -0,0 +1,657 @@
+#include "Engine/CookedScene.h"
+
+#include <chrono>
+#include <fstream>
+
+#include "assimp/DefaultIOSystem.h"
+#include "assimp/Importer.hpp"
+#include "assimp/postprocess.h"
+#include "assimp/scene.h"
+#include "assimp/GltfMaterial.h"
+
+#include "Core/JobSystem.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/MeshOptimization.h"
+
+namespace
+{
+    constexpr uint32 IMPORTER_FLAGS = aiProcess_ConvertToLeftHanded | aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_CalcTangentSpace;
+    constexpr uint64 SECTION_ALIGNMENT = 16;
+
+    // Welds vertices assimp's exact JoinIdenticalVertices keeps apart because of float noise
+    constexpr float WELD_EPSILON = 1e-5f;
+    constexpr float OVERDRAW_THRESHOLD = 1.05f;
+    constexpr uint32 MAX_CLUSTER_TRIANGLES = 128;
+
+    // Every LOD targets half the triangles of the previous one. Levels which remove less than a fifth of them are dropped.
+    constexpr float LOD_MAX_RELATIVE_ERROR = 0.05f;     // Of the bounding sphere radius
+    constexpr float LOD_MIN_INDEX_RATIO = 0.8f;
+
+    constexpr size_t SECTION_ELEMENT_SIZES[] =
+    {
+        sizeof(CookedString),   // SourceFiles
+        sizeof(CookedNode),     // Nodes
+        sizeof(uint32),         // MeshRefs
+        sizeof(CookedMaterial), // Materials
+        sizeof(CookedMesh),     // Meshes
+        sizeof(CookedMeshLod),  // MeshLods
+        sizeof(MeshCluster),    // Clusters
+        sizeof(char),           // Strings
+        sizeof(uint16),         // Indices16
+        sizeof(uint32),         // Indices32
+        sizeof(Vec3),           // Positions
+        sizeof(Vec3),           // Normals
+        sizeof(Vec3),           // Tangents
+        sizeof(Vec2),           // UVs
+    };
+    static_assert(std::size(SECTION_ELEMENT_SIZES) == (size_t) CookedSceneSection::Count);
+    static_assert(sizeof(Vec3) == 3 * sizeof(float) && sizeof(Vec2) == 2 * sizeof(float), "Vertex streams have to match the VertexBuffer strides");
+
+    /**
+     * Remembers every file assimp opens, e.g. the .bin buffers of a glTF file.
+     * The cooked file has to be rebuilt as soon as any of them changes.
+     */
+    class RecordingIOSystem : public Assimp::DefaultIOSystem
+    {
+    public:
+        RecordingIOSystem(std::vector<String>& out_files) : files_(out_files) {}
+
+        Assimp::IOStream* Open(const char* file_path, const char* mode) override
+        {
+            Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file_path, mode);
+            if (stream != nullptr && std::find(files_.begin(), files_.end(), file_path) == files_.end())
+            {
+                files_.push_back(file_path);
+            }
+            return stream;
+        }
+
+    private:
+        std::vector<String>& files_;
+    };
+
+    String GetRelativePath(const std::filesystem::path& root_path, const String& file_path)
+    {
+        const std::filesystem::path relative_path = std::filesystem::path(file_path).lexically_normal().lexically_relative(root_path);
+        return relative_path.empty() ? file_path : relative_path.generic_string();
+    }
+
+    // Returns 0 if any of the files can't be read
+    uint64 ComputeSourceHash(const std::filesystem::path& root_path, const std::vector<String>& relative_paths)
+    {
+        uint64 hash = Hash::HashBytes(&IMPORTER_FLAGS, sizeof(IMPORTER_FLAGS));
+        for (const String& relative_path : relative_paths)
+        {
+            MappedFile file;
+            if (file.Open((root_path / relative_path).string()) == false)
+            {
+                return 0;
+            }
+
+            hash = Hash::HashBytes(relative_path.data(), relative_path.size(), hash);
+            hash = Hash::HashBytes(file.GetData(), file.GetSize(), hash);
+        }
+
+        return hash;
+    }
+
+    class CookedSceneWriter
+    {
+    public:
+        CookedSceneWriter()
+        {
+            blob_.resize(sizeof(CookedSceneHeader));
+        }
+
+        CookedString AddString(std::string_view str)
+        {
+            CookedString out{ .offset = (uint32) strings_.size(), .length = (uint32) str.size() };
+            strings_.append(str);
+            return out;
+        }
+
+        template<typename T>
+        void WriteSection(CookedSceneSection section, const T* elements, size_t count)
+        {
+            CHECK(sizeof(T) == SECTION_ELEMENT_SIZES[(uint32) section]);
+            const size_t offset = (blob_.size() + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+            blob_.resize(offset + sizeof(T) * count);
+            if (count > 0)
+            {
+                std::memcpy(blob_.data() + offset, elements, sizeof(T) * count);
+            }
+            header_.sections[(uint32) section] = { .offset = offset, .count = count };
+        }
+
+        template<typename T>
+        void WriteSection(CookedSceneSection section, const std::vector<T>& elements)
+        {
+            WriteSection(section, elements.data(), elements.size());
+        }
+
+        std::vector<uint8> Finish(uint64 source_hash)
+        {
+            WriteSection(CookedSceneSection::Strings, strings_.data(), strings_.size());
+
+            header_.source_hash = source_hash;
+            header_.file_size = blob_.size();
+            std::memcpy(blob_.data(), &header_, sizeof(CookedSceneHeader));
+            return std::move(blob_);
+        }
+
+    private:
+        CookedSceneHeader header_;
+        std::vector<uint8> blob_;
+        String strings_;
+    };
+
+    CookedString AddTexturePath(CookedSceneWriter& writer, const aiMaterial* ai_material, aiTextureType type, uint32 idx)
+    {
+        aiString tex_path;
+        if (ai_material->GetTexture(type, idx, &tex_path) != AI_SUCCESS || tex_path.length == 0)
+        {
+            return {};
+        }
+
+        return writer.AddString(tex_path.C_Str());
+    }
+
+    CookedMaterial CookMaterial(CookedSceneWriter& writer, const aiMaterial* ai_material)
+    {
+        CookedMaterial material;
+
+        aiString blend_mode_string;
+        ai_material->Get(AI_MATKEY_GLTF_ALPHAMODE, blend_mode_string);
+        if (blend_mode_string == aiString("MASK"))
+        {
+            material.flags |= CookedMaterial::ALPHA_MASK_BIT;
+            material.alpha_cutoff = 1.0f;
+            ai_material->Get(AI_MATKEY_GLTF_ALPHACUTOFF, material.alpha_cutoff);
+        }
+        else if (blend_mode_string == aiString("BLEND"))
+        {
+            material.flags |= CookedMaterial::ALPHA_BLEND_BIT;
+        }
+
+        int is_two_sided = 0;
+        ai_material->Get(AI_MATKEY_TWOSIDED, is_two_sided);
+        if (is_two_sided)
+        {
+            material.flags |= CookedMaterial::TWO_SIDED_BIT;
+        }
+
+        aiVector3D base_color;
+        if (ai_material->Get(AI_MATKEY_BASE_COLOR, base_color) == AI_SUCCESS)
+        {
+            material.flags |= CookedMaterial::BASE_COLOR_BIT;
+            material.base_color[0] = base_color.x;
+            material.base_color[1] = base_color.y;
+            material.base_color[2] = base_color.z;
+        }
+
+        material.textures[(uint32) CookedTextureSlot::BaseColor] = AddTexturePath(writer, ai_material, aiTextureType_BASE_COLOR, 0);
+        material.textures[(uint32) CookedTextureSlot::Normal] = AddTexturePath(writer, ai_material, aiTextureType_NORMALS, 0);
+        material.textures[(uint32) CookedTextureSlot::MetallicRoughness] =
+            AddTexturePath(writer, ai_material, AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE);
+
+        return material;
+    }
+
+    void BuildVertexData(const aiMesh* ai_mesh, VertexData& vertex_data, Box& out_bounds)
+    {
+        vertex_data.indices.reserve(ai_mesh->mNumFaces * 3);
+        for (uint32 i = 0; i < ai_mesh->mNumFaces; ++i)
+        {
+            const aiFace& face = ai_mesh->mFaces[i];
+            if(face.mNumIndices != 3)
+            {
+                LOG_WARN("Incomplete triangle in mesh: {}", ai_mesh->mName.C_Str());
+            }
+
+            vertex_data.indices.push_back(face.mIndices[0]);
+            vertex_data.indices.push_back(face.mIndices[1]);
+            vertex_data.indices.push_back(face.mIndices[2]);
+        }
+
+        vertex_data.pos.reserve(ai_mesh->mNumVertices);
+        vertex_data.normals.reserve(ai_mesh->mNumVertices);
+        vertex_data.uvs.reserve(ai_mesh->mNumVertices);
+        vertex_data.tangents.reserve(ai_mesh->mNumVertices);
+        for (uint32 vertex_id = 0; vertex_id < ai_mesh->mNumVertices; ++vertex_id)
+        {
+            const aiVector3D& vertex = ai_mesh->mVertices[vertex_id];
+            vertex_data.pos.push_back({ vertex.x, vertex.y, vertex.z });
+
+            const aiVector3D& normal = ai_mesh->HasNormals() ? ai_mesh->mNormals[vertex_id] : aiVector3D(0.0f, 0.0f, 0.0f);
+            vertex_data.normals.push_back({ normal.x, normal.y, normal.z });
+
+            const aiVector3D& uv = ai_mesh->HasTextureCoords(0) ? ai_mesh->mTextureCoords[0][vertex_id] : aiVector3D(0.0f, 0.0f, 0.0f);
+            vertex_data.uvs.push_back({ uv.x, uv.y });
+
+            Vec3 tangent = Vec3::ZERO;
+            if(ai_mesh->HasTangentsAndBitangents())
+            {
+                const aiVector3D& ai_tangent = ai_mesh->mTangents[vertex_id];
+                const aiVector3D& ai_bitangent = ai_mesh->mBitangents[vertex_id];
+                tangent = { ai_tangent.x, ai_tangent.y, ai_tangent.z };
+                Vec3 bitangent = { ai_bitangent.x, ai_bitangent.y, ai_bitangent.z };
+
+                // Some models have mirrored UVs -> We have to fix the tangent
+                if (Vec3::Dot(Vec3::Cross({ normal.x, normal.y, normal.z }, tangent), bitangent) < 0.0f)
+                {
+                    tangent = tangent * -1.0;
+                }
+            }
+
+            vertex_data.tangents.push_back({ tangent.x, tangent.y, tangent.z });
+        }
+
+        out_bounds = Box(vertex_data.pos);
+    }
+
+    struct MeshLodData
+    {
+        uint32 num_indices = 0;
+        float error = 0.0f;
+        std::vector<MeshCluster> clusters;
+    };
+
+    // Simplifies the optimized mesh into up to StaticMesh::MAX_LODS levels, the full detail one first. The indices of all levels
+    // end up concatenated in mesh_data and share its vertices.
+    void BuildLods(VertexData& mesh_data, const Box& bounds, std::vector<MeshLodData>& out_lods)
+    {
+        const std::vector<uint32> full_detail_indices = std::move(mesh_data.indices);
+        const uint32 num_vertices = (uint32) mesh_data.pos.size();
+        const float max_error = LOD_MAX_RELATIVE_ERROR * bounds.GetExtents().Length();
+
+        mesh_data.indices.clear();
+        for (uint32 lod = 0; lod < StaticMesh::MAX_LODS; ++lod)
+        {
+            std::vector<uint32> indices;
+            float error = 0.0f;
+            if (lod == 0)
+            {
+                indices = full_detail_indices;
+            }
+            else
+            {
+                // Always simplified from the full detail mesh, so the error is measured against the original surface
+                const uint32 target_index_count = (uint32) (full_detail_indices.size() >> lod) / 3 * 3;
+                indices = SimplifyMesh(full_detail_indices, mesh_data.pos, target_index_count, max_error, error);
+                if (indices.empty() || indices.size() > out_lods.back().num_indices * LOD_MIN_INDEX_RATIO)
+                {
+                    break;
+                }
+                OptimizeVertexCache(indices, num_vertices);
+            }
+
+            out_lods.push_back(MeshLodData
+                {
+                    .num_indices = (uint32) indices.size(),
+                    .error = error,
+                    .clusters = BuildClusters(indices, mesh_data.pos, MAX_CLUSTER_TRIANGLES)
+                });
+            mesh_data.indices.insert(mesh_data.indices.end(), indices.begin(), indices.end());
+        }
+
+        // Clustering regroups the triangles and the LODs add their own references, so the vertices get renumbered once more
+        OptimizeVertexFetch(mesh_data);
+    }
+
+    void CookNodes(CookedSceneWriter& writer, const aiNode* node, int32 parent_idx, std::vector<CookedNode>& out_nodes, std::vector<uint32>& out_mesh_refs)
+    {
+        aiVector3D scaling;
+        aiQuaternion rotation;
+        aiVector3D translation;
+        node->mTransformation.Decompose(scaling, rotation, translation);
+
+        CookedNode cooked_node
+        {
+            .name = writer.AddString(node->mName.C_Str()),
+            .parent_idx = parent_idx,
+            .first_mesh_ref = (uint32) out_mesh_refs.size(),
+            .num_mesh_refs = node->mNumMeshes,
+            .scaling = { scaling.x, scaling.y, scaling.z },
+            .rotation = { rotation.x, rotation.y, rotation.z, rotation.w },
+            .translation = { translation.x, translation.y, translation.z }
+        };
+
+        const int32 node_idx = (int32) out_nodes.size();
+        out_nodes.push_back(cooked_node);
+        out_mesh_refs.insert(out_mesh_refs.end(), node->mMeshes, node->mMeshes + node->mNumMeshes);
+
+        // Depth first, so parents precede their children and the importer can create entities in file order
+        for (uint32 i = 0; i < node->mNumChildren; ++i)
+        {
+            CookNodes(writer, node->mChildren[i], node_idx, out_nodes, out_mesh_refs);
+        }
+    }
+
+    std::vector<uint8> Cook(const String& scene_path)
+    {
+        LOG("Cooking scene: {}", scene_path);
+        const std::filesystem::path root_path = std::filesystem::path(scene_path).parent_path();
+
+        std::vector<String> opened_files;
+        Assimp::Importer ai_importer;
+        ai_importer.SetIOHandler(new RecordingIOSystem(opened_files));  // Importer takes ownership
+        const aiScene* ai_scene = ai_importer.ReadFile(scene_path, IMPORTER_FLAGS);
+        CHECK_MSG(ai_scene != nullptr, "Failed to load mesh from file: {}. \n Error: {}", scene_path, ai_importer.GetErrorString());
+
+        // Building and optimizing the vertex streams doesn't depend on other meshes, so every mesh gets its own job
+        std::vector<VertexData> vertex_data(ai_scene->mNumMeshes);
+        std::vector<Box> bounds(ai_scene->mNumMeshes);
+        std::vector<VertexCacheStats> stats_before(ai_scene->mNumMeshes);
+        std::vector<VertexCacheStats> stats_after(ai_scene->mNumMeshes);
+        std::vector<std::vector<MeshLodData>> mesh_lods(ai_scene->mNumMeshes);
+
+        JobCounter counter;
+        for (uint32 i = 0; i < ai_scene->mNumMeshes; ++i)
+        {
+            jobs::Run([&vertex_data, &bounds, &stats_before, &stats_after, &mesh_lods, ai_scene, i]()
+                {
+                    VertexData& mesh_data = vertex_data[i];
+                    BuildVertexData(ai_scene->mMeshes[i], mesh_data, bounds[i]);
+
+                    stats_before[i] = AnalyzeVertexCache(mesh_data.indices, (uint32) mesh_data.pos.size());
+                    OptimizeMesh(mesh_data, WELD_EPSILON, OVERDRAW_THRESHOLD);
+                    BuildLods(mesh_data, bounds[i], mesh_lods[i]);
+
+                    const std::span<const uint32> full_detail_indices = std::span(mesh_data.indices).first(mesh_lods[i][0].num_indices);
+                    stats_after[i] = AnalyzeVertexCache(full_detail_indices, (uint32) mesh_data.pos.size());
+                }, &counter);
+        }
+
+        CookedSceneWriter writer;
+
+        std::vector<CookedString> source_files;
+        std::vector<String> relative_source_paths;
+        for (const String& file_path : opened_files)
+        {
+            relative_source_paths.push_back(GetRelativePath(root_path, file_path));
+            source_files.push_back(writer.AddString(relative_source_paths.back()));
+        }
+
+        std::vector<CookedNode> nodes;
+        std::vector<uint32> mesh_refs;
+        CookNodes(writer, ai_scene->mRootNode, -1, nodes, mesh_refs);
+
+        std::vector<CookedMaterial> materials;
+        materials.reserve(ai_scene->mNumMaterials);
+        for (uint32 i = 0; i < ai_scene->mNumMaterials; ++i)
+        {
+            materials.push_back(CookMaterial(writer, ai_scene->mMaterials[i]));
+        }
+
+        jobs::Wait(counter);
+
+        uint64 num_transforms_before = 0;
+        uint64 num_transforms_after = 0;
+        uint64 num_triangles = 0;
+        for (uint32 i = 0; i < ai_scene->mNumMeshes; ++i)
+        {
+            String lod_triangles;
+            for (const MeshLodData& lod : mesh_lods[i])
+            {
+                lod_triangles += fmt::format("{}{}", lod_triangles.empty() ? "" : " / ", lod.num_indices / 3);
+            }
+
+            LOG("Optimized mesh {} ({}): {} -> {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} clusters, LOD triangles {}", i,
+                ai_scene->mMeshes[i]->mName.C_Str(), stats_before[i].num_vertices, stats_after[i].num_vertices, stats_before[i].acmr, stats_after[i].acmr,
+                stats_before[i].atvr, stats_after[i].atvr, mesh_lods[i][0].clusters.size(), lod_triangles);
+            num_transforms_before += stats_before[i].num_transforms;
+            num_transforms_after += stats_after[i].num_transforms;
+            num_triangles += stats_after[i].num_triangles;
+        }
+
+        if (num_triangles > 0)
+        {
+            LOG("Optimized {} meshes: ACMR {:.3f} -> {:.3f}", ai_scene->mNumMeshes,
+                (double) num_transforms_before / num_triangles, (double) num_transforms_after / num_triangles);
+        }
+
+        // Concatenate the per mesh streams. Indices stay relative to the first vertex of their mesh,
+        // so only meshes with more vertices than 16 bits can address need 32 bit indices.
+        std::vector<CookedMesh> meshes;
+        meshes.reserve(ai_scene->mNumMeshes);
+        VertexData streams;
+        std::vector<uint16> indices16;
+        std::vector<CookedMeshLod> lods;
+        std::vector<MeshCluster> clusters;
+        for (uint32 i = 0; i < ai_scene->mNumMeshes; ++i)
+        {
+            const VertexData& mesh_data = vertex_data[i];
+            const std::vector<MeshLodData>& mesh_lod_data = mesh_lods[i];
+            const bool has_16bit_indices = mesh_data.pos.size() <= IndexBuffer::MAX_UINT16_VERTICES;
+            const uint32 first_index = (uint32) (has_16bit_indices ? indices16.size() : streams.indices.size());
+            meshes.push_back(CookedMesh
+                {
+                    .material_idx = ai_scene->mMeshes[i]->mMaterialIndex,
+                    .first_index = first_index,
+                    .num_indices = mesh_lod_data[0].num_indices,
+                    .index_size = has_16bit_indices ? (uint32) sizeof(uint16) : (uint32) sizeof(uint32),
+                    .first_vertex = (uint32) streams.pos.size(),
+                    .num_vertices = (uint32) mesh_data.pos.size(),
+                    .bounds_min = { bounds[i].min_x, bounds[i].min_y, bounds[i].min_z },
+                    .bounds_max = { bounds[i].max_x, bounds[i].max_y, bounds[i].max_z },
+                    .first_cluster = (uint32) clusters.size(),
+                    .num_clusters = (uint32) mesh_lod_data[0].clusters.size(),
+                    .first_lod = (uint32) lods.size(),
+                    .num_lods = (uint32) mesh_lod_data.size() - 1
+                });
+            clusters.insert(clusters.end(), mesh_lod_data[0].clusters.begin(), mesh_lod_data[0].clusters.end());
+
+            uint32 lod_first_index = first_index + mesh_lod_data[0].num_indices;
+            for (size_t lod = 1; lod < mesh_lod_data.size(); ++lod)
+            {
+                lods.push_back(CookedMeshLod
+                    {
+                        .first_index = lod_first_index,
+                        .num_indices = mesh_lod_data[lod].num_indices,
+                        .first_cluster = (uint32) clusters.size(),
+                        .num_clusters = (uint32) mesh_lod_data[lod].clusters.size(),
+                        .error = mesh_lod_data[lod].error
+                    });
+                clusters.insert(clusters.end(), mesh_lod_data[lod].clusters.begin(), mesh_lod_data[lod].clusters.end());
+                lod_first_index += mesh_lod_data[lod].num_indices;
+            }
+
+            if (has_16bit_indices)
+            {
+                std::transform(mesh_data.indices.begin(), mesh_data.indices.end(), std::back_inserter(indices16), [](uint32 index) { return (uint16) index; });
+            }
+            else
+            {
+                streams.indices.insert(streams.indices.end(), mesh_data.indices.begin(), mesh_data.indices.end());
+            }
+            streams.pos.insert(streams.pos.end(), mesh_data.pos.begin(), mesh_data.pos.end());
+            streams.normals.insert(streams.normals.end(), mesh_data.normals.begin(), mesh_data.normals.end());
+            streams.tangents.insert(streams.tangents.end(), mesh_data.tangents.begin(), mesh_data.tangents.end());
+            streams.uvs.insert(streams.uvs.end(), mesh_data.uvs.begin(), mesh_data.uvs.end());
+        }
+
+        writer.WriteSection(CookedSceneSection::SourceFiles, source_files);
+        writer.WriteSection(CookedSceneSection::Nodes, nodes);
+        writer.WriteSection(CookedSceneSection::MeshRefs, mesh_refs);
+        writer.WriteSection(CookedSceneSection::Materials, materials);
+        writer.WriteSection(CookedSceneSection::Meshes, meshes);
+        writer.WriteSection(CookedSceneSection::MeshLods, lods);
+        writer.WriteSection(CookedSceneSection::Clusters, clusters);
+        writer.WriteSection(CookedSceneSection::Indices16, indices16);
+        writer.WriteSection(CookedSceneSection::Indices32, streams.indices);
+        writer.WriteSection(CookedSceneSection::Positions, streams.pos);
+        writer.WriteSection(CookedSceneSection::Normals, streams.normals);
+        writer.WriteSection(CookedSceneSection::Tangents, streams.tangents);
+        writer.WriteSection(CookedSceneSection::UVs, streams.uvs);
+
+        return writer.Finish(ComputeSourceHash(root_path, relative_source_paths));
+    }
+}
+
+UniquePtr<CookedScene> CookedScene::Load(const String& scene_path)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    const String cooked_path = GetCookedPath(scene_path);
+    const std::filesystem::path root_path = std::filesystem::path(scene_path).parent_path();
+
+    UniquePtr<CookedScene> scene(new CookedScene());
+    if (scene->file_.Open(cooked_path))
+    {
+        scene->data_ = scene->file_.GetData();
+        scene->size_ = scene->file_.GetSize();
+
+        bool is_up_to_date = scene->Validate();
+        if (is_up_to_date)
+        {
+            std::vector<String> source_files;
+            for (const CookedString& source_file : scene->GetSourceFiles())
+            {
+                source_files.emplace_back(scene->GetString(source_file));
+            }
+            is_up_to_date = ComputeSourceHash(root_path, source_files) == scene->GetHeader().source_hash;
+        }
+
+        if (is_up_to_date)
+        {
+            const auto end_time = std::chrono::high_resolution_clock::now();
+            LOG("Mapped cooked scene {} in {:.1f} ms", cooked_path, std::chrono::duration<double, std::milli>(end_time - start_time).count());
+            return scene;
+        }
+
+        LOG("Cooked scene {} is outdated", cooked_path);
+        scene.reset(new CookedScene());    // Unmap before overwriting the file
+    }
+
+    std::vector<uint8> blob = Cook(scene_path);
+
+    bool is_written = false;
+    {
+        std::ofstream file(cooked_path, std::ios::binary | std::ios::trunc);
+        is_written = file.is_open() && file.write((const char*) blob.data(), blob.size()).good();
+    }
+
+    if (is_written && scene->file_.Open(cooked_path))
+    {
+        scene->data_ = scene->file_.GetData();
+        scene->size_ = scene->file_.GetSize();
+    }
+    else
+    {
+        // E.g. read-only asset directory. Use the cooked data straight from memory, next launch will try again.
+        LOG_WARN("Failed to write cooked scene: {}", cooked_path);
+        scene->blob_ = std::move(blob);
+        scene->data_ = scene->blob_.data();
+        scene->size_ = scene->blob_.size();
+    }
+
+    CHECK(scene->Validate());
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    LOG("Cooked scene {} in {:.1f} ms", cooked_path, std::chrono::duration<double, std::milli>(end_time - start_time).count());
+    return scene;
+}
+
+String CookedScene::GetCookedPath(const String& scene_path)
+{
+    return std::filesystem::path(scene_path).replace_extension(".dxmesh").string();
+}
+
+std::string_view CookedScene::GetString(const CookedString& str) const
+{
+    const std::span<const char> strings = GetSection<char>(CookedSceneSection::Strings);
+    CHECK(str.offset + str.length <= strings.size());
+    return { strings.data() + str.offset, str.length };
+}
+
+bool CookedScene::HasValidClusters(uint32 first_cluster, uint32 num_clusters, uint32 num_indices) const
+{
+    if ((uint64) first_cluster + num_clusters > GetClusters().size())
+    {
+        return false;
+    }
+
+    for (const MeshCluster& cluster : GetClusters().subspan(first_cluster, num_clusters))
+    {
+        if (cluster.num_indices % 3 != 0 || (uint64) cluster.first_index + cluster.num_indices > num_indices)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CookedScene::Validate() const
+{
+    if (size_ < sizeof(CookedSceneHeader))
+    {
+        return false;
+    }
+
+    const CookedSceneHeader& header = GetHeader();
+    if (header.magic != CookedSceneHeader::MAGIC || header.version != CookedSceneHeader::VERSION || header.file_size != size_)
+    {
+        return false;
+    }
+
+    for (uint32 i = 0; i < (uint32) CookedSceneSection::Count; ++i)
+    {
+        const CookedRange& range = header.sections[i];
+        if (range.offset % SECTION_ALIGNMENT != 0 || range.offset < sizeof(CookedSceneHeader) || range.offset > size_ ||
+            range.count > (size_ - range.offset) / SECTION_ELEMENT_SIZES[i])
+        {
+            return false;
+        }
+    }
+
+    // Cross references, so the importer can trust the file without further checks
+    const std::span<const CookedNode> nodes = GetNodes();
+    const std::span<const uint32> mesh_refs = GetMeshRefs();
+    const std::span<const CookedMesh> meshes = GetMeshes();
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const CookedNode& node = nodes[i];
+        if (node.parent_idx >= (int32) i || (i > 0 && node.parent_idx < 0) ||
+            (uint64) node.first_mesh_ref + node.num_mesh_refs > mesh_refs.size())
+        {
+            return false;
+        }
+    }
+
+    for (uint32 mesh_ref : mesh_refs)
+    {
+        if (mesh_ref >= meshes.size())
+        {
+            return false;
+        }
+    }
+
+    for (const CookedMesh& mesh : meshes)
+    {
+        const size_t num_section_indices = mesh.index_size == sizeof(uint16) ? GetIndices16().size() : GetIndices32().size();
+        if (mesh.material_idx >= GetMaterials().size() ||
+            (mesh.index_size != sizeof(uint16) && mesh.index_size != sizeof(uint32)) ||
+            (mesh.index_size == sizeof(uint16) && mesh.num_vertices > IndexBuffer::MAX_UINT16_VERTICES) ||
+            (uint64) mesh.first_index + mesh.num_indices > num_section_indices ||
+            (uint64) mesh.first_vertex + mesh.num_vertices > GetPositions().size() ||
+            (uint64) mesh.first_vertex + mesh.num_vertices > GetNormals().size() ||
+            (uint64) mesh.first_vertex + mesh.num_vertices > GetTangents().size() ||
+            (uint64) mesh.first_vertex + mesh.num_vertices > GetUVs().size() ||
+            (uint64) mesh.first_lod + mesh.num_lods > GetMeshLods().size() ||
+            HasValidClusters(mesh.first_cluster, mesh.num_clusters, mesh.num_indices) == false)
+        {
+            return false;
+        }
+
+        for (const CookedMeshLod& lod : GetMeshLods().subspan(mesh.first_lod, mesh.num_lods))
+        {
+            if ((uint64) lod.first_index + lod.num_indices > num_section_indices ||
+                HasValidClusters(lod.first_cluster, lod.num_clusters, lod.num_indices) == false)
+            {
+                return false;
+            }
+        }
+    }
+
+    return nodes.empty() == false;
+}
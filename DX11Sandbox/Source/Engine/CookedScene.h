@@ -0,0 +1,170 @@
+#pragma once
+#include <span>
+#include <string_view>
+
+#include "Core/MappedFile.h"
+#include "Renderer/ClusterCulling.h"
+
+/**
+ * Cooked scene file (.dxmesh). Stores the result of the assimp import in exactly the layout the scene importer consumes,
+ * so loading a scene is a memory mapping instead of a full assimp post processing run:
+ *
+ * [header][source files][nodes][mesh refs][materials][meshes][mesh lods][clusters][strings][16 bit indices][32 bit indices][positions][normals][tangents][uvs]
+ *
+ * Every section starts at a 16 byte aligned offset. The vertex streams are laid out like the VertexBuffer slots,
+ * so pointers into the mapping can be passed to buffer creation without any conversion.
+ */
+enum class CookedSceneSection : uint32
+{
+    SourceFiles,
+    Nodes,
+    MeshRefs,
+    Materials,
+    Meshes,
+    MeshLods,
+    Clusters,
+    Strings,
+    Indices16,
+    Indices32,
+    Positions,
+    Normals,
+    Tangents,
+    UVs,
+    Count
+};
+
+enum class CookedTextureSlot : uint32
+{
+    BaseColor,
+    Normal,
+    MetallicRoughness,
+    Count
+};
+
+struct CookedRange
+{
+    uint64 offset = 0;  // In bytes, from the start of the file
+    uint64 count = 0;   // In elements
+};
+
+struct CookedString
+{
+    uint32 offset = 0;  // Into the string section
+    uint32 length = 0;
+};
+
+struct CookedSceneHeader
+{
+    static constexpr uint32 MAGIC = 0x534D5844;    // "DXMS"
+    static constexpr uint32 VERSION = 5;            // Bump whenever the layout or the import settings change
+
+    uint32 magic = MAGIC;
+    uint32 version = VERSION;
+    uint64 source_hash = 0;     // Content hash of every file assimp read while cooking
+    uint64 file_size = 0;
+    CookedRange sections[(uint32) CookedSceneSection::Count];
+};
+
+struct CookedNode
+{
+    CookedString name;
+    int32 parent_idx = -1;      // Parents always precede their children, -1 for the root
+    uint32 first_mesh_ref = 0;
+    uint32 num_mesh_refs = 0;
+    float scaling[3] = {};
+    float rotation[4] = {};
+    float translation[3] = {};
+};
+
+struct CookedMaterial
+{
+    static constexpr uint32 TWO_SIDED_BIT = 1 << 0;
+    static constexpr uint32 ALPHA_MASK_BIT = 1 << 1;
+    static constexpr uint32 ALPHA_BLEND_BIT = 1 << 2;
+    static constexpr uint32 BASE_COLOR_BIT = 1 << 3;    // base_color is valid
+
+    uint32 flags = 0;
+    float alpha_cutoff = 0.0f;
+    float base_color[3] = {};
+    CookedString textures[(uint32) CookedTextureSlot::Count];  // Relative to the scene directory, empty if unused
+};
+
+struct CookedMesh
+{
+    uint32 material_idx = 0;
+    uint32 first_index = 0;     // Indices are relative to first_vertex
+    uint32 num_indices = 0;
+    uint32 index_size = 2;      // 2 or 4 bytes, selects the index section first_index points into
+    uint32 first_vertex = 0;
+    uint32 num_vertices = 0;
+    float bounds_min[3] = {};   // Model space
+    float bounds_max[3] = {};
+    uint32 first_cluster = 0;   // Together the clusters cover all indices of the mesh
+    uint32 num_clusters = 0;
+    uint32 first_lod = 0;       // Coarser levels, finest first
+    uint32 num_lods = 0;
+};
+
+// Simplified version of a mesh. Shares its vertices, indices are in the same section.
+struct CookedMeshLod
+{
+    uint32 first_index = 0;
+    uint32 num_indices = 0;
+    uint32 first_cluster = 0;
+    uint32 num_clusters = 0;
+    float error = 0.0f;         // Model space distance to the full detail surface, see SimplifyMesh()
+};
+
+/**
+ * Read-only view of a cooked scene. Usually backed by a memory mapped .dxmesh file next to the source scene.
+ */
+class CookedScene
+{
+public:
+    // Maps the cooked version of the scene. If it is missing, outdated or was written by another version,
+    // the scene gets imported with assimp and cooked first.
+    static UniquePtr<CookedScene> Load(const String& scene_path);
+
+    static String GetCookedPath(const String& scene_path);
+
+    std::span<const CookedNode> GetNodes() const { return GetSection<CookedNode>(CookedSceneSection::Nodes); }
+    std::span<const uint32> GetMeshRefs() const { return GetSection<uint32>(CookedSceneSection::MeshRefs); }
+    std::span<const CookedMaterial> GetMaterials() const { return GetSection<CookedMaterial>(CookedSceneSection::Materials); }
+    std::span<const CookedMesh> GetMeshes() const { return GetSection<CookedMesh>(CookedSceneSection::Meshes); }
+    std::span<const CookedMeshLod> GetMeshLods() const { return GetSection<CookedMeshLod>(CookedSceneSection::MeshLods); }
+    std::span<const MeshCluster> GetClusters() const { return GetSection<MeshCluster>(CookedSceneSection::Clusters); }
+    std::span<const CookedString> GetSourceFiles() const { return GetSection<CookedString>(CookedSceneSection::SourceFiles); }
+
+    std::span<const uint16> GetIndices16() const { return GetSection<uint16>(CookedSceneSection::Indices16); }
+    std::span<const uint32> GetIndices32() const { return GetSection<uint32>(CookedSceneSection::Indices32); }
+    std::span<const Vec3> GetPositions() const { return GetSection<Vec3>(CookedSceneSection::Positions); }
+    std::span<const Vec3> GetNormals() const { return GetSection<Vec3>(CookedSceneSection::Normals); }
+    std::span<const Vec3> GetTangents() const { return GetSection<Vec3>(CookedSceneSection::Tangents); }
+    std::span<const Vec2> GetUVs() const { return GetSection<Vec2>(CookedSceneSection::UVs); }
+
+    std::string_view GetString(const CookedString& str) const;
+
+    const CookedSceneHeader& GetHeader() const { return *(const CookedSceneHeader*) data_; }
+
+private:
+    CookedScene() = default;
+
+    // Checks magic, version and that every section lies within the file.
+    bool Validate() const;
+    // Clusters lie within the section and within the index range of their mesh or LOD
+    bool HasValidClusters(uint32 first_cluster, uint32 num_clusters, uint32 num_indices) const;
+
+    template<typename T>
+    std::span<const T> GetSection(CookedSceneSection section) const
+    {
+        const CookedRange& range = GetHeader().sections[(uint32) section];
+        return { (const T*) (data_ + range.offset), (size_t) range.count };
+    }
+
+    // Either the mapped file, or the freshly cooked blob if it could not be written to disk
+    MappedFile file_;
+    std::vector<uint8> blob_;
+
+    const uint8* data_ = nullptr;
+    size_t size_ = 0;
+};
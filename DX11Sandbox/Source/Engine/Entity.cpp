@@ -2,7 +2,7 @@
 
 Entity::Entity()
 {
-    transform_ = AddComponent<TransformComponent>();
+    transform_ = AddComponent<EntityTransformComponent>();
 }
 
 Entity::~Entity()
@@ -56,7 +56,7 @@ public:
     }
 
     String name_;
-    TransformComponent* transform_;
+    EntityTransformComponent* transform_;
 
 private:
     std::vector<IComponent*> components_;
@@ -0,0 +1,281 @@
+#include "Engine/EntityRegistry.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+    ComponentInfo component_infos[MAX_COMPONENT_TYPES];
+    std::atomic<uint32> num_component_types = 0;
+    std::mutex register_mutex;
+
+    uint32 AlignUp(uint32 value, uint32 alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+uint32 ComponentRegistry::Register(const ComponentInfo& info)
+{
+    // Type ids are assigned lazily from function local statics, which may happen on any thread
+    std::lock_guard<std::mutex> lock(register_mutex);
+
+    const uint32 type_id = num_component_types.load(std::memory_order_relaxed);
+    CHECK_MSG(type_id < MAX_COMPONENT_TYPES, "Too many component types. Increase MAX_COMPONENT_TYPES.");
+    component_infos[type_id] = info;
+    num_component_types.store(type_id + 1, std::memory_order_release);
+    return type_id;
+}
+
+const ComponentInfo& ComponentRegistry::GetInfo(uint32 type_id)
+{
+    CHECK(type_id < num_component_types.load(std::memory_order_acquire));
+    return component_infos[type_id];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+EntityRegistry::EntityRegistry()
+{
+    // Fresh entities live in the archetype without any components
+    GetOrCreateArchetype(0);
+}
+
+EntityRegistry::~EntityRegistry()
+{
+    for (const UniquePtr<Archetype>& archetype : archetypes_)
+    {
+        for (uint32 row = 0; row < archetype->num_entities; ++row)
+        {
+            for (uint32 column_idx = 0; column_idx < (uint32) archetype->type_ids.size(); ++column_idx)
+            {
+                ComponentRegistry::GetInfo(archetype->type_ids[column_idx]).destroy(GetComponentStorage(*archetype, row, column_idx));
+            }
+        }
+    }
+}
+
+EntityId EntityRegistry::Create()
+{
+    CHECK(iteration_depth_ == 0);
+
+    uint32 index;
+    if (free_indices_.empty() == false)
+    {
+        index = free_indices_.back();
+        free_indices_.pop_back();
+    }
+    else
+    {
+        index = (uint32) records_.size();
+        records_.push_back(EntityRecord());
+    }
+
+    const EntityId entity{ .index = index, .generation = records_[index].generation };
+
+    Archetype& empty_archetype = *mask_to_archetype_.at(0);
+    records_[index].archetype = &empty_archetype;
+    records_[index].row = AllocateRow(empty_archetype, entity);
+    ++num_entities_;
+
+    return entity;
+}
+
+void EntityRegistry::Destroy(EntityId entity)
+{
+    CHECK(iteration_depth_ == 0);
+    if (IsAlive(entity) == false)
+    {
+        return;
+    }
+
+    EntityRecord& record = records_[entity.index];
+    Archetype& archetype = *record.archetype;
+    for (uint32 column_idx = 0; column_idx < (uint32) archetype.type_ids.size(); ++column_idx)
+    {
+        ComponentRegistry::GetInfo(archetype.type_ids[column_idx]).destroy(GetComponentStorage(archetype, record.row, column_idx));
+    }
+    RemoveRow(archetype, record.row);
+
+    record.archetype = nullptr;
+    record.generation++;
+    free_indices_.push_back(entity.index);
+    --num_entities_;
+}
+
+bool EntityRegistry::IsAlive(EntityId entity) const
+{
+    return entity.index < records_.size() && records_[entity.index].generation == entity.generation && records_[entity.index].archetype != nullptr;
+}
+
+void* EntityRegistry::AddComponent(EntityId entity, uint32 type_id)
+{
+    CHECK(iteration_depth_ == 0);
+    CHECK(IsAlive(entity));
+
+    const EntityRecord& record = records_[entity.index];
+    Archetype& target = *GetOrCreateArchetype(record.archetype->mask | (ComponentMask(1) << type_id));
+    MoveEntity(entity, target);
+
+    return GetComponentStorage(target, record.row, target.column_of_type[type_id]);
+}
+
+void EntityRegistry::RemoveComponent(EntityId entity, uint32 type_id)
+{
+    CHECK(iteration_depth_ == 0);
+    if (GetComponent(entity, type_id) == nullptr)
+    {
+        return;
+    }
+
+    const EntityRecord& record = records_[entity.index];
+    MoveEntity(entity, *GetOrCreateArchetype(record.archetype->mask & ~(ComponentMask(1) << type_id)));
+}
+
+void* EntityRegistry::GetComponent(EntityId entity, uint32 type_id) const
+{
+    if (IsAlive(entity) == false)
+    {
+        return nullptr;
+    }
+
+    const EntityRecord& record = records_[entity.index];
+    const int32 column_idx = record.archetype->column_of_type[type_id];
+    if (column_idx < 0)
+    {
+        return nullptr;
+    }
+
+    return GetComponentStorage(*record.archetype, record.row, column_idx);
+}
+
+Archetype* EntityRegistry::GetOrCreateArchetype(ComponentMask mask)
+{
+    auto it = mask_to_archetype_.find(mask);
+    if (it != mask_to_archetype_.end())
+    {
+        return it->second;
+    }
+
+    UniquePtr<Archetype> archetype = MakeUnique<Archetype>();
+    archetype->mask = mask;
+    archetype->column_of_type.fill(-1);
+
+    uint32 row_size = sizeof(EntityId);
+    for (uint32 type_id = 0; type_id < MAX_COMPONENT_TYPES; ++type_id)
+    {
+        if (mask & (ComponentMask(1) << type_id))
+        {
+            archetype->column_of_type[type_id] = (int32) archetype->type_ids.size();
+            archetype->type_ids.push_back(type_id);
+            row_size += ComponentRegistry::GetInfo(type_id).size;
+        }
+    }
+    archetype->column_offsets.resize(archetype->type_ids.size());
+
+    // Start with the upper bound and shrink until the aligned columns fit into a chunk
+    for (uint32 capacity = EntityChunk::SIZE / row_size; capacity > 0; --capacity)
+    {
+        uint32 offset = capacity * sizeof(EntityId);
+        for (uint32 column_idx = 0; column_idx < (uint32) archetype->type_ids.size(); ++column_idx)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(archetype->type_ids[column_idx]);
+            offset = AlignUp(offset, std::max(info.alignment, 16u));
+            archetype->column_offsets[column_idx] = offset;
+            offset += capacity * info.size;
+        }
+
+        if (offset <= EntityChunk::SIZE)
+        {
+            archetype->chunk_capacity = capacity;
+            break;
+        }
+    }
+    CHECK_MSG(archetype->chunk_capacity > 0, "Components of archetype {:#x} don't fit into a single chunk", mask);
+
+    Archetype* out = archetype.get();
+    archetypes_.push_back(std::move(archetype));
+    mask_to_archetype_[mask] = out;
+    return out;
+}
+
+void* EntityRegistry::GetComponentStorage(const Archetype& archetype, uint32 row, uint32 column_idx) const
+{
+    EntityChunk& chunk = *archetype.chunks[row / archetype.chunk_capacity];
+    const ComponentInfo& info = ComponentRegistry::GetInfo(archetype.type_ids[column_idx]);
+    return chunk.data + archetype.column_offsets[column_idx] + (row % archetype.chunk_capacity) * info.size;
+}
+
+uint32 EntityRegistry::AllocateRow(Archetype& archetype, EntityId entity)
+{
+    const uint32 row = archetype.num_entities;
+    if (row / archetype.chunk_capacity >= archetype.chunks.size())
+    {
+        archetype.chunks.push_back(MakeUnique<EntityChunk>());
+    }
+
+    EntityChunk& chunk = *archetype.chunks[row / archetype.chunk_capacity];
+    archetype.GetEntityIds(chunk)[chunk.num_entities] = entity;
+    chunk.num_entities++;
+    archetype.num_entities++;
+
+    return row;
+}
+
+void EntityRegistry::RemoveRow(Archetype& archetype, uint32 row)
+{
+    const uint32 last_row = archetype.num_entities - 1;
+    EntityChunk& last_chunk = *archetype.chunks[last_row / archetype.chunk_capacity];
+
+    if (row != last_row)
+    {
+        for (uint32 column_idx = 0; column_idx < (uint32) archetype.type_ids.size(); ++column_idx)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(archetype.type_ids[column_idx]);
+            void* last = GetComponentStorage(archetype, last_row, column_idx);
+            info.move_construct(GetComponentStorage(archetype, row, column_idx), last);
+            info.destroy(last);
+        }
+
+        const EntityId moved_entity = archetype.GetEntityIds(last_chunk)[last_row % archetype.chunk_capacity];
+        archetype.GetEntityIds(*archetype.chunks[row / archetype.chunk_capacity])[row % archetype.chunk_capacity] = moved_entity;
+        records_[moved_entity.index].row = row;
+    }
+
+    last_chunk.num_entities--;
+    archetype.num_entities--;
+
+    // Keep one empty chunk behind the used ones, so entities moving back and forth across a chunk boundary don't allocate every time
+    const size_t num_used_chunks = (archetype.num_entities + archetype.chunk_capacity - 1) / archetype.chunk_capacity;
+    if (archetype.chunks.size() > num_used_chunks + 1)
+    {
+        archetype.chunks.pop_back();
+    }
+}
+
+void EntityRegistry::MoveEntity(EntityId entity, Archetype& target)
+{
+    EntityRecord& record = records_[entity.index];
+    Archetype& source = *record.archetype;
+    const uint32 source_row = record.row;
+    const uint32 target_row = AllocateRow(target, entity);
+
+    for (uint32 column_idx = 0; column_idx < (uint32) source.type_ids.size(); ++column_idx)
+    {
+        const uint32 type_id = source.type_ids[column_idx];
+        const ComponentInfo& info = ComponentRegistry::GetInfo(type_id);
+        void* src = GetComponentStorage(source, source_row, column_idx);
+
+        const int32 target_column_idx = target.column_of_type[type_id];
+        if (target_column_idx >= 0)
+        {
+            info.move_construct(GetComponentStorage(target, target_row, target_column_idx), src);
+        }
+        info.destroy(src);
+    }
+
+    RemoveRow(source, source_row);
+
+    record.archetype = &target;
+    record.row = target_row;
+}
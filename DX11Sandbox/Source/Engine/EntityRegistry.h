@@ -0,0 +1,263 @@
+#pragma once
+#include <tuple>
+
+#include "Core/JobSystem.h"
+
+struct EntityId
+{
+    static constexpr uint32 INVALID_INDEX = 0xffffffff;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+    bool operator==(const EntityId& other) const = default;
+
+    uint32 index = INVALID_INDEX;
+    uint32 generation = 0;
+};
+MAKE_HASHABLE(EntityId, t.index, t.generation);
+
+static constexpr uint32 MAX_COMPONENT_TYPES = 64;
+using ComponentMask = uint64;
+
+/**
+ * Type erased information about a component type. Components are plain movable types, they don't need to derive from anything.
+ */
+struct ComponentInfo
+{
+    uint32 size = 0;
+    uint32 alignment = 0;
+    void (*move_construct)(void* dst, void* src) = nullptr;
+    void (*destroy)(void* component) = nullptr;
+};
+
+class ComponentRegistry
+{
+public:
+    // Type ids are assigned on first use, so they are only stable within a run
+    template<typename T>
+    static uint32 GetTypeId()
+    {
+        static const uint32 type_id = Register(ComponentInfo
+            {
+                .size = sizeof(T),
+                .alignment = alignof(T),
+                .move_construct = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+                .destroy = [](void* component) { static_cast<T*>(component)->~T(); }
+            });
+        return type_id;
+    }
+
+    template<typename... Ts>
+    static ComponentMask GetMask()
+    {
+        return ((ComponentMask(1) << GetTypeId<Ts>()) | ... | ComponentMask(0));
+    }
+
+    static const ComponentInfo& GetInfo(uint32 type_id);
+
+private:
+    static uint32 Register(const ComponentInfo& info);
+};
+
+/**
+ * Fixed size block of memory which stores the components of up to Archetype::chunk_capacity entities.
+ * Every component type gets its own contiguous column: [entity ids][component A][component B]...
+ */
+struct alignas(64) EntityChunk
+{
+    static constexpr uint32 SIZE = 16 * 1024;
+
+    uint8 data[SIZE];
+    uint32 num_entities = 0;
+};
+
+/**
+ * All entities with exactly the same set of components.
+ * Entities are densely packed: Every chunk except the last used one is full. At most one empty chunk is kept behind it.
+ */
+struct Archetype
+{
+    template<typename T>
+    T* GetColumn(EntityChunk& chunk) const
+    {
+        const int32 column_idx = column_of_type[ComponentRegistry::GetTypeId<T>()];
+        CHECK(column_idx >= 0);
+        return reinterpret_cast<T*>(chunk.data + column_offsets[column_idx]);
+    }
+
+    EntityId* GetEntityIds(EntityChunk& chunk) const { return reinterpret_cast<EntityId*>(chunk.data); }
+
+    ComponentMask mask = 0;
+    std::vector<uint32> type_ids;           // Ascending
+    std::vector<uint32> column_offsets;     // In bytes from the start of the chunk, same order as type_ids
+    std::array<int32, MAX_COMPONENT_TYPES> column_of_type;   // -1 if the type isn't part of this archetype
+    uint32 chunk_capacity = 0;
+    uint32 num_entities = 0;
+    std::vector<UniquePtr<EntityChunk>> chunks;
+};
+
+/**
+ * Archetype based entity component storage.
+ *
+ * Entities with the same set of components share an archetype and their components are stored column-wise in chunks,
+ * so queries like Each<TransformComponent, StaticMeshComponent>() iterate over contiguous arrays instead of chasing pointers.
+ *
+ * Adding or removing a component moves the entity into another archetype, and destroying an entity moves the last entity
+ * of its archetype into the hole. So component pointers are only valid until the next structural change.
+ * Structural changes are not allowed while iterating.
+ */
+class EntityRegistry
+{
+public:
+    EntityRegistry();
+    ~EntityRegistry();
+
+    EntityRegistry(const EntityRegistry&) = delete;
+    EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+    EntityId Create();
+    void Destroy(EntityId entity);
+    bool IsAlive(EntityId entity) const;
+
+    uint32 GetNumEntities() const { return num_entities_; }
+    uint32 GetNumArchetypes() const { return (uint32) archetypes_.size(); }
+
+    template<typename T, typename... Args>
+    T* AddComponent(EntityId entity, Args&&... args)
+    {
+        const uint32 type_id = ComponentRegistry::GetTypeId<T>();
+        if (T* existing = GetComponent<T>(entity))
+        {
+            CHECK_MSG(false, "Entity already has this component");
+            return existing;
+        }
+
+        void* storage = AddComponent(entity, type_id);
+        return new (storage) T(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    void RemoveComponent(EntityId entity)
+    {
+        RemoveComponent(entity, ComponentRegistry::GetTypeId<T>());
+    }
+
+    template<typename T>
+    T* GetComponent(EntityId entity) const
+    {
+        return static_cast<T*>(GetComponent(entity, ComponentRegistry::GetTypeId<T>()));
+    }
+
+    template<typename T>
+    bool HasComponent(EntityId entity) const
+    {
+        return GetComponent<T>(entity) != nullptr;
+    }
+
+    // Calls func(Ts&...) or func(EntityId, Ts&...) for every entity which has all of the given components.
+    template<typename... Ts, typename Func>
+    void Each(Func&& func)
+    {
+        const ComponentMask mask = ComponentRegistry::GetMask<Ts...>();
+
+        ++iteration_depth_;
+        for (const UniquePtr<Archetype>& archetype : archetypes_)
+        {
+            if ((archetype->mask & mask) != mask)
+            {
+                continue;
+            }
+
+            for (const UniquePtr<EntityChunk>& chunk : archetype->chunks)
+            {
+                EachInChunk<Ts...>(*archetype, *chunk, func);
+            }
+        }
+        --iteration_depth_;
+    }
+
+    // Same as Each, but chunks are processed in parallel on the job system. func must be safe to call concurrently.
+    template<typename... Ts, typename Func>
+    void ParallelEach(Func&& func)
+    {
+        const ComponentMask mask = ComponentRegistry::GetMask<Ts...>();
+
+        std::vector<std::pair<Archetype*, EntityChunk*>> chunks;
+        for (const UniquePtr<Archetype>& archetype : archetypes_)
+        {
+            if ((archetype->mask & mask) == mask)
+            {
+                for (const UniquePtr<EntityChunk>& chunk : archetype->chunks)
+                {
+                    // Skips the spare chunk, it would only cost a job
+                    if (chunk->num_entities > 0)
+                    {
+                        chunks.push_back({ archetype.get(), chunk.get() });
+                    }
+                }
+            }
+        }
+
+        ++iteration_depth_;
+        jobs::ParallelFor((uint32) chunks.size(), 1, [&chunks, &func](uint32 begin, uint32 end)
+            {
+                for (uint32 i = begin; i < end; ++i)
+                {
+                    EachInChunk<Ts...>(*chunks[i].first, *chunks[i].second, func);
+                }
+            });
+        --iteration_depth_;
+    }
+
+private:
+    struct EntityRecord
+    {
+        Archetype* archetype = nullptr;
+        uint32 row = 0;         // Position within the archetype, across all of its chunks
+        uint32 generation = 0;
+    };
+
+    template<typename... Ts, typename Func>
+    static void EachInChunk(const Archetype& archetype, EntityChunk& chunk, Func& func)
+    {
+        const EntityId* entity_ids = archetype.GetEntityIds(chunk);
+        const std::tuple<Ts*...> columns{ archetype.GetColumn<Ts>(chunk)... };
+        for (uint32 i = 0; i < chunk.num_entities; ++i)
+        {
+            if constexpr (std::is_invocable_v<Func&, EntityId, Ts&...>)
+            {
+                func(entity_ids[i], std::get<Ts*>(columns)[i]...);
+            }
+            else
+            {
+                func(std::get<Ts*>(columns)[i]...);
+            }
+        }
+    }
+
+    // Moves the entity into the archetype with the additional component and returns the uninitialized storage for it
+    void* AddComponent(EntityId entity, uint32 type_id);
+    void RemoveComponent(EntityId entity, uint32 type_id);
+    void* GetComponent(EntityId entity, uint32 type_id) const;
+
+    Archetype* GetOrCreateArchetype(ComponentMask mask);
+    void* GetComponentStorage(const Archetype& archetype, uint32 row, uint32 column_idx) const;
+
+    // Appends an uninitialized row and returns its index
+    uint32 AllocateRow(Archetype& archetype, EntityId entity);
+
+    // Fills the hole with the last row of the archetype. The components in the hole must have been moved out or destroyed already.
+    void RemoveRow(Archetype& archetype, uint32 row);
+
+    // Moves the entity's components into the target archetype. Components the target doesn't have are destroyed.
+    void MoveEntity(EntityId entity, Archetype& target);
+
+    std::vector<UniquePtr<Archetype>> archetypes_;
+    std::unordered_map<ComponentMask, Archetype*> mask_to_archetype_;
+
+    std::vector<EntityRecord> records_;
+    std::vector<uint32> free_indices_;
+    uint32 num_entities_ = 0;
+
+    // Structural changes would move components underneath a running query
+    uint32 iteration_depth_ = 0;
+};
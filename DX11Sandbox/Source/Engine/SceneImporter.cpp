@@ -1,115 +1,265 @@
 #include "SceneImporter.h"
 
-#include "assimp/Importer.hpp"
-#include "assimp/postprocess.h"
-#include "assimp/scene.h"
-#include "assimp/GltfMaterial.h"
+#include <chrono>
 
-SharedPtr<Entity> SceneImporter::ImportScene(const SceneDescription& scene_desc, World& world)
+#include "Core/JobSystem.h"
+#include "Renderer/GraphicsBackend.h"
+#include "Renderer/VertexQuantization.h"
+
+EntityId SceneImporter::ImportScene(const SceneDescription& scene_desc, World& world)
 {
     LOG("Loading Scene: {}", scene_desc.path);
-    auto root_path = std::filesystem::path(scene_desc.path).parent_path();
+    const auto start_time = std::chrono::high_resolution_clock::now();
 
-    SharedPtr<Model> model = MakeShared<Model>();
+    // Runs assimp only if there is no up to date cooked version of the scene
+    const UniquePtr<CookedScene> scene = CookedScene::Load(scene_desc.path);
 
-    Assimp::Importer ai_importer;
-    uint32 importer_flags = aiProcess_ConvertToLeftHanded | aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_CalcTangentSpace;
-    const aiScene* ai_scene = ai_importer.ReadFile(scene_desc.path, importer_flags);
-    CHECK_MSG(ai_scene != nullptr, "Failed to load mesh from file: {}. \n Error: {}", scene_desc.path, ai_importer.GetErrorString());
+    // Texture decoding doesn't touch the device, so it runs as jobs.
+    // Only the creation of the D3D resources has to happen on the main thread.
+    const std::vector<TextureDesc> texture_descs = GatherTextures(scene_desc, *scene);
+    std::vector<TextureData> texture_data(texture_descs.size());
 
-    aiNode* root = ai_scene->mRootNode;
-    SharedPtr<Entity> entity = ProcessNode(scene_desc, ai_scene, root, nullptr, world);
-    return entity;
+    JobCounter counter;
+    for (size_t i = 0; i < texture_descs.size(); ++i)
+    {
+        jobs::Run([&texture_descs, &texture_data, i]()
+            {
+                texture_data[i] = TextureData::Load(texture_descs[i]);
+            }, &counter);
+    }
+    jobs::Wait(counter);
+
+    for (size_t i = 0; i < texture_descs.size(); ++i)
+    {
+        gfx::resource_manager->textures.Create(texture_descs[i], texture_data[i]);
+    }
+    texture_data.clear();
+
+    // One set of buffers for the whole scene, so drawing one mesh after another doesn't rebind any of them
+    const SceneGeometry geometry = CreateGeometry(scene_desc, *scene);
+
+    // Parents precede their children, so entities can be created in file order
+    const std::span<const CookedNode> nodes = scene->GetNodes();
+    const std::span<const uint32> mesh_refs = scene->GetMeshRefs();
+    std::vector<EntityId> node_entities(nodes.size());
+
+    // Nodes referencing the same mesh share its buffers and material, so the renderer can draw them instanced
+    std::vector<SharedPtr<Model>> mesh_models(scene->GetMeshes().size());
+    for (size_t node_idx = 0; node_idx < nodes.size(); ++node_idx)
+    {
+        const CookedNode& node = nodes[node_idx];
+        const EntityId parent = node.parent_idx >= 0 ? node_entities[node.parent_idx] : EntityId();
+        node_entities[node_idx] = ProcessNode(scene_desc, *scene, node, parent, world);
+
+        for (uint32 i = 0; i < node.num_mesh_refs; ++i)
+        {
+            const uint32 mesh_idx = mesh_refs[node.first_mesh_ref + i];
+            SharedPtr<Model>& mesh_model = mesh_models[mesh_idx];
+            SharedPtr<Model> model = mesh_model != nullptr ? mesh_model->CreateInstance() : SceneImporter::ProcessMesh(scene_desc, *scene, geometry, mesh_idx);
+            if (mesh_model == nullptr)
+            {
+                mesh_model = model;
+            }
+
+            const EntityId mesh_entity = world.CreateEntity(String(scene->GetString(node.name)));
+            world.AddComponent<StaticMeshComponent>(mesh_entity)->model_ = model;
+            world.AddChild(node_entities[node_idx], mesh_entity);
+        }
+    }
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    LOG("Loaded scene {} in {:.1f} ms ({} textures, {} meshes, {} threads)", scene_desc.path,
+        std::chrono::duration<double, std::milli>(end_time - start_time).count(), texture_descs.size(), scene->GetMeshes().size(), jobs::GetNumThreads());
+
+    return node_entities[0];
 }
 
-SharedPtr<Entity> SceneImporter::ProcessNode(const SceneDescription& scene_desc, const aiScene* scene, aiNode* node, Entity* parent, World& world)
+std::vector<TextureDesc> SceneImporter::GatherTextures(const SceneDescription& scene_desc, const CookedScene& scene)
 {
-    SharedPtr<Entity> entity = MakeShared<Entity>();
-    entity->name_ = node->mName.C_Str();
-    world.Add(entity);
+    const std::filesystem::path root_path = std::filesystem::path(scene_desc.path).parent_path();
 
-    bool apply_correction_transform = true; // If we want to correct the import, we only have to touch the first node in the tree.
-    if(parent != nullptr)
+    std::vector<TextureDesc> texture_descs;
+    std::unordered_set<TextureDesc> unique_descs;
+    auto add_texture = [&](TextureDesc desc, TextureCompression compression, uint8 first_channel)
     {
-        apply_correction_transform = false;
-        parent->AddChild(entity.get());
-    }
+        desc.is_streamed = scene_desc.stream_textures;
+        if (scene_desc.compress_textures)
+        {
+            desc.compression = compression;
+            desc.first_channel = first_channel;
+        }
 
-    aiVector3D scaling;
-    aiQuaternion rotation;
-    aiVector3D translation;
-    node->mTransformation.Decompose(scaling, rotation, translation);
-    
-    Transform import_transform = {
-        { scaling.x, scaling.y, scaling.z },
-        { rotation.x, rotation.y, rotation.z, rotation.w },
-        { translation.x, translation.y, translation.z }
+        // Textures can be shared between materials or even scenes
+        if (gfx::resource_manager->textures.Get(desc) == nullptr && unique_descs.insert(desc).second)
+        {
+            texture_descs.push_back(desc);
+        }
     };
 
-    if(apply_correction_transform)
+    for (const CookedMaterial& material : scene.GetMaterials())
     {
-        import_transform = import_transform * scene_desc.import_correction_transform;
+        TextureDesc desc;
+        if (GetTextureDesc(root_path, scene, material, CookedTextureSlot::BaseColor, TextureSpace::SRGB, desc))
+        {
+            add_texture(desc, TextureCompression::BC7, 0);
+        }
+
+        if (GetTextureDesc(root_path, scene, material, CookedTextureSlot::Normal, TextureSpace::Linear, desc))
+        {
+            // Only X and Y, the shaders reconstruct Z
+            add_texture(desc, TextureCompression::BC5, 0);
+        }
+
+        if (GetTextureDesc(root_path, scene, material, CookedTextureSlot::MetallicRoughness, TextureSpace::Linear, desc))
+        {
+            // glTF stores roughness in G and metallic in B, compressed they end up in R and G
+            add_texture(desc, TextureCompression::BC5, 1);
+        }
+    }
+
+    return texture_descs;
+}
+
+bool SceneImporter::GetTextureDesc(const std::filesystem::path& root_path, const CookedScene& scene, const CookedMaterial& material,
+    CookedTextureSlot slot, TextureSpace texture_space, TextureDesc& out_desc)
+{
+    const std::string_view tex_path = scene.GetString(material.textures[(uint32) slot]);
+    if (tex_path.empty())
+    {
+        return false;
+    }
+
+    out_desc = TextureDesc{ (root_path / std::filesystem::path(tex_path)).string(), texture_space };
+    return true;
+}
+
+SceneImporter::SceneGeometry SceneImporter::CreateGeometry(const SceneDescription& scene_desc, const CookedScene& scene)
+{
+    SceneGeometry geometry;
+    if (scene.GetMeshes().empty())
+    {
+        return geometry;
+    }
+
+    // Streams point straight into the cooked file, no intermediate copies
+    const std::span<const uint16> indices16 = scene.GetIndices16();
+    if (indices16.empty() == false)
+    {
+        geometry.indices16 = MakeShared<IndexBuffer>(indices16.data(), (uint32) indices16.size());
     }
 
-    entity->transform_->SetLocalTransform(import_transform);
+    const std::span<const uint32> indices32 = scene.GetIndices32();
+    if (indices32.empty() == false)
+    {
+        geometry.indices32 = MakeShared<IndexBuffer>(indices32.data(), (uint32) indices32.size());
+    }
+
+    const std::span<const MeshCluster> clusters = scene.GetClusters();
+    geometry.clusters = MakeShared<const std::vector<MeshCluster>>(clusters.begin(), clusters.end());
+
+    const std::span<const Vec3> positions = scene.GetPositions();
+    const uint32 num_vertices = (uint32) positions.size();
+    const VertexFormat vertex_format = scene_desc.vertex_format;
+    if (vertex_format == VertexFormat::Float)
+    {
+        geometry.pos = MakeShared<VertexBuffer>(positions.data(), num_vertices, sizeof(Vec3), VertexBufferSlots::POS);
+        geometry.normals = MakeShared<VertexBuffer>(scene.GetNormals().data(), num_vertices, sizeof(Vec3), VertexBufferSlots::NORMALS);
+        geometry.tangents = MakeShared<VertexBuffer>(scene.GetTangents().data(), num_vertices, sizeof(Vec3), VertexBufferSlots::TANGENTS);
+        geometry.uv = MakeShared<VertexBuffer>(scene.GetUVs().data(), num_vertices, sizeof(Vec2), VertexBufferSlots::TEX_COORD);
+        return geometry;
+    }
+
+    // The cooked streams stay float, packing is cheap enough to do on every import
+    static constexpr uint32 VERTICES_PER_JOB = 16 * 1024;
+    std::vector<PackedVertexAttributes> attributes(num_vertices);
+    jobs::ParallelFor(num_vertices, VERTICES_PER_JOB, [&scene, &attributes](uint32 begin, uint32 end)
+        {
+            const std::span<const Vec3> normals = scene.GetNormals();
+            const std::span<const Vec3> tangents = scene.GetTangents();
+            const std::span<const Vec2> uvs = scene.GetUVs();
+            for (uint32 i = begin; i < end; ++i)
+            {
+                attributes[i] = PackVertexAttributes(normals[i], tangents[i], uvs[i]);
+            }
+        });
+    geometry.attributes = MakeShared<VertexBuffer>(attributes.data(), num_vertices, sizeof(PackedVertexAttributes), VertexBufferSlots::ATTRIBUTES);
 
-    for(uint32 mesh_idx = 0; mesh_idx < node->mNumMeshes; ++mesh_idx)
+    if (vertex_format == VertexFormat::PackedQuantized)
+    {
+        // Every mesh gets the full 16 bits for its own bounds, the world matrix of its model undoes the quantization
+        const std::span<const CookedMesh> meshes = scene.GetMeshes();
+        std::vector<QuantizedPosition> quantized_positions(num_vertices);
+        geometry.position_dequantizations.resize(meshes.size());
+        jobs::ParallelFor((uint32) meshes.size(), 1, [&meshes, &positions, &quantized_positions, &geometry](uint32 begin, uint32 end)
+            {
+                for (uint32 mesh_idx = begin; mesh_idx < end; ++mesh_idx)
+                {
+                    const CookedMesh& mesh = meshes[mesh_idx];
+                    geometry.position_dequantizations[mesh_idx] = QuantizePositions(positions.subspan(mesh.first_vertex, mesh.num_vertices),
+                        Vec3(mesh.bounds_min[0], mesh.bounds_min[1], mesh.bounds_min[2]), Vec3(mesh.bounds_max[0], mesh.bounds_max[1], mesh.bounds_max[2]),
+                        std::span<QuantizedPosition>(quantized_positions).subspan(mesh.first_vertex, mesh.num_vertices));
+                }
+            });
+        geometry.pos = MakeShared<VertexBuffer>(quantized_positions.data(), num_vertices, sizeof(QuantizedPosition), VertexBufferSlots::POS);
+    }
+    else
     {
-        SharedPtr<Entity> mesh_entity = MakeShared<Entity>();
-        mesh_entity->name_ = node->mName.C_Str();
+        geometry.pos = MakeShared<VertexBuffer>(positions.data(), num_vertices, sizeof(Vec3), VertexBufferSlots::POS);
+    }
+
+    const uint32 float_bytes = GetVertexBytes(VertexFormat::Float);
+    const uint32 packed_bytes = GetVertexBytes(vertex_format);
+    LOG("Packed {} vertices of {}: {} bytes per vertex instead of {} ({} instead of {} for depth passes), {:.1f} MiB instead of {:.1f} MiB",
+        num_vertices, scene_desc.path, packed_bytes, float_bytes, GetPositionBytes(vertex_format), GetPositionBytes(VertexFormat::Float),
+        (double) packed_bytes * num_vertices / (1024.0 * 1024.0), (double) float_bytes * num_vertices / (1024.0 * 1024.0));
+    return geometry;
+}
 
-        StaticMeshComponent* mesh_component = mesh_entity->AddComponent<StaticMeshComponent>();
-        mesh_component->model_ = SceneImporter::ProcessMesh(scene_desc, scene, node, mesh_idx);
+EntityId SceneImporter::ProcessNode(const SceneDescription& scene_desc, const CookedScene& scene, const CookedNode& node,
+    EntityId parent, World& world)
+{
+    const EntityId entity = world.CreateEntity(String(scene.GetString(node.name)));
 
-        world.Add(mesh_entity);
-        entity->AddChild(mesh_entity.get());
+    bool apply_correction_transform = true; // If we want to correct the import, we only have to touch the first node in the tree.
+    if(parent.IsValid())
+    {
+        apply_correction_transform = false;
+        world.AddChild(parent, entity);
     }
 
-    for (uint32 i = 0; i < node->mNumChildren; ++i)
+    Transform import_transform = {
+        { node.scaling[0], node.scaling[1], node.scaling[2] },
+        { node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3] },
+        { node.translation[0], node.translation[1], node.translation[2] }
+    };
+
+    if(apply_correction_transform)
     {
-        ProcessNode(scene_desc, scene, node->mChildren[i], entity.get(), world);
+        import_transform = import_transform * scene_desc.import_correction_transform;
     }
 
+    world.GetComponent<TransformComponent>(entity)->SetLocalTransform(import_transform);
     return entity;
 }
 
-SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc, const aiScene* scene, aiNode* node, uint32 mesh_idx)
+SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc, const CookedScene& scene, const SceneGeometry& geometry,
+    uint32 mesh_idx)
 {
     SharedPtr<Model> model = MakeShared<Model>();
     auto root_path = std::filesystem::path(scene_desc.path).parent_path();
 
-    VertexData vertex_data;
-    uint32 num_model_indices = 0;
-    uint32 num_model_vertices = 0;
+    const CookedMesh& cooked_mesh = scene.GetMeshes()[mesh_idx];
+    const CookedMaterial& cooked_material = scene.GetMaterials()[cooked_mesh.material_idx];
 
-    aiMesh* ai_mesh = scene->mMeshes[node->mMeshes[mesh_idx]];
-    aiMaterial* ai_material = scene->mMaterials[ai_mesh->mMaterialIndex];
+    const bool is_alpha_cutoff = (cooked_material.flags & CookedMaterial::ALPHA_MASK_BIT) != 0;
+    const bool is_two_sided = (cooked_material.flags & CookedMaterial::TWO_SIDED_BIT) != 0;
 
     BlendState material_blendstate = BlendState::Opaque;
-    aiString blend_mode_string;
-    ai_material->Get(AI_MATKEY_GLTF_ALPHAMODE, blend_mode_string);
-
-    aiShadingMode shading_mode;
-    ai_material->Get(AI_MATKEY_SHADING_MODEL, shading_mode);
-
-    bool is_alpha_cutoff = false;
-    float alpha_cutoff = 0.0f;
-
-    if (blend_mode_string == aiString("MASK"))
-    {
-        is_alpha_cutoff = true;
-        alpha_cutoff = 1.0f;
-        ai_material->Get(AI_MATKEY_GLTF_ALPHACUTOFF, alpha_cutoff);
-        material_blendstate = BlendState::NonPremultipliedAlpha;
-    }
-    else if (blend_mode_string == aiString("BLEND"))
+    if (cooked_material.flags & (CookedMaterial::ALPHA_MASK_BIT | CookedMaterial::ALPHA_BLEND_BIT))
     {
         material_blendstate = BlendState::NonPremultipliedAlpha;
     }
 
-    int is_two_sided = 0;
-    ai_material->Get(AI_MATKEY_TWOSIDED, is_two_sided);
-
     MaterialDesc mat_desc_textured
     {
         .vs_path = "assets/shaders/forward_phong_vs.hlsl",
@@ -118,7 +268,9 @@ SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc,
         .blend_state = material_blendstate,
         .depth_stencil_state = DepthStencilState::Default,
         .is_alpha_cutoff = is_alpha_cutoff,
-        .alpha_cutoff_val = alpha_cutoff
+        .alpha_cutoff_val = cooked_material.alpha_cutoff,
+        .supports_instancing = true,
+        .vertex_format = scene_desc.vertex_format
     };
 
     Handle<Material> mat_handle = gfx::resource_manager->materials.Create(mat_desc_textured);
@@ -126,19 +278,17 @@ SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc,
 
     int32 bound_texture_bits = 0;
 
-    aiVector3D base_color;
-    aiString diffuse_tex_path;
-    if (ai_material->GetTexture(aiTextureType_BASE_COLOR, 0, &diffuse_tex_path) == AI_SUCCESS &&
-        diffuse_tex_path.C_Str() != "")
+    // Textures were already decoded and created in ImportScene, so these are just cache lookups
+    TextureDesc tex_desc;
+    if (GetTextureDesc(root_path, scene, cooked_material, CookedTextureSlot::BaseColor, TextureSpace::SRGB, tex_desc))
     {
-        std::filesystem::path tex_path = root_path / std::filesystem::path(diffuse_tex_path.C_Str());
-        Handle<Texture> tex = gfx::resource_manager->textures.GetHandle(TextureDesc{ tex_path.string(), TextureSpace::SRGB });
+        Handle<Texture> tex = gfx::resource_manager->textures.GetHandle(tex_desc);
         mat->SetTexture("tex_diffuse", tex);
         bound_texture_bits |= DIFFUSE_TEX_BIT;
     }
-    else if(ai_material->Get(AI_MATKEY_BASE_COLOR, base_color) == AI_SUCCESS)
+    else if(cooked_material.flags & CookedMaterial::BASE_COLOR_BIT)
     {
-        mat->SetParam("base_color", Vec3{ base_color.x, base_color.y, base_color.z });
+        mat->SetParam("base_color", Vec3{ cooked_material.base_color[0], cooked_material.base_color[1], cooked_material.base_color[2] });
     }
     else 
     {
@@ -146,22 +296,16 @@ SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc,
         mat->SetParam("base_color", DEFAULT_BASE_COLOR);
     }
 
-    aiString normal_tex_path;
-    if (ai_material->GetTexture(aiTextureType_NORMALS, 0, &normal_tex_path) == AI_SUCCESS &&
-        normal_tex_path.C_Str() != "")
+    if (GetTextureDesc(root_path, scene, cooked_material, CookedTextureSlot::Normal, TextureSpace::Linear, tex_desc))
     {
-        std::filesystem::path tex_path = root_path / std::filesystem::path(normal_tex_path.C_Str());
-        Handle<Texture> tex = gfx::resource_manager->textures.GetHandle(TextureDesc{ tex_path.string(), TextureSpace::Linear });
+        Handle<Texture> tex = gfx::resource_manager->textures.GetHandle(tex_desc);
         mat->SetTexture("tex_normal", tex);
         bound_texture_bits |= NORMAL_TEX_BIT;
     }
 
-    aiString metallic_roughness_tex_path;
-    if (ai_material->GetTexture(AI_MATKEY_GLTF_PBRMETALLICROUGHNESS_METALLICROUGHNESS_TEXTURE, &metallic_roughness_tex_path) == AI_SUCCESS &&
-        metallic_roughness_tex_path.C_Str() != "")
+    if (GetTextureDesc(root_path, scene, cooked_material, CookedTextureSlot::MetallicRoughness, TextureSpace::Linear, tex_desc))
     {
-        std::filesystem::path tex_path = root_path / std::filesystem::path(metallic_roughness_tex_path.C_Str());
-        Handle<Texture> tex = gfx::resource_manager->textures.GetHandle(TextureDesc{ tex_path.string(), TextureSpace::Linear });
+        Handle<Texture> tex = gfx::resource_manager->textures.GetHandle(tex_desc);
         mat->SetTexture("tex_metallic_roughness", tex);
         bound_texture_bits |= METALLIC_ROUGHNESS_TEX_BIT;
     }
@@ -175,74 +319,35 @@ SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc,
 
     model->materials_.push_back(mat_handle);
 
-    // Geometry
-    uint32 num_mesh_indices = 0;
-    for (uint32 i = 0; i < ai_mesh->mNumFaces; ++i)
-    {
-        const aiFace& face = ai_mesh->mFaces[i];
-        if(face.mNumIndices != 3)
-        {
-            LOG_WARN("Incomplete triangle in mesh: {}", ai_mesh->mName.C_Str());
-        }
-
-        vertex_data.indices.push_back(num_model_vertices + face.mIndices[0]);
-        vertex_data.indices.push_back(num_model_vertices + face.mIndices[1]);
-        vertex_data.indices.push_back(num_model_vertices + face.mIndices[2]);
-        num_mesh_indices += 3;
-    }
-    num_model_indices += num_mesh_indices;
-
-    for (uint32 vertex_id = 0; vertex_id < ai_mesh->mNumVertices; ++vertex_id)
-    {
-        const aiVector3D& vertex = ai_mesh->mVertices[vertex_id];
-        vertex_data.pos.push_back({ vertex.x, vertex.y, vertex.z });
-
-        const aiVector3D& normal = ai_mesh->HasNormals() ? ai_mesh->mNormals[vertex_id] : aiVector3D(0.0f, 0.0f, 0.0f);
-        vertex_data.normals.push_back({ normal.x, normal.y, normal.z });
-
-        const aiVector3D& uv = ai_mesh->HasTextureCoords(0) ? ai_mesh->mTextureCoords[0][vertex_id] : aiVector3D(0.0f, 0.0f, 0.0f);
-        vertex_data.uvs.push_back({ uv.x, uv.y });
-
-        Vec3 tangent = Vec3::ZERO;
-        if(ai_mesh->HasTangentsAndBitangents())
-        {
-            const aiVector3D& ai_tangent = ai_mesh->mTangents[vertex_id];
-            const aiVector3D& ai_bitangent = ai_mesh->mBitangents[vertex_id];
-            tangent = { ai_tangent.x, ai_tangent.y, ai_tangent.z };
-            Vec3 bitangent = { ai_bitangent.x, ai_bitangent.y, ai_bitangent.z };
-            
-            // Some models have mirrored UVs -> We have to fix the tangent
-            if (Vec3::Dot(Vec3::Cross({ normal.x, normal.y, normal.z }, tangent), bitangent) < 0.0f)
-            {
-                tangent = tangent * -1.0;
-            }
-        } 
-
-        vertex_data.tangents.push_back({ tangent.x, tangent.y, tangent.z });
-
-        num_model_vertices++;
-    }
-
     StaticMesh mesh;
-    mesh.start_idx = num_model_indices - num_mesh_indices;
-    mesh.offset = 0;
-    mesh.num_indices = num_mesh_indices;
+    mesh.start_idx = cooked_mesh.first_index;
+    mesh.offset = cooked_mesh.first_vertex;     // Base vertex, the cooked indices are relative to it
+    mesh.num_indices = cooked_mesh.num_indices;
     mesh.material_slot = (uint32) (model->materials_.size() - 1);
+    mesh.vertex_format = scene_desc.vertex_format;
+    mesh.bounds = Box(cooked_mesh.bounds_min[0], cooked_mesh.bounds_max[0], cooked_mesh.bounds_min[1], cooked_mesh.bounds_max[1],
+        cooked_mesh.bounds_min[2], cooked_mesh.bounds_max[2]);
+    mesh.clusters = std::span(*geometry.clusters).subspan(cooked_mesh.first_cluster, cooked_mesh.num_clusters);
     mesh.model = model.get();
     model->meshes_.push_back(mesh);
 
-    D3D11_BUFFER_DESC cbuffer_desc = {};
-    cbuffer_desc.Usage = D3D11_USAGE_DEFAULT;   // Read / Write access
-    cbuffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    cbuffer_desc.ByteWidth = sizeof(CBufferPerObject);
-    cbuffer_desc.CPUAccessFlags = 0;
-    DX11_VERIFY(gfx::device->CreateBuffer(&cbuffer_desc, nullptr, &model->cbuffer_per_object));
-
-    model->index_buffer = MakeShared<IndexBuffer>(vertex_data.indices.data(), (uint32) vertex_data.indices.size());
-    model->pos = MakeShared<VertexBuffer>(vertex_data.pos.data(), (uint32) vertex_data.pos.size(), sizeof(Vec3), VertexBufferSlots::POS);
-    model->normals = MakeShared<VertexBuffer>(vertex_data.normals.data(), (uint32) vertex_data.normals.size(), sizeof(Vec3), VertexBufferSlots::NORMALS);
-    model->tangents = MakeShared<VertexBuffer>(vertex_data.tangents.data(), (uint32) vertex_data.tangents.size(), sizeof(Vec3), VertexBufferSlots::TANGENTS);
-    model->uv = MakeShared<VertexBuffer>(vertex_data.uvs.data(), (uint32) vertex_data.uvs.size(), sizeof(Vec2), VertexBufferSlots::TEX_COORD);
+    GpuBufferDesc cbuffer_desc = {};
+    cbuffer_desc.size = sizeof(CBufferPerObject);
+    cbuffer_desc.usage = GpuUsage::Default;   // Read / Write access
+    cbuffer_desc.bind_flags = GpuBind::ConstantBuffer;
+    model->cbuffer_per_object = gfx::backend->CreateBuffer(cbuffer_desc);
+
+    model->index_buffer = cooked_mesh.index_size == sizeof(uint16) ? geometry.indices16 : geometry.indices32;
+    model->pos = geometry.pos;
+    model->normals = geometry.normals;
+    model->tangents = geometry.tangents;
+    model->uv = geometry.uv;
+    model->attributes = geometry.attributes;
+    model->clusters = geometry.clusters;
+    if (geometry.position_dequantizations.empty() == false)
+    {
+        model->position_dequantization = geometry.position_dequantizations[mesh_idx];
+    }
 
     for (StaticMesh& mesh : model->meshes_)
     {
@@ -251,6 +356,23 @@ SharedPtr<Model> SceneImporter::ProcessMesh(const SceneDescription& scene_desc,
         mesh.normals = model->normals;
         mesh.tangents = model->tangents;
         mesh.uv = model->uv;
+        mesh.attributes = model->attributes;
+    }
+
+    // Coarser levels share the buffers, material and bounds, only their index range and clusters differ
+    StaticMesh& full_detail_mesh = model->meshes_.back();
+    full_detail_mesh.first_lod = (uint32) model->lod_meshes_.size();
+    full_detail_mesh.num_lods = cooked_mesh.num_lods;
+    for (const CookedMeshLod& cooked_lod : scene.GetMeshLods().subspan(cooked_mesh.first_lod, cooked_mesh.num_lods))
+    {
+        StaticMesh& lod_mesh = model->lod_meshes_.emplace_back(full_detail_mesh);
+        lod_mesh.start_idx = cooked_lod.first_index;
+        lod_mesh.num_indices = cooked_lod.num_indices;
+        lod_mesh.clusters = std::span(*geometry.clusters).subspan(cooked_lod.first_cluster, cooked_lod.num_clusters);
+        lod_mesh.lod = (uint32) model->lod_meshes_.size() - full_detail_mesh.first_lod;
+        lod_mesh.lod_error = cooked_lod.error;
+        lod_mesh.first_lod = 0;
+        lod_mesh.num_lods = 0;
     }
 
     return model;
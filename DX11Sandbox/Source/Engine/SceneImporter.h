@@ -1,24 +1,47 @@
 #pragma once
-#include "Engine/Entity.h"
+#include "Engine/CookedScene.h"
 #include "Engine/World.h"
 #include "Renderer/Mesh.h"
+#include "Renderer/Texture.h"
 
 struct SceneDescription
 {
     String path;
     Transform import_correction_transform;
+    bool stream_textures = false;   // Textures start with their mip tail, see TextureStreamer
+    bool compress_textures = false; // Block compressed and cached next to the images, see CookedTexture
+    VertexFormat vertex_format = VertexFormat::Float;   // The packed formats need shaders with PACKED_ATTRIBUTES and QUANTIZED_POSITIONS variants
 };
 
-struct aiScene;
-struct aiNode;
-
 class SceneImporter
 {
 public:
-    static SharedPtr<Entity> ImportScene(const SceneDescription& scene_desc, World& world);
+    // Returns the root entity of the scene
+    static EntityId ImportScene(const SceneDescription& scene_desc, World& world);
 
 private:
+    // Shared by all meshes of a scene, meshes select their range with start_idx and the base vertex
+    struct SceneGeometry
+    {
+        SharedPtr<IndexBuffer> indices16;   // Meshes with at most IndexBuffer::MAX_UINT16_VERTICES vertices
+        SharedPtr<IndexBuffer> indices32;
+        SharedPtr<VertexBuffer> pos;
+        SharedPtr<VertexBuffer> normals;
+        SharedPtr<VertexBuffer> tangents;
+        SharedPtr<VertexBuffer> uv;
+        SharedPtr<VertexBuffer> attributes;         // Instead of normals, tangents and uv for the packed vertex formats
+        std::vector<Mat4> position_dequantizations; // Per mesh, only for quantized positions
+        SharedPtr<const std::vector<MeshCluster>> clusters; // Copied out of the cooked scene, which is unmapped after the import
+    };
+
+    // Unique textures referenced by the scene's materials which are not cached yet
+    static std::vector<TextureDesc> GatherTextures(const SceneDescription& scene_desc, const CookedScene& scene);
+    static bool GetTextureDesc(const std::filesystem::path& root_path, const CookedScene& scene, const CookedMaterial& material,
+        CookedTextureSlot slot, TextureSpace texture_space, TextureDesc& out_desc);
 
-    static SharedPtr<Entity> ProcessNode(const SceneDescription& scene_desc, const aiScene* scene, aiNode* node, Entity* parent, World& world);
-    static SharedPtr<Model> ProcessMesh(const SceneDescription& scene_desc, const aiScene* scene, aiNode* node, uint32 mesh_idx);
+    static EntityId ProcessNode(const SceneDescription& scene_desc, const CookedScene& scene, const CookedNode& node,
+        EntityId parent, World& world);
+    static SceneGeometry CreateGeometry(const SceneDescription& scene_desc, const CookedScene& scene);
+    static SharedPtr<Model> ProcessMesh(const SceneDescription& scene_desc, const CookedScene& scene, const SceneGeometry& geometry,
+        uint32 mesh_idx);
 };
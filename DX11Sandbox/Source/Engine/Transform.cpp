@@ -6,9 +6,56 @@ Transform::Transform()
 
 Transform::Transform(const Vec3& scaling, const Quat& rotation, const Vec3& translation)
 {
-    SetWorldScaling(scaling);
-    SetWorldRotation(rotation);
-    SetWorldTranslation(translation);
+    SetWorldTransform(scaling, rotation, translation);
+}
+
+Transform::Transform(const Transform& other)
+{
+    CopyValues(other);
+
+    // Without parent local and world are the same
+    if (other.parent_ != nullptr)
+    {
+        scaling_local_ = scaling_world_;
+        rotation_local_ = rotation_world_;
+        translation_local_ = translation_world_;
+        matrix_local_ = matrix_world_;
+    }
+}
+
+Transform& Transform::operator=(const Transform& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    if (parent_ == nullptr && children_.empty())
+    {
+        return *this = Transform(other);
+    }
+
+    CopyValues(other);
+    SetDirty();
+    OnChanged();
+    return *this;
+}
+
+Transform::Transform(Transform&& other) noexcept
+{
+    CopyValues(other);
+    TakeLinks(other);
+}
+
+Transform& Transform::operator=(Transform&& other) noexcept
+{
+    if (this != &other)
+    {
+        Unlink();
+        CopyValues(other);
+        TakeLinks(other);
+    }
+    return *this;
 }
 
 Transform Transform::operator*(const Transform& other) const
@@ -25,6 +72,7 @@ Transform Transform::operator*(const Transform& other) const
 
 Transform& Transform::operator*=(const Transform& other)
 {
+    Decompose();
     matrix_world_ *= other.GetWorldMatrix();
 
     SetDirty();
@@ -39,9 +87,18 @@ void Transform::SetFromMatrix(const Mat4& matrix)
     Quat rotation;
     Vec3 translation;
     matrix.Decompose(scaling, rotation, translation);
-    SetWorldScaling(scaling);
-    SetWorldRotation(rotation);
-    SetWorldTranslation(translation);
+    SetWorldTransform(scaling, rotation, translation);
+}
+
+void Transform::SetWorldMatrix(const Mat4& matrix)
+{
+    CHECK(parent_ == nullptr && children_.empty());
+
+    // Renderers only need the matrix each frame, the decomposition waits for the first getter or setter which needs it
+    matrix_world_ = matrix;
+    matrix_local_ = matrix;
+    is_decomposed_ = false;
+    is_dirty_ = false;
 }
 
 void Transform::SetWorldTransform(const Transform& t)
@@ -51,25 +108,22 @@ void Transform::SetWorldTransform(const Transform& t)
 
 void Transform::SetWorldTransform(const Vec3& scaling, const Quat& rotation, const Vec3& translation)
 {
-    if (scaling_world_ != scaling)
-    {
-        scaling_world_ = scaling;
-        SetDirty();
-    }
+    Decompose();
 
-    if (rotation_world_ != rotation)
-    {
-        rotation_world_ = rotation;
-        SetDirty();
-    }
+    // Convert all three into the parent's space first, so the subtree is only recomputed once
+    scaling_world_ = scaling;
+    rotation_world_ = rotation;
+    translation_world_ = translation;
 
-    if (translation_world_ != translation)
+    if (parent_ == nullptr)
     {
-        translation_world_ = translation;
-        SetDirty();
+        SetLocalTransform(scaling, rotation, translation);
+        return;
     }
 
-    RecalculateTransform();
+    ResolveAncestors();
+    SetLocalTransform(scaling / parent_->GetWorldScaling(), rotation * parent_->GetWorldRotation().Inverse(),
+        translation * parent_->GetWorldMatrix().Invert());
 }
 
 void Transform::SetLocalTransform(const Transform& t)
@@ -79,6 +133,7 @@ void Transform::SetLocalTransform(const Transform& t)
 
 void Transform::SetLocalTransform(const Vec3& scaling, const Quat& rotation, const Vec3& translation)
 {
+    Decompose();
     if (scaling_local_ != scaling)
     {
         scaling_local_ = scaling;
@@ -96,22 +151,24 @@ void Transform::SetLocalTransform(const Vec3& scaling, const Quat& rotation, con
         translation_local_ = translation;
         SetDirty();
     }
-    
-    RecalculateTransform();
+
+    OnChanged();
 }
 
 void Transform::SetLocalScaling(const Vec3& scaling)
 {
+    Decompose();
     if (scaling_local_ != scaling)
     {
         scaling_local_ = scaling;
         SetDirty();
-        RecalculateTransform();
+        OnChanged();
     }
 }
 
 void Transform::SetWorldScaling(const Vec3& scaling)
 {
+    Decompose();
     if (scaling_world_ != scaling)
     {
         scaling_world_ = scaling;
@@ -123,6 +180,7 @@ void Transform::SetWorldScaling(const Vec3& scaling)
         }
         else
         {
+            ResolveAncestors();
             SetLocalScaling(scaling / parent_->GetWorldScaling());
         }
     }
@@ -130,16 +188,18 @@ void Transform::SetWorldScaling(const Vec3& scaling)
 
 void Transform::SetLocalRotation(const Quat& rotation)
 {
+    Decompose();
     if (rotation_local_ != rotation)
     {
         rotation_local_ = rotation;
         SetDirty();
-        RecalculateTransform();
+        OnChanged();
     }
 }
 
 void Transform::SetWorldRotation(const Quat& rotation)
 {
+    Decompose();
     if (rotation_world_ != rotation)
     {
         rotation_world_ = rotation;
@@ -151,6 +211,7 @@ void Transform::SetWorldRotation(const Quat& rotation)
         }
         else
         {
+            ResolveAncestors();
             SetLocalRotation(rotation * parent_->GetWorldRotation().Inverse());
         }
     }
@@ -158,16 +219,18 @@ void Transform::SetWorldRotation(const Quat& rotation)
 
 void Transform::SetLocalTranslation(const Vec3& translation)
 {
+    Decompose();
     if (translation_local_ != translation)
     {
         translation_local_ = translation;
         SetDirty();
-        RecalculateTransform();
+        OnChanged();
     }
 }
 
 void Transform::SetWorldTranslation(const Vec3& translation)
 {
+    Decompose();
     if (translation_world_ != translation)
     {
         translation_world_ = translation;
@@ -179,6 +242,7 @@ void Transform::SetWorldTranslation(const Vec3& translation)
         }
         else
         {
+            ResolveAncestors();
             SetLocalTranslation(translation * parent_->GetWorldMatrix().Invert());
         }
     }
@@ -186,16 +250,19 @@ void Transform::SetWorldTranslation(const Vec3& translation)
 
 Vec3 Transform::GetLocalScaling() const
 {
+    Decompose();
     return scaling_local_;
 }
 
 Quat Transform::GetLocalRotation() const
 {
+    Decompose();
     return rotation_local_;
 }
 
 Vec3 Transform::GetLocalTranslation() const
 {
+    Decompose();
     return translation_local_;
 }
 
@@ -206,16 +273,19 @@ Mat4 Transform::GetLocalMatrix() const
 
 Vec3 Transform::GetWorldScaling() const
 {
+    Decompose();
     return scaling_world_;
 }
 
 Quat Transform::GetWorldRotation() const
 {
+    Decompose();
     return rotation_world_;
 }
 
 Vec3 Transform::GetWorldTranslation() const
 {
+    Decompose();
     return translation_world_;
 }
 
@@ -224,18 +294,118 @@ Mat4 Transform::GetWorldMatrix() const
     return matrix_world_;
 }
 
+void Transform::Decompose() const
+{
+    if (is_decomposed_)
+    {
+        return;
+    }
+
+    // Only SetWorldMatrix() skips it, which requires a transform without parent. Local and world are the same.
+    matrix_world_.Decompose(scaling_world_, rotation_world_, translation_world_);
+    scaling_local_ = scaling_world_;
+    rotation_local_ = rotation_world_;
+    translation_local_ = translation_world_;
+    is_decomposed_ = true;
+}
+
+void Transform::CopyValues(const Transform& other)
+{
+    scaling_world_ = other.scaling_world_;
+    rotation_world_ = other.rotation_world_;
+    translation_world_ = other.translation_world_;
+    matrix_world_ = other.matrix_world_;
+    translation_local_ = other.translation_local_;
+    scaling_local_ = other.scaling_local_;
+    rotation_local_ = other.rotation_local_;
+    matrix_local_ = other.matrix_local_;
+    is_decomposed_ = other.is_decomposed_;
+    is_dirty_ = other.is_dirty_;
+    update_mode_ = other.update_mode_;
+}
+
+void Transform::Unlink()
+{
+    if (parent_ != nullptr)
+    {
+        std::erase(parent_->children_, this);
+        parent_ = nullptr;
+    }
+
+    for (Transform* child : children_)
+    {
+        child->parent_ = nullptr;
+        child->SetDirty();
+        child->OnChanged();
+    }
+    children_.clear();
+}
+
+void Transform::TakeLinks(Transform& other)
+{
+    parent_ = other.parent_;
+    children_ = std::move(other.children_);
+
+    // Patch the links which still point to the old address
+    if (parent_ != nullptr)
+    {
+        std::replace(parent_->children_.begin(), parent_->children_.end(), &other, this);
+    }
+
+    for (Transform* child : children_)
+    {
+        child->parent_ = this;
+    }
+
+    other.parent_ = nullptr;
+    other.children_.clear();
+}
+
+void Transform::SetUpdateMode(TransformUpdateMode mode)
+{
+    update_mode_ = mode;
+    OnChanged();
+}
+
 void Transform::SetDirty()
 {
     is_dirty_ = true;
 }
 
-void Transform::RecalculateTransform()
+void Transform::OnChanged()
+{
+    if (update_mode_ == TransformUpdateMode::Immediate)
+    {
+        RecalculateTransform();
+    }
+}
+
+void Transform::ResolveAncestors()
+{
+    Transform* top_dirty = nullptr;
+    for (Transform* ancestor = parent_; ancestor != nullptr; ancestor = ancestor->parent_)
+    {
+        if (ancestor->is_dirty_)
+        {
+            top_dirty = ancestor;
+        }
+    }
+
+    if (top_dirty != nullptr)
+    {
+        top_dirty->RecalculateTransform();
+    }
+}
+
+uint32 Transform::RecalculateTransform()
 {
     if (is_dirty_ == false)
     {
-        return;
+        return 0;
     }
 
+    Decompose();
+
     // First recalculate this transform
     matrix_local_ = Mat4::SRT(scaling_local_, rotation_local_, translation_local_);
     matrix_world_ = matrix_local_;
@@ -248,20 +418,38 @@ void Transform::RecalculateTransform()
     matrix_world_.Decompose(scaling_world_, rotation_world_, translation_world_);
 
     // Then its children
+    uint32 num_recalculated = 1;
     for(Transform* t : children_)
     {
         t->SetDirty();
-        t->RecalculateTransform();
+        num_recalculated += t->RecalculateTransform();
     }
 
     is_dirty_ = false;
+    return num_recalculated;
+}
+
+uint32 Transform::Flush()
+{
+    if (is_dirty_)
+    {
+        return RecalculateTransform();
+    }
+
+    // Clean transforms may still have dirty descendants
+    uint32 num_recalculated = 0;
+    for (Transform* t : children_)
+    {
+        num_recalculated += t->Flush();
+    }
+    return num_recalculated;
 }
 
 void Transform::SetParent(Transform* t)
 {
     CHECK(t != this);
 
-    if(parent_ != nullptr)
+    if(parent_ != nullptr && t != nullptr)
     {
         // TODO: Remove from previous parent
         CHECK_NO_ENTRY();
@@ -270,7 +458,7 @@ void Transform::SetParent(Transform* t)
     parent_ = t;
 
     SetDirty();
-    RecalculateTransform();
+    OnChanged();
 }
 
 void Transform::AddChild(Transform* t)
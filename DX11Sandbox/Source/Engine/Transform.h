@@ -1,5 +1,11 @@
 #pragma once
 
+enum class TransformUpdateMode : uint8
+{
+    Immediate,  // Setters recompute the transform and its children right away
+    Deferred    // Setters only mark dirty, Flush() on the root recomputes all dirty subtrees at once
+};
+
 /**
  * Transform consisting of scale, rotation (quaternion) and translation.
  */
@@ -9,12 +15,25 @@ public:
     Transform();
     Transform(const Vec3& scaling, const Quat& rotation, const Vec3& translation);
 
+    // Copies are detached and keep the world transform of the other one. Assigning to a transform with parent or children keeps
+    // its place in the hierarchy and takes over the local transform instead.
+    Transform(const Transform& other);
+    Transform& operator=(const Transform& other);
+
+    // Takes over the hierarchy links of the other transform, e.g. when a container relocates it
+    Transform(Transform&& other) noexcept;
+    Transform& operator=(Transform&& other) noexcept;
+
     Transform operator*(const Transform& other) const;
     Transform& operator*=(const Transform& other);
 
     Transform Multiply(const Transform& other) const;
 
     void SetFromMatrix(const Mat4& matrix);
+
+    // Takes over a world matrix computed elsewhere, e.g. by a TransformHierarchy. Only for transforms without parent and children.
+    // Only stores the matrix, scaling, rotation and translation are decomposed from it when they are needed.
+    void SetWorldMatrix(const Mat4& matrix);
     void SetWorldTransform(const Transform& t);
     void SetWorldTransform(const Vec3& scaling, const Quat& rotation, const Vec3& translation);
     void SetLocalTransform(const Transform& t);
@@ -39,30 +58,58 @@ public:
     Vec3 GetWorldTranslation() const;
     Mat4 GetWorldMatrix() const;
 
+    // In deferred mode the world values are only valid after the next Flush()
+    void SetUpdateMode(TransformUpdateMode mode);
+    TransformUpdateMode GetUpdateMode() const { return update_mode_; }
+
     void SetDirty();
-    void RecalculateTransform();
+    bool IsDirty() const { return is_dirty_; }
+
+    // Both return the number of recomputed transforms
+    uint32 RecalculateTransform();
+    uint32 Flush();
 
     void SetParent(Transform* t);
     void AddChild(Transform* t);
     void RemoveChild(Transform* t);
+    Transform* GetParent() const { return parent_; }
 
     Vec4 GetWorldForward()
     {
-        return Vec4::Transform(Vec4::FORWARD, rotation_world_);
+        return Vec4::Transform(Vec4::FORWARD, GetWorldRotation());
     }
 
 private:
-    Vec3 scaling_world_ = Vec3(1.0f);
-    Quat rotation_world_ = Quat::IDENTITY;
-    Vec3 translation_world_ = Vec3::ZERO;
+    // Everything except the hierarchy links
+    void CopyValues(const Transform& other);
+
+    // Leaves the parent and orphans the children
+    void Unlink();
+    void TakeLinks(Transform& other);
+
+    // Recomputes right away in immediate mode
+    void OnChanged();
+
+    // World setters need the parent's world values, which may be dirty in deferred mode
+    void ResolveAncestors();
+
+    // Catches up on the decomposition skipped by SetWorldMatrix()
+    void Decompose() const;
+
+    // Mutable, the getters decompose them on demand after SetWorldMatrix()
+    mutable Vec3 scaling_world_ = Vec3(1.0f);
+    mutable Quat rotation_world_ = Quat::IDENTITY;
+    mutable Vec3 translation_world_ = Vec3::ZERO;
     Mat4 matrix_world_ = Mat4::IDENTITY;
 
-    Vec3 translation_local_ = Vec3::ZERO;
-    Vec3 scaling_local_ = Vec3(1.0f);
-    Quat rotation_local_ = Quat::IDENTITY;
+    mutable Vec3 translation_local_ = Vec3::ZERO;
+    mutable Vec3 scaling_local_ = Vec3(1.0f);
+    mutable Quat rotation_local_ = Quat::IDENTITY;
     Mat4 matrix_local_ = Mat4::IDENTITY;
+    mutable bool is_decomposed_ = true;
 
     bool is_dirty_ = true;
+    TransformUpdateMode update_mode_ = TransformUpdateMode::Immediate;
 
     Transform* parent_ = nullptr;
     std::vector<Transform*> children_;
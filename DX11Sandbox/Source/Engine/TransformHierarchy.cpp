@@ -0,0 +1,406 @@
+#include "Engine/TransformHierarchy.h"
+
+#include <numeric>
+
+using namespace DirectX;
+
+TransformId TransformHierarchy::Create()
+{
+    TransformId id;
+    if (free_ids_.empty() == false)
+    {
+        id.value = free_ids_.back();
+        free_ids_.pop_back();
+    }
+    else
+    {
+        id.value = (uint32) id_to_index_.size();
+        id_to_index_.push_back(0);
+    }
+
+    // New nodes are roots, so appending them never breaks the order
+    const uint32 idx = (uint32) parents_.size();
+    parents_.push_back(NO_PARENT);
+    local_scalings_.push_back(Vec3::ONE);
+    local_rotations_.push_back(Quat::IDENTITY);
+    local_translations_.push_back(Vec3::ZERO);
+    world_matrices_.push_back(Mat4::IDENTITY);
+    index_to_id_.push_back(id.value);
+    id_to_index_[id.value] = idx;
+
+    if (idx % 64 == 0)
+    {
+        dirty_bits_.push_back(0);
+    }
+
+    return id;
+}
+
+void TransformHierarchy::Destroy(TransformId id)
+{
+    if (IsValid(id) == false)
+    {
+        return;
+    }
+
+    const uint32 idx = GetIndex(id);
+    const uint32 num_nodes = GetNumNodes();
+
+    // Nodes behind idx shift one slot to the front. Erasing keeps the relative order, so parents still come first.
+    std::vector<uint32> orphans;
+    for (uint32 i = idx + 1; i < num_nodes; ++i)
+    {
+        SetDirtyBit(i - 1, IsDirty(i));
+
+        if (parents_[i] == (int32) idx)
+        {
+            parents_[i] = NO_PARENT;
+            orphans.push_back(i - 1);
+        }
+        else if (parents_[i] > (int32) idx)
+        {
+            --parents_[i];
+        }
+        --id_to_index_[index_to_id_[i]];
+    }
+    SetDirtyBit(num_nodes - 1, false);
+
+    parents_.erase(parents_.begin() + idx);
+    local_scalings_.erase(local_scalings_.begin() + idx);
+    local_rotations_.erase(local_rotations_.begin() + idx);
+    local_translations_.erase(local_translations_.begin() + idx);
+    world_matrices_.erase(world_matrices_.begin() + idx);
+    index_to_id_.erase(index_to_id_.begin() + idx);
+    if ((num_nodes - 1) % 64 == 0)
+    {
+        dirty_bits_.pop_back();
+    }
+
+    id_to_index_[id.value] = TransformId::INVALID;
+    free_ids_.push_back(id.value);
+
+    if (first_dirty_ > idx)
+    {
+        --first_dirty_;
+    }
+
+    // Former children are roots now, so their world matrices change
+    for (uint32 orphan_idx : orphans)
+    {
+        MarkDirty(orphan_idx);
+    }
+}
+
+bool TransformHierarchy::IsValid(TransformId id) const
+{
+    return id.value < id_to_index_.size() && id_to_index_[id.value] != TransformId::INVALID;
+}
+
+void TransformHierarchy::SetParent(TransformId id, TransformId parent)
+{
+    const uint32 idx = GetIndex(id);
+    const int32 parent_idx = parent.IsValid() ? (int32) GetIndex(parent) : NO_PARENT;
+
+    for (int32 ancestor = parent_idx; ancestor != NO_PARENT; ancestor = parents_[ancestor])
+    {
+        CHECK_MSG(ancestor != (int32) idx, "Transform can't be parented to its own descendant");
+    }
+
+    parents_[idx] = parent_idx;
+    MarkDirty(idx);
+
+    if (parent_idx > (int32) idx)
+    {
+        SortByDepth();
+    }
+}
+
+TransformId TransformHierarchy::GetParent(TransformId id) const
+{
+    const int32 parent_idx = parents_[GetIndex(id)];
+    return parent_idx != NO_PARENT ? TransformId{ .value = index_to_id_[parent_idx] } : TransformId();
+}
+
+void TransformHierarchy::SetLocalTransform(TransformId id, const Vec3& scaling, const Quat& rotation, const Vec3& translation)
+{
+    const uint32 idx = GetIndex(id);
+    local_scalings_[idx] = scaling;
+    local_rotations_[idx] = rotation;
+    local_translations_[idx] = translation;
+    MarkDirty(idx);
+}
+
+void TransformHierarchy::SetLocalScaling(TransformId id, const Vec3& scaling)
+{
+    const uint32 idx = GetIndex(id);
+    local_scalings_[idx] = scaling;
+    MarkDirty(idx);
+}
+
+void TransformHierarchy::SetLocalRotation(TransformId id, const Quat& rotation)
+{
+    const uint32 idx = GetIndex(id);
+    local_rotations_[idx] = rotation;
+    MarkDirty(idx);
+}
+
+void TransformHierarchy::SetLocalTranslation(TransformId id, const Vec3& translation)
+{
+    const uint32 idx = GetIndex(id);
+    local_translations_[idx] = translation;
+    MarkDirty(idx);
+}
+
+Vec3 TransformHierarchy::GetLocalScaling(TransformId id) const
+{
+    return local_scalings_[GetIndex(id)];
+}
+
+Quat TransformHierarchy::GetLocalRotation(TransformId id) const
+{
+    return local_rotations_[GetIndex(id)];
+}
+
+Vec3 TransformHierarchy::GetLocalTranslation(TransformId id) const
+{
+    return local_translations_[GetIndex(id)];
+}
+
+void TransformHierarchy::SetWorldScaling(TransformId id, const Vec3& scaling)
+{
+    const TransformId parent = GetParent(id);
+    if (parent.IsValid() == false)
+    {
+        SetLocalScaling(id, scaling);
+        return;
+    }
+
+    const Vec3 parent_scaling = GetWorldScaling(parent);
+    Vec3 local_scaling;
+    XMStoreFloat3(&local_scaling, XMVectorDivide(XMLoadFloat3(&scaling), XMLoadFloat3(&parent_scaling)));
+    SetLocalScaling(id, local_scaling);
+}
+
+void TransformHierarchy::SetWorldRotation(TransformId id, const Quat& rotation)
+{
+    const TransformId parent = GetParent(id);
+    if (parent.IsValid() == false)
+    {
+        SetLocalRotation(id, rotation);
+        return;
+    }
+
+    SetLocalRotation(id, rotation * GetWorldRotation(parent).Inverse());
+}
+
+void TransformHierarchy::SetWorldTranslation(TransformId id, const Vec3& translation)
+{
+    const TransformId parent = GetParent(id);
+    if (parent.IsValid() == false)
+    {
+        SetLocalTranslation(id, translation);
+        return;
+    }
+
+    SetLocalTranslation(id, translation * GetWorldMatrix(parent).Invert());
+}
+
+Mat4 TransformHierarchy::GetWorldMatrix(TransformId id) const
+{
+    return ComputeWorldMatrix(GetIndex(id));
+}
+
+Vec3 TransformHierarchy::GetWorldTranslation(TransformId id) const
+{
+    const uint32 idx = GetIndex(id);
+    if (has_dirty_ == false)
+    {
+        const Mat4& world = world_matrices_[idx];
+        return Vec3(world._41, world._42, world._43);
+    }
+
+    Vec3 translation;
+    XMStoreFloat3(&translation, ComputeWorldMatrix(idx).r[3]);
+    return translation;
+}
+
+Vec3 TransformHierarchy::GetWorldScaling(TransformId id) const
+{
+    Vec3 scaling;
+    Quat rotation;
+    Vec3 translation;
+    GetWorldMatrix(id).Decompose(scaling, rotation, translation);
+    return scaling;
+}
+
+Quat TransformHierarchy::GetWorldRotation(TransformId id) const
+{
+    Vec3 scaling;
+    Quat rotation;
+    Vec3 translation;
+    GetWorldMatrix(id).Decompose(scaling, rotation, translation);
+    return rotation;
+}
+
+Vec4 TransformHierarchy::GetWorldForward(TransformId id) const
+{
+    // Row vectors: The local forward axis ends up in the third row, scaled by the world scaling
+    return Vec4(XMVector3Normalize(ComputeWorldMatrix(GetIndex(id)).r[2]));
+}
+
+uint32 TransformHierarchy::Update()
+{
+    if (has_dirty_ == false)
+    {
+        return 0;
+    }
+
+    const uint32 num_nodes = GetNumNodes();
+    uint32 num_updated = 0;
+
+    for (uint32 idx = first_dirty_; idx < num_nodes; ++idx)
+    {
+        // Dirtiness flows down: Parents were visited first, so their bit already includes their ancestors
+        const int32 parent_idx = parents_[idx];
+        if (IsDirty(idx) == false)
+        {
+            if (parent_idx == NO_PARENT || IsDirty(parent_idx) == false)
+            {
+                continue;
+            }
+            SetDirtyBit(idx, true);
+        }
+
+        XMMATRIX world = ComputeLocalMatrix(idx);
+        if (parent_idx != NO_PARENT)
+        {
+            world = XMMatrixMultiply(world, XMLoadFloat4x4(&world_matrices_[parent_idx]));
+        }
+        XMStoreFloat4x4(&world_matrices_[idx], world);
+        ++num_updated;
+    }
+
+    std::fill(dirty_bits_.begin() + first_dirty_ / 64, dirty_bits_.end(), 0);
+    first_dirty_ = num_nodes;
+    has_dirty_ = false;
+    return num_updated;
+}
+
+uint32 TransformHierarchy::GetIndex(TransformId id) const
+{
+    CHECK(IsValid(id));
+    return id_to_index_[id.value];
+}
+
+XMMATRIX TransformHierarchy::ComputeLocalMatrix(uint32 idx) const
+{
+    // Same as Mat4::SRT, without the temporaries
+    return XMMatrixAffineTransformation(XMLoadFloat3(&local_scalings_[idx]), XMVectorZero(), XMLoadFloat4(&local_rotations_[idx]),
+        XMLoadFloat3(&local_translations_[idx]));
+}
+
+XMMATRIX TransformHierarchy::ComputeWorldMatrix(uint32 idx) const
+{
+    // Everything above the topmost dirty node of the chain is up to date
+    int32 top_dirty_idx = NO_PARENT;
+    if (has_dirty_)
+    {
+        for (int32 ancestor = (int32) idx; ancestor != NO_PARENT; ancestor = parents_[ancestor])
+        {
+            if (IsDirty(ancestor))
+            {
+                top_dirty_idx = ancestor;
+            }
+        }
+    }
+
+    if (top_dirty_idx == NO_PARENT)
+    {
+        return XMLoadFloat4x4(&world_matrices_[idx]);
+    }
+
+    XMMATRIX world = ComputeLocalMatrix(idx);
+    for (int32 ancestor = (int32) idx; ancestor != top_dirty_idx; )
+    {
+        ancestor = parents_[ancestor];
+        world = XMMatrixMultiply(world, ComputeLocalMatrix(ancestor));
+    }
+
+    if (parents_[top_dirty_idx] != NO_PARENT)
+    {
+        world = XMMatrixMultiply(world, XMLoadFloat4x4(&world_matrices_[parents_[top_dirty_idx]]));
+    }
+    return world;
+}
+
+void TransformHierarchy::SetDirtyBit(uint32 idx, bool is_dirty)
+{
+    const uint64 bit = uint64(1) << (idx % 64);
+    dirty_bits_[idx / 64] = is_dirty ? (dirty_bits_[idx / 64] | bit) : (dirty_bits_[idx / 64] & ~bit);
+}
+
+void TransformHierarchy::MarkDirty(uint32 idx)
+{
+    SetDirtyBit(idx, true);
+    first_dirty_ = has_dirty_ ? std::min(first_dirty_, idx) : idx;
+    has_dirty_ = true;
+}
+
+void TransformHierarchy::SortByDepth()
+{
+    const uint32 num_nodes = GetNumNodes();
+
+    // Only the reparented subtree is out of order, so walking up the chains is fine
+    std::vector<uint32> depths(num_nodes, 0);
+    for (uint32 idx = 0; idx < num_nodes; ++idx)
+    {
+        for (int32 ancestor = parents_[idx]; ancestor != NO_PARENT; ancestor = parents_[ancestor])
+        {
+            ++depths[idx];
+        }
+    }
+
+    // Stable, so siblings and unrelated nodes keep their relative order
+    std::vector<uint32> new_to_old(num_nodes);
+    std::iota(new_to_old.begin(), new_to_old.end(), 0);
+    std::stable_sort(new_to_old.begin(), new_to_old.end(), [&depths](uint32 a, uint32 b) { return depths[a] < depths[b]; });
+
+    std::vector<uint32> old_to_new(num_nodes);
+    for (uint32 new_idx = 0; new_idx < num_nodes; ++new_idx)
+    {
+        old_to_new[new_to_old[new_idx]] = new_idx;
+    }
+
+    auto permute = [&new_to_old](auto& values)
+    {
+        std::remove_reference_t<decltype(values)> sorted;
+        sorted.reserve(values.size());
+        for (uint32 old_idx : new_to_old)
+        {
+            sorted.push_back(values[old_idx]);
+        }
+        values = std::move(sorted);
+    };
+
+    permute(parents_);
+    permute(local_scalings_);
+    permute(local_rotations_);
+    permute(local_translations_);
+    permute(world_matrices_);
+    permute(index_to_id_);
+
+    for (uint32 idx = 0; idx < num_nodes; ++idx)
+    {
+        if (parents_[idx] != NO_PARENT)
+        {
+            parents_[idx] = (int32) old_to_new[parents_[idx]];
+        }
+        id_to_index_[index_to_id_[idx]] = idx;
+    }
+
+    // Rare enough to not bother with remapping the bits
+    for (uint32 idx = 0; idx < num_nodes; ++idx)
+    {
+        MarkDirty(idx);
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+struct TransformId
+{
+    static constexpr uint32 INVALID = 0xffffffff;
+
+    bool IsValid() const { return value != INVALID; }
+    bool operator==(const TransformId& other) const = default;
+
+    uint32 value = INVALID;
+};
+
+/**
+ * Flattened transform hierarchy.
+ *
+ * Nodes are stored as parallel arrays (parent index, local scaling, rotation, translation, world matrix) and parents always
+ * come before their children. So a single linear pass over the arrays computes every local-to-world matrix, the parent
+ * matrix is always up to date when a child gets to it:
+ *
+ *     world[i] = local[i] * world[parent[i]]
+ *
+ * Setters only write the local values and set a bit in the dirty bitset, nothing gets recomputed until Update().
+ * Update() recomputes dirty nodes and their descendants, usually once per frame from World::FlushTransforms().
+ * Only world matrices are stored, world scaling and rotation get decomposed when somebody asks for them.
+ *
+ * Getters never write: For a node with a dirty ancestor they compose the chain of local matrices on the fly.
+ *
+ * Ids are stable, array indices are not: Destroy() and SetParent() may move nodes around to keep the order.
+ */
+class TransformHierarchy
+{
+public:
+    TransformHierarchy() = default;
+
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+    TransformId Create();
+
+    // Children of the destroyed node become roots and keep their local transform
+    void Destroy(TransformId id);
+    bool IsValid(TransformId id) const;
+
+    // Keeps the local transform of the node, so it moves along with the new parent. Pass an invalid id to detach.
+    void SetParent(TransformId id, TransformId parent);
+    TransformId GetParent(TransformId id) const;
+
+    void SetLocalTransform(TransformId id, const Vec3& scaling, const Quat& rotation, const Vec3& translation);
+    void SetLocalScaling(TransformId id, const Vec3& scaling);
+    void SetLocalRotation(TransformId id, const Quat& rotation);
+    void SetLocalTranslation(TransformId id, const Vec3& translation);
+
+    Vec3 GetLocalScaling(TransformId id) const;
+    Quat GetLocalRotation(TransformId id) const;
+    Vec3 GetLocalTranslation(TransformId id) const;
+
+    // World setters convert into the parent's space
+    void SetWorldScaling(TransformId id, const Vec3& scaling);
+    void SetWorldRotation(TransformId id, const Quat& rotation);
+    void SetWorldTranslation(TransformId id, const Vec3& translation);
+
+    // Up to date even if the hierarchy is dirty, but cheapest right after Update()
+    Mat4 GetWorldMatrix(TransformId id) const;
+    Vec3 GetWorldTranslation(TransformId id) const;
+    Vec3 GetWorldScaling(TransformId id) const;
+    Quat GetWorldRotation(TransformId id) const;
+    Vec4 GetWorldForward(TransformId id) const;
+
+    // Recomputes the world matrices of all dirty nodes and their descendants in one pass. Returns the number of recomputed nodes.
+    uint32 Update();
+    bool IsDirty() const { return has_dirty_; }
+
+    uint32 GetNumNodes() const { return (uint32) parents_.size(); }
+
+private:
+    static constexpr int32 NO_PARENT = -1;
+
+    uint32 GetIndex(TransformId id) const;
+    void SetDirtyBit(uint32 idx, bool is_dirty);
+    void MarkDirty(uint32 idx);
+    bool IsDirty(uint32 idx) const { return (dirty_bits_[idx / 64] >> (idx % 64)) & 1; }
+
+    DirectX::XMMATRIX ComputeLocalMatrix(uint32 idx) const;
+
+    // Stored world matrix if it is up to date, otherwise composed from the chain of local matrices
+    DirectX::XMMATRIX ComputeWorldMatrix(uint32 idx) const;
+
+    // Restores the parent-before-child order after a reparent broke it
+    void SortByDepth();
+
+    // Per node, indexed by position in the hierarchy
+    std::vector<int32> parents_;
+    std::vector<Vec3> local_scalings_;
+    std::vector<Quat> local_rotations_;
+    std::vector<Vec3> local_translations_;
+    std::vector<Mat4> world_matrices_;
+    std::vector<uint64> dirty_bits_;
+    std::vector<uint32> index_to_id_;
+
+    // Indexed by TransformId::value
+    std::vector<uint32> id_to_index_;
+    std::vector<uint32> free_ids_;
+
+    // Everything in front of this index is clean
+    uint32 first_dirty_ = 0;
+    bool has_dirty_ = false;
+};
@@ -11,6 +11,101 @@ void World::Update()
     gfx::camera.Update();
 }
 
+void World::FlushTransforms()
+{
+    transform_stats_ = {};
+    transform_stats_.num_nodes = transforms_.GetNumNodes();
+    transform_stats_.num_recomputed = transforms_.Update();
+
+    // Children are in the list as well, but they get flushed through their root
+    for (const SharedPtr<Entity>& entity : entities_)
+    {
+        if (entity->transform_->GetParent() == nullptr)
+        {
+            transform_stats_.num_recomputed_legacy += entity->transform_->Flush();
+        }
+    }
+}
+
+EntityId World::CreateEntity(const String& name)
+{
+    const EntityId entity = registry_.Create();
+    registry_.AddComponent<NameComponent>(entity)->name_ = name;
+    registry_.AddComponent<TransformComponent>(entity, &transforms_, transforms_.Create());
+    return entity;
+}
+
+void World::DestroyEntity(EntityId entity)
+{
+    if (registry_.IsAlive(entity) == false)
+    {
+        return;
+    }
+
+    if (HierarchyComponent* hierarchy = registry_.GetComponent<HierarchyComponent>(entity))
+    {
+        // Children detach themselves from this entity's component while being destroyed
+        while (hierarchy->children_.empty() == false)
+        {
+            DestroyEntity(hierarchy->children_.back());
+            hierarchy = registry_.GetComponent<HierarchyComponent>(entity);
+        }
+
+        if (HierarchyComponent* parent_hierarchy = registry_.GetComponent<HierarchyComponent>(hierarchy->parent_))
+        {
+            std::erase(parent_hierarchy->children_, entity);
+        }
+    }
+
+    if (const TransformComponent* transform = registry_.GetComponent<TransformComponent>(entity))
+    {
+        transforms_.Destroy(transform->GetId());
+    }
+    registry_.Destroy(entity);
+}
+
+void World::AddChild(EntityId parent, EntityId child)
+{
+    CHECK(parent != child);
+    CHECK(GetParent(child).IsValid() == false);
+
+    // Adding components moves the entities, so only fetch the pointers afterwards
+    if (registry_.HasComponent<HierarchyComponent>(parent) == false)
+    {
+        registry_.AddComponent<HierarchyComponent>(parent);
+    }
+
+    if (registry_.HasComponent<HierarchyComponent>(child) == false)
+    {
+        registry_.AddComponent<HierarchyComponent>(child);
+    }
+
+    registry_.GetComponent<HierarchyComponent>(parent)->children_.push_back(child);
+    registry_.GetComponent<HierarchyComponent>(child)->parent_ = parent;
+
+    const TransformComponent* parent_transform = registry_.GetComponent<TransformComponent>(parent);
+    const TransformComponent* child_transform = registry_.GetComponent<TransformComponent>(child);
+    CHECK(parent_transform != nullptr && child_transform != nullptr);
+    transforms_.SetParent(child_transform->GetId(), parent_transform->GetId());
+}
+
+EntityId World::GetParent(EntityId entity) const
+{
+    const HierarchyComponent* hierarchy = registry_.GetComponent<HierarchyComponent>(entity);
+    return hierarchy != nullptr ? hierarchy->parent_ : EntityId();
+}
+
+EntityId World::GetChild(EntityId entity, uint32 idx) const
+{
+    const HierarchyComponent* hierarchy = registry_.GetComponent<HierarchyComponent>(entity);
+    if (hierarchy != nullptr && idx < hierarchy->children_.size())
+    {
+        return hierarchy->children_[idx];
+    }
+
+    return EntityId();
+}
+
 void World::Add(const SharedPtr<Entity>& entity)
 {
     entities_.push_back(entity);
@@ -1,7 +1,28 @@
 #pragma once
 
 #include "Engine/Entity.h"
+#include "Engine/EntityRegistry.h"
+#include "Engine/TransformHierarchy.h"
 
+struct TransformStats
+{
+    uint32 num_nodes = 0;
+    uint32 num_recomputed = 0;          // Hierarchy nodes
+    uint32 num_recomputed_legacy = 0;   // Transforms of the heap allocated entities
+};
+
+/**
+ * Owns the entities of a scene.
+ *
+ * Entities are ids into an archetype based registry and their components are stored in contiguous columns:
+ *
+ *     world.Each<TransformComponent, StaticMeshComponent>([](TransformComponent& transform, StaticMeshComponent& mesh) { ... });
+ *
+ * Transforms of all entities live in a single flattened TransformHierarchy. Setting a transform only marks it dirty,
+ * FlushTransforms() brings all of them up to date in one pass before the frame gets culled and rendered.
+ *
+ * The heap allocated Entity objects are still supported for the earlier samples.
+ */
 class World 
 {
 public:
@@ -10,10 +31,68 @@ public:
 
     void Update();
 
-    void Add(const SharedPtr<Entity>& entity);
+    // Resolves all dirty transforms. Call once per frame after gameplay code and before culling and rendering.
+    void FlushTransforms();
+    const TransformStats& GetTransformStats() const { return transform_stats_; }
+
+    // Creates an entity with a name and a transform, like the Entity class always had
+    EntityId CreateEntity(const String& name = "");
+
+    // Also destroys all children
+    void DestroyEntity(EntityId entity);
+    bool IsAlive(EntityId entity) const { return registry_.IsAlive(entity); }
+
+    // Links the transforms, so the child follows the parent
+    void AddChild(EntityId parent, EntityId child);
+    EntityId GetParent(EntityId entity) const;
+    EntityId GetChild(EntityId entity, uint32 idx) const;
+
+    template<typename T, typename... Args>
+    T* AddComponent(EntityId entity, Args&&... args)
+    {
+        return registry_.AddComponent<T>(entity, std::forward<Args>(args)...);
+    }
 
+    template<typename T>
+    void RemoveComponent(EntityId entity)
+    {
+        registry_.RemoveComponent<T>(entity);
+    }
+
+    template<typename T>
+    T* GetComponent(EntityId entity) const
+    {
+        return registry_.GetComponent<T>(entity);
+    }
+
+    template<typename T>
+    bool HasComponent(EntityId entity) const
+    {
+        return registry_.HasComponent<T>(entity);
+    }
+
+    template<typename... Ts, typename Func>
+    void Each(Func&& func)
+    {
+        registry_.Each<Ts...>(std::forward<Func>(func));
+    }
+
+    template<typename... Ts, typename Func>
+    void ParallelEach(Func&& func)
+    {
+        registry_.ParallelEach<Ts...>(std::forward<Func>(func));
+    }
+
+    const EntityRegistry& GetRegistry() const { return registry_; }
+    TransformHierarchy& GetTransforms() { return transforms_; }
+
+    // Legacy entities
+    void Add(const SharedPtr<Entity>& entity);
     const std::vector<SharedPtr<Entity>>& GetEntities() const;
 
 private:
+    TransformHierarchy transforms_;
+    TransformStats transform_stats_;
+    EntityRegistry registry_;
     std::vector<SharedPtr<Entity>> entities_;
 };
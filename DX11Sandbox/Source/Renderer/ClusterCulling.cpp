@@ -0,0 +1,160 @@
+#include "Renderer/ClusterCulling.h"
+
+#include "Renderer/Instancing.h"
+#include "Renderer/Mesh.h"
+
+namespace
+{
+    // Planes are covectors: dot(v * W, p) = dot(v, W * p), so they move into model space with the world matrix itself
+    Vec4 TransformPlaneToModelSpace(const Vec4& p, const Mat4& w)
+    {
+        return Vec4(
+            w._11 * p.x + w._12 * p.y + w._13 * p.z + w._14 * p.w,
+            w._21 * p.x + w._22 * p.y + w._23 * p.z + w._24 * p.w,
+            w._31 * p.x + w._32 * p.y + w._33 * p.z + w._34 * p.w,
+            w._41 * p.x + w._42 * p.y + w._43 * p.z + w._44 * p.w);
+    }
+
+    bool IsMirroring(const Mat4& w)
+    {
+        const float determinant = w._11 * (w._22 * w._33 - w._23 * w._32) -
+            w._12 * (w._21 * w._33 - w._23 * w._31) +
+            w._13 * (w._21 * w._32 - w._22 * w._31);
+        return determinant < 0.0f;
+    }
+
+    bool IsInsideFrustum(const MeshCluster& cluster, const Vec4 (&planes)[Frustum::NUM_PLANES])
+    {
+        for (const Vec4& plane : planes)
+        {
+            const float distance = cluster.center.x * plane.x + cluster.center.y * plane.y + cluster.center.z * plane.z + plane.w;
+            const float radius = cluster.extents.x * std::abs(plane.x) + cluster.extents.y * std::abs(plane.y) + cluster.extents.z * std::abs(plane.z);
+            if (distance + radius < 0.0f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // True if every triangle of the cluster faces away from the viewer, or towards it if cone_sign is -1.
+    // Bounding sphere variant of the cone test, so the cone doesn't need an apex. See Arseny Kapoulkine's meshoptimizer.
+    bool IsConeCulled(const MeshCluster& cluster, const Vec4& viewer, float cone_sign)
+    {
+        if (cluster.cone_cutoff >= 1.0f)
+        {
+            return false;
+        }
+
+        const Vec3 to_cluster(cluster.center.x * viewer.w - viewer.x, cluster.center.y * viewer.w - viewer.y, cluster.center.z * viewer.w - viewer.z);
+        return cone_sign * Vec3::Dot(to_cluster, cluster.cone_axis) >= cluster.cone_cutoff * to_cluster.Length() + cluster.radius * viewer.w;
+    }
+}
+
+CulledFaces GetCulledFaces(RasterizerState rasterizer_state)
+{
+    // Front faces are clockwise for all of them
+    switch (rasterizer_state)
+    {
+    case RasterizerState::CullClockwise:
+        return CulledFaces::Front;
+    case RasterizerState::CullCounterClockwise:
+    case RasterizerState::Pancaking:
+        return CulledFaces::Back;
+    default:
+        return CulledFaces::None;
+    }
+}
+
+void CullClusters(const ClusterCullView& view, std::span<const MeshCluster> clusters, std::span<const Mat4> world_matrices,
+    VisibilityBits& scratch_visibility, std::vector<ClusterRange>& out_ranges, ClusterCullStats& out_stats)
+{
+    const uint32 num_clusters = (uint32) clusters.size();
+    scratch_visibility.Reset(num_clusters);
+
+    for (const Mat4& world : world_matrices)
+    {
+        Vec4 planes[Frustum::NUM_PLANES];
+        for (uint32 p = 0; p < Frustum::NUM_PLANES; ++p)
+        {
+            planes[p] = TransformPlaneToModelSpace(view.frustum.planes[p], world);
+        }
+
+        const Vec4 viewer = view.viewer * world.Invert();
+
+        // The rasterizer decides by the winding on screen, which mirroring flips
+        CulledFaces culled_faces = view.culled_faces;
+        if (culled_faces != CulledFaces::None && IsMirroring(world))
+        {
+            culled_faces = culled_faces == CulledFaces::Back ? CulledFaces::Front : CulledFaces::Back;
+        }
+        const float cone_sign = culled_faces == CulledFaces::Back ? 1.0f : -1.0f;
+
+        for (uint32 cluster_idx = 0; cluster_idx < num_clusters; ++cluster_idx)
+        {
+            const MeshCluster& cluster = clusters[cluster_idx];
+            if (scratch_visibility.IsSet(cluster_idx) || IsInsideFrustum(cluster, planes) == false ||
+                (culled_faces != CulledFaces::None && IsConeCulled(cluster, viewer, cone_sign)))
+            {
+                continue;
+            }
+
+            scratch_visibility.Set(cluster_idx);
+        }
+    }
+
+    const size_t first_range = out_ranges.size();
+    uint64 num_indices = 0;
+    uint64 num_visible_indices = 0;
+    for (uint32 cluster_idx = 0; cluster_idx < num_clusters; ++cluster_idx)
+    {
+        const MeshCluster& cluster = clusters[cluster_idx];
+        num_indices += cluster.num_indices;
+        if (scratch_visibility.IsSet(cluster_idx) == false)
+        {
+            continue;
+        }
+
+        num_visible_indices += cluster.num_indices;
+        if (out_ranges.size() > first_range && out_ranges.back().first_index + out_ranges.back().num_indices == cluster.first_index)
+        {
+            out_ranges.back().num_indices += cluster.num_indices;
+        }
+        else
+        {
+            out_ranges.push_back(ClusterRange{ .first_index = cluster.first_index, .num_indices = cluster.num_indices });
+        }
+    }
+
+    // Every instance draws all ranges
+    out_stats.num_triangles += num_indices / 3 * world_matrices.size();
+    out_stats.num_visible_triangles += num_visible_indices / 3 * world_matrices.size();
+}
+
+std::span<const ClusterRange> CullBatchClusters(const InstanceBatchList& batches, const InstanceBatch& batch, bool is_enabled,
+    ClusterCullContext& context)
+{
+    const StaticMesh& mesh = *batch.mesh;
+    context.ranges.clear();
+
+    if (is_enabled == false || mesh.clusters.empty())
+    {
+        const uint64 num_triangles = (uint64) mesh.num_indices / 3 * batch.num_instances;
+        context.stats.num_triangles += num_triangles;
+        context.stats.num_visible_triangles += num_triangles;
+        context.ranges.push_back(ClusterRange{ .first_index = 0, .num_indices = mesh.num_indices });
+        return context.ranges;
+    }
+
+    // The clusters are in model space, so the instances are culled with their transforms instead of the vertex world matrices,
+    // which would also map quantized positions
+    context.instance_world_matrices.clear();
+    for (uint32 instance_idx = batch.first_instance; instance_idx < batch.first_instance + batch.num_instances; ++instance_idx)
+    {
+        context.instance_world_matrices.push_back(batches.instance_meshes_[instance_idx]->model->transform.GetWorldMatrix());
+    }
+
+    CullClusters(context.view, mesh.clusters, context.instance_world_matrices, context.visibility, context.ranges, context.stats);
+    return context.ranges;
+}
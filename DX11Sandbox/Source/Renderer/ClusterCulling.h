@@ -0,0 +1,96 @@
+#pragma once
+#include <span>
+
+#include "Renderer/Culling.h"
+#include "Renderer/RenderState.h"
+
+class InstanceBatchList;
+struct InstanceBatch;
+
+/**
+ * A few dozen to a hundred neighboring triangles of a mesh with similar facing, see BuildClusters().
+ * Cooked as is, all bounds are in model space.
+ */
+struct MeshCluster
+{
+    uint32 first_index = 0;     // Relative to the first index of the mesh
+    uint32 num_indices = 0;
+    Vec3 center;                // Of the AABB, also the center of the bounding sphere
+    Vec3 extents;
+    float radius = 0.0f;
+    Vec3 cone_axis;             // Average facing of the triangles
+    float cone_cutoff = 1.0f;   // Sine of the angle between the axis and the farthest triangle normal, >= 1 if the cone is too wide to cull
+};
+
+// Visible clusters are drawn in runs, relative to the first index of the mesh
+struct ClusterRange
+{
+    uint32 first_index = 0;
+    uint32 num_indices = 0;
+};
+
+enum class CulledFaces : uint8
+{
+    None,
+    Back,
+    Front
+};
+
+// Which faces the rasterizer state discards, the cone test can only reject clusters made of those
+CulledFaces GetCulledFaces(RasterizerState rasterizer_state);
+
+/**
+ * Frustum and viewer of a view in world space. The viewer is homogeneous, so one cone test covers both projections:
+ * w = 1 is the position of a perspective viewer, w = 0 is the direction towards an orthographic one.
+ */
+struct ClusterCullView
+{
+    Frustum frustum;
+    Vec4 viewer;
+    CulledFaces culled_faces = CulledFaces::Back;
+};
+
+struct ClusterCullStats
+{
+    uint64 num_triangles = 0;           // Of the objects which passed object culling
+    uint64 num_visible_triangles = 0;
+
+    ClusterCullStats& operator+=(const ClusterCullStats& other)
+    {
+        num_triangles += other.num_triangles;
+        num_visible_triangles += other.num_visible_triangles;
+        return *this;
+    }
+
+    float GetRejectedPercent() const
+    {
+        return num_triangles > 0 ? 100.0f * (float) (num_triangles - num_visible_triangles) / (float) num_triangles : 0.0f;
+    }
+};
+
+/**
+ * Tests the clusters of one mesh against the frustum and the normal cones against the viewer, for every instance.
+ * The view is transformed into the model space of each instance instead of transforming all cluster bounds into world space.
+ *
+ * Appends the index ranges of clusters which are visible in any of the instances. Neighboring visible clusters are merged
+ * into one range, so a fully visible mesh is still a single draw call. Mirroring world matrices flip the culled faces.
+ */
+void CullClusters(const ClusterCullView& view, std::span<const MeshCluster> clusters, std::span<const Mat4> world_matrices,
+    VisibilityBits& scratch_visibility, std::vector<ClusterRange>& out_ranges, ClusterCullStats& out_stats);
+
+/**
+ * Cluster culling state of one view. Owned by the view, so every encoding job has its own scratch memory.
+ */
+struct ClusterCullContext
+{
+    ClusterCullView view;
+    VisibilityBits visibility;
+    std::vector<Mat4> instance_world_matrices;  // Of the batch being culled, not transposed
+    std::vector<ClusterRange> ranges;
+    ClusterCullStats stats;
+};
+
+// Index ranges of the batch's mesh to draw, relative to its first index. Empty if no cluster is visible in any instance.
+// Meshes without clusters are drawn as a whole, like all meshes if is_enabled is false.
+std::span<const ClusterRange> CullBatchClusters(const InstanceBatchList& batches, const InstanceBatch& batch, bool is_enabled,
+    ClusterCullContext& context);
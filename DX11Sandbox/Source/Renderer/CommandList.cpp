@@ -0,0 +1,354 @@
+#include "Renderer/CommandList.h"
+
+#include "Renderer/GraphicsBackend.h"
+#include "Renderer/GraphicsContext.h"
+#include "Renderer/Instancing.h"
+#include "Renderer/Mesh.h"
+
+namespace
+{
+    struct CommandHeader
+    {
+        RenderCommandType type;
+        uint32 size;    // Of the payload following the header
+    };
+
+    struct SetViewportCommand
+    {
+        Viewport viewport;
+    };
+
+    struct SetRasterizerStateCommand
+    {
+        RasterizerState state;
+    };
+
+    struct SetVertexShaderCommand
+    {
+        GpuVertexShader* shader;
+    };
+
+    struct SetPixelShaderCommand
+    {
+        GpuPixelShader* shader;
+    };
+
+    struct SetInputLayoutCommand
+    {
+        GpuInputLayout* input_layout;
+    };
+
+    struct SetConstantBufferCommand
+    {
+        GpuBuffer* buffer;
+        uint32 slot;
+    };
+
+    struct SetVertexBufferCommand
+    {
+        GpuBuffer* buffer;
+        uint32 slot;
+        uint32 stride;
+        uint32 offset;
+    };
+
+    struct SetIndexBufferCommand
+    {
+        GpuBuffer* buffer;
+        IndexFormat format;
+        uint32 offset;
+    };
+
+    struct SetShaderResourceCommand
+    {
+        GpuShaderResourceView* srv;
+        uint32 slot;
+    };
+
+    struct SetRenderTargetCommand
+    {
+        GpuRenderTargetView* rtv;
+        GpuDepthStencilView* dsv;
+    };
+
+    struct ClearDepthCommand
+    {
+        GpuDepthStencilView* dsv;
+        float depth;
+    };
+
+    // Followed by data_size bytes
+    struct UpdateBufferCommand
+    {
+        GpuBuffer* buffer;
+        uint32 data_size;
+    };
+
+    struct BindMeshCommand
+    {
+        const StaticMesh* mesh;
+        bool is_instanced;
+    };
+
+    struct BindObjectConstantsCommand
+    {
+        Model* model;
+    };
+
+    struct UploadInstancesCommand
+    {
+        InstanceBuffer* instance_buffer;
+        const Mat4* world_matrices;
+        uint32 num_instances;
+    };
+
+    struct DrawIndexedCommand
+    {
+        uint32 num_indices;
+        uint32 start_idx;
+        int32 base_vertex;
+    };
+
+    struct DrawIndexedInstancedCommand
+    {
+        uint32 num_indices;
+        uint32 num_instances;
+        uint32 start_idx;
+        int32 base_vertex;
+        uint32 first_instance;
+    };
+
+    // The arena is a byte stream without padding, so commands are copied in and out instead of being accessed in place
+    template<typename Command>
+    Command Read(const uint8* payload)
+    {
+        static_assert(std::is_trivially_copyable_v<Command>);
+        Command command;
+        std::memcpy(&command, payload, sizeof(Command));
+        return command;
+    }
+
+    template<typename Command>
+    void Write(uint8* payload, const Command& command)
+    {
+        static_assert(std::is_trivially_copyable_v<Command>);
+        std::memcpy(payload, &command, sizeof(Command));
+    }
+}
+
+void CommandList::Reset()
+{
+    data_.clear();
+    num_commands_ = 0;
+}
+
+void CommandList::SetViewport(const Viewport& viewport)
+{
+    Write(Allocate(RenderCommandType::SetViewport, sizeof(SetViewportCommand)), SetViewportCommand{ viewport });
+}
+
+void CommandList::SetRasterizerState(RasterizerState state)
+{
+    Write(Allocate(RenderCommandType::SetRasterizerState, sizeof(SetRasterizerStateCommand)), SetRasterizerStateCommand{ state });
+}
+
+void CommandList::SetVertexShader(GpuVertexShader* shader)
+{
+    Write(Allocate(RenderCommandType::SetVertexShader, sizeof(SetVertexShaderCommand)), SetVertexShaderCommand{ shader });
+}
+
+void CommandList::SetPixelShader(GpuPixelShader* shader)
+{
+    Write(Allocate(RenderCommandType::SetPixelShader, sizeof(SetPixelShaderCommand)), SetPixelShaderCommand{ shader });
+}
+
+void CommandList::SetInputLayout(GpuInputLayout* input_layout)
+{
+    Write(Allocate(RenderCommandType::SetInputLayout, sizeof(SetInputLayoutCommand)), SetInputLayoutCommand{ input_layout });
+}
+
+void CommandList::SetConstantBuffer(GpuBuffer* buffer, uint32 slot)
+{
+    Write(Allocate(RenderCommandType::SetConstantBuffer, sizeof(SetConstantBufferCommand)), SetConstantBufferCommand{ buffer, slot });
+}
+
+void CommandList::SetVertexBuffer(GpuBuffer* buffer, uint32 slot, uint32 stride, uint32 offset)
+{
+    Write(Allocate(RenderCommandType::SetVertexBuffer, sizeof(SetVertexBufferCommand)),
+        SetVertexBufferCommand{ buffer, slot, stride, offset });
+}
+
+void CommandList::SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset)
+{
+    Write(Allocate(RenderCommandType::SetIndexBuffer, sizeof(SetIndexBufferCommand)), SetIndexBufferCommand{ buffer, format, offset });
+}
+
+void CommandList::SetPSShaderResource(GpuShaderResourceView* srv, uint32 slot)
+{
+    Write(Allocate(RenderCommandType::SetPSShaderResource, sizeof(SetShaderResourceCommand)), SetShaderResourceCommand{ srv, slot });
+}
+
+void CommandList::SetRenderTarget(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv)
+{
+    Write(Allocate(RenderCommandType::SetRenderTarget, sizeof(SetRenderTargetCommand)), SetRenderTargetCommand{ rtv, dsv });
+}
+
+void CommandList::ClearDepth(GpuDepthStencilView* dsv, float depth)
+{
+    CHECK(dsv != nullptr);
+    Write(Allocate(RenderCommandType::ClearDepth, sizeof(ClearDepthCommand)), ClearDepthCommand{ dsv, depth });
+}
+
+void CommandList::UpdateBuffer(GpuBuffer* buffer, const void* data, uint32 data_size)
+{
+    CHECK(buffer != nullptr && data != nullptr && data_size > 0);
+
+    uint8* payload = Allocate(RenderCommandType::UpdateBuffer, sizeof(UpdateBufferCommand) + data_size);
+    Write(payload, UpdateBufferCommand{ buffer, data_size });
+    std::memcpy(payload + sizeof(UpdateBufferCommand), data, data_size);
+}
+
+void CommandList::BindMesh(const StaticMesh* mesh, bool is_instanced)
+{
+    CHECK(mesh != nullptr);
+    Write(Allocate(RenderCommandType::BindMesh, sizeof(BindMeshCommand)), BindMeshCommand{ mesh, is_instanced });
+}
+
+void CommandList::BindObjectConstants(Model* model)
+{
+    CHECK(model != nullptr);
+    Write(Allocate(RenderCommandType::BindObjectConstants, sizeof(BindObjectConstantsCommand)), BindObjectConstantsCommand{ model });
+}
+
+void CommandList::UploadInstances(InstanceBuffer* instance_buffer, std::span<const Mat4> world_matrices)
+{
+    CHECK(instance_buffer != nullptr && world_matrices.empty() == false);
+    Write(Allocate(RenderCommandType::UploadInstances, sizeof(UploadInstancesCommand)),
+        UploadInstancesCommand{ instance_buffer, world_matrices.data(), (uint32) world_matrices.size() });
+}
+
+void CommandList::DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex)
+{
+    Write(Allocate(RenderCommandType::DrawIndexed, sizeof(DrawIndexedCommand)), DrawIndexedCommand{ num_indices, start_idx, base_vertex });
+}
+
+void CommandList::DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex,
+    uint32 first_instance)
+{
+    Write(Allocate(RenderCommandType::DrawIndexedInstanced, sizeof(DrawIndexedInstancedCommand)),
+        DrawIndexedInstancedCommand{ num_indices, num_instances, start_idx, base_vertex, first_instance });
+}
+
+void CommandList::Replay() const
+{
+    uint32 instance_base = 0;
+
+    size_t offset = 0;
+    while (offset < data_.size())
+    {
+        const CommandHeader header = Read<CommandHeader>(&data_[offset]);
+        const uint8* payload = &data_[offset + sizeof(CommandHeader)];
+        offset += sizeof(CommandHeader) + header.size;
+
+        switch (header.type)
+        {
+        case RenderCommandType::SetViewport:
+            gfx::SetViewport(Read<SetViewportCommand>(payload).viewport);
+            break;
+        case RenderCommandType::SetRasterizerState:
+            gfx::SetRasterizerState(Read<SetRasterizerStateCommand>(payload).state);
+            break;
+        case RenderCommandType::SetVertexShader:
+            gfx::SetVertexShader(Read<SetVertexShaderCommand>(payload).shader);
+            break;
+        case RenderCommandType::SetPixelShader:
+            gfx::SetPixelShader(Read<SetPixelShaderCommand>(payload).shader);
+            break;
+        case RenderCommandType::SetInputLayout:
+            gfx::SetInputLayout(Read<SetInputLayoutCommand>(payload).input_layout);
+            break;
+        case RenderCommandType::SetConstantBuffer:
+        {
+            const SetConstantBufferCommand command = Read<SetConstantBufferCommand>(payload);
+            gfx::SetConstantBuffer(command.buffer, command.slot);
+            break;
+        }
+        case RenderCommandType::SetVertexBuffer:
+        {
+            const SetVertexBufferCommand command = Read<SetVertexBufferCommand>(payload);
+            gfx::SetVertexBuffer(command.buffer, command.slot, command.stride, command.offset);
+            break;
+        }
+        case RenderCommandType::SetIndexBuffer:
+        {
+            const SetIndexBufferCommand command = Read<SetIndexBufferCommand>(payload);
+            gfx::SetIndexBuffer(command.buffer, command.format, command.offset);
+            break;
+        }
+        case RenderCommandType::SetPSShaderResource:
+        {
+            const SetShaderResourceCommand command = Read<SetShaderResourceCommand>(payload);
+            gfx::SetPSShaderResource(command.srv, command.slot);
+            break;
+        }
+        case RenderCommandType::SetRenderTarget:
+        {
+            const SetRenderTargetCommand command = Read<SetRenderTargetCommand>(payload);
+            gfx::SetRenderTargets(command.rtv, command.dsv);
+            break;
+        }
+        case RenderCommandType::ClearDepth:
+        {
+            const ClearDepthCommand command = Read<ClearDepthCommand>(payload);
+            gfx::ClearDepthStencil(command.dsv, GpuClear::Depth, command.depth);
+            break;
+        }
+        case RenderCommandType::UpdateBuffer:
+        {
+            const UpdateBufferCommand command = Read<UpdateBufferCommand>(payload);
+            gfx::backend->UpdateBuffer(command.buffer, payload + sizeof(UpdateBufferCommand));
+            break;
+        }
+        case RenderCommandType::BindMesh:
+        {
+            const BindMeshCommand command = Read<BindMeshCommand>(payload);
+            command.mesh->Bind(command.is_instanced);
+            break;
+        }
+        case RenderCommandType::BindObjectConstants:
+            Read<BindObjectConstantsCommand>(payload).model->Bind();
+            break;
+        case RenderCommandType::UploadInstances:
+        {
+            const UploadInstancesCommand command = Read<UploadInstancesCommand>(payload);
+            instance_base = command.instance_buffer->Allocate({ command.world_matrices, command.num_instances });
+            command.instance_buffer->Bind();
+            break;
+        }
+        case RenderCommandType::DrawIndexed:
+        {
+            const DrawIndexedCommand command = Read<DrawIndexedCommand>(payload);
+            gfx::DrawIndexed(command.num_indices, command.start_idx, command.base_vertex);
+            break;
+        }
+        case RenderCommandType::DrawIndexedInstanced:
+        {
+            const DrawIndexedInstancedCommand command = Read<DrawIndexedInstancedCommand>(payload);
+            gfx::DrawIndexedInstanced(command.num_indices, command.num_instances, command.start_idx, command.base_vertex,
+                instance_base + command.first_instance);
+            break;
+        }
+        default:
+            CHECK_NO_ENTRY();
+        }
+    }
+}
+
+uint8* CommandList::Allocate(RenderCommandType type, uint32 size)
+{
+    const size_t offset = data_.size();
+    data_.resize(offset + sizeof(CommandHeader) + size);
+    Write(&data_[offset], CommandHeader{ type, size });
+    ++num_commands_;
+    return &data_[offset + sizeof(CommandHeader)];
+}
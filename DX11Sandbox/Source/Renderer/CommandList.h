@@ -0,0 +1,87 @@
+#pragma once
+#include <span>
+
+#include "Renderer/GraphicsTypes.h"
+#include "Renderer/RenderState.h"
+
+class InstanceBuffer;
+struct Model;
+struct StaticMesh;
+
+enum class RenderCommandType : uint8
+{
+    SetViewport,
+    SetRasterizerState,
+    SetVertexShader,
+    SetPixelShader,
+    SetInputLayout,
+    SetConstantBuffer,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetPSShaderResource,
+    SetRenderTarget,
+    ClearDepth,
+    UpdateBuffer,
+    BindMesh,
+    BindObjectConstants,
+    UploadInstances,
+    DrawIndexed,
+    DrawIndexedInstanced
+};
+
+/**
+ * Frame commands recorded into a linear arena of small POD commands and replayed later on the main thread.
+ *
+ * Recording doesn't touch the device context, so each pass or view can be encoded by its own job and the lists are replayed
+ * in a fixed order afterwards. Replaying goes through the gfx:: functions, so redundant state changes are still filtered,
+ * also across lists. Reset() keeps the memory of the arena, recording doesn't allocate once the list has warmed up.
+ *
+ * Commands store raw pointers to buffers, shaders, meshes and models. Those have to stay alive until the list was replayed.
+ * A list must only be recorded by one thread at a time.
+ */
+class CommandList
+{
+public:
+    void Reset();
+
+    void SetViewport(const Viewport& viewport);
+    void SetRasterizerState(RasterizerState state);
+    void SetVertexShader(GpuVertexShader* shader);
+    void SetPixelShader(GpuPixelShader* shader);
+    void SetInputLayout(GpuInputLayout* input_layout);
+    void SetConstantBuffer(GpuBuffer* buffer, uint32 slot);
+    void SetVertexBuffer(GpuBuffer* buffer, uint32 slot, uint32 stride, uint32 offset = 0);
+    void SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset = 0);
+    void SetPSShaderResource(GpuShaderResourceView* srv, uint32 slot);
+
+    void SetRenderTarget(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv);
+    void ClearDepth(GpuDepthStencilView* dsv, float depth = 1.0f);
+
+    // Copies the data into the list. Replaces the whole buffer on replay, so data_size has to match the size of the buffer.
+    void UpdateBuffer(GpuBuffer* buffer, const void* data, uint32 data_size);
+
+    // StaticMesh::Bind() and Model::Bind(). Deferred to the replay, both upload data and look up resources.
+    void BindMesh(const StaticMesh* mesh, bool is_instanced = false);
+    void BindObjectConstants(Model* model);
+
+    // Allocates the matrices from the instance buffer on replay and binds it. The matrices are not copied.
+    // The first instance of following instanced draws is relative to the first uploaded matrix.
+    void UploadInstances(InstanceBuffer* instance_buffer, std::span<const Mat4> world_matrices);
+
+    void DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex);
+    void DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 first_instance);
+
+    // Main thread only
+    void Replay() const;
+
+    bool IsEmpty() const { return num_commands_ == 0; }
+    uint32 GetNumCommands() const { return num_commands_; }
+    size_t GetSizeBytes() const { return data_.size(); }
+
+private:
+    // Appends a command of the given size and returns the memory for its payload
+    uint8* Allocate(RenderCommandType type, uint32 size);
+
+    std::vector<uint8> data_;
+    uint32 num_commands_ = 0;
+};
@@ -1,6 +1,6 @@
 #include "Renderer/ConstantBuffer.h"
 
-#include "Renderer/DX11Util.h"
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/GraphicsContext.h"
 
 ConstantBuffer::ConstantBuffer(size_t size)
@@ -48,12 +48,11 @@ void ConstantBuffer::Init()
 
     data_ = new uint8[size_];
 
-    D3D11_BUFFER_DESC buffer_desc = {};
-    buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;   // Read / Write access
-    buffer_desc.ByteWidth = static_cast<UINT>(size_);
-    DX11_VERIFY(gfx::device->CreateBuffer(&buffer_desc, nullptr, &buffer_));
+    GpuBufferDesc buffer_desc = {};
+    buffer_desc.size = static_cast<uint32>(size_);
+    buffer_desc.usage = GpuUsage::Default;   // Read / Write access
+    buffer_desc.bind_flags = GpuBind::ConstantBuffer;
+    buffer_ = gfx::backend->CreateBuffer(buffer_desc);
 }
 
 bool ConstantBuffer::SetFloat(const std::string& param_name, float val)
@@ -150,7 +149,7 @@ void ConstantBuffer::Upload()
 
     if(is_dirty_)
     {
-        gfx::device_context->UpdateSubresource(buffer_.Get(), 0, nullptr, (void*) data_, 0, 0);
+        gfx::backend->UpdateBuffer(buffer_.get(), data_);
         is_dirty_ = false;
     }
 }
@@ -1,7 +1,5 @@
 #pragma once
-#include <d3d11.h>
-
-#include "Renderer/DX11Types.h"
+#include "Renderer/GraphicsTypes.h"
 
 enum class ParameterType
 {
@@ -26,7 +24,7 @@ static inline const std::unordered_map<ParameterType, size_t> PARAMETER_TYPE_TO_
 struct CBufferParam
 {
     ParameterType type = ParameterType::Unknown;
-    UINT offset = 0;
+    uint32 offset = 0;
 
     bool operator==(const CBufferParam& other) const
     {
@@ -76,6 +74,6 @@ public:
     size_t size_ = 0;
     uint8* data_ = nullptr;
     uint32 slot_ = 0;
-    ComPtr<ID3D11Buffer> buffer_ = nullptr;
+    SharedPtr<GpuBuffer> buffer_ = nullptr;
     bool is_dirty_ = false;
 };
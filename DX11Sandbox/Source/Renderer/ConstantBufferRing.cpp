@@ -0,0 +1,76 @@
+#include "Renderer/ConstantBufferRing.h"
+
+#include "Renderer/GraphicsBackend.h"
+#include "Renderer/GraphicsContext.h"
+
+ConstantBufferRing::ConstantBufferRing(uint32 size)
+    : size_(size)
+{
+    CHECK(size > 0 && size % ALIGNMENT == 0);
+
+    is_supported_ = gfx::backend->SupportsConstantBufferOffsets();
+
+    if (is_supported_ == false)
+    {
+        LOG_WARN("Constant buffer offsetting is not supported. Falling back to per object constant buffers.");
+        return;
+    }
+
+    GpuBufferDesc desc =
+    {
+        .size = size_,
+        .usage = GpuUsage::Dynamic,
+        .bind_flags = GpuBind::ConstantBuffer
+    };
+    buffer_ = gfx::backend->CreateBuffer(desc);
+    buffer_->SetDebugName("ConstantBufferRing");
+}
+
+void ConstantBufferRing::BeginFrame()
+{
+    // Everything allocated last frame is still in flight -> rename the buffer on the next allocation
+    offset_ = 0;
+    is_discard_pending_ = true;
+    ++generation_;
+}
+
+ConstantBufferAllocation ConstantBufferRing::Allocate(const void* data, uint32 data_size)
+{
+    CHECK(is_supported_);
+    CHECK(data != nullptr && data_size > 0);
+
+    const uint32 aligned_size = (data_size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    CHECK(aligned_size <= size_);
+
+    if (offset_ + aligned_size > size_)
+    {
+        // Out of space. Discarding invalidates all allocations made so far, users have to upload again.
+        LOG_WARN("ConstantBufferRing ran out of space ({} bytes). Consider increasing its size.", size_);
+        offset_ = 0;
+        is_discard_pending_ = true;
+        ++generation_;
+    }
+
+    const MapType map_type = is_discard_pending_ ? MapType::WriteDiscard : MapType::WriteNoOverwrite;
+    is_discard_pending_ = false;
+
+    uint8* mapped = static_cast<uint8*>(gfx::backend->Map(buffer_.get(), map_type));
+    std::memcpy(mapped + offset_, data, data_size);
+    gfx::backend->Unmap(buffer_.get());
+
+    ConstantBufferAllocation allocation =
+    {
+        .buffer = buffer_.get(),
+        .first_constant = offset_ / CONSTANT_SIZE,
+        .num_constants = aligned_size / CONSTANT_SIZE,
+        .generation = generation_
+    };
+
+    offset_ += aligned_size;
+    return allocation;
+}
+
+bool ConstantBufferRing::IsValid(const ConstantBufferAllocation& allocation) const
+{
+    return allocation.buffer != nullptr && allocation.generation == generation_;
+}
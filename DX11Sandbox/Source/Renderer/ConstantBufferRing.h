@@ -0,0 +1,47 @@
+#pragma once
+#include "Renderer/GraphicsTypes.h"
+
+/**
+ * Sub-range of the ring, bound as a range of constants (VS/PSSetConstantBuffers1 on D3D11).
+ * Only valid as long as the ring's generation did not change, i.e. until the end of the frame it was allocated in.
+ */
+struct ConstantBufferAllocation
+{
+    GpuBuffer* buffer = nullptr;
+    uint32 first_constant = 0;
+    uint32 num_constants = 0;
+    uint64 generation = 0;
+};
+
+/**
+ * Large dynamic constant buffer which is sub-allocated linearly over the course of a frame.
+ * Allocations are written with MapType::WriteNoOverwrite, the first allocation of a frame (or after running out of space)
+ * uses MapType::WriteDiscard so the driver can rename the buffer while the GPU still reads the old contents.
+ *
+ * Requires constant buffer offsetting (D3D 11.1). Check IsSupported() and fall back to regular constant buffers otherwise.
+ */
+class ConstantBufferRing
+{
+public:
+    ConstantBufferRing(uint32 size);
+
+    void BeginFrame();
+
+    ConstantBufferAllocation Allocate(const void* data, uint32 data_size);
+    bool IsValid(const ConstantBufferAllocation& allocation) const;
+    bool IsSupported() const { return is_supported_; }
+
+    // Offsets and sizes passed to *SetConstantBuffers1 are measured in shader constants (16 bytes) and have to be multiples of 16.
+    static constexpr uint32 CONSTANT_SIZE = 16;
+    static constexpr uint32 ALIGNMENT = 256;
+
+    static constexpr uint32 DEFAULT_SIZE = 4 * 1024 * 1024;
+
+private:
+    SharedPtr<GpuBuffer> buffer_;
+    uint32 size_ = 0;
+    uint32 offset_ = 0;
+    uint64 generation_ = 1;
+    bool is_discard_pending_ = true;
+    bool is_supported_ = false;
+};
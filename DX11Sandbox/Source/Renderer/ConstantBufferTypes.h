@@ -20,3 +20,11 @@ DECLSPEC_ALIGN(16)
 struct CBufferPerFrame
 {
 };
+
+// Per shadow view, see EncodeShadowView()
+DECLSPEC_ALIGN(16)
+struct CBufferLightView
+{
+    Mat4 view;
+    Mat4 view_projection;
+};
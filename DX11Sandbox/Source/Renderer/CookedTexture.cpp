@@ -0,0 +1,210 @@
+#include "Renderer/CookedTexture.h"
+
+#include <chrono>
+#include <fstream>
+
+#include "Renderer/TextureCompression.h"
+
+namespace
+{
+    constexpr uint64 MIP_ALIGNMENT = 16;
+
+    // Returns 0 if the image can't be read
+    uint64 ComputeSourceHash(const TextureDesc& desc)
+    {
+        MappedFile file;
+        if (file.Open(desc.file_path) == false)
+        {
+            return 0;
+        }
+
+        // Different settings produce different blocks, e.g. a texture used as both color and data
+        const uint8 settings[] = { (uint8) desc.compression, desc.first_channel, (uint8) desc.texture_space, (uint8) desc.generateMipMaps };
+        const uint64 hash = Hash::HashBytes(settings, sizeof(settings));
+        return Hash::HashBytes(file.GetData(), file.GetSize(), hash);
+    }
+
+    const char* GetCompressionName(TextureCompression compression)
+    {
+        switch (compression)
+        {
+        case TextureCompression::None: return "rgba8";
+        case TextureCompression::BC1: return "bc1";
+        case TextureCompression::BC3: return "bc3";
+        case TextureCompression::BC4: return "bc4";
+        case TextureCompression::BC5: return "bc5";
+        case TextureCompression::BC7: return "bc7";
+        default: CHECK_NO_ENTRY();
+        }
+        return "";
+    }
+
+    std::vector<uint8> Cook(const TextureDesc& desc)
+    {
+        LOG("Cooking texture: {}", desc.file_path);
+
+        TextureDesc source_desc = desc;
+        source_desc.compression = TextureCompression::None;
+        const TextureData source = TextureData::LoadMips(source_desc, 0, desc.generateMipMaps ? ~0u : 1);
+
+        CookedTextureHeader header;
+        header.width = (uint32) source.width;
+        header.height = (uint32) source.height;
+        header.num_channels = (uint32) source.num_channels;
+        header.num_mips = (uint32) source.mips.size();
+        CHECK(header.num_mips <= CookedTextureHeader::MAX_MIPS);
+
+        // Mip 0 has to be made of whole blocks. Smaller mips are padded by the hardware.
+        TextureCompression compression = desc.compression;
+        if (header.width % 4 != 0 || header.height % 4 != 0)
+        {
+            LOG_WARN("Texture {} is not a multiple of 4 texels, it is cooked uncompressed", desc.file_path);
+            compression = TextureCompression::None;
+        }
+        header.format = GetCompressedFormat(compression, desc.texture_space);
+
+        std::vector<uint8> blob(sizeof(CookedTextureHeader));
+        for (uint32 mip_idx = 0; mip_idx < header.num_mips; ++mip_idx)
+        {
+            const TextureMip& mip = source.mips[mip_idx];
+            const std::vector<uint8> blocks = compression != TextureCompression::None ? CompressMip(mip, compression, desc.first_channel) : std::vector<uint8>();
+            const std::vector<uint8>& mip_data = compression != TextureCompression::None ? blocks : mip.pixels;
+
+            const size_t offset = (blob.size() + MIP_ALIGNMENT - 1) & ~(MIP_ALIGNMENT - 1);
+            blob.resize(offset + mip_data.size());
+            std::memcpy(blob.data() + offset, mip_data.data(), mip_data.size());
+            header.mips[mip_idx] = { .offset = offset, .size = mip_data.size() };
+        }
+
+        header.source_hash = ComputeSourceHash(desc);
+        header.file_size = blob.size();
+        std::memcpy(blob.data(), &header, sizeof(CookedTextureHeader));
+        return blob;
+    }
+}
+
+SharedPtr<const CookedTexture> CookedTexture::Load(const TextureDesc& desc)
+{
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    const String cooked_path = GetCookedPath(desc);
+
+    SharedPtr<CookedTexture> texture(new CookedTexture());
+    if (texture->file_.Open(cooked_path))
+    {
+        texture->data_ = texture->file_.GetData();
+        texture->size_ = texture->file_.GetSize();
+        if (texture->Validate() && ComputeSourceHash(desc) == texture->GetHeader().source_hash)
+        {
+            return texture;
+        }
+
+        LOG("Cooked texture {} is outdated", cooked_path);
+        texture.reset(new CookedTexture());    // Unmap before overwriting the file
+    }
+
+    std::vector<uint8> blob = Cook(desc);
+
+    bool is_written = false;
+    {
+        std::ofstream file(cooked_path, std::ios::binary | std::ios::trunc);
+        is_written = file.is_open() && file.write((const char*) blob.data(), blob.size()).good();
+    }
+
+    if (is_written && texture->file_.Open(cooked_path))
+    {
+        texture->data_ = texture->file_.GetData();
+        texture->size_ = texture->file_.GetSize();
+    }
+    else
+    {
+        // E.g. read-only asset directory. Use the cooked data straight from memory, next launch will try again.
+        LOG_WARN("Failed to write cooked texture: {}", cooked_path);
+        texture->blob_ = std::move(blob);
+        texture->data_ = texture->blob_.data();
+        texture->size_ = texture->blob_.size();
+    }
+
+    CHECK(texture->Validate());
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    LOG("Cooked texture {} in {:.1f} ms", cooked_path, std::chrono::duration<double, std::milli>(end_time - start_time).count());
+    return texture;
+}
+
+String CookedTexture::GetCookedPath(const TextureDesc& desc)
+{
+    // Same settings as the source hash
+    String settings = GetCompressionName(desc.compression);
+    if (desc.first_channel != 0)
+    {
+        settings += fmt::format("_c{}", (uint32) desc.first_channel);
+    }
+    if (desc.texture_space == TextureSpace::SRGB)
+    {
+        settings += "_srgb";
+    }
+    if (desc.generateMipMaps == false)
+    {
+        settings += "_nomips";
+    }
+
+    return std::filesystem::path(desc.file_path).replace_extension("." + settings + ".dxtex").string();
+}
+
+TextureData CookedTexture::GetMips(uint32 first_mip, uint32 end_mip) const
+{
+    const CookedTextureHeader& header = GetHeader();
+    end_mip = std::min(end_mip, header.num_mips);
+    CHECK(first_mip < end_mip);
+
+    TextureData data;
+    data.num_channels = (int32) header.num_channels;
+    data.width = (int32) header.width;
+    data.height = (int32) header.height;
+    data.format = header.format;
+    data.first_mip = first_mip;
+    data.mips.reserve(end_mip - first_mip);
+    for (uint32 mip_idx = first_mip; mip_idx < end_mip; ++mip_idx)
+    {
+        const CookedTextureMip& cooked_mip = header.mips[mip_idx];
+        TextureMip& mip = data.mips.emplace_back();
+        mip.width = std::max(header.width >> mip_idx, 1u);
+        mip.height = std::max(header.height >> mip_idx, 1u);
+        mip.pixels.assign(data_ + cooked_mip.offset, data_ + cooked_mip.offset + cooked_mip.size);
+    }
+
+    return data;
+}
+
+bool CookedTexture::Validate() const
+{
+    if (size_ < sizeof(CookedTextureHeader))
+    {
+        return false;
+    }
+
+    const CookedTextureHeader& header = GetHeader();
+    if (header.magic != CookedTextureHeader::MAGIC || header.version != CookedTextureHeader::VERSION || header.file_size != size_ ||
+        header.num_mips == 0 || header.num_mips > CookedTextureHeader::MAX_MIPS || header.num_mips > Texture::CalcNumMipLevels(header.width, header.height))
+    {
+        return false;
+    }
+
+    if (GetBlockBytes(header.format) == 0 && header.format != GpuFormat::R8G8B8A8_UNorm && header.format != GpuFormat::R8G8B8A8_UNorm_SRGB)
+    {
+        return false;
+    }
+
+    for (uint32 mip_idx = 0; mip_idx < header.num_mips; ++mip_idx)
+    {
+        const CookedTextureMip& mip = header.mips[mip_idx];
+        const uint64 expected_size = CalcMipBytes(header.format, std::max(header.width >> mip_idx, 1u), std::max(header.height >> mip_idx, 1u));
+        if (mip.offset % MIP_ALIGNMENT != 0 || mip.offset < sizeof(CookedTextureHeader) || mip.offset > size_ ||
+            mip.size != expected_size || mip.size > size_ - mip.offset)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
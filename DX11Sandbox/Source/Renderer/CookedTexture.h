@@ -0,0 +1,70 @@
+#pragma once
+#include "Core/MappedFile.h"
+
+#include "Renderer/Texture.h"
+
+struct CookedTextureMip
+{
+    uint64 offset = 0;  // In bytes, from the start of the file
+    uint64 size = 0;
+};
+
+struct CookedTextureHeader
+{
+    static constexpr uint32 MAGIC = 0x58545844;    // "DXTX"
+    static constexpr uint32 VERSION = 1;            // Bump whenever the layout or the encoders change
+    static constexpr uint32 MAX_MIPS = 16;
+
+    uint32 magic = MAGIC;
+    uint32 version = VERSION;
+    uint64 source_hash = 0;     // Content hash of the image file and the cook settings
+    uint64 file_size = 0;
+    GpuFormat format = GpuFormat::Unknown;
+    uint32 width = 0;           // Of mip 0
+    uint32 height = 0;
+    uint32 num_channels = 0;    // Of the source image
+    uint32 num_mips = 0;
+    CookedTextureMip mips[MAX_MIPS];
+};
+
+/**
+ * Cooked texture file (.dxtex). Stores the block compressed mip chain of an image file, so loading a compressed texture
+ * copies the blocks instead of decoding, downsampling and compressing the image:
+ *
+ * [header][mip 0][mip 1]...
+ *
+ * Every mip starts at a 16 byte aligned offset. Images which are not a multiple of 4 texels can't be block compressed,
+ * their mips are stored as RGBA8 instead.
+ */
+class CookedTexture
+{
+public:
+    // Maps the cooked version of the texture. If it is missing, outdated or was cooked with other settings, it gets cooked first.
+    // Cooking runs the encoders as jobs, so this has to be called from the main thread or a job.
+    // Checking for outdated files hashes the whole image, so streamed textures keep the result to load their mips, see Texture::cooked_.
+    static SharedPtr<const CookedTexture> Load(const TextureDesc& desc);
+
+    // Next to the image, named after the cook settings, e.g. albedo.bc7_srgb.dxtex. Textures which share an image
+    // but are cooked with other settings get their own file instead of recooking each other's.
+    static String GetCookedPath(const TextureDesc& desc);
+
+    // Copies the mips [first_mip, end_mip), end_mip is clamped to the chain. Can be called from any thread.
+    TextureData GetMips(uint32 first_mip, uint32 end_mip) const;
+
+    GpuFormat GetFormat() const { return GetHeader().format; }
+
+    const CookedTextureHeader& GetHeader() const { return *(const CookedTextureHeader*) data_; }
+
+private:
+    CookedTexture() = default;
+
+    // Checks magic, version and that every mip lies within the file and has the size its format requires.
+    bool Validate() const;
+
+    // Either the mapped file, or the freshly cooked blob if it could not be written to disk
+    MappedFile file_;
+    std::vector<uint8> blob_;
+
+    const uint8* data_ = nullptr;
+    size_t size_ = 0;
+};
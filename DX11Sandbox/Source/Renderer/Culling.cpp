@@ -0,0 +1,198 @@
+#include "Renderer/Culling.h"
+
+namespace
+{
+    Vec4 NormalizePlane(float a, float b, float c, float d)
+    {
+        const float inv_length = 1.0f / std::sqrt(a * a + b * b + c * c);
+        return Vec4(a * inv_length, b * inv_length, c * inv_length, d * inv_length);
+    }
+}
+
+Frustum Frustum::FromViewProjection(const Mat4& m)
+{
+    // Gribb / Hartmann plane extraction for row vectors (v' = v * M), with D3D clip space z in [0, w].
+    // See: https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+    Frustum frustum;
+    frustum.planes[LEFT] = NormalizePlane(m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41);
+    frustum.planes[RIGHT] = NormalizePlane(m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41);
+    frustum.planes[BOTTOM] = NormalizePlane(m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42);
+    frustum.planes[TOP] = NormalizePlane(m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42);
+    frustum.planes[NEAR_PLANE] = NormalizePlane(m._13, m._23, m._33, m._43);
+    frustum.planes[FAR_PLANE] = NormalizePlane(m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43);
+    return frustum;
+}
+
+void Frustum::DisablePlane(uint32 plane_idx)
+{
+    CHECK(plane_idx < NUM_PLANES);
+    planes[plane_idx] = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+uint32 BoundsSoA::Add(const Box& local_bounds, const Mat4& world)
+{
+    if (num_bounds_ % 4 == 0)
+    {
+        const size_t padded_size = num_bounds_ + 4;
+        center_x_.resize(padded_size, 0.0f);
+        center_y_.resize(padded_size, 0.0f);
+        center_z_.resize(padded_size, 0.0f);
+        extent_x_.resize(padded_size, 0.0f);
+        extent_y_.resize(padded_size, 0.0f);
+        extent_z_.resize(padded_size, 0.0f);
+    }
+
+    // Arvo: The world space extents are the local extents projected onto the absolute rotation / scale part of the matrix
+    const Vec3 c = local_bounds.center;
+    const Vec3 e = local_bounds.GetExtents();
+
+    const uint32 idx = num_bounds_++;
+    center_x_[idx] = c.x * world._11 + c.y * world._21 + c.z * world._31 + world._41;
+    center_y_[idx] = c.x * world._12 + c.y * world._22 + c.z * world._32 + world._42;
+    center_z_[idx] = c.x * world._13 + c.y * world._23 + c.z * world._33 + world._43;
+    extent_x_[idx] = e.x * std::abs(world._11) + e.y * std::abs(world._21) + e.z * std::abs(world._31);
+    extent_y_[idx] = e.x * std::abs(world._12) + e.y * std::abs(world._22) + e.z * std::abs(world._32);
+    extent_z_[idx] = e.x * std::abs(world._13) + e.y * std::abs(world._23) + e.z * std::abs(world._33);
+    return idx;
+}
+
+void BoundsSoA::Clear()
+{
+    center_x_.clear();
+    center_y_.clear();
+    center_z_.clear();
+    extent_x_.clear();
+    extent_y_.clear();
+    extent_z_.clear();
+    num_bounds_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void VisibilityBits::Reset(uint32 num_bits)
+{
+    words_.assign((num_bits + 63) / 64, 0ull);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void FrustumCull(const Frustum& frustum, const BoundsSoA& bounds, VisibilityBits& out_visibility, CullStats& out_stats,
+    const VisibilityBits* candidates)
+{
+    using namespace DirectX;
+
+    const uint32 num_bounds = bounds.Size();
+    out_visibility.Reset(num_bounds);
+
+    // Splat each plane once, the loop below only works on 4-wide lanes
+    XMVECTOR plane_x[Frustum::NUM_PLANES];
+    XMVECTOR plane_y[Frustum::NUM_PLANES];
+    XMVECTOR plane_z[Frustum::NUM_PLANES];
+    XMVECTOR plane_w[Frustum::NUM_PLANES];
+    XMVECTOR plane_abs_x[Frustum::NUM_PLANES];
+    XMVECTOR plane_abs_y[Frustum::NUM_PLANES];
+    XMVECTOR plane_abs_z[Frustum::NUM_PLANES];
+    for (uint32 p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        const Vec4& plane = frustum.planes[p];
+        plane_x[p] = XMVectorReplicate(plane.x);
+        plane_y[p] = XMVectorReplicate(plane.y);
+        plane_z[p] = XMVectorReplicate(plane.z);
+        plane_w[p] = XMVectorReplicate(plane.w);
+        plane_abs_x[p] = XMVectorAbs(plane_x[p]);
+        plane_abs_y[p] = XMVectorAbs(plane_y[p]);
+        plane_abs_z[p] = XMVectorAbs(plane_z[p]);
+    }
+
+    const XMVECTOR zero = XMVectorZero();
+    uint32 num_visible = 0;
+
+    for (uint32 i = 0; i < num_bounds; i += 4)
+    {
+        const XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.center_x_[i]));
+        const XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.center_y_[i]));
+        const XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.center_z_[i]));
+        const XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extent_x_[i]));
+        const XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extent_y_[i]));
+        const XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extent_z_[i]));
+
+        // A box is outside if it is completely behind any of the planes, i.e. distance + projected radius < 0
+        XMVECTOR is_outside = XMVectorFalseInt();
+        for (uint32 p = 0; p < Frustum::NUM_PLANES; ++p)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(cx, plane_x[p], plane_w[p]);
+            distance = XMVectorMultiplyAdd(cy, plane_y[p], distance);
+            distance = XMVectorMultiplyAdd(cz, plane_z[p], distance);
+
+            XMVECTOR radius = XMVectorMultiply(ex, plane_abs_x[p]);
+            radius = XMVectorMultiplyAdd(ey, plane_abs_y[p], radius);
+            radius = XMVectorMultiplyAdd(ez, plane_abs_z[p], radius);
+
+            is_outside = XMVectorOrInt(is_outside, XMVectorLess(XMVectorAdd(distance, radius), zero));
+        }
+
+        XMUINT4 outside_mask;
+        XMStoreUInt4(&outside_mask, is_outside);
+        const uint32 lanes[4] = { outside_mask.x, outside_mask.y, outside_mask.z, outside_mask.w };
+
+        const uint32 num_lanes = std::min(4u, num_bounds - i);
+        for (uint32 lane = 0; lane < num_lanes; ++lane)
+        {
+            if (lanes[lane] == 0 && (candidates == nullptr || candidates->IsSet(i + lane)))
+            {
+                out_visibility.Set(i + lane);
+                ++num_visible;
+            }
+        }
+    }
+
+    out_stats.num_tested += num_bounds;
+    out_stats.num_visible += num_visible;
+}
+
+void SphereCull(const Sphere& sphere, const BoundsSoA& bounds, VisibilityBits& out_visibility)
+{
+    using namespace DirectX;
+
+    const uint32 num_bounds = bounds.Size();
+    out_visibility.Reset(num_bounds);
+
+    const XMVECTOR sphere_x = XMVectorReplicate(sphere.center.x);
+    const XMVECTOR sphere_y = XMVectorReplicate(sphere.center.y);
+    const XMVECTOR sphere_z = XMVectorReplicate(sphere.center.z);
+    const XMVECTOR radius_sq = XMVectorReplicate(sphere.radius * sphere.radius);
+    const XMVECTOR zero = XMVectorZero();
+
+    for (uint32 i = 0; i < num_bounds; i += 4)
+    {
+        // Distance from the sphere center to the closest point of the box, per axis
+        const XMVECTOR dx = XMVectorMax(XMVectorSubtract(XMVectorAbs(XMVectorSubtract(
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.center_x_[i])), sphere_x)),
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extent_x_[i]))), zero);
+        const XMVECTOR dy = XMVectorMax(XMVectorSubtract(XMVectorAbs(XMVectorSubtract(
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.center_y_[i])), sphere_y)),
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extent_y_[i]))), zero);
+        const XMVECTOR dz = XMVectorMax(XMVectorSubtract(XMVectorAbs(XMVectorSubtract(
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.center_z_[i])), sphere_z)),
+            XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&bounds.extent_z_[i]))), zero);
+
+        XMVECTOR distance_sq = XMVectorMultiply(dx, dx);
+        distance_sq = XMVectorMultiplyAdd(dy, dy, distance_sq);
+        distance_sq = XMVectorMultiplyAdd(dz, dz, distance_sq);
+
+        XMUINT4 inside_mask;
+        XMStoreUInt4(&inside_mask, XMVectorLessOrEqual(distance_sq, radius_sq));
+        const uint32 lanes[4] = { inside_mask.x, inside_mask.y, inside_mask.z, inside_mask.w };
+
+        const uint32 num_lanes = std::min(4u, num_bounds - i);
+        for (uint32 lane = 0; lane < num_lanes; ++lane)
+        {
+            if (lanes[lane] != 0)
+            {
+                out_visibility.Set(i + lane);
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+/**
+ * View frustum as 6 normalized planes (ax + by + cz + d = 0), normals pointing inwards.
+ */
+struct Frustum
+{
+    static constexpr uint32 NUM_PLANES = 6;
+    static constexpr uint32 LEFT = 0;
+    static constexpr uint32 RIGHT = 1;
+    static constexpr uint32 BOTTOM = 2;
+    static constexpr uint32 TOP = 3;
+    static constexpr uint32 NEAR_PLANE = 4;
+    static constexpr uint32 FAR_PLANE = 5;
+
+    // Expects a row major view projection matrix as used on the CPU side, i.e. before transposing it for the GPU.
+    static Frustum FromViewProjection(const Mat4& view_projection);
+
+    // Replaces the plane with one that accepts everything, e.g. to keep shadow casters between the light and its near plane.
+    void DisablePlane(uint32 plane_idx);
+
+    Vec4 planes[NUM_PLANES];
+};
+
+/**
+ * World space AABBs stored as structure of arrays, so the culling kernel can test 4 boxes per instruction.
+ * The arrays are padded to a multiple of 4 with empty boxes.
+ */
+class BoundsSoA
+{
+public:
+    // Transforms the local space box into a world space AABB. Returns the index of the new entry.
+    uint32 Add(const Box& local_bounds, const Mat4& world);
+    void Clear();
+
+    uint32 Size() const { return num_bounds_; }
+
+    std::vector<float> center_x_;
+    std::vector<float> center_y_;
+    std::vector<float> center_z_;
+    std::vector<float> extent_x_;
+    std::vector<float> extent_y_;
+    std::vector<float> extent_z_;
+
+private:
+    uint32 num_bounds_ = 0;
+};
+
+class VisibilityBits
+{
+public:
+    void Reset(uint32 num_bits);
+    void Set(uint32 idx) { words_[idx >> 6] |= 1ull << (idx & 63); }
+    bool IsSet(uint32 idx) const { return (words_[idx >> 6] >> (idx & 63)) & 1ull; }
+
+    std::vector<uint64> words_;
+};
+
+struct CullStats
+{
+    uint32 num_tested = 0;
+    uint32 num_visible = 0;
+};
+
+// Marks all boxes which intersect or are contained in the frustum.
+// If candidates are passed, boxes which are not set in there are treated as invisible, e.g. to combine the results of multiple tests.
+void FrustumCull(const Frustum& frustum, const BoundsSoA& bounds, VisibilityBits& out_visibility, CullStats& out_stats,
+    const VisibilityBits* candidates = nullptr);
+
+// Marks all boxes which intersect the sphere.
+void SphereCull(const Sphere& sphere, const BoundsSoA& bounds, VisibilityBits& out_visibility);
@@ -0,0 +1,528 @@
+#include "Renderer/D3D11Backend.h"
+
+#include <d3d11sdklayers.h>
+
+#include "imgui_impl_dx11.h"
+
+#include "Core/Window.h"
+#include "Renderer/RenderStateCache.h"
+
+namespace
+{
+    static_assert(GpuClear::Depth == D3D11_CLEAR_DEPTH && GpuClear::Stencil == D3D11_CLEAR_STENCIL);
+
+    void InitDevice(Window* window)
+    {
+        CHECK(window != nullptr);
+        const HWND hwnd = static_cast<HWND>(window->GetHandle());
+        CHECK(hwnd != nullptr);
+
+        DXGI_SWAP_CHAIN_DESC1 swapchain_desc = {};
+        swapchain_desc.Width = static_cast<UINT>(window->GetWidth());
+        swapchain_desc.Height = static_cast<UINT>(window->GetHeight());
+        swapchain_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;  // Not SRGB due to DXGI_SWAP_EFFECT_FLIP_DISCARD!
+                                                             // See: https://walbourn.github.io/care-and-feeding-of-modern-swapchains/
+        swapchain_desc.Stereo = FALSE;
+        swapchain_desc.SampleDesc.Count = 1;
+        swapchain_desc.SampleDesc.Quality = 0;
+        swapchain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;   // Describes surface usage and CPU access for backbuffer
+        swapchain_desc.BufferCount = 2U;
+        swapchain_desc.Scaling = DXGI_SCALING::DXGI_SCALING_STRETCH;
+        swapchain_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;   // Don't use DXGI_SWAP_EFFECT_DISCARD - causes random stutters.
+        swapchain_desc.AlphaMode = DXGI_ALPHA_MODE::DXGI_ALPHA_MODE_IGNORE;
+
+        D3D_FEATURE_LEVEL accepted_feature_levels[] =
+        {
+            D3D_FEATURE_LEVEL_11_1,
+            D3D_FEATURE_LEVEL_11_0,
+        };
+
+        D3D_FEATURE_LEVEL device_feature_level;
+
+        uint32 create_device_flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+#if _RENDER_DEBUG
+        create_device_flags |= D3D11_CREATE_DEVICE_DEBUG; // Enable debug layers
+#endif
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> device_context;
+        DX11_VERIFY(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE::D3D_DRIVER_TYPE_HARDWARE, nullptr, create_device_flags, accepted_feature_levels,
+            _countof(accepted_feature_levels), D3D11_SDK_VERSION, &device, &device_feature_level, &device_context));
+
+        DX11_VERIFY(device.As(&gfx::device));
+        DX11_VERIFY(device_context.As(&gfx::device_context));
+
+        ComPtr<IDXGIDevice> dxgi_device;
+        DX11_VERIFY(gfx::device.As(&dxgi_device));
+
+        ComPtr<IDXGIAdapter> dxgi_adapter;
+        DX11_VERIFY(dxgi_device->GetAdapter(&dxgi_adapter));
+
+        ComPtr<IDXGIFactory4> dxgi_factory;
+        DX11_VERIFY(dxgi_adapter->GetParent(__uuidof(IDXGIFactory4), &dxgi_factory));
+
+        ComPtr<IDXGISwapChain1> dxgi_swapchain_1;
+        DX11_VERIFY(dxgi_factory->CreateSwapChainForHwnd(gfx::device.Get(), hwnd, &swapchain_desc, nullptr, nullptr, &dxgi_swapchain_1));
+        DX11_VERIFY(dxgi_swapchain_1.As(&gfx::swapchain));
+    }
+
+    D3D11_USAGE ToD3D11(GpuUsage usage)
+    {
+        switch (usage)
+        {
+        case GpuUsage::Default: return D3D11_USAGE_DEFAULT;
+        case GpuUsage::Immutable: return D3D11_USAGE_IMMUTABLE;
+        case GpuUsage::Dynamic: return D3D11_USAGE_DYNAMIC;
+        default:
+            CHECK_NO_ENTRY();
+            return D3D11_USAGE_DEFAULT;
+        }
+    }
+
+    UINT ToD3D11BindFlags(uint32 bind_flags)
+    {
+        UINT d3d11_bind_flags = 0;
+        d3d11_bind_flags |= (bind_flags & GpuBind::VertexBuffer) ? D3D11_BIND_VERTEX_BUFFER : 0;
+        d3d11_bind_flags |= (bind_flags & GpuBind::IndexBuffer) ? D3D11_BIND_INDEX_BUFFER : 0;
+        d3d11_bind_flags |= (bind_flags & GpuBind::ConstantBuffer) ? D3D11_BIND_CONSTANT_BUFFER : 0;
+        d3d11_bind_flags |= (bind_flags & GpuBind::ShaderResource) ? D3D11_BIND_SHADER_RESOURCE : 0;
+        d3d11_bind_flags |= (bind_flags & GpuBind::RenderTarget) ? D3D11_BIND_RENDER_TARGET : 0;
+        d3d11_bind_flags |= (bind_flags & GpuBind::DepthStencil) ? D3D11_BIND_DEPTH_STENCIL : 0;
+        return d3d11_bind_flags;
+    }
+
+    D3D11_MAP ToD3D11(MapType map_type)
+    {
+        return map_type == MapType::WriteNoOverwrite ? D3D11_MAP_WRITE_NO_OVERWRITE : D3D11_MAP_WRITE_DISCARD;
+    }
+
+    D3D11_PRIMITIVE_TOPOLOGY ToD3D11(PrimitiveTopology primitive_topology)
+    {
+        switch (primitive_topology)
+        {
+        case PrimitiveTopology::TriangleList: return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        case PrimitiveTopology::LineList: return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+        default: return D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        }
+    }
+
+    DXGI_FORMAT ToD3D11(IndexFormat format)
+    {
+        switch (format)
+        {
+        case IndexFormat::UInt16: return DXGI_FORMAT_R16_UINT;
+        case IndexFormat::UInt32: return DXGI_FORMAT_R32_UINT;
+        default: return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    DXGI_FORMAT ToD3D11(GpuFormat format)
+    {
+        return static_cast<DXGI_FORMAT>(format);
+    }
+
+    // The views are of the texture's own format unless the description names one
+    DXGI_FORMAT GetViewFormat(const GpuTexture* texture, const GpuViewDesc& desc)
+    {
+        return ToD3D11(desc.format != GpuFormat::Unknown ? desc.format : texture->GetDesc().format);
+    }
+}
+
+D3D11Backend::D3D11Backend(Window* window)
+{
+    InitDevice(window);
+
+    if (FAILED(gfx::device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options_, sizeof(options_))))
+    {
+        options_ = {};
+    }
+
+    gfx::render_state_cache = new RenderStateCache();
+    ImGui_ImplDX11_Init(gfx::device.Get(), gfx::device_context.Get());
+}
+
+D3D11Backend::~D3D11Backend()
+{
+    gfx::device_context->ClearState();
+    gfx::device_context->Flush();
+
+    ImGui_ImplDX11_Shutdown();
+
+    delete gfx::render_state_cache;
+    gfx::render_state_cache = nullptr;
+
+    gfx::swapchain.Reset();
+    gfx::device_context.Reset();
+
+    ReportLiveObjects(gfx::device);
+    gfx::device.Reset();
+}
+
+SharedPtr<GpuBuffer> D3D11Backend::CreateBuffer(const GpuBufferDesc& desc, const void* initial_data)
+{
+    D3D11_BUFFER_DESC buffer_desc = {};
+    buffer_desc.ByteWidth = desc.size;
+    buffer_desc.Usage = ToD3D11(desc.usage);
+    buffer_desc.BindFlags = ToD3D11BindFlags(desc.bind_flags);
+    buffer_desc.CPUAccessFlags = desc.usage == GpuUsage::Dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+    buffer_desc.MiscFlags = desc.structure_stride > 0 ? D3D11_RESOURCE_MISC_BUFFER_STRUCTURED : 0;
+    buffer_desc.StructureByteStride = desc.structure_stride;
+
+    D3D11_SUBRESOURCE_DATA subresource_data = {};
+    subresource_data.pSysMem = initial_data;
+
+    ComPtr<ID3D11Buffer> buffer;
+    DX11_VERIFY(gfx::device->CreateBuffer(&buffer_desc, initial_data != nullptr ? &subresource_data : nullptr, &buffer));
+    return WrapNative<GpuBuffer>(buffer, desc);
+}
+
+SharedPtr<GpuTexture> D3D11Backend::CreateTexture2D(const GpuTextureDesc& desc, const void* initial_data, uint32 row_pitch)
+{
+    CHECK_MSG(initial_data == nullptr || desc.num_mips == 1, "Initial data only fills a single mip");
+
+    D3D11_TEXTURE2D_DESC texture_desc = {};
+    texture_desc.Width = desc.width;
+    texture_desc.Height = desc.height;
+    texture_desc.MipLevels = desc.num_mips;
+    texture_desc.ArraySize = desc.array_size;
+    texture_desc.Format = ToD3D11(desc.format);
+    texture_desc.SampleDesc.Count = 1;
+    texture_desc.Usage = ToD3D11(desc.usage);
+    texture_desc.BindFlags = ToD3D11BindFlags(desc.bind_flags);
+    texture_desc.CPUAccessFlags = desc.usage == GpuUsage::Dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+    texture_desc.MiscFlags |= desc.is_cube ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+    texture_desc.MiscFlags |= desc.generates_mips ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0;
+
+    D3D11_SUBRESOURCE_DATA subresource_data = {};
+    subresource_data.pSysMem = initial_data;
+    subresource_data.SysMemPitch = row_pitch;
+
+    ComPtr<ID3D11Texture2D> texture;
+    DX11_VERIFY(gfx::device->CreateTexture2D(&texture_desc, initial_data != nullptr ? &subresource_data : nullptr, &texture));
+    return WrapNative<GpuTexture>(texture, desc);
+}
+
+SharedPtr<GpuShaderResourceView> D3D11Backend::CreateShaderResourceView(GpuTexture* texture, const GpuViewDesc& desc)
+{
+    CHECK(texture != nullptr);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+    srv_desc.Format = GetViewFormat(texture, desc);
+    switch (desc.dimension)
+    {
+    case GpuViewDimension::Texture2D:
+        srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srv_desc.Texture2D.MipLevels = (UINT) -1;
+        break;
+    case GpuViewDimension::Texture2DArray:
+        srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srv_desc.Texture2DArray.MipLevels = (UINT) -1;
+        srv_desc.Texture2DArray.FirstArraySlice = desc.first_array_slice;
+        srv_desc.Texture2DArray.ArraySize = desc.array_size;
+        break;
+    case GpuViewDimension::TextureCube:
+        srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+        srv_desc.TextureCube.MipLevels = (UINT) -1;
+        break;
+    default:
+        CHECK_NO_ENTRY();
+    }
+
+    ComPtr<ID3D11ShaderResourceView> srv;
+    DX11_VERIFY(gfx::device->CreateShaderResourceView(ToNative(texture), &srv_desc, &srv));
+    return WrapNative<GpuShaderResourceView>(srv);
+}
+
+SharedPtr<GpuShaderResourceView> D3D11Backend::CreateStructuredBufferView(GpuBuffer* buffer)
+{
+    CHECK(buffer != nullptr && buffer->GetDesc().structure_stride > 0);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+    srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+    srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srv_desc.Buffer.FirstElement = 0;
+    srv_desc.Buffer.NumElements = buffer->GetDesc().size / buffer->GetDesc().structure_stride;
+
+    ComPtr<ID3D11ShaderResourceView> srv;
+    DX11_VERIFY(gfx::device->CreateShaderResourceView(ToNative(buffer), &srv_desc, &srv));
+    return WrapNative<GpuShaderResourceView>(srv);
+}
+
+SharedPtr<GpuRenderTargetView> D3D11Backend::CreateRenderTargetView(GpuTexture* texture, const GpuViewDesc& desc)
+{
+    CHECK(texture != nullptr);
+    CHECK_MSG(desc.dimension != GpuViewDimension::TextureCube, "Render into the faces through Texture2DArray views");
+
+    D3D11_RENDER_TARGET_VIEW_DESC rtv_desc = {};
+    rtv_desc.Format = GetViewFormat(texture, desc);
+    if (desc.dimension == GpuViewDimension::Texture2DArray)
+    {
+        rtv_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+        rtv_desc.Texture2DArray.FirstArraySlice = desc.first_array_slice;
+        rtv_desc.Texture2DArray.ArraySize = desc.array_size;
+    }
+    else
+    {
+        rtv_desc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+    }
+
+    ComPtr<ID3D11RenderTargetView> rtv;
+    DX11_VERIFY(gfx::device->CreateRenderTargetView(ToNative(texture), &rtv_desc, &rtv));
+    return WrapNative<GpuRenderTargetView>(rtv);
+}
+
+SharedPtr<GpuDepthStencilView> D3D11Backend::CreateDepthStencilView(GpuTexture* texture, const GpuViewDesc& desc)
+{
+    CHECK(texture != nullptr);
+    CHECK_MSG(desc.dimension != GpuViewDimension::TextureCube, "Render into the faces through Texture2DArray views");
+
+    D3D11_DEPTH_STENCIL_VIEW_DESC dsv_desc = {};
+    dsv_desc.Format = GetViewFormat(texture, desc);
+    if (desc.dimension == GpuViewDimension::Texture2DArray)
+    {
+        dsv_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+        dsv_desc.Texture2DArray.FirstArraySlice = desc.first_array_slice;
+        dsv_desc.Texture2DArray.ArraySize = desc.array_size;
+    }
+    else
+    {
+        dsv_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    }
+
+    ComPtr<ID3D11DepthStencilView> dsv;
+    DX11_VERIFY(gfx::device->CreateDepthStencilView(ToNative(texture), &dsv_desc, &dsv));
+    return WrapNative<GpuDepthStencilView>(dsv);
+}
+
+SharedPtr<GpuVertexShader> D3D11Backend::CreateVertexShader(std::span<const uint8> bytecode)
+{
+    ComPtr<ID3D11VertexShader> shader;
+    DX11_VERIFY(gfx::device->CreateVertexShader(bytecode.data(), bytecode.size(), nullptr, &shader));
+    return WrapNative<GpuVertexShader>(shader);
+}
+
+SharedPtr<GpuPixelShader> D3D11Backend::CreatePixelShader(std::span<const uint8> bytecode)
+{
+    ComPtr<ID3D11PixelShader> shader;
+    DX11_VERIFY(gfx::device->CreatePixelShader(bytecode.data(), bytecode.size(), nullptr, &shader));
+    return WrapNative<GpuPixelShader>(shader);
+}
+
+SharedPtr<GpuInputLayout> D3D11Backend::CreateInputLayout(std::span<const VertexElement> elements, std::span<const uint8> vs_bytecode)
+{
+    std::vector<D3D11_INPUT_ELEMENT_DESC> element_descs;
+    element_descs.reserve(elements.size());
+    for (const VertexElement& element : elements)
+    {
+        element_descs.push_back({
+            .SemanticName = element.semantic_name,
+            .SemanticIndex = element.semantic_index,
+            .Format = ToD3D11(element.format),
+            .InputSlot = element.slot,
+            .AlignedByteOffset = element.offset,
+            .InputSlotClass = element.is_per_instance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA,
+            .InstanceDataStepRate = element.is_per_instance ? 1u : 0u
+        });
+    }
+
+    ComPtr<ID3D11InputLayout> input_layout;
+    DX11_VERIFY(gfx::device->CreateInputLayout(element_descs.data(), (UINT) element_descs.size(), vs_bytecode.data(), vs_bytecode.size(),
+        &input_layout));
+    return WrapNative<GpuInputLayout>(input_layout);
+}
+
+bool D3D11Backend::SupportsConstantBufferOffsets() const
+{
+    return options_.ConstantBufferOffsetting && options_.MapNoOverwriteOnDynamicConstantBuffer;
+}
+
+bool D3D11Backend::SupportsNoOverwriteOnShaderResources() const
+{
+    return options_.MapNoOverwriteOnDynamicBufferSRV;
+}
+
+void* D3D11Backend::Map(GpuBuffer* buffer, MapType map_type)
+{
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    DX11_VERIFY(gfx::device_context->Map(ToNative(buffer), 0, ToD3D11(map_type), 0, &mapped));
+    return mapped.pData;
+}
+
+void D3D11Backend::Unmap(GpuBuffer* buffer)
+{
+    gfx::device_context->Unmap(ToNative(buffer), 0);
+}
+
+void D3D11Backend::UpdateBuffer(GpuBuffer* buffer, const void* data)
+{
+    gfx::device_context->UpdateSubresource(ToNative(buffer), 0, nullptr, data, 0, 0);
+}
+
+void D3D11Backend::UpdateTexture(GpuTexture* texture, uint32 mip, const void* data, uint32 row_pitch)
+{
+    gfx::device_context->UpdateSubresource(ToNative(texture), mip, nullptr, data, row_pitch, 0);
+}
+
+void D3D11Backend::CopyTextureMip(GpuTexture* dst, uint32 dst_mip, GpuTexture* src, uint32 src_mip)
+{
+    gfx::device_context->CopySubresourceRegion(ToNative(dst), dst_mip, 0, 0, 0, ToNative(src), src_mip, nullptr);
+}
+
+void D3D11Backend::CopyTexture(GpuTexture* dst, GpuTexture* src)
+{
+    gfx::device_context->CopyResource(ToNative(dst), ToNative(src));
+}
+
+void D3D11Backend::GenerateMips(GpuShaderResourceView* srv)
+{
+    gfx::device_context->GenerateMips(ToNative(srv));
+}
+
+void D3D11Backend::SetPrimitiveTopology(PrimitiveTopology primitive_topology)
+{
+    gfx::device_context->IASetPrimitiveTopology(ToD3D11(primitive_topology));
+}
+
+void D3D11Backend::SetBlendState(BlendState state)
+{
+    gfx::device_context->OMSetBlendState(gfx::render_state_cache->GetBlendState(state).Get(), nullptr, 0xffffffff);
+}
+
+void D3D11Backend::SetDepthStencilState(DepthStencilState state)
+{
+    gfx::device_context->OMSetDepthStencilState(gfx::render_state_cache->GetDepthStencilState(state).Get(), 1);
+}
+
+void D3D11Backend::SetRasterizerState(RasterizerState state)
+{
+    gfx::device_context->RSSetState(gfx::render_state_cache->GetRasterizerState(state).Get());
+}
+
+void D3D11Backend::SetVertexShader(GpuVertexShader* shader)
+{
+    gfx::device_context->VSSetShader(ToNative(shader), nullptr, 0);
+}
+
+void D3D11Backend::SetPixelShader(GpuPixelShader* shader)
+{
+    gfx::device_context->PSSetShader(ToNative(shader), nullptr, 0);
+}
+
+void D3D11Backend::SetInputLayout(GpuInputLayout* input_layout)
+{
+    gfx::device_context->IASetInputLayout(ToNative(input_layout));
+}
+
+void D3D11Backend::SetConstantBuffer(ShaderStage stage, uint32 slot, GpuBuffer* buffer, uint32 first_constant, uint32 num_constants)
+{
+    ID3D11Buffer* native_buffer = ToNative(buffer);
+    switch (stage)
+    {
+    case ShaderStage::VS:
+        if (num_constants > 0)
+        {
+            gfx::device_context->VSSetConstantBuffers1(slot, 1, &native_buffer, &first_constant, &num_constants);
+        }
+        else
+        {
+            gfx::device_context->VSSetConstantBuffers(slot, 1, &native_buffer);
+        }
+        break;
+    case ShaderStage::PS:
+        if (num_constants > 0)
+        {
+            gfx::device_context->PSSetConstantBuffers1(slot, 1, &native_buffer, &first_constant, &num_constants);
+        }
+        else
+        {
+            gfx::device_context->PSSetConstantBuffers(slot, 1, &native_buffer);
+        }
+        break;
+    default:
+        CHECK_NO_ENTRY();
+    }
+}
+
+void D3D11Backend::SetVertexBuffer(uint32 slot, GpuBuffer* buffer, uint32 stride, uint32 offset)
+{
+    ID3D11Buffer* native_buffer = ToNative(buffer);
+    gfx::device_context->IASetVertexBuffers(slot, 1, &native_buffer, &stride, &offset);
+}
+
+void D3D11Backend::SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset)
+{
+    gfx::device_context->IASetIndexBuffer(ToNative(buffer), ToD3D11(format), offset);
+}
+
+void D3D11Backend::SetShaderResource(ShaderStage stage, uint32 slot, GpuShaderResourceView* srv)
+{
+    ID3D11ShaderResourceView* native_srv = ToNative(srv);
+    switch (stage)
+    {
+    case ShaderStage::VS:
+        gfx::device_context->VSSetShaderResources(slot, 1, &native_srv);
+        break;
+    case ShaderStage::PS:
+        gfx::device_context->PSSetShaderResources(slot, 1, &native_srv);
+        break;
+    default:
+        CHECK_NO_ENTRY();
+    }
+}
+
+void D3D11Backend::SetSampler(ShaderStage stage, uint32 slot, SamplerState state)
+{
+    ID3D11SamplerState* sampler = gfx::render_state_cache->GetSamplerState(state).Get();
+    switch (stage)
+    {
+    case ShaderStage::VS:
+        gfx::device_context->VSSetSamplers(slot, 1, &sampler);
+        break;
+    case ShaderStage::PS:
+        gfx::device_context->PSSetSamplers(slot, 1, &sampler);
+        break;
+    default:
+        CHECK_NO_ENTRY();
+    }
+}
+
+void D3D11Backend::SetViewport(const Viewport& viewport)
+{
+    const D3D11_VIEWPORT d3d11_viewport = { viewport.x, viewport.y, viewport.width, viewport.height, viewport.min_depth, viewport.max_depth };
+    gfx::device_context->RSSetViewports(1, &d3d11_viewport);
+}
+
+void D3D11Backend::SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv)
+{
+    ID3D11RenderTargetView* native_rtv = ToNative(rtv);
+    gfx::device_context->OMSetRenderTargets(native_rtv != nullptr ? 1 : 0, &native_rtv, ToNative(dsv));
+}
+
+void D3D11Backend::ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4])
+{
+    gfx::device_context->ClearRenderTargetView(ToNative(rtv), color);
+}
+
+void D3D11Backend::ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth, uint8 stencil)
+{
+    gfx::device_context->ClearDepthStencilView(ToNative(dsv), clear_flags, depth, stencil);
+}
+
+void D3D11Backend::DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex)
+{
+    gfx::device_context->DrawIndexed(num_indices, start_idx, base_vertex);
+}
+
+void D3D11Backend::DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 start_instance)
+{
+    gfx::device_context->DrawIndexedInstanced(num_indices, num_instances, start_idx, base_vertex, start_instance);
+}
+
+void D3D11Backend::Present()
+{
+    DX11_VERIFY(gfx::swapchain->Present(1, 0));
+}
+
+GraphicsBackend* CreateD3D11Backend(Window* window)
+{
+    return new D3D11Backend(window);
+}
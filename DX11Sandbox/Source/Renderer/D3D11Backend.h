@@ -0,0 +1,132 @@
+#pragma once
+#include <dxgi1_4.h>
+#include <d3d11_3.h>
+
+#include "Renderer/DX11Types.h"
+#include "Renderer/DX11Util.h"
+#include "Renderer/GraphicsBackend.h"
+
+class RenderStateCache;
+
+template<typename Object>
+struct D3D11NativeType;
+
+template<> struct D3D11NativeType<GpuBuffer> { using Type = ID3D11Buffer; };
+template<> struct D3D11NativeType<GpuTexture> { using Type = ID3D11Texture2D; };
+template<> struct D3D11NativeType<GpuShaderResourceView> { using Type = ID3D11ShaderResourceView; };
+template<> struct D3D11NativeType<GpuRenderTargetView> { using Type = ID3D11RenderTargetView; };
+template<> struct D3D11NativeType<GpuDepthStencilView> { using Type = ID3D11DepthStencilView; };
+template<> struct D3D11NativeType<GpuVertexShader> { using Type = ID3D11VertexShader; };
+template<> struct D3D11NativeType<GpuPixelShader> { using Type = ID3D11PixelShader; };
+template<> struct D3D11NativeType<GpuInputLayout> { using Type = ID3D11InputLayout; };
+
+/**
+ * GPU object of the D3D11 backend. Holds a reference to the native object, the engine side description goes to Object.
+ */
+template<typename Object>
+class D3D11Object final : public Object
+{
+public:
+    using Native = typename D3D11NativeType<Object>::Type;
+
+    template<typename ... Args>
+    explicit D3D11Object(ComPtr<Native> native, Args&& ... args)
+        : Object(std::forward<Args>(args)...)
+        , native_(std::move(native))
+    {
+    }
+
+    Native* GetNative() const { return native_.Get(); }
+
+    void SetDebugName(const String& name) override
+    {
+        ::SetDebugName(native_.Get(), name);
+    }
+
+private:
+    ComPtr<Native> native_;
+};
+
+// Native object behind a GPU object of the D3D11 backend, null for null
+template<typename Object>
+typename D3D11NativeType<Object>::Type* ToNative(const Object* object)
+{
+    return object != nullptr ? static_cast<const D3D11Object<Object>*>(object)->GetNative() : nullptr;
+}
+
+// For objects which were created through gfx::device directly, e.g. views of the swap chain's back buffer.
+// Buffers and textures take their description as well.
+template<typename Object, typename ... Args>
+SharedPtr<Object> WrapNative(ComPtr<typename D3D11NativeType<Object>::Type> native, Args&& ... args)
+{
+    return MakeShared<D3D11Object<Object>>(std::move(native), std::forward<Args>(args)...);
+}
+
+/**
+ * Owns the D3D11 device, the swap chain of the window and the ImGui renderer on top of them, forwards everything to them.
+ * Samples which render with D3D11 on their own reach the device through gfx::device and gfx::device_context.
+ */
+class D3D11Backend final : public GraphicsBackend
+{
+public:
+    explicit D3D11Backend(Window* window);
+    ~D3D11Backend() override;
+
+    SharedPtr<GpuBuffer> CreateBuffer(const GpuBufferDesc& desc, const void* initial_data = nullptr) override;
+    SharedPtr<GpuTexture> CreateTexture2D(const GpuTextureDesc& desc, const void* initial_data = nullptr, uint32 row_pitch = 0) override;
+    SharedPtr<GpuShaderResourceView> CreateShaderResourceView(GpuTexture* texture, const GpuViewDesc& desc = {}) override;
+    SharedPtr<GpuShaderResourceView> CreateStructuredBufferView(GpuBuffer* buffer) override;
+    SharedPtr<GpuRenderTargetView> CreateRenderTargetView(GpuTexture* texture, const GpuViewDesc& desc = {}) override;
+    SharedPtr<GpuDepthStencilView> CreateDepthStencilView(GpuTexture* texture, const GpuViewDesc& desc = {}) override;
+
+    SharedPtr<GpuVertexShader> CreateVertexShader(std::span<const uint8> bytecode) override;
+    SharedPtr<GpuPixelShader> CreatePixelShader(std::span<const uint8> bytecode) override;
+    SharedPtr<GpuInputLayout> CreateInputLayout(std::span<const VertexElement> elements, std::span<const uint8> vs_bytecode) override;
+
+    bool SupportsConstantBufferOffsets() const override;
+    bool SupportsNoOverwriteOnShaderResources() const override;
+
+    void* Map(GpuBuffer* buffer, MapType map_type) override;
+    void Unmap(GpuBuffer* buffer) override;
+    void UpdateBuffer(GpuBuffer* buffer, const void* data) override;
+
+    void UpdateTexture(GpuTexture* texture, uint32 mip, const void* data, uint32 row_pitch) override;
+    void CopyTextureMip(GpuTexture* dst, uint32 dst_mip, GpuTexture* src, uint32 src_mip) override;
+    void CopyTexture(GpuTexture* dst, GpuTexture* src) override;
+    void GenerateMips(GpuShaderResourceView* srv) override;
+
+    void SetPrimitiveTopology(PrimitiveTopology primitive_topology) override;
+    void SetBlendState(BlendState state) override;
+    void SetDepthStencilState(DepthStencilState state) override;
+    void SetRasterizerState(RasterizerState state) override;
+    void SetVertexShader(GpuVertexShader* shader) override;
+    void SetPixelShader(GpuPixelShader* shader) override;
+    void SetInputLayout(GpuInputLayout* input_layout) override;
+    void SetConstantBuffer(ShaderStage stage, uint32 slot, GpuBuffer* buffer, uint32 first_constant, uint32 num_constants) override;
+    void SetVertexBuffer(uint32 slot, GpuBuffer* buffer, uint32 stride, uint32 offset) override;
+    void SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset) override;
+    void SetShaderResource(ShaderStage stage, uint32 slot, GpuShaderResourceView* srv) override;
+    void SetSampler(ShaderStage stage, uint32 slot, SamplerState state) override;
+    void SetViewport(const Viewport& viewport) override;
+    void SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv) override;
+
+    void ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4]) override;
+    void ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth, uint8 stencil) override;
+
+    void DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex) override;
+    void DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 start_instance) override;
+
+    void Present() override;
+
+private:
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options_ = {};
+};
+
+namespace gfx
+{
+    // Valid while a D3D11Backend exists
+    inline ComPtr<ID3D11Device3> device = nullptr;
+    inline ComPtr<ID3D11DeviceContext3> device_context = nullptr;
+    inline ComPtr<IDXGISwapChain3> swapchain = nullptr;
+    inline RenderStateCache* render_state_cache = nullptr;
+}
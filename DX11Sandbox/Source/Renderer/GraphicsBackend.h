@@ -0,0 +1,93 @@
+#pragma once
+#include <span>
+
+#include "Renderer/GraphicsTypes.h"
+#include "Renderer/RenderState.h"
+
+class Window;
+
+// Stages which the gfx::Set* functions bind resources to
+enum class ShaderStage : uint8
+{
+    VS,
+    PS
+};
+
+/**
+ * Everything the gfx:: functions need from the device, i.e. resource creation, uploads, state changes and draws.
+ *
+ * The gfx::Set* functions filter redundant state changes before they reach the backend, so the backend only sees calls
+ * which actually change something. D3D11Backend forwards them to the D3D11 device. NullGraphicsBackend records them
+ * instead, which allows to run the CPU side of the renderer without a GPU or window (see gfx::InitHeadless()).
+ *
+ * The interface only uses the engine types of GraphicsTypes.h, so the renderer and the null backend build without the
+ * Windows SDK. Only D3D11Backend and the code which talks to D3D11 directly (shader compilation, the render state objects,
+ * samples which render on their own) include it.
+ */
+class GraphicsBackend
+{
+public:
+    virtual ~GraphicsBackend() = default;
+
+    virtual SharedPtr<GpuBuffer> CreateBuffer(const GpuBufferDesc& desc, const void* initial_data = nullptr) = 0;
+    // initial_data fills the first mip, rows are row_pitch bytes apart. Required by immutable textures, which have a single mip.
+    virtual SharedPtr<GpuTexture> CreateTexture2D(const GpuTextureDesc& desc, const void* initial_data = nullptr, uint32 row_pitch = 0) = 0;
+    virtual SharedPtr<GpuShaderResourceView> CreateShaderResourceView(GpuTexture* texture, const GpuViewDesc& desc = {}) = 0;
+    // All elements of a structured buffer
+    virtual SharedPtr<GpuShaderResourceView> CreateStructuredBufferView(GpuBuffer* buffer) = 0;
+    virtual SharedPtr<GpuRenderTargetView> CreateRenderTargetView(GpuTexture* texture, const GpuViewDesc& desc = {}) = 0;
+    virtual SharedPtr<GpuDepthStencilView> CreateDepthStencilView(GpuTexture* texture, const GpuViewDesc& desc = {}) = 0;
+
+    // From compiled bytecode, see ShaderCompiler
+    virtual SharedPtr<GpuVertexShader> CreateVertexShader(std::span<const uint8> bytecode) = 0;
+    virtual SharedPtr<GpuPixelShader> CreatePixelShader(std::span<const uint8> bytecode) = 0;
+    virtual SharedPtr<GpuInputLayout> CreateInputLayout(std::span<const VertexElement> elements, std::span<const uint8> vs_bytecode) = 0;
+
+    // D3D 11.1 features, see ConstantBufferRing and InstanceBuffer
+    virtual bool SupportsConstantBufferOffsets() const = 0;
+    virtual bool SupportsNoOverwriteOnShaderResources() const = 0;
+
+    // Dynamic buffers only. Returns a pointer to the start of the buffer.
+    virtual void* Map(GpuBuffer* buffer, MapType map_type) = 0;
+    virtual void Unmap(GpuBuffer* buffer) = 0;
+
+    // Replaces the whole contents of a default usage buffer
+    virtual void UpdateBuffer(GpuBuffer* buffer, const void* data) = 0;
+
+    // Replaces a mip of a default usage texture. row_pitch is the size of a row of texels, or of 4x4 blocks if compressed.
+    virtual void UpdateTexture(GpuTexture* texture, uint32 mip, const void* data, uint32 row_pitch) = 0;
+    // Between textures of the same format, the mips have to be of the same size
+    virtual void CopyTextureMip(GpuTexture* dst, uint32 dst_mip, GpuTexture* src, uint32 src_mip) = 0;
+    virtual void CopyTexture(GpuTexture* dst, GpuTexture* src) = 0;
+    // Fills the mips below the first one of a texture which was created with GpuTextureDesc::generates_mips
+    virtual void GenerateMips(GpuShaderResourceView* srv) = 0;
+
+    virtual void SetPrimitiveTopology(PrimitiveTopology primitive_topology) = 0;
+    virtual void SetBlendState(BlendState state) = 0;
+    virtual void SetDepthStencilState(DepthStencilState state) = 0;
+    virtual void SetRasterizerState(RasterizerState state) = 0;
+    virtual void SetVertexShader(GpuVertexShader* shader) = 0;
+    virtual void SetPixelShader(GpuPixelShader* shader) = 0;
+    virtual void SetInputLayout(GpuInputLayout* input_layout) = 0;
+    // num_constants == 0 binds the whole buffer
+    virtual void SetConstantBuffer(ShaderStage stage, uint32 slot, GpuBuffer* buffer, uint32 first_constant, uint32 num_constants) = 0;
+    virtual void SetVertexBuffer(uint32 slot, GpuBuffer* buffer, uint32 stride, uint32 offset) = 0;
+    virtual void SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset) = 0;
+    virtual void SetShaderResource(ShaderStage stage, uint32 slot, GpuShaderResourceView* srv) = 0;
+    virtual void SetSampler(ShaderStage stage, uint32 slot, SamplerState state) = 0;
+    virtual void SetViewport(const Viewport& viewport) = 0;
+    // A single color target at most, rtv and dsv may be null
+    virtual void SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv) = 0;
+
+    virtual void ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4]) = 0;
+    // clear_flags is a combination of GpuClear::Flags
+    virtual void ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth, uint8 stencil) = 0;
+
+    virtual void DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex) = 0;
+    virtual void DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 start_instance) = 0;
+
+    virtual void Present() = 0;
+};
+
+// Creates the device and the swap chain of the window, see D3D11Backend. Requires an ImGui context for its ImGui renderer.
+GraphicsBackend* CreateD3D11Backend(Window* window);
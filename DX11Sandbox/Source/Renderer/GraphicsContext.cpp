@@ -1,87 +1,45 @@
 #include "Renderer/GraphicsContext.h"
 
-#include <d3d11sdklayers.h>
-
 #include "imgui.h"
-#include "imgui_impl_dx11.h"
 #include "imgui_impl_sdl.h"
 
 #include "Core/Window.h"
-#include "Renderer/DX11Util.h"
+#include "Renderer/ConstantBufferRing.h"
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/IRenderer.h"
+#include "Renderer/NullGraphicsBackend.h"
 
 extern IRenderer* CreateRenderer();
 
 namespace
 {
-    void InitDevice(Window* window)
-    {
-        CHECK(window != nullptr);
-        const HWND hwnd = static_cast<HWND>(window->GetHandle());
-        CHECK(hwnd != nullptr);
-
-        DXGI_SWAP_CHAIN_DESC1 swapchain_desc = {};
-        swapchain_desc.Width = static_cast<UINT>(window->GetWidth());
-        swapchain_desc.Height = static_cast<UINT>(window->GetHeight());
-        swapchain_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;  // Not SRGB due to DXGI_SWAP_EFFECT_FLIP_DISCARD!
-                                                             // See: https://walbourn.github.io/care-and-feeding-of-modern-swapchains/
-        swapchain_desc.Stereo = FALSE;
-        swapchain_desc.SampleDesc.Count = 1;
-        swapchain_desc.SampleDesc.Quality = 0;
-        swapchain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;   // Describes surface usage and CPU access for backbuffer
-        swapchain_desc.BufferCount = 2U;
-        swapchain_desc.Scaling = DXGI_SCALING::DXGI_SCALING_STRETCH;
-        swapchain_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;   // Don't use DXGI_SWAP_EFFECT_DISCARD - causes random stutters.
-        swapchain_desc.AlphaMode = DXGI_ALPHA_MODE::DXGI_ALPHA_MODE_IGNORE;
-
-        D3D_FEATURE_LEVEL accepted_feature_levels[] =
-        {
-            D3D_FEATURE_LEVEL_11_1,
-            D3D_FEATURE_LEVEL_11_0,
-        };
-
-        D3D_FEATURE_LEVEL device_feature_level;
-
-        uint32 create_device_flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
-#if _RENDER_DEBUG
-        create_device_flags |= D3D11_CREATE_DEVICE_DEBUG; // Enable debug layers
-#endif
-        ComPtr<ID3D11Device> device;
-        ComPtr<ID3D11DeviceContext> device_context;
-        DX11_VERIFY(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE::D3D_DRIVER_TYPE_HARDWARE, nullptr, create_device_flags, accepted_feature_levels,
-            _countof(accepted_feature_levels), D3D11_SDK_VERSION, &device, &device_feature_level, &device_context));
-
-        DX11_VERIFY(device.As(&gfx::device));
-        DX11_VERIFY(device_context.As(&gfx::device_context));
-
-        ComPtr<IDXGIDevice> dxgi_device;
-        DX11_VERIFY(gfx::device.As(&dxgi_device));
-
-        ComPtr<IDXGIAdapter> dxgi_adapter;
-        DX11_VERIFY(dxgi_device->GetAdapter(&dxgi_adapter));
-
-        ComPtr<IDXGIFactory4> dxgi_factory;
-        DX11_VERIFY(dxgi_adapter->GetParent(__uuidof(IDXGIFactory4), &dxgi_factory));
-
-        ComPtr<IDXGISwapChain1> dxgi_swapchain_1;
-        DX11_VERIFY(dxgi_factory->CreateSwapChainForHwnd(gfx::device.Get(), hwnd, &swapchain_desc, nullptr, nullptr, &dxgi_swapchain_1));
-        DX11_VERIFY(dxgi_swapchain_1.As(&gfx::swapchain));
-    }
+    // Without a D3D11 device
+    bool is_headless = false;
 
     void InitGlobalRenderStates()
     {
-        std::array<ID3D11SamplerState*, 7> samplers = {
-            gfx::render_state_cache->GetSamplerState(SamplerState::PointClamp).Get(),
-            gfx::render_state_cache->GetSamplerState(SamplerState::PointWrap).Get(),
-            gfx::render_state_cache->GetSamplerState(SamplerState::LinearClamp).Get(),
-            gfx::render_state_cache->GetSamplerState(SamplerState::LinearWrap).Get(),
-            gfx::render_state_cache->GetSamplerState(SamplerState::AnisotropicClamp).Get(),
-            gfx::render_state_cache->GetSamplerState(SamplerState::AnisotropicWrap).Get(),
-            gfx::render_state_cache->GetSamplerState(SamplerState::ShadowPCF).Get(),
+        constexpr SamplerState samplers[] =
+        {
+            SamplerState::PointClamp,
+            SamplerState::PointWrap,
+            SamplerState::LinearClamp,
+            SamplerState::LinearWrap,
+            SamplerState::AnisotropicClamp,
+            SamplerState::AnisotropicWrap,
+            SamplerState::ShadowPCF,
         };
 
-        gfx::device_context->VSSetSamplers(0, (UINT) samplers.size(), samplers.data());
-        gfx::device_context->PSSetSamplers(0, (UINT) samplers.size(), samplers.data());
+        for (uint32 slot = 0; slot < (uint32) std::size(samplers); ++slot)
+        {
+            gfx::SetSampler(samplers[slot], slot);
+        }
+    }
+
+    // The pipeline state keeps the bound objects alive, see PipelineState
+    template<typename Object>
+    SharedPtr<Object> Retain(Object* object)
+    {
+        return object != nullptr ? std::static_pointer_cast<Object>(object->shared_from_this()) : nullptr;
     }
 }
 
@@ -92,18 +50,19 @@ namespace gfx
         LOG("Initializing Graphics Context");
         CHECK(IsValid() == false);
 
-        InitDevice(window);
-        render_state_cache = new RenderStateCache();
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGui_ImplSDL2_InitForD3D(window->GetSDLHandle());
+
+        backend = CreateD3D11Backend(window);
         resource_manager = new ResourceManager();
+        resource_manager->shader_archive.Load(ShaderArchive::DEFAULT_PATH);
         renderer = CreateRenderer();
 
-        InitGlobalRenderStates();
-        gfx::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        constant_buffer_ring = new ConstantBufferRing(ConstantBufferRing::DEFAULT_SIZE);
 
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
-        ImGui_ImplSDL2_InitForD3D(window->GetSDLHandle());
-        ImGui_ImplDX11_Init(device.Get(), device_context.Get());
+        InitGlobalRenderStates();
+        gfx::SetPrimitiveTopology(PrimitiveTopology::TriangleList);
     }
 
     void Shutdown()
@@ -111,41 +70,84 @@ namespace gfx
         LOG("Shutting down Graphics Context");
         CHECK(IsValid());
 
-        device_context->ClearState();
-        device_context->Flush();
+        delete renderer;
+        renderer = nullptr;
+
+        delete constant_buffer_ring;
+        constant_buffer_ring = nullptr;
+
+        delete resource_manager;
+        resource_manager = nullptr;
+
+        // Releases what is still bound before the backend reports live objects
+        InvalidatePipelineState();
+
+        delete backend;
+        backend = nullptr;
 
-        ImGui_ImplDX11_Shutdown();
         ImGui_ImplSDL2_Shutdown();
         ImGui::DestroyContext();
+    }
 
-        delete renderer;
-        renderer = nullptr;
+    NullGraphicsBackend* InitHeadless()
+    {
+        LOG("Initializing headless Graphics Context");
+        CHECK(backend == nullptr && IsValid() == false);
+
+        NullGraphicsBackend* null_backend = new NullGraphicsBackend();
+        backend = null_backend;
+        is_headless = true;
+        resource_manager = new ResourceManager();
+        resource_manager->shader_archive.Load(ShaderArchive::DEFAULT_PATH);
+        constant_buffer_ring = new ConstantBufferRing(ConstantBufferRing::DEFAULT_SIZE);
+
+        gfx::SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+        return null_backend;
+    }
+
+    void ShutdownHeadless()
+    {
+        LOG("Shutting down headless Graphics Context");
+        CHECK(IsHeadless());
 
-        delete render_state_cache;
-        render_state_cache = nullptr;
+        delete constant_buffer_ring;
+        constant_buffer_ring = nullptr;
 
         delete resource_manager;
         resource_manager = nullptr;
 
-        swapchain.Reset();
-        device_context.Reset();
+        InvalidatePipelineState();
 
-        ReportLiveObjects(device);
-        device.Reset();
+        delete backend;
+        backend = nullptr;
+        is_headless = false;
+
+        pipeline_stats = PipelineStats();
+        last_frame_stats = PipelineStats();
+        frame_index = 0;
     }
 
     bool IsValid()
     {
-        return device != nullptr && device_context != nullptr && swapchain != nullptr &&
-            render_state_cache != nullptr && renderer != nullptr;
+        return backend != nullptr && renderer != nullptr && is_headless == false;
     }
 
-    void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY primitive_topology)
+    bool IsHeadless()
+    {
+        return backend != nullptr && is_headless;
+    }
+
+    void SetPrimitiveTopology(PrimitiveTopology primitive_topology)
     {
         if (pipeline_state.primitive_topology != primitive_topology)
         {
-            device_context->IASetPrimitiveTopology(primitive_topology);
+            backend->SetPrimitiveTopology(primitive_topology);
             pipeline_state.primitive_topology = primitive_topology;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
@@ -153,8 +155,13 @@ namespace gfx
     {
         if(pipeline_state.blend_state != state)
         {
-            device_context->OMSetBlendState(render_state_cache->GetBlendState(state).Get(), nullptr, 0xffffffff);
+            backend->SetBlendState(state);
             pipeline_state.blend_state = state;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
@@ -162,8 +169,13 @@ namespace gfx
     {
         if (pipeline_state.depth_stencil_state != state)
         {
-            device_context->OMSetDepthStencilState(render_state_cache->GetDepthStencilState(state).Get(), 1);
+            backend->SetDepthStencilState(state);
             pipeline_state.depth_stencil_state = state;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
@@ -171,50 +183,273 @@ namespace gfx
     {
         if (pipeline_state.rasterizer_state != state)
         {
-            device_context->RSSetState(render_state_cache->GetRasterizerState(state).Get());
+            backend->SetRasterizerState(state);
             pipeline_state.rasterizer_state = state;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void SetVertexShader(GpuVertexShader* shader)
+    {
+        if(pipeline_state.vs.get() != shader)
+        {
+            backend->SetVertexShader(shader);
+            pipeline_state.vs = Retain(shader);
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void SetPixelShader(GpuPixelShader* shader)
+    {
+        if (pipeline_state.ps.get() != shader)
+        {
+            backend->SetPixelShader(shader);
+            pipeline_state.ps = Retain(shader);
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void SetInputLayout(GpuInputLayout* input_layout)
+    {
+        if (pipeline_state.input_layout.get() != input_layout)
+        {
+            backend->SetInputLayout(input_layout);
+            pipeline_state.input_layout = Retain(input_layout);
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
-    void SetVertexShader(ID3D11VertexShader* shader)
+    void SetConstantBuffer(GpuBuffer* buffer, int slot)
     {
-        if(pipeline_state.vs != shader)
+        SetConstantBuffer(buffer, slot, 0, 0);
+    }
+
+    void SetConstantBuffer(GpuBuffer* buffer, int slot, uint32 first_constant, uint32 num_constants)
+    {
+        CHECK(slot >= 0 && (size_t) slot < PipelineState::NUM_CBUFFER_SLOTS);
+
+        uint32* vs_range = pipeline_state.vs_constant_buffer_ranges[slot];
+        if (pipeline_state.vs_constant_buffers[slot].get() != buffer || vs_range[0] != first_constant || vs_range[1] != num_constants)
+        {
+            backend->SetConstantBuffer(ShaderStage::VS, slot, buffer, first_constant, num_constants);
+            pipeline_state.vs_constant_buffers[slot] = Retain(buffer);
+            vs_range[0] = first_constant;
+            vs_range[1] = num_constants;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+
+        uint32* ps_range = pipeline_state.ps_constant_buffer_ranges[slot];
+        if (pipeline_state.ps_constant_buffers[slot].get() != buffer || ps_range[0] != first_constant || ps_range[1] != num_constants)
+        {
+            backend->SetConstantBuffer(ShaderStage::PS, slot, buffer, first_constant, num_constants);
+            pipeline_state.ps_constant_buffers[slot] = Retain(buffer);
+            ps_range[0] = first_constant;
+            ps_range[1] = num_constants;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void SetVertexBuffer(GpuBuffer* buffer, uint32 slot, uint32 stride, uint32 offset)
+    {
+        CHECK(slot < PipelineState::NUM_VERTEX_BUFFER_SLOTS);
+
+        if (pipeline_state.vertex_buffers[slot].get() != buffer ||
+            pipeline_state.vertex_buffer_strides[slot] != stride ||
+            pipeline_state.vertex_buffer_offsets[slot] != offset)
+        {
+            backend->SetVertexBuffer(slot, buffer, stride, offset);
+            pipeline_state.vertex_buffers[slot] = Retain(buffer);
+            pipeline_state.vertex_buffer_strides[slot] = stride;
+            pipeline_state.vertex_buffer_offsets[slot] = offset;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
         {
-            device_context->VSSetShader(shader, nullptr, 0);
-            pipeline_state.vs = shader;
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
-    void SetPixelShader(ID3D11PixelShader* shader)
+    void SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset)
     {
-        if (pipeline_state.ps != shader)
+        if (pipeline_state.index_buffer.get() != buffer ||
+            pipeline_state.index_buffer_format != format ||
+            pipeline_state.index_buffer_offset != offset)
+        {
+            backend->SetIndexBuffer(buffer, format, offset);
+            pipeline_state.index_buffer = Retain(buffer);
+            pipeline_state.index_buffer_format = format;
+            pipeline_state.index_buffer_offset = offset;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void SetShaderResource(GpuShaderResourceView* srv, uint32 slot)
+    {
+        SetVSShaderResource(srv, slot);
+        SetPSShaderResource(srv, slot);
+    }
+
+    void SetVSShaderResource(GpuShaderResourceView* srv, uint32 slot)
+    {
+        CHECK(slot < PipelineState::NUM_SRV_SLOTS);
+
+        if (pipeline_state.vs_srvs[slot].get() != srv)
+        {
+            backend->SetShaderResource(ShaderStage::VS, slot, srv);
+            pipeline_state.vs_srvs[slot] = Retain(srv);
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void SetPSShaderResource(GpuShaderResourceView* srv, uint32 slot)
+    {
+        CHECK(slot < PipelineState::NUM_SRV_SLOTS);
+
+        if (pipeline_state.ps_srvs[slot].get() != srv)
         {
-            device_context->PSSetShader(shader, nullptr, 0);
-            pipeline_state.ps = shader;
+            backend->SetShaderResource(ShaderStage::PS, slot, srv);
+            pipeline_state.ps_srvs[slot] = Retain(srv);
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
-    void SetInputLayout(ID3D11InputLayout* input_layout)
+    void SetSampler(SamplerState state, uint32 slot)
     {
-        if (pipeline_state.input_layout != input_layout)
+        CHECK(slot < PipelineState::NUM_SAMPLER_SLOTS);
+
+        if (pipeline_state.vs_samplers[slot] != state)
+        {
+            backend->SetSampler(ShaderStage::VS, slot, state);
+            pipeline_state.vs_samplers[slot] = state;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+
+        if (pipeline_state.ps_samplers[slot] != state)
+        {
+            backend->SetSampler(ShaderStage::PS, slot, state);
+            pipeline_state.ps_samplers[slot] = state;
+            ++pipeline_stats.num_calls_issued;
+        }
+        else
         {
-            device_context->IASetInputLayout(input_layout);
-            pipeline_state.input_layout = input_layout;
+            ++pipeline_stats.num_calls_skipped;
         }
     }
 
-    void SetConstantBuffer(ID3D11Buffer* buffer, int slot)
+    void SetViewport(const Viewport& viewport)
     {
-        if (pipeline_state.vs_constant_buffers[slot] != buffer)
+        if (pipeline_state.has_viewport == false || pipeline_state.viewport != viewport)
         {
-            device_context->VSSetConstantBuffers(slot, 1, &buffer);
-            pipeline_state.vs_constant_buffers[slot] = buffer;
+            backend->SetViewport(viewport);
+            pipeline_state.viewport = viewport;
+            pipeline_state.has_viewport = true;
+            ++pipeline_stats.num_calls_issued;
         }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
 
-        if (pipeline_state.ps_constant_buffers[slot] != buffer)
+    void SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv)
+    {
+        if (pipeline_state.rtv.get() != rtv || pipeline_state.dsv.get() != dsv)
         {
-            device_context->PSSetConstantBuffers(slot, 1, &buffer);
-            pipeline_state.ps_constant_buffers[slot] = buffer;
+            backend->SetRenderTargets(rtv, dsv);
+            pipeline_state.rtv = Retain(rtv);
+            pipeline_state.dsv = Retain(dsv);
+            ++pipeline_stats.num_calls_issued;
         }
+        else
+        {
+            ++pipeline_stats.num_calls_skipped;
+        }
+    }
+
+    void ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4])
+    {
+        CHECK(rtv != nullptr);
+        backend->ClearRenderTarget(rtv, color);
+    }
+
+    void ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth, uint8 stencil)
+    {
+        CHECK(dsv != nullptr);
+        backend->ClearDepthStencil(dsv, clear_flags, depth, stencil);
+    }
+
+    void DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex)
+    {
+        backend->DrawIndexed(num_indices, start_idx, base_vertex);
+        ++pipeline_stats.num_draw_calls;
+        ++pipeline_stats.num_instances;
+    }
+
+    void DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 start_instance)
+    {
+        backend->DrawIndexedInstanced(num_indices, num_instances, start_idx, base_vertex, start_instance);
+        ++pipeline_stats.num_draw_calls;
+        pipeline_stats.num_instances += num_instances;
+    }
+
+    void InvalidatePipelineState()
+    {
+        pipeline_state = PipelineState();
+    }
+
+    void ResetPipelineStats()
+    {
+        last_frame_stats = pipeline_stats;
+        pipeline_stats = PipelineStats();
+    }
+
+    void EndFrame()
+    {
+        pipeline_state.rtv = nullptr;
+        pipeline_state.dsv = nullptr;
+
+        ResetPipelineStats();
+        constant_buffer_ring->BeginFrame();
+        ++frame_index;
     }
 }
@@ -1,54 +1,124 @@
 #pragma once
-#include <dxgi1_4.h>
-#include <d3d11_3.h>
-
-#include "Renderer/DX11Types.h"
+#include "Renderer/GraphicsTypes.h"
 #include "Renderer/RenderState.h"
 #include "Renderer/ResourceManager.h"
 #include "Renderer/Camera.h"
 
+class ConstantBufferRing;
+class GraphicsBackend;
 class IRenderer;
-class RenderStateCache;
+class NullGraphicsBackend;
 struct ResourceManager;
 class Window;
 
 namespace gfx
 {
+    /**
+     * Holds references to the bound objects, like the device context does. A released object's address could be reused by a new
+     * one, which the filter would then take for the bound object.
+     */
     struct PipelineState
     {
         static constexpr size_t NUM_CBUFFER_SLOTS = 8;
+        static constexpr size_t NUM_VERTEX_BUFFER_SLOTS = 8;
+        static constexpr size_t NUM_SRV_SLOTS = 16;
+        static constexpr size_t NUM_SAMPLER_SLOTS = 8;
+
+        using SamplerSlots = std::array<SamplerState, NUM_SAMPLER_SLOTS>;
+        static constexpr SamplerSlots INVALID_SAMPLERS = [] { SamplerSlots samplers{}; samplers.fill(SamplerState::Invalid); return samplers; }();
 
-        D3D11_PRIMITIVE_TOPOLOGY primitive_topology = D3D11_PRIMITIVE_TOPOLOGY::D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        PrimitiveTopology primitive_topology = PrimitiveTopology::Invalid;
         BlendState blend_state = BlendState::Invalid;
         DepthStencilState depth_stencil_state = DepthStencilState::Invalid;
         RasterizerState rasterizer_state = RasterizerState::Invalid;
-        ID3D11VertexShader* vs = nullptr;
-        ID3D11PixelShader* ps = nullptr;
-        ID3D11InputLayout* input_layout = nullptr;
-        ID3D11Buffer* vs_constant_buffers[NUM_CBUFFER_SLOTS]{};
-        ID3D11Buffer* ps_constant_buffers[NUM_CBUFFER_SLOTS]{};
+        SharedPtr<GpuVertexShader> vs;
+        SharedPtr<GpuPixelShader> ps;
+        SharedPtr<GpuInputLayout> input_layout;
+        SharedPtr<GpuBuffer> vs_constant_buffers[NUM_CBUFFER_SLOTS]{};
+        SharedPtr<GpuBuffer> ps_constant_buffers[NUM_CBUFFER_SLOTS]{};
+        // First constant / num constants of ranged bindings. Zero for bindings of the whole buffer.
+        uint32 vs_constant_buffer_ranges[NUM_CBUFFER_SLOTS][2]{};
+        uint32 ps_constant_buffer_ranges[NUM_CBUFFER_SLOTS][2]{};
+        SharedPtr<GpuBuffer> vertex_buffers[NUM_VERTEX_BUFFER_SLOTS]{};
+        uint32 vertex_buffer_strides[NUM_VERTEX_BUFFER_SLOTS]{};
+        uint32 vertex_buffer_offsets[NUM_VERTEX_BUFFER_SLOTS]{};
+        SharedPtr<GpuBuffer> index_buffer;
+        IndexFormat index_buffer_format = IndexFormat::Invalid;
+        uint32 index_buffer_offset = 0;
+        SharedPtr<GpuShaderResourceView> vs_srvs[NUM_SRV_SLOTS]{};
+        SharedPtr<GpuShaderResourceView> ps_srvs[NUM_SRV_SLOTS]{};
+        SamplerSlots vs_samplers = INVALID_SAMPLERS;
+        SamplerSlots ps_samplers = INVALID_SAMPLERS;
+        Viewport viewport{};
+        bool has_viewport = false;
+        SharedPtr<GpuRenderTargetView> rtv;
+        SharedPtr<GpuDepthStencilView> dsv;
+    };
+
+    /**
+     * Counts the state changes requested through the gfx::Set* functions.
+     * Issued calls reached the backend, skipped ones were filtered because the state was already bound.
+     */
+    struct PipelineStats
+    {
+        uint32 num_calls_issued = 0;
+        uint32 num_calls_skipped = 0;
+        uint32 num_draw_calls = 0;
+        uint32 num_instances = 0;     // Drawn by all draw calls, a non-instanced draw counts as one
     };
 
     void Init(Window* window);
     void Shutdown();
     bool IsValid();
 
-    void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY primitive_topology);
+    // Without device, swap chain, renderer and ImGui. Resources, state changes and draws go to the returned recording backend,
+    // which stays owned by the graphics context.
+    NullGraphicsBackend* InitHeadless();
+    void ShutdownHeadless();
+    bool IsHeadless();
+
+    void SetPrimitiveTopology(PrimitiveTopology primitive_topology);
     void SetBlendState(BlendState state);
     void SetDepthStencilState(DepthStencilState state);
     void SetRasterizerState(RasterizerState state);
-    void SetVertexShader(ID3D11VertexShader* shader);
-    void SetPixelShader(ID3D11PixelShader* shader);
-    void SetInputLayout(ID3D11InputLayout* input_layout);
-    void SetConstantBuffer(ID3D11Buffer* buffer, int slot);
-
-    inline ComPtr<ID3D11Device3> device = nullptr;
-    inline ComPtr<ID3D11DeviceContext3> device_context = nullptr;
-    inline ComPtr<IDXGISwapChain3> swapchain = nullptr;
-    inline RenderStateCache* render_state_cache = nullptr;
+    void SetVertexShader(GpuVertexShader* shader);
+    void SetPixelShader(GpuPixelShader* shader);
+    void SetInputLayout(GpuInputLayout* input_layout);
+    void SetConstantBuffer(GpuBuffer* buffer, int slot);
+    void SetConstantBuffer(GpuBuffer* buffer, int slot, uint32 first_constant, uint32 num_constants);
+    void SetVertexBuffer(GpuBuffer* buffer, uint32 slot, uint32 stride, uint32 offset = 0);
+    void SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset = 0);
+    void SetShaderResource(GpuShaderResourceView* srv, uint32 slot);
+    void SetVSShaderResource(GpuShaderResourceView* srv, uint32 slot);
+    void SetPSShaderResource(GpuShaderResourceView* srv, uint32 slot);
+    void SetSampler(SamplerState state, uint32 slot);
+    void SetViewport(const Viewport& viewport);
+    void SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv);
+
+    // Not state changes, always reach the backend. clear_flags is a combination of GpuClear::Flags.
+    void ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4]);
+    void ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth = 1.0f, uint8 stencil = 0);
+
+    void DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex);
+    void DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 start_instance);
+
+    // Forget the tracked state, e.g. after somebody else touched the device context.
+    void InvalidatePipelineState();
+
+    // Called once per frame. Moves the current counters to last_frame_stats.
+    void ResetPipelineStats();
+
+    // Called after presenting a frame. Presenting unbinds the back buffer, so the tracked render targets are reset.
+    void EndFrame();
+
+    inline GraphicsBackend* backend = nullptr;
     inline ResourceManager* resource_manager = nullptr;
     inline IRenderer* renderer = nullptr;
     inline PipelineState pipeline_state;
+    inline PipelineStats pipeline_stats;
+    inline PipelineStats last_frame_stats;
+    inline ConstantBufferRing* constant_buffer_ring = nullptr;
+    inline uint64 frame_index = 0;
 
     // Scene Data
     inline Camera camera;
@@ -0,0 +1,185 @@
+#pragma once
+
+// Values match DXGI_FORMAT, so the D3D11 backend passes them through and cooked textures store them as they are
+enum class GpuFormat : uint32
+{
+    Unknown = 0,
+    R32G32B32A32_Float = 2,
+    R32G32B32A32_UInt = 3,
+    R32G32B32A32_SInt = 4,
+    R32G32B32_Float = 6,
+    R32G32B32_UInt = 7,
+    R32G32B32_SInt = 8,
+    R16G16B16A16_UNorm = 11,
+    R32G32_Float = 16,
+    R32G32_UInt = 17,
+    R32G32_SInt = 18,
+    R8G8B8A8_UNorm = 28,
+    R8G8B8A8_UNorm_SRGB = 29,
+    R16G16_Float = 34,
+    R16G16_SNorm = 37,
+    R32_Typeless = 39,
+    D32_Float = 40,
+    R32_Float = 41,
+    R32_UInt = 42,
+    R32_SInt = 43,
+    D24_UNorm_S8_UInt = 45,
+    R16_UInt = 57,
+    BC1_UNorm = 71,
+    BC1_UNorm_SRGB = 72,
+    BC3_UNorm = 77,
+    BC3_UNorm_SRGB = 78,
+    BC4_UNorm = 80,
+    BC5_UNorm = 83,
+    BC7_UNorm = 98,
+    BC7_UNorm_SRGB = 99
+};
+
+enum class GpuUsage : uint8
+{
+    Default,    // Written by the GPU or through GraphicsBackend::Update*()
+    Immutable,  // Initial data only
+    Dynamic     // Written by the CPU through GraphicsBackend::Map()
+};
+
+namespace GpuBind
+{
+    enum Flags : uint32
+    {
+        None = 0,
+        VertexBuffer = 1 << 0,
+        IndexBuffer = 1 << 1,
+        ConstantBuffer = 1 << 2,
+        ShaderResource = 1 << 3,
+        RenderTarget = 1 << 4,
+        DepthStencil = 1 << 5
+    };
+}
+
+namespace GpuClear
+{
+    enum Flags : uint32
+    {
+        Depth = 1 << 0,
+        Stencil = 1 << 1
+    };
+}
+
+enum class MapType : uint8
+{
+    WriteDiscard,       // The previous contents are gone, the driver renames the buffer if the GPU still reads it
+    WriteNoOverwrite    // The previous contents stay, only ranges which no pending draw reads may be written
+};
+
+enum class IndexFormat : uint8
+{
+    UInt16,
+    UInt32,
+    Invalid
+};
+
+enum class PrimitiveTopology : uint8
+{
+    TriangleList,
+    LineList,
+    Invalid
+};
+
+struct GpuBufferDesc
+{
+    uint32 size = 0;
+    GpuUsage usage = GpuUsage::Default;
+    uint32 bind_flags = GpuBind::None;
+    uint32 structure_stride = 0;    // Structured buffer of elements of this size, unless zero
+};
+
+struct GpuTextureDesc
+{
+    uint32 width = 0;
+    uint32 height = 0;
+    uint32 num_mips = 1;            // Zero allocates the full chain
+    uint32 array_size = 1;          // Six per cube
+    GpuFormat format = GpuFormat::Unknown;
+    GpuUsage usage = GpuUsage::Default;
+    uint32 bind_flags = GpuBind::ShaderResource;
+    bool is_cube = false;
+    bool generates_mips = false;    // Filled by GraphicsBackend::GenerateMips(), requires GpuBind::RenderTarget
+};
+
+enum class GpuViewDimension : uint8
+{
+    Texture2D,
+    Texture2DArray,
+    TextureCube
+};
+
+// Shader resource, render target and depth stencil views of textures. Shader resource views see all mips.
+struct GpuViewDesc
+{
+    GpuFormat format = GpuFormat::Unknown;   // Unknown views the texture in its own format
+    GpuViewDimension dimension = GpuViewDimension::Texture2D;
+    uint32 first_array_slice = 0;           // Texture2DArray only
+    uint32 array_size = 1;
+};
+
+struct Viewport
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float min_depth = 0.0f;
+    float max_depth = 1.0f;
+
+    bool operator==(const Viewport& other) const = default;
+};
+
+struct VertexElement
+{
+    const char* semantic_name = nullptr;
+    uint32 semantic_index = 0;
+    GpuFormat format = GpuFormat::Unknown;
+    uint32 slot = 0;
+    uint32 offset = 0;
+    bool is_per_instance = false;   // Stepped once per instance instead of once per vertex
+};
+
+/**
+ * Device objects created by the GraphicsBackend. The backends derive their own objects from these, the renderer only sees
+ * the engine side descriptions. Owned through SharedPtr, bound and recorded by raw pointer.
+ */
+class GpuObject : public std::enable_shared_from_this<GpuObject>
+{
+public:
+    virtual ~GpuObject() = default;
+
+    // Shows up in graphics debuggers and in the live object report of the debug device. Objects without a device ignore it.
+    virtual void SetDebugName(const String& name) {}
+};
+
+class GpuBuffer : public GpuObject
+{
+public:
+    explicit GpuBuffer(const GpuBufferDesc& desc) : desc_(desc) {}
+    const GpuBufferDesc& GetDesc() const { return desc_; }
+
+private:
+    GpuBufferDesc desc_;
+};
+
+class GpuTexture : public GpuObject
+{
+public:
+    explicit GpuTexture(const GpuTextureDesc& desc) : desc_(desc) {}
+    const GpuTextureDesc& GetDesc() const { return desc_; }
+
+private:
+    GpuTextureDesc desc_;
+};
+
+class GpuShaderResourceView : public GpuObject {};
+class GpuRenderTargetView : public GpuObject {};
+class GpuDepthStencilView : public GpuObject {};
+class GpuVertexShader : public GpuObject {};
+class GpuPixelShader : public GpuObject {};
+class GpuInputLayout : public GpuObject {};
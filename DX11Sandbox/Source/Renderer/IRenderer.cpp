@@ -1,9 +1,11 @@
 #include "IRenderer.h"
 
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/GraphicsContext.h"
 
 void IRenderer::Present()
 {
     // Swap front buffer with backbuffer
-    DX11_VERIFY(gfx::swapchain->Present(1, 0));
+    gfx::backend->Present();
+    gfx::EndFrame();
 }
@@ -1,26 +1,43 @@
 #include "Renderer/IndexBuffer.h"
 
-#include <d3d11.h>
-
-#include "Renderer/DX11Util.h"
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/GraphicsContext.h"
 
-IndexBuffer::IndexBuffer(uint16* indices, uint32 num_indices)
+IndexBuffer::IndexBuffer(const uint16* indices, uint32 num_indices)
+    : num_(num_indices), format_(IndexFormat::UInt16)
+{
+    Create(indices, sizeof(uint16));
+}
+
+IndexBuffer::IndexBuffer(const uint32* indices, uint32 num_indices)
     : num_(num_indices)
 {
-    D3D11_BUFFER_DESC index_buffer_desc = {};
-    index_buffer_desc.Usage = D3D11_USAGE_DEFAULT;   // Read / Write access
-    index_buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    index_buffer_desc.ByteWidth = sizeof(uint16) * num_indices;
-    index_buffer_desc.CPUAccessFlags = 0;
+    // Half the memory and index fetch bandwidth
+    const uint32 max_index = num_indices > 0 ? *std::max_element(indices, indices + num_indices) : 0;
+    if (max_index < MAX_UINT16_VERTICES)
+    {
+        std::vector<uint16> narrow_indices(num_indices);
+        std::transform(indices, indices + num_indices, narrow_indices.begin(), [](uint32 index) { return (uint16) index; });
+        format_ = IndexFormat::UInt16;
+        Create(narrow_indices.data(), sizeof(uint16));
+    }
+    else
+    {
+        format_ = IndexFormat::UInt32;
+        Create(indices, sizeof(uint32));
+    }
+}
 
-    D3D11_SUBRESOURCE_DATA subresource_data = {};
-    subresource_data.pSysMem = indices;
-    DX11_VERIFY(gfx::device->CreateBuffer(&index_buffer_desc, &subresource_data, &index_buffer_));
+void IndexBuffer::Create(const void* indices, uint32 bytes_per_index)
+{
+    GpuBufferDesc index_buffer_desc = {};
+    index_buffer_desc.size = bytes_per_index * num_;
+    index_buffer_desc.usage = GpuUsage::Default;   // Read / Write access
+    index_buffer_desc.bind_flags = GpuBind::IndexBuffer;
+    index_buffer_ = gfx::backend->CreateBuffer(index_buffer_desc, indices);
 }
 
 void IndexBuffer::Bind()
 {
-    gfx::device_context->IASetIndexBuffer(index_buffer_.Get(), DXGI_FORMAT::DXGI_FORMAT_R16_UINT, 0);
+    gfx::SetIndexBuffer(index_buffer_.get(), format_, 0);
 }
-
@@ -1,22 +1,31 @@
 #pragma once
-#include <d3d11.h>
-
-#include "Renderer/DX11Types.h"
+#include "Renderer/GraphicsTypes.h"
 
 class IndexBuffer
 {
 public:
-    IndexBuffer(uint16* indices, uint32 num_indices);
+    // Meshes with at most this many vertices can be drawn with 16 bit indices, relative to their base vertex
+    static constexpr uint32 MAX_UINT16_VERTICES = 1u << 16;
+
+    IndexBuffer(const uint16* indices, uint32 num_indices);
+
+    // Stored as 16 bit indices if all of them fit
+    IndexBuffer(const uint32* indices, uint32 num_indices);
 
     void Bind();
 
     inline uint32 GetNum() { return num_; };
+    IndexFormat GetFormat() const { return format_; }
 
-    const ComPtr<ID3D11Buffer>& GetNativePtr() const
+    const SharedPtr<GpuBuffer>& GetNativePtr() const
     {
         return index_buffer_;
     }
 
     uint32 num_ = 0;
-    ComPtr<ID3D11Buffer> index_buffer_;
+    IndexFormat format_ = IndexFormat::UInt16;
+    SharedPtr<GpuBuffer> index_buffer_;
+
+private:
+    void Create(const void* indices, uint32 bytes_per_index);
 };
@@ -0,0 +1,204 @@
+#include "Renderer/Instancing.h"
+
+#include "Renderer/Culling.h"
+#include "Renderer/GraphicsBackend.h"
+#include "Renderer/GraphicsContext.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/VertexBuffer.h"
+
+namespace
+{
+    bool HasSameGeometry(const StaticMesh& a, const StaticMesh& b)
+    {
+        return a.index_buffer == b.index_buffer && a.pos == b.pos &&
+            a.start_idx == b.start_idx && a.num_indices == b.num_indices && a.offset == b.offset;
+    }
+
+    Handle<Material> GetMaterialHandle(const StaticMesh& mesh)
+    {
+        return mesh.model != nullptr ? mesh.model->materials_[mesh.material_slot] : Handle<Material>();
+    }
+
+    bool IsInstanceable(const StaticMesh& mesh, InstanceBatchMode mode)
+    {
+        switch (mode)
+        {
+        case InstanceBatchMode::Disabled:
+            return false;
+        case InstanceBatchMode::Forward:
+        {
+            const Material* material = gfx::resource_manager->materials.Get(GetMaterialHandle(mesh));
+            return material != nullptr && material->SupportsInstancing();
+        }
+        case InstanceBatchMode::DepthOnly:
+            return true;
+        default:
+            CHECK_NO_ENTRY();
+        }
+
+        return false;
+    }
+}
+
+InstanceBuffer::InstanceBuffer(uint32 capacity)
+{
+    CHECK(capacity > 0);
+
+    is_no_overwrite_supported_ = gfx::backend->SupportsNoOverwriteOnShaderResources();
+
+    if (is_no_overwrite_supported_ == false)
+    {
+        LOG_WARN("Mapping shader resources without overwrite is not supported. Every instance upload renames the buffer.");
+    }
+
+    Create(capacity);
+}
+
+void InstanceBuffer::Create(uint32 capacity)
+{
+    capacity_ = capacity;
+    offset_ = 0;
+    is_discard_pending_ = true;
+
+    GpuBufferDesc desc =
+    {
+        .size = capacity_ * (uint32) sizeof(Mat4),
+        .usage = GpuUsage::Dynamic,
+        .bind_flags = GpuBind::ShaderResource,
+        .structure_stride = sizeof(Mat4)
+    };
+    buffer_ = gfx::backend->CreateBuffer(desc);
+    buffer_->SetDebugName("InstanceBuffer");
+
+    srv_ = gfx::backend->CreateStructuredBufferView(buffer_.get());
+
+    // Never changes, the start instance of the draw call does the offsetting
+    std::vector<uint32> indices(capacity_);
+    for (uint32 i = 0; i < capacity_; ++i)
+    {
+        indices[i] = i;
+    }
+
+    GpuBufferDesc indices_desc =
+    {
+        .size = capacity_ * (uint32) sizeof(uint32),
+        .usage = GpuUsage::Immutable,
+        .bind_flags = GpuBind::VertexBuffer
+    };
+    instance_indices_ = gfx::backend->CreateBuffer(indices_desc, indices.data());
+    instance_indices_->SetDebugName("InstanceBuffer indices");
+}
+
+void InstanceBuffer::BeginFrame()
+{
+    offset_ = 0;
+    is_discard_pending_ = true;
+}
+
+uint32 InstanceBuffer::Allocate(std::span<const Mat4> world_matrices)
+{
+    const uint32 num_instances = (uint32) world_matrices.size();
+    CHECK(num_instances > 0);
+
+    if (num_instances > capacity_)
+    {
+        // Draws which were already issued keep the old buffer alive until the GPU is done with them
+        const uint32 new_capacity = std::max(num_instances, capacity_ * 2);
+        LOG_WARN("InstanceBuffer ran out of space ({} instances). Growing to {}.", capacity_, new_capacity);
+        Create(new_capacity);
+    }
+    else if (offset_ + num_instances > capacity_ || is_no_overwrite_supported_ == false)
+    {
+        // Renaming the buffer doesn't affect draws which were already issued, they still see the old contents
+        offset_ = 0;
+        is_discard_pending_ = true;
+    }
+
+    const MapType map_type = is_discard_pending_ ? MapType::WriteDiscard : MapType::WriteNoOverwrite;
+    is_discard_pending_ = false;
+
+    Mat4* mapped = static_cast<Mat4*>(gfx::backend->Map(buffer_.get(), map_type));
+    std::memcpy(mapped + offset_, world_matrices.data(), world_matrices.size_bytes());
+    gfx::backend->Unmap(buffer_.get());
+
+    const uint32 first_instance = offset_;
+    offset_ += num_instances;
+    return first_instance;
+}
+
+void InstanceBuffer::Bind() const
+{
+    gfx::SetVSShaderResource(srv_.get(), SRV_SLOT);
+    gfx::SetVertexBuffer(instance_indices_.get(), VertexBufferSlots::INSTANCE_INDEX, sizeof(uint32));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void InstanceBatchList::Build(const RenderQueue& queue, std::span<const Mat4> item_world_matrices, InstanceBatchMode mode,
+    const VisibilityBits* visibility)
+{
+    CHECK(item_world_matrices.size() == queue.items_.size());
+    Clear();
+
+    for (size_t idx : queue.item_indices_)
+    {
+        if (visibility != nullptr && visibility->IsSet((uint32) idx) == false)
+        {
+            continue;
+        }
+
+        const StaticMesh& mesh = *queue.items_[idx].mesh;
+        if (batches_.empty() == false && batches_.back().is_instanced && CanInstance(*batches_.back().mesh, mesh, mode))
+        {
+            ++batches_.back().num_instances;
+        }
+        else
+        {
+            batches_.push_back(InstanceBatch
+                {
+                    .mesh = &mesh,
+                    .first_instance = (uint32) world_matrices_.size(),
+                    .num_instances = 1,
+                    .is_instanced = IsInstanceable(mesh, mode)
+                });
+        }
+
+        world_matrices_.push_back(item_world_matrices[idx]);
+        instance_meshes_.push_back(&mesh);
+    }
+}
+
+void InstanceBatchList::Clear()
+{
+    batches_.clear();
+    world_matrices_.clear();
+    instance_meshes_.clear();
+}
+
+InstancingStats InstanceBatchList::GetStats() const
+{
+    return InstancingStats
+    {
+        .num_items = (uint32) world_matrices_.size(),
+        .num_draw_calls = (uint32) batches_.size()
+    };
+}
+
+bool InstanceBatchList::CanInstance(const StaticMesh& a, const StaticMesh& b, InstanceBatchMode mode)
+{
+    switch (mode)
+    {
+    case InstanceBatchMode::Disabled:
+        return false;
+    case InstanceBatchMode::Forward:
+        return HasSameGeometry(a, b) && a.normals == b.normals && a.uv == b.uv && a.tangents == b.tangents && a.attributes == b.attributes &&
+            GetMaterialHandle(a) == GetMaterialHandle(b);
+    case InstanceBatchMode::DepthOnly:
+        return HasSameGeometry(a, b);
+    default:
+        CHECK_NO_ENTRY();
+    }
+
+    return false;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <span>
+
+#include "Renderer/GraphicsTypes.h"
+
+class RenderQueue;
+class VisibilityBits;
+struct StaticMesh;
+
+/**
+ * Dynamic structured buffer with the world matrices of instanced draws, sub-allocated linearly over the course of a frame
+ * like the ConstantBufferRing.
+ *
+ * Shaders can't see the start instance of a draw call through SV_InstanceID, so a static per instance vertex stream
+ * (0, 1, 2, ...) is bound next to it. Per instance vertex data is offset by the start instance, so the shader reads
+ * the index of its matrix from the INSTANCE_INDEX semantic and the draw call only has to pass the first instance.
+ */
+class InstanceBuffer
+{
+public:
+    InstanceBuffer(uint32 capacity = DEFAULT_CAPACITY);
+
+    void BeginFrame();
+
+    // Copies the (transposed) matrices into the buffer and returns the index of the first one. Call Bind() before drawing.
+    uint32 Allocate(std::span<const Mat4> world_matrices);
+
+    // Binds the structured buffer and the instance index stream for the vertex shader
+    void Bind() const;
+
+    uint32 GetCapacity() const { return capacity_; }
+
+    static constexpr uint32 SRV_SLOT = 8;
+    static constexpr uint32 DEFAULT_CAPACITY = 64 * 1024;
+
+private:
+    void Create(uint32 capacity);
+
+    SharedPtr<GpuBuffer> buffer_;
+    SharedPtr<GpuShaderResourceView> srv_;
+    SharedPtr<GpuBuffer> instance_indices_;
+    uint32 capacity_ = 0;
+    uint32 offset_ = 0;
+    bool is_discard_pending_ = true;
+    bool is_no_overwrite_supported_ = false;
+};
+
+enum class InstanceBatchMode
+{
+    Disabled,   // Every item gets its own non-instanced batch
+    Forward,    // Same buffers, index range and material
+    DepthOnly   // Same positions and index range, materials are ignored
+};
+
+/**
+ * Consecutive items of a sorted queue which are drawn with a single draw call.
+ */
+struct InstanceBatch
+{
+    const StaticMesh* mesh = nullptr;   // Any of the instances, they only differ in their world matrix
+    uint32 first_instance = 0;          // Into InstanceBatchList::world_matrices_
+    uint32 num_instances = 0;
+    bool is_instanced = false;          // Otherwise the batch contains a single item which uses the per object cbuffer
+};
+
+struct InstancingStats
+{
+    uint32 num_items = 0;
+    uint32 num_draw_calls = 0;
+
+    InstancingStats& operator+=(const InstancingStats& other)
+    {
+        num_items += other.num_items;
+        num_draw_calls += other.num_draw_calls;
+        return *this;
+    }
+};
+
+/**
+ * Collapses runs of identical draws in a sorted RenderQueue into instanced batches.
+ * The sort key groups items by program, material and mesh, so identical draws end up next to each other.
+ * Batches only merge neighbors, so the draw order of the queue is preserved (instances are rasterized in order).
+ */
+class InstanceBatchList
+{
+public:
+    // item_world_matrices are indexed like the items of the queue and already transposed for the GPU.
+    // Items which are not set in visibility are skipped.
+    void Build(const RenderQueue& queue, std::span<const Mat4> item_world_matrices, InstanceBatchMode mode,
+        const VisibilityBits* visibility = nullptr);
+    void Clear();
+
+    InstancingStats GetStats() const;
+
+    static bool CanInstance(const StaticMesh& a, const StaticMesh& b, InstanceBatchMode mode);
+
+    std::vector<InstanceBatch> batches_;
+    std::vector<Mat4> world_matrices_;
+    std::vector<const StaticMesh*> instance_meshes_;    // Indexed like world_matrices_, for culling the instances of a batch
+};
@@ -31,12 +31,51 @@ Material::Material(const MaterialDesc& desc)
         });
     }
 
+    // Only the vertex shader sees the vertex format, so the pixel shaders don't get extra permutations
+    std::vector<ShaderMacro> vs_defines = defines;
+    if (desc.vertex_format != VertexFormat::Float)
+    {
+        static constexpr const char* PACKED_ATTRIBUTES_MACRO_NAME = "PACKED_ATTRIBUTES";
+
+        vs_defines.push_back({
+            .name = PACKED_ATTRIBUTES_MACRO_NAME,
+            .value = ENABLE
+        });
+    }
+
+    if (desc.vertex_format == VertexFormat::PackedQuantized)
+    {
+        static constexpr const char* QUANTIZED_POSITIONS_MACRO_NAME = "QUANTIZED_POSITIONS";
+
+        vs_defines.push_back({
+            .name = QUANTIZED_POSITIONS_MACRO_NAME,
+            .value = ENABLE
+        });
+    }
+
     vs_ = gfx::resource_manager->vertex_shaders.GetHandle({
             .path = desc.vs_path,
-            .defines = defines
+            .defines = vs_defines
         });
     CHECK(vs_.IsValid());
 
+    if (desc.supports_instancing)
+    {
+        static constexpr const char* INSTANCED_MACRO_NAME = "INSTANCED";
+
+        std::vector<ShaderMacro> instanced_defines = vs_defines;
+        instanced_defines.push_back({
+            .name = INSTANCED_MACRO_NAME,
+            .value = ENABLE
+        });
+
+        vs_instanced_ = gfx::resource_manager->vertex_shaders.GetHandle({
+                .path = desc.vs_path,
+                .defines = instanced_defines
+            });
+        CHECK(vs_instanced_.IsValid());
+    }
+
     ps_ = gfx::resource_manager->pixel_shaders.GetHandle({
             .path = desc.ps_path,
             .defines = defines
@@ -52,7 +91,7 @@ Material::Material(const MaterialDesc& desc)
         if (was_inserted == true)
         {
             cbuffers_.push_back(MakeUnique<ConstantBuffer>(binding_desc));
-            SetDebugName(cbuffers_[cbuffers_.size() - 1]->buffer_.Get(), desc.vs_path + binding_desc.name);
+            cbuffers_[cbuffers_.size() - 1]->buffer_->SetDebugName(desc.vs_path + binding_desc.name);
         }
     }
 
@@ -63,7 +102,7 @@ Material::Material(const MaterialDesc& desc)
         if (was_inserted)
         {
             cbuffers_.push_back(MakeUnique<ConstantBuffer>(binding_desc));
-            SetDebugName(cbuffers_[cbuffers_.size() - 1]->buffer_.Get(), desc.ps_path + binding_desc.name);
+            cbuffers_[cbuffers_.size() - 1]->buffer_->SetDebugName(desc.ps_path + binding_desc.name);
         }
     }
 
@@ -88,16 +127,16 @@ Material::Material(const MaterialDesc& desc)
     }
 }
 
-void Material::Bind()
+void Material::Bind(bool is_instanced)
 {
-    gfx::resource_manager->vertex_shaders.Get(vs_)->Bind();
+    CHECK(is_instanced == false || SupportsInstancing());
+    gfx::resource_manager->vertex_shaders.Get(is_instanced ? vs_instanced_ : vs_)->Bind();
     gfx::resource_manager->pixel_shaders.Get(ps_)->Bind();
 
     for(const auto& cbuffer : cbuffers_)
     {
         cbuffer->Upload();
-        gfx::device_context->VSSetConstantBuffers(cbuffer->slot_, 1, cbuffer->buffer_.GetAddressOf());
-        gfx::device_context->PSSetConstantBuffers(cbuffer->slot_, 1, cbuffer->buffer_.GetAddressOf());
+        gfx::SetConstantBuffer(cbuffer->buffer_.get(), cbuffer->slot_);
     }
 
     for(const auto& [key, val] : texture_parameters_)
@@ -105,8 +144,7 @@ void Material::Bind()
         Texture* tex = gfx::resource_manager->textures.Get(val.tex);
         if(tex != nullptr)
         {
-            gfx::device_context->VSSetShaderResources(val.slot, 1 /*num views*/, tex->srv_.GetAddressOf());
-            gfx::device_context->PSSetShaderResources(val.slot, 1 /*num views*/, tex->srv_.GetAddressOf());
+            gfx::SetShaderResource(tex->srv_.get(), val.slot);
         }
     }
 
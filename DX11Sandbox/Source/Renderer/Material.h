@@ -4,6 +4,7 @@
 #include "Renderer/RenderState.h"
 #include "Renderer/Shader.h"
 #include "Renderer/Texture.h"
+#include "Renderer/VertexBuffer.h"
 
 static inline constexpr uint32 DIFFUSE_TEX_BIT = 1 << 0;
 static inline constexpr uint32 NORMAL_TEX_BIT = 1 << 1;
@@ -26,6 +27,8 @@ struct MaterialDesc
     bool is_alpha_cutoff = false;
     float alpha_cutoff_val = 0.0f;
     bool is_lit = true;
+    bool supports_instancing = false;  // The vertex shader has an INSTANCED variant
+    VertexFormat vertex_format = VertexFormat::Float;  // Packed formats need the PACKED_ATTRIBUTES and QUANTIZED_POSITIONS variants
 
     bool operator==(const MaterialDesc& other) const
     {
@@ -36,11 +39,13 @@ struct MaterialDesc
             depth_stencil_state == other.depth_stencil_state &&
             is_alpha_cutoff == other.is_alpha_cutoff &&
             alpha_cutoff_val == other.alpha_cutoff_val &&
-            is_lit == other.is_lit;
+            is_lit == other.is_lit &&
+            supports_instancing == other.supports_instancing &&
+            vertex_format == other.vertex_format;
     }
 };
 MAKE_HASHABLE(MaterialDesc, t.vs_path, t.ps_path, t.rasterizer_state, t.blend_state, t.depth_stencil_state,
-    t.is_alpha_cutoff, t.alpha_cutoff_val, t.is_lit);
+    t.is_alpha_cutoff, t.alpha_cutoff_val, t.is_lit, t.supports_instancing, t.vertex_format);
 
 class Material
 {
@@ -48,7 +53,9 @@ public:
     Material(const MaterialDesc& desc);
     ~Material() = default;
 
-    virtual void Bind();
+    // The instanced variant reads the world matrices from the bound InstanceBuffer instead of the per object cbuffer
+    virtual void Bind(bool is_instanced = false);
+    bool SupportsInstancing() const { return vs_instanced_.IsValid(); }
 
     void SetTexture(const std::string& param_name, Handle<Texture> texture);
     void SetParam(const std::string& param_name, Vec3 val);
@@ -74,6 +81,7 @@ public:
 
 public:
     Handle<VertexShader> vs_;
+    Handle<VertexShader> vs_instanced_;     // Only valid if the material supports instancing
     Handle<PixelShader> ps_;
 
     RasterizerState rasterizer_state_;
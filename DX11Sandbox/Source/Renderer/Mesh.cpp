@@ -4,9 +4,10 @@
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/GraphicsContext.h"
 
-void StaticMesh::Bind() const
+void StaticMesh::Bind(bool is_instanced) const
 {
     if (index_buffer != nullptr)
     {
@@ -33,16 +34,50 @@ void StaticMesh::Bind() const
         uv->Bind();
     }
 
+    if (attributes)
+    {
+        attributes->Bind();
+    }
+
     // TODO: ... Why do I store the materials in the model again?
     if(Material* material = gfx::resource_manager->materials.Get(model->materials_[material_slot]))
     {
-        material->Bind();
+        material->Bind(is_instanced);
     }
 }
 
 void StaticMesh::Render() const
 {
-    gfx::device_context->DrawIndexed(num_indices, start_idx, offset);
+    gfx::DrawIndexed(num_indices, start_idx, offset);
+}
+
+void StaticMesh::RenderInstanced(uint32 first_instance, uint32 num_instances) const
+{
+    gfx::DrawIndexedInstanced(num_indices, num_instances, start_idx, offset, first_instance);
+}
+
+StaticMesh* StaticMesh::SelectLod(float projected_radius, float max_error_pixels)
+{
+    // The errors are in model space, the bounding sphere relates them to pixels
+    const float radius = bounds.GetExtents().Length();
+    if (num_lods == 0 || radius <= 0.0f)
+    {
+        return this;
+    }
+
+    const float max_error = max_error_pixels * radius / projected_radius;
+    StaticMesh* selected = this;
+    for (uint32 i = 0; i < num_lods; ++i)
+    {
+        StaticMesh& lod_mesh = model->lod_meshes_[first_lod + i];
+        if (lod_mesh.lod_error > max_error)
+        {
+            break;
+        }
+        selected = &lod_mesh;
+    }
+
+    return selected;
 }
 
 SharedPtr<Model> MeshImporter::LoadFromFile(const MeshFileDesc& desc)
@@ -152,6 +187,7 @@ SharedPtr<Model> MeshImporter::LoadFromFile(const MeshFileDesc& desc)
 
             num_model_indices += num_mesh_indices;
 
+            const uint32 first_mesh_vertex = num_model_vertices;
             for (uint32 vertex_id = 0; vertex_id < ai_mesh->mNumVertices; ++vertex_id)
             {
                 const aiVector3D& vertex = ai_mesh->mVertices[vertex_id];
@@ -172,6 +208,7 @@ SharedPtr<Model> MeshImporter::LoadFromFile(const MeshFileDesc& desc)
             mesh.offset = 0;
             mesh.num_indices = num_mesh_indices;
             mesh.material_slot = ai_mesh->mMaterialIndex;
+            mesh.bounds = Box(vertex_data.pos.data() + first_mesh_vertex, ai_mesh->mNumVertices);
             mesh.model = model.get();
 
             model->meshes_.push_back(mesh);
@@ -183,21 +220,20 @@ SharedPtr<Model> MeshImporter::LoadFromFile(const MeshFileDesc& desc)
         }
     }
 
-    D3D11_BUFFER_DESC cbuffer_desc = {};
-    cbuffer_desc.Usage = D3D11_USAGE_DEFAULT;   // Read / Write access
-    cbuffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    cbuffer_desc.ByteWidth = sizeof(CBufferPerObject);
-    cbuffer_desc.CPUAccessFlags = 0;
-    DX11_VERIFY(gfx::device->CreateBuffer(&cbuffer_desc, nullptr, &model->cbuffer_per_object));
+    GpuBufferDesc cbuffer_desc = {};
+    cbuffer_desc.size = sizeof(CBufferPerObject);
+    cbuffer_desc.usage = GpuUsage::Default;   // Read / Write access
+    cbuffer_desc.bind_flags = GpuBind::ConstantBuffer;
+    model->cbuffer_per_object = gfx::backend->CreateBuffer(cbuffer_desc);
 
     model->index_buffer = MakeShared<IndexBuffer>(vertex_data.indices.data(), (uint32) vertex_data.indices.size());
-    SetDebugName(model->index_buffer->GetNativePtr().Get(), desc.path + " index");
+    model->index_buffer->GetNativePtr()->SetDebugName(desc.path + " index");
     model->pos = MakeShared<VertexBuffer>(vertex_data.pos.data(), (uint32) vertex_data.pos.size(), sizeof(Vec3), VertexBufferSlots::POS);
-    SetDebugName(model->pos->GetNativePtr().Get(), desc.path + " pos");
+    model->pos->GetNativePtr()->SetDebugName(desc.path + " pos");
     model->normals = MakeShared<VertexBuffer>(vertex_data.normals.data(), (uint32) vertex_data.normals.size(), sizeof(Vec3), VertexBufferSlots::NORMALS);
-    SetDebugName(model->normals->GetNativePtr().Get(), desc.path + " normals");
+    model->normals->GetNativePtr()->SetDebugName(desc.path + " normals");
     model->uv = MakeShared<VertexBuffer>(vertex_data.uvs.data(), (uint32) vertex_data.uvs.size(), sizeof(Vec2), VertexBufferSlots::TEX_COORD);
-    SetDebugName(model->uv->GetNativePtr().Get(), desc.path + " uv0");
+    model->uv->GetNativePtr()->SetDebugName(desc.path + " uv0");
 
     for (StaticMesh& mesh : model->meshes_)
     {
@@ -210,13 +246,71 @@ SharedPtr<Model> MeshImporter::LoadFromFile(const MeshFileDesc& desc)
     return model;
 }
 
-void Model::Bind()
+SharedPtr<Model> Model::CreateInstance() const
+{
+    SharedPtr<Model> instance = MakeShared<Model>();
+    instance->materials_ = materials_;
+    instance->meshes_ = meshes_;
+    instance->lod_meshes_ = lod_meshes_;
+    for (StaticMesh& mesh : instance->meshes_)
+    {
+        mesh.model = instance.get();
+    }
+    for (StaticMesh& mesh : instance->lod_meshes_)
+    {
+        mesh.model = instance.get();
+    }
+
+    instance->transform = transform;
+    instance->position_dequantization = position_dequantization;
+    instance->index_buffer = index_buffer;
+    instance->pos = pos;
+    instance->uv = uv;
+    instance->normals = normals;
+    instance->tangents = tangents;
+    instance->attributes = attributes;
+    instance->clusters = clusters;
+
+    if (cbuffer_per_object != nullptr)
+    {
+        instance->cbuffer_per_object = gfx::backend->CreateBuffer(cbuffer_per_object->GetDesc());
+    }
+
+    return instance;
+}
+
+Mat4 Model::GetVertexWorldMatrix() const
 {
-    per_object_data.mat_world = transform.GetWorldMatrix().Transpose();
-    gfx::device_context->UpdateSubresource(cbuffer_per_object.Get(), 0, nullptr, &per_object_data, 0, 0);
+    return position_dequantization * transform.GetWorldMatrix();
+}
 
+void Model::Bind()
+{
     static constexpr int CBUFFER_SLOT_PER_OBJECT = 2;
-    gfx::SetConstantBuffer(cbuffer_per_object.Get(), CBUFFER_SLOT_PER_OBJECT);
+
+    // The same model is bound once per view (shadow cascades, cube faces, main pass, ...), but only uploaded once per frame.
+    if (gfx::constant_buffer_ring->IsSupported())
+    {
+        if (gfx::constant_buffer_ring->IsValid(per_object_allocation) == false)
+        {
+            per_object_data.mat_world = GetVertexWorldMatrix().Transpose();
+            per_object_allocation = gfx::constant_buffer_ring->Allocate(&per_object_data, sizeof(CBufferPerObject));
+        }
+
+        gfx::SetConstantBuffer(per_object_allocation.buffer, CBUFFER_SLOT_PER_OBJECT,
+            per_object_allocation.first_constant, per_object_allocation.num_constants);
+    }
+    else
+    {
+        if (per_object_upload_frame != gfx::frame_index)
+        {
+            per_object_data.mat_world = GetVertexWorldMatrix().Transpose();
+            gfx::backend->UpdateBuffer(cbuffer_per_object.get(), &per_object_data);
+            per_object_upload_frame = gfx::frame_index;
+        }
+
+        gfx::SetConstantBuffer(cbuffer_per_object.get(), CBUFFER_SLOT_PER_OBJECT);
+    }
 }
 
 void Model::Render()
@@ -1,5 +1,7 @@
 #pragma once
 #include "Engine/Transform.h"
+#include "Renderer/ClusterCulling.h"
+#include "Renderer/ConstantBufferRing.h"
 #include "Renderer/ConstantBufferTypes.h"
 #include "Renderer/GraphicsContext.h"
 #include "Renderer/IndexBuffer.h"
@@ -11,7 +13,7 @@ struct aiNode;
 struct aiMesh;
 
 struct VertexData {
-    std::vector<uint16> indices;
+    std::vector<uint32> indices;    // Narrowed to 16 bit by the IndexBuffer if they fit
     std::vector<Vec3> pos;
     std::vector<Vec3> normals;
     std::vector<Vec3> tangents;
@@ -148,20 +150,37 @@ struct CubeMeshData
 
 struct StaticMesh
 {
+    static constexpr uint32 MAX_LODS = 4;   // Including the full detail one
+
     void PrepareRender();
-    void Bind() const;
+    void Bind(bool is_instanced = false) const;
     void Render() const;
 
+    // Instances are read from the bound InstanceBuffer, starting at first_instance
+    void RenderInstanced(uint32 first_instance, uint32 num_instances) const;
+
+    // Coarsest LOD whose error stays within max_error_pixels, given the radius of the bounding sphere projected to pixels.
+    // Returns this mesh if it has no LODs.
+    StaticMesh* SelectLod(float projected_radius, float max_error_pixels);
+
     uint32 start_idx = 0;
     uint32 num_indices = 0;
     uint32 offset = 0;
     uint32 material_slot = 0;
+    Box bounds;     // Model space
+    VertexFormat vertex_format = VertexFormat::Float;
 
     SharedPtr<IndexBuffer> index_buffer;
     SharedPtr<VertexBuffer> pos;
     SharedPtr<VertexBuffer> uv;
     SharedPtr<VertexBuffer> normals;
     SharedPtr<VertexBuffer> tangents;
+    SharedPtr<VertexBuffer> attributes;     // Replaces uv, normals and tangents for the packed vertex formats
+    std::span<const MeshCluster> clusters;  // Owned by the model, empty if the mesh can only be culled as a whole
+    uint32 lod = 0;             // Level of this mesh, 0 is full detail
+    float lod_error = 0.0f;     // Model space distance to the full detail surface
+    uint32 first_lod = 0;       // Coarser levels in Model::lod_meshes_, only set on the full detail mesh
+    uint32 num_lods = 0;
     struct Model* model = nullptr;
 };
 
@@ -170,17 +189,30 @@ struct Model
     void Bind();
     void Render();
 
+    // Shares buffers and materials with this model, only the transform and the per object data are separate.
+    // Meshes of both models can be drawn with a single instanced draw call.
+    SharedPtr<Model> CreateInstance() const;
+
+    // World matrix for the vertex shaders, maps quantized positions back to model space first
+    Mat4 GetVertexWorldMatrix() const;
+
     CBufferPerObject per_object_data;
-    ComPtr<ID3D11Buffer> cbuffer_per_object = nullptr;
+    SharedPtr<GpuBuffer> cbuffer_per_object = nullptr;   // Only used if the device does not support constant buffer offsets
+    ConstantBufferAllocation per_object_allocation;
+    uint64 per_object_upload_frame = ~0ull;
     std::vector<Handle<Material>> materials_;
     std::vector<StaticMesh> meshes_;
+    std::vector<StaticMesh> lod_meshes_;    // Coarser levels of meshes_, see StaticMesh::SelectLod()
 
     Transform transform;
+    Mat4 position_dequantization = Mat4::IDENTITY;   // See QuantizePositions()
     SharedPtr<IndexBuffer> index_buffer;
     SharedPtr<VertexBuffer> pos;
     SharedPtr<VertexBuffer> uv;
     SharedPtr<VertexBuffer> normals;
     SharedPtr<VertexBuffer> tangents;
+    SharedPtr<VertexBuffer> attributes;
+    SharedPtr<const std::vector<MeshCluster>> clusters;     // Keeps the clusters of the meshes alive, shared by all instances
 };
 
 struct MeshFileDesc
@@ -0,0 +1,841 @@
+#include "Renderer/MeshOptimization.h"
+
+#include "Renderer/Vertex.h"
+
+namespace
+{
+    // Scoring of Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+    constexpr uint32 SCORING_CACHE_SIZE = 32;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    constexpr uint32 OVERDRAW_CACHE_SIZE = 16;
+
+    // Below that the normals of a cluster spread over more than ~84 degrees from the axis, and the cone hardly ever rejects it
+    constexpr float MIN_CLUSTER_CONE_DOT = 0.1f;
+
+    float CalcVertexScore(int32 cache_position, uint32 num_remaining_triangles)
+    {
+        if (num_remaining_triangles == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cache_position >= 0)
+        {
+            // The vertices of the last triangle get a fixed score, otherwise the next triangle would always reuse its edge
+            if (cache_position < 3)
+            {
+                score = LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                const float scale = 1.0f / (SCORING_CACHE_SIZE - 3);
+                score = std::pow(1.0f - (cache_position - 3) * scale, CACHE_DECAY_POWER);
+            }
+        }
+
+        // Vertices with few triangles left are finished first, so they don't leave lonely triangles behind
+        return score + VALENCE_BOOST_SCALE * std::pow((float) num_remaining_triangles, -VALENCE_BOOST_POWER);
+    }
+
+    /**
+     * FIFO cache without explicit entries. A vertex is cached if it missed within the last cache_size misses.
+     */
+    class FifoCacheSimulator
+    {
+    public:
+        FifoCacheSimulator(uint32 num_vertices, uint32 cache_size)
+            : miss_stamps_(num_vertices, 0), cache_size_(cache_size), num_misses_(cache_size)
+        {
+        }
+
+        // Returns true if the vertex missed
+        bool Access(uint32 vertex)
+        {
+            if (num_misses_ - miss_stamps_[vertex] < cache_size_)
+            {
+                return false;
+            }
+
+            miss_stamps_[vertex] = ++num_misses_;
+            return true;
+        }
+
+        void Flush()
+        {
+            num_misses_ += cache_size_;
+        }
+
+    private:
+        std::vector<uint32> miss_stamps_;
+        uint32 cache_size_ = 0;
+        uint32 num_misses_ = 0;
+    };
+
+    // Sum of squared distances to planes, as the symmetric 4x4 matrix of Garland and Heckbert. Doubles, because the
+    // evaluation subtracts large terms for meshes far away from the origin.
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+        double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+        double a22 = 0.0, a23 = 0.0;
+        double a33 = 0.0;
+        double weight = 0.0;
+
+        void AddPlane(const Vec3& normal, float distance, float plane_weight)
+        {
+            const double x = normal.x, y = normal.y, z = normal.z, d = distance, w = plane_weight;
+            a00 += w * x * x; a01 += w * x * y; a02 += w * x * z; a03 += w * x * d;
+            a11 += w * y * y; a12 += w * y * z; a13 += w * y * d;
+            a22 += w * z * z; a23 += w * z * d;
+            a33 += w * d * d;
+            weight += w;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+            a11 += other.a11; a12 += other.a12; a13 += other.a13;
+            a22 += other.a22; a23 += other.a23;
+            a33 += other.a33;
+            weight += other.weight;
+            return *this;
+        }
+
+        // Weighted mean of the squared distances
+        float Evaluate(const Vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+                a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+                a22 * z * z + 2.0 * a23 * z +
+                a33;
+            return weight > 0.0 ? (float) std::max(error / weight, 0.0) : 0.0f;
+        }
+    };
+
+    Vec3 CalcTriangleNormal(const Vec3& p0, const Vec3& p1, const Vec3& p2)
+    {
+        return Vec3::Cross(Vec3(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z), Vec3(p2.x - p0.x, p2.y - p0.y, p2.z - p0.z));
+    }
+
+    template<typename T>
+    void RemapStream(std::vector<T>& stream, const std::vector<uint32>& remap, uint32 num_vertices)
+    {
+        if (stream.empty())
+        {
+            return;
+        }
+
+        std::vector<T> remapped(num_vertices);
+        for (size_t vertex = 0; vertex < stream.size(); ++vertex)
+        {
+            if (remap[vertex] != ~0u)
+            {
+                remapped[remap[vertex]] = stream[vertex];
+            }
+        }
+        stream.swap(remapped);
+    }
+}
+
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32> indices, uint32 num_vertices, uint32 cache_size)
+{
+    VertexCacheStats stats;
+    stats.num_triangles = (uint32) indices.size() / 3;
+
+    FifoCacheSimulator cache(num_vertices, cache_size);
+    std::vector<bool> is_referenced(num_vertices, false);
+    for (uint32 index : indices)
+    {
+        stats.num_transforms += cache.Access(index) ? 1 : 0;
+        if (is_referenced[index] == false)
+        {
+            is_referenced[index] = true;
+            ++stats.num_vertices;
+        }
+    }
+
+    stats.acmr = stats.num_triangles > 0 ? (float) stats.num_transforms / stats.num_triangles : 0.0f;
+    stats.atvr = stats.num_vertices > 0 ? (float) stats.num_transforms / stats.num_vertices : 0.0f;
+    return stats;
+}
+
+uint32 WeldVertices(VertexData& data, float epsilon)
+{
+    // Adding 0 turns -0 into +0, they compare equal but don't hash the same
+    auto snap = [epsilon](float value)
+    {
+        return (epsilon > 0.0f ? std::round(value / epsilon) * epsilon : value) + 0.0f;
+    };
+    auto snap_vec3 = [&snap](const Vec3& v) { return Vec3(snap(v.x), snap(v.y), snap(v.z)); };
+
+    const uint32 num_vertices = (uint32) data.pos.size();
+    std::unordered_map<VertexPosUVNormalsTangents, uint32> unique_vertices;
+    unique_vertices.reserve(num_vertices);
+
+    std::vector<uint32> remap(num_vertices);
+    for (uint32 vertex = 0; vertex < num_vertices; ++vertex)
+    {
+        VertexPosUVNormalsTangents key;
+        key.pos = snap_vec3(data.pos[vertex]);
+        key.normal = data.normals.empty() ? Vec3::ZERO : snap_vec3(data.normals[vertex]);
+        key.uv = data.uvs.empty() ? Vec2() : Vec2(snap(data.uvs[vertex].x), snap(data.uvs[vertex].y));
+        key.tangent = data.tangents.empty() ? Vec3::ZERO : snap_vec3(data.tangents[vertex]);
+        remap[vertex] = unique_vertices.try_emplace(key, vertex).first->second;
+    }
+
+    for (uint32& index : data.indices)
+    {
+        index = remap[index];
+    }
+
+    return (uint32) unique_vertices.size();
+}
+
+void OptimizeVertexCache(std::span<uint32> indices, uint32 num_vertices)
+{
+    const uint32 num_triangles = (uint32) indices.size() / 3;
+
+    // Remaining triangles of each vertex. The first num_remaining_triangles entries of each range are the ones not emitted yet.
+    std::vector<uint32> first_vertex_triangle(num_vertices + 1, 0);
+    for (uint32 index : indices)
+    {
+        ++first_vertex_triangle[index + 1];
+    }
+    for (uint32 vertex = 0; vertex < num_vertices; ++vertex)
+    {
+        first_vertex_triangle[vertex + 1] += first_vertex_triangle[vertex];
+    }
+
+    std::vector<uint32> vertex_triangles(indices.size());
+    std::vector<uint32> num_remaining_triangles(num_vertices, 0);
+    for (uint32 triangle = 0; triangle < num_triangles; ++triangle)
+    {
+        for (uint32 corner = 0; corner < 3; ++corner)
+        {
+            const uint32 vertex = indices[triangle * 3 + corner];
+            vertex_triangles[first_vertex_triangle[vertex] + num_remaining_triangles[vertex]++] = triangle;
+        }
+    }
+
+    std::vector<int32> cache_positions(num_vertices, -1);
+    std::vector<float> vertex_scores(num_vertices);
+    for (uint32 vertex = 0; vertex < num_vertices; ++vertex)
+    {
+        vertex_scores[vertex] = CalcVertexScore(-1, num_remaining_triangles[vertex]);
+    }
+
+    auto calc_triangle_score = [&](uint32 triangle)
+    {
+        return vertex_scores[indices[triangle * 3]] + vertex_scores[indices[triangle * 3 + 1]] + vertex_scores[indices[triangle * 3 + 2]];
+    };
+
+    std::vector<bool> is_emitted(num_triangles, false);
+    std::vector<uint32> optimized_indices;
+    optimized_indices.reserve(indices.size());
+
+    // LRU order, the most recently used vertex first. The 3 extra entries hold the vertices of a new triangle before the oldest ones drop out.
+    uint32 cache[SCORING_CACHE_SIZE + 3];
+    uint32 cache_size = 0;
+
+    int32 best_triangle = -1;
+    uint32 next_unemitted_triangle = 0;
+    for (uint32 num_emitted = 0; num_emitted < num_triangles; ++num_emitted)
+    {
+        // None of the cached vertices has triangles left, continue with the next one in input order
+        if (best_triangle < 0)
+        {
+            while (is_emitted[next_unemitted_triangle])
+            {
+                ++next_unemitted_triangle;
+            }
+            best_triangle = (int32) next_unemitted_triangle;
+        }
+
+        is_emitted[best_triangle] = true;
+
+        uint32 new_cache[SCORING_CACHE_SIZE + 3];
+        uint32 new_cache_size = 0;
+        for (uint32 corner = 0; corner < 3; ++corner)
+        {
+            const uint32 vertex = indices[best_triangle * 3 + corner];
+            optimized_indices.push_back(vertex);
+
+            // Degenerate triangles reference a vertex twice
+            if (std::find(new_cache, new_cache + new_cache_size, vertex) != new_cache + new_cache_size)
+            {
+                continue;
+            }
+            new_cache[new_cache_size++] = vertex;
+
+            // Listed once per corner the vertex is used for
+            uint32* triangles = &vertex_triangles[first_vertex_triangle[vertex]];
+            num_remaining_triangles[vertex] = (uint32) (std::remove(triangles, triangles + num_remaining_triangles[vertex], (uint32) best_triangle) - triangles);
+        }
+
+        const uint32 num_triangle_vertices = new_cache_size;
+        for (uint32 i = 0; i < cache_size; ++i)
+        {
+            if (std::find(new_cache, new_cache + num_triangle_vertices, cache[i]) == new_cache + num_triangle_vertices)
+            {
+                new_cache[new_cache_size++] = cache[i];
+            }
+        }
+
+        // Rescore every vertex which moved, including the ones which just dropped out of the cache
+        for (uint32 i = 0; i < new_cache_size; ++i)
+        {
+            const uint32 vertex = new_cache[i];
+            cache_positions[vertex] = i < SCORING_CACHE_SIZE ? (int32) i : -1;
+            vertex_scores[vertex] = CalcVertexScore(cache_positions[vertex], num_remaining_triangles[vertex]);
+        }
+
+        // The next triangle is the best one touching a cached vertex
+        best_triangle = -1;
+        float best_score = -1.0f;
+        for (uint32 i = 0; i < new_cache_size; ++i)
+        {
+            const uint32 vertex = new_cache[i];
+            const uint32* triangles = &vertex_triangles[first_vertex_triangle[vertex]];
+            for (uint32 triangle_idx = 0; triangle_idx < num_remaining_triangles[vertex]; ++triangle_idx)
+            {
+                const float score = calc_triangle_score(triangles[triangle_idx]);
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_triangle = (int32) triangles[triangle_idx];
+                }
+            }
+        }
+
+        cache_size = std::min(new_cache_size, SCORING_CACHE_SIZE);
+        std::copy(new_cache, new_cache + cache_size, cache);
+    }
+
+    std::copy(optimized_indices.begin(), optimized_indices.end(), indices.begin());
+}
+
+void OptimizeOverdraw(std::span<uint32> indices, std::span<const Vec3> positions, float threshold)
+{
+    const uint32 num_triangles = (uint32) indices.size() / 3;
+    if (num_triangles == 0)
+    {
+        return;
+    }
+
+    const uint32 num_vertices = (uint32) positions.size();
+    const float max_cluster_acmr = AnalyzeVertexCache(indices, num_vertices, OVERDRAW_CACHE_SIZE).acmr * threshold;
+
+    // Every cluster is simulated starting from an empty cache, that's what it gets after reordering in the worst case
+    std::vector<uint32> cluster_starts = { 0 };
+    FifoCacheSimulator cache(num_vertices, OVERDRAW_CACHE_SIZE);
+    uint32 num_cluster_misses = 0;
+    for (uint32 triangle = 0; triangle < num_triangles; ++triangle)
+    {
+        uint32 num_misses = 0;
+        for (uint32 corner = 0; corner < 3; ++corner)
+        {
+            num_misses += cache.Access(indices[triangle * 3 + corner]) ? 1 : 0;
+        }
+
+        if (num_misses == 3 && triangle > cluster_starts.back())
+        {
+            cluster_starts.push_back(triangle);
+            num_cluster_misses = 0;
+        }
+        num_cluster_misses += num_misses;
+
+        const uint32 num_cluster_triangles = triangle + 1 - cluster_starts.back();
+        if (triangle + 1 < num_triangles && num_cluster_misses <= max_cluster_acmr * num_cluster_triangles)
+        {
+            cluster_starts.push_back(triangle + 1);
+            num_cluster_misses = 0;
+            cache.Flush();
+        }
+    }
+    cluster_starts.push_back(num_triangles);
+
+    // Area weighted centroids and normals
+    const uint32 num_clusters = (uint32) cluster_starts.size() - 1;
+    std::vector<Vec3> cluster_centroids(num_clusters);
+    std::vector<Vec3> cluster_normals(num_clusters);
+    Vec3 mesh_centroid = Vec3::ZERO;
+    float mesh_area = 0.0f;
+    for (uint32 cluster = 0; cluster < num_clusters; ++cluster)
+    {
+        Vec3 centroid = Vec3::ZERO;
+        Vec3 normal = Vec3::ZERO;
+        float area = 0.0f;
+        for (uint32 triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1]; ++triangle)
+        {
+            const Vec3& p0 = positions[indices[triangle * 3]];
+            const Vec3& p1 = positions[indices[triangle * 3 + 1]];
+            const Vec3& p2 = positions[indices[triangle * 3 + 2]];
+
+            const Vec3 triangle_normal = Vec3::Cross(Vec3(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z), Vec3(p2.x - p0.x, p2.y - p0.y, p2.z - p0.z));
+            const float triangle_area = triangle_normal.Length() * 0.5f;
+            Vec3 triangle_centroid((p0.x + p1.x + p2.x) / 3.0f, (p0.y + p1.y + p2.y) / 3.0f, (p0.z + p1.z + p2.z) / 3.0f);
+
+            normal += triangle_normal;
+            triangle_centroid *= triangle_area;
+            centroid += triangle_centroid;
+            area += triangle_area;
+        }
+
+        mesh_centroid += centroid;
+        mesh_area += area;
+        if (area > 0.0f)
+        {
+            centroid *= 1.0f / area;
+        }
+
+        cluster_centroids[cluster] = centroid;
+        cluster_normals[cluster] = normal.LengthSquared() > 0.0f ? Vec3::Normalize(normal) : Vec3::ZERO;
+    }
+
+    if (mesh_area > 0.0f)
+    {
+        mesh_centroid *= 1.0f / mesh_area;
+    }
+
+    // Clusters on the outside facing outwards first
+    std::vector<float> cluster_sort_keys(num_clusters);
+    std::vector<uint32> cluster_order(num_clusters);
+    for (uint32 cluster = 0; cluster < num_clusters; ++cluster)
+    {
+        Vec3 to_cluster = cluster_centroids[cluster];
+        to_cluster -= mesh_centroid;
+        cluster_sort_keys[cluster] = Vec3::Dot(to_cluster, cluster_normals[cluster]);
+        cluster_order[cluster] = cluster;
+    }
+
+    std::stable_sort(cluster_order.begin(), cluster_order.end(), [&cluster_sort_keys](uint32 a, uint32 b)
+    {
+        return cluster_sort_keys[a] > cluster_sort_keys[b];
+    });
+
+    std::vector<uint32> sorted_indices;
+    sorted_indices.reserve(indices.size());
+    for (uint32 cluster : cluster_order)
+    {
+        sorted_indices.insert(sorted_indices.end(), indices.begin() + cluster_starts[cluster] * 3, indices.begin() + cluster_starts[cluster + 1] * 3);
+    }
+
+    std::copy(sorted_indices.begin(), sorted_indices.end(), indices.begin());
+}
+
+uint32 OptimizeVertexFetch(VertexData& data)
+{
+    std::vector<uint32> remap(data.pos.size(), ~0u);
+    uint32 num_vertices = 0;
+    for (uint32& index : data.indices)
+    {
+        if (remap[index] == ~0u)
+        {
+            remap[index] = num_vertices++;
+        }
+        index = remap[index];
+    }
+
+    RemapStream(data.pos, remap, num_vertices);
+    RemapStream(data.normals, remap, num_vertices);
+    RemapStream(data.tangents, remap, num_vertices);
+    RemapStream(data.uvs, remap, num_vertices);
+    return num_vertices;
+}
+
+std::vector<MeshCluster> BuildClusters(std::span<uint32> indices, std::span<const Vec3> positions, uint32 max_triangles)
+{
+    CHECK(max_triangles > 0);
+
+    const uint32 num_triangles = (uint32) indices.size() / 3;
+    const uint32 num_vertices = (uint32) positions.size();
+    std::vector<MeshCluster> clusters;
+    if (num_triangles == 0)
+    {
+        return clusters;
+    }
+
+    // Triangles of each vertex
+    std::vector<uint32> first_vertex_triangle(num_vertices + 1, 0);
+    for (uint32 index : indices)
+    {
+        ++first_vertex_triangle[index + 1];
+    }
+    for (uint32 vertex = 0; vertex < num_vertices; ++vertex)
+    {
+        first_vertex_triangle[vertex + 1] += first_vertex_triangle[vertex];
+    }
+
+    std::vector<uint32> vertex_triangles(indices.size());
+    std::vector<uint32> num_vertex_triangles(num_vertices, 0);
+    for (uint32 triangle = 0; triangle < num_triangles; ++triangle)
+    {
+        for (uint32 corner = 0; corner < 3; ++corner)
+        {
+            const uint32 vertex = indices[triangle * 3 + corner];
+            vertex_triangles[first_vertex_triangle[vertex] + num_vertex_triangles[vertex]++] = triangle;
+        }
+    }
+
+    // Zero for degenerate triangles, they never get rasterized and don't widen the cone
+    std::vector<Vec3> triangle_normals(num_triangles);
+    for (uint32 triangle = 0; triangle < num_triangles; ++triangle)
+    {
+        const Vec3& p0 = positions[indices[triangle * 3]];
+        const Vec3& p1 = positions[indices[triangle * 3 + 1]];
+        const Vec3& p2 = positions[indices[triangle * 3 + 2]];
+
+        const Vec3 normal = Vec3::Cross(Vec3(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z), Vec3(p2.x - p0.x, p2.y - p0.y, p2.z - p0.z));
+        triangle_normals[triangle] = normal.LengthSquared() > 0.0f ? Vec3::Normalize(normal) : Vec3::ZERO;
+    }
+
+    std::vector<bool> is_assigned(num_triangles, false);
+    std::vector<uint32> vertex_clusters(num_vertices, ~0u);     // The last cluster which uses the vertex
+    std::vector<uint32> clustered_indices;
+    clustered_indices.reserve(indices.size());
+
+    std::vector<uint32> cluster_triangles;
+    std::vector<uint32> candidates;
+    uint32 next_unassigned_triangle = 0;
+    uint32 num_assigned = 0;
+    while (num_assigned < num_triangles)
+    {
+        const uint32 cluster_idx = (uint32) clusters.size();
+        cluster_triangles.clear();
+        candidates.clear();
+        Vec3 normal_sum = Vec3::ZERO;
+
+        int32 triangle = -1;
+        while (cluster_triangles.size() < max_triangles && num_assigned < num_triangles)
+        {
+            // Out of neighbors, continue with the next triangle in input order. After the vertex cache optimization it's usually close by.
+            if (triangle < 0)
+            {
+                while (is_assigned[next_unassigned_triangle])
+                {
+                    ++next_unassigned_triangle;
+                }
+                triangle = (int32) next_unassigned_triangle;
+            }
+
+            is_assigned[triangle] = true;
+            ++num_assigned;
+            cluster_triangles.push_back((uint32) triangle);
+            normal_sum += triangle_normals[triangle];
+            for (uint32 corner = 0; corner < 3; ++corner)
+            {
+                const uint32 vertex = indices[triangle * 3 + corner];
+                if (vertex_clusters[vertex] != cluster_idx)
+                {
+                    vertex_clusters[vertex] = cluster_idx;
+                    candidates.insert(candidates.end(), vertex_triangles.begin() + first_vertex_triangle[vertex],
+                        vertex_triangles.begin() + first_vertex_triangle[vertex + 1]);
+                }
+            }
+
+            const Vec3 axis = normal_sum.LengthSquared() > 0.0f ? Vec3::Normalize(normal_sum) : Vec3::ZERO;
+            triangle = -1;
+            float best_score = std::numeric_limits<float>::max();
+            size_t num_candidates = 0;
+            for (uint32 candidate : candidates)
+            {
+                if (is_assigned[candidate])
+                {
+                    continue;
+                }
+                candidates[num_candidates++] = candidate;
+
+                uint32 num_new_vertices = 0;
+                for (uint32 corner = 0; corner < 3; ++corner)
+                {
+                    num_new_vertices += vertex_clusters[indices[candidate * 3 + corner]] != cluster_idx ? 1 : 0;
+                }
+
+                // The facing term is within [0, 2), so it only breaks ties between the same number of new vertices
+                const float score = (float) num_new_vertices * 2.0f + (1.0f - Vec3::Dot(triangle_normals[candidate], axis));
+                if (score < best_score)
+                {
+                    best_score = score;
+                    triangle = (int32) candidate;
+                }
+            }
+            candidates.resize(num_candidates);
+        }
+
+        MeshCluster& cluster = clusters.emplace_back();
+        cluster.first_index = (uint32) clustered_indices.size();
+        cluster.num_indices = (uint32) cluster_triangles.size() * 3;
+
+        Vec3 bounds_min(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vec3 bounds_max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (uint32 cluster_triangle : cluster_triangles)
+        {
+            for (uint32 corner = 0; corner < 3; ++corner)
+            {
+                const uint32 vertex = indices[cluster_triangle * 3 + corner];
+                clustered_indices.push_back(vertex);
+
+                const Vec3& pos = positions[vertex];
+                bounds_min = Vec3(std::min(bounds_min.x, pos.x), std::min(bounds_min.y, pos.y), std::min(bounds_min.z, pos.z));
+                bounds_max = Vec3(std::max(bounds_max.x, pos.x), std::max(bounds_max.y, pos.y), std::max(bounds_max.z, pos.z));
+            }
+        }
+
+        cluster.center = Vec3((bounds_min.x + bounds_max.x) * 0.5f, (bounds_min.y + bounds_max.y) * 0.5f, (bounds_min.z + bounds_max.z) * 0.5f);
+        cluster.extents = Vec3((bounds_max.x - bounds_min.x) * 0.5f, (bounds_max.y - bounds_min.y) * 0.5f, (bounds_max.z - bounds_min.z) * 0.5f);
+
+        float radius_squared = 0.0f;
+        for (uint32 i = cluster.first_index; i < cluster.first_index + cluster.num_indices; ++i)
+        {
+            const Vec3& pos = positions[clustered_indices[i]];
+            const Vec3 offset(pos.x - cluster.center.x, pos.y - cluster.center.y, pos.z - cluster.center.z);
+            radius_squared = std::max(radius_squared, offset.LengthSquared());
+        }
+        cluster.radius = std::sqrt(radius_squared);
+
+        if (normal_sum.LengthSquared() > 0.0f)
+        {
+            cluster.cone_axis = Vec3::Normalize(normal_sum);
+
+            float min_dot = 1.0f;
+            for (uint32 cluster_triangle : cluster_triangles)
+            {
+                if (triangle_normals[cluster_triangle].LengthSquared() > 0.0f)
+                {
+                    min_dot = std::min(min_dot, Vec3::Dot(triangle_normals[cluster_triangle], cluster.cone_axis));
+                }
+            }
+
+            // Sine of the widest angle between the axis and a triangle normal
+            cluster.cone_cutoff = min_dot > MIN_CLUSTER_CONE_DOT ? std::sqrt(1.0f - min_dot * min_dot) : 1.0f;
+        }
+    }
+
+    std::copy(clustered_indices.begin(), clustered_indices.end(), indices.begin());
+    return clusters;
+}
+
+std::vector<uint32> SimplifyMesh(std::span<const uint32> indices, std::span<const Vec3> positions, uint32 target_index_count,
+    float max_error, float& out_error)
+{
+    const uint32 num_vertices = (uint32) positions.size();
+    std::vector<uint32> result(indices.begin(), indices.end());
+    out_error = 0.0f;
+
+    // Planes of the original triangles, weighted by area so tiny triangles don't dominate the error
+    std::vector<Quadric> quadrics(num_vertices);
+    for (size_t i = 0; i + 2 < result.size(); i += 3)
+    {
+        const Vec3& p0 = positions[result[i]];
+        const Vec3 normal = CalcTriangleNormal(p0, positions[result[i + 1]], positions[result[i + 2]]);
+        const float length = normal.Length();
+        if (length == 0.0f)
+        {
+            continue;
+        }
+
+        const Vec3 plane_normal = Vec3::Normalize(normal);
+        const float distance = -Vec3::Dot(plane_normal, p0);
+        for (uint32 corner = 0; corner < 3; ++corner)
+        {
+            quadrics[result[i + corner]].AddPlane(plane_normal, distance, length * 0.5f);
+        }
+    }
+
+    // Edges with a single triangle. Seams are borders as well, the two sides reference different vertices.
+    std::unordered_map<uint64, uint32> edge_counts;
+    edge_counts.reserve(result.size());
+    for (size_t i = 0; i + 2 < result.size(); i += 3)
+    {
+        for (uint32 corner = 0; corner < 3; ++corner)
+        {
+            const uint32 a = result[i + corner];
+            const uint32 b = result[i + (corner + 1) % 3];
+            ++edge_counts[((uint64) std::min(a, b) << 32) | std::max(a, b)];
+        }
+    }
+
+    std::vector<bool> is_locked(num_vertices, false);
+    for (const auto& [edge, count] : edge_counts)
+    {
+        if (count == 1)
+        {
+            is_locked[(uint32) (edge >> 32)] = true;
+            is_locked[(uint32) edge] = true;
+        }
+    }
+
+    struct Collapse
+    {
+        uint32 from = 0;
+        uint32 to = 0;
+        float error = 0.0f;
+    };
+
+    const float max_collapse_error = max_error * max_error;
+    std::vector<uint32> first_vertex_triangle;
+    std::vector<uint32> vertex_triangles;
+    std::vector<uint64> edges;
+    std::vector<Collapse> collapses;
+    std::vector<bool> is_touched;
+    while (result.size() > target_index_count)
+    {
+        const uint32 num_triangles = (uint32) result.size() / 3;
+
+        // Triangles of each vertex, for the flip test
+        first_vertex_triangle.assign(num_vertices + 1, 0);
+        for (uint32 index : result)
+        {
+            ++first_vertex_triangle[index + 1];
+        }
+        for (uint32 vertex = 0; vertex < num_vertices; ++vertex)
+        {
+            first_vertex_triangle[vertex + 1] += first_vertex_triangle[vertex];
+        }
+
+        vertex_triangles.resize(result.size());
+        std::vector<uint32> num_vertex_triangles(num_vertices, 0);
+        for (uint32 triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            for (uint32 corner = 0; corner < 3; ++corner)
+            {
+                const uint32 vertex = result[triangle * 3 + corner];
+                vertex_triangles[first_vertex_triangle[vertex] + num_vertex_triangles[vertex]++] = triangle;
+            }
+        }
+
+        // Every edge once, in its cheaper direction
+        edges.clear();
+        for (uint32 triangle = 0; triangle < num_triangles; ++triangle)
+        {
+            for (uint32 corner = 0; corner < 3; ++corner)
+            {
+                const uint32 a = result[triangle * 3 + corner];
+                const uint32 b = result[triangle * 3 + (corner + 1) % 3];
+                edges.push_back(((uint64) std::min(a, b) << 32) | std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (uint64 edge : edges)
+        {
+            const uint32 a = (uint32) (edge >> 32);
+            const uint32 b = (uint32) edge;
+            if (is_locked[a] && is_locked[b])
+            {
+                continue;
+            }
+
+            Quadric merged = quadrics[a];
+            merged += quadrics[b];
+            const float error_a_to_b = is_locked[a] ? FLT_MAX : merged.Evaluate(positions[b]);
+            const float error_b_to_a = is_locked[b] ? FLT_MAX : merged.Evaluate(positions[a]);
+            collapses.push_back(error_a_to_b <= error_b_to_a ?
+                Collapse{ .from = a, .to = b, .error = error_a_to_b } :
+                Collapse{ .from = b, .to = a, .error = error_b_to_a });
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+        // A collapse removes about two triangles. Vertices around a collapse are left alone for the rest of the pass,
+        // the flip tests of later collapses have to see the positions they were computed with.
+        const uint32 num_wanted_collapses = (num_triangles - target_index_count / 3) / 2 + 1;
+        uint32 num_collapses = 0;
+        is_touched.assign(num_vertices, false);
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.error > max_collapse_error || num_collapses >= num_wanted_collapses)
+            {
+                break;
+            }
+
+            if (is_touched[collapse.from] || is_touched[collapse.to])
+            {
+                continue;
+            }
+
+            // Triangles which keep existing must not turn over
+            const Vec3& new_pos = positions[collapse.to];
+            bool is_flipping = false;
+            for (uint32 j = first_vertex_triangle[collapse.from]; j < first_vertex_triangle[collapse.from + 1] && is_flipping == false; ++j)
+            {
+                const uint32* triangle = &result[vertex_triangles[j] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                {
+                    continue;
+                }
+
+                Vec3 moved[3];
+                for (uint32 corner = 0; corner < 3; ++corner)
+                {
+                    moved[corner] = triangle[corner] == collapse.from ? new_pos : positions[triangle[corner]];
+                }
+
+                const Vec3 old_normal = CalcTriangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+                is_flipping = Vec3::Dot(old_normal, CalcTriangleNormal(moved[0], moved[1], moved[2])) <= 0.0f;
+            }
+
+            if (is_flipping)
+            {
+                continue;
+            }
+
+            for (uint32 j = first_vertex_triangle[collapse.from]; j < first_vertex_triangle[collapse.from + 1]; ++j)
+            {
+                const uint32* triangle = &result[vertex_triangles[j] * 3];
+                is_touched[triangle[0]] = is_touched[triangle[1]] = is_touched[triangle[2]] = true;
+            }
+
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (uint32 j = first_vertex_triangle[collapse.from]; j < first_vertex_triangle[collapse.from + 1]; ++j)
+            {
+                uint32* triangle = &result[vertex_triangles[j] * 3];
+                for (uint32 corner = 0; corner < 3; ++corner)
+                {
+                    triangle[corner] = triangle[corner] == collapse.from ? collapse.to : triangle[corner];
+                }
+            }
+
+            out_error = std::max(out_error, collapse.error);
+            ++num_collapses;
+        }
+
+        if (num_collapses == 0)
+        {
+            break;
+        }
+
+        // The triangles around each collapsed edge became degenerate
+        size_t num_indices = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            const uint32 a = result[i], b = result[i + 1], c = result[i + 2];
+            if (a != b && b != c && a != c)
+            {
+                result[num_indices++] = a;
+                result[num_indices++] = b;
+                result[num_indices++] = c;
+            }
+        }
+        result.resize(num_indices);
+    }
+
+    out_error = std::sqrt(out_error);
+    return result;
+}
+
+void OptimizeMesh(VertexData& data, float weld_epsilon, float overdraw_threshold)
+{
+    WeldVertices(data, weld_epsilon);
+    OptimizeVertexCache(data.indices, (uint32) data.pos.size());
+    OptimizeOverdraw(data.indices, data.pos, overdraw_threshold);
+    OptimizeVertexFetch(data);
+}
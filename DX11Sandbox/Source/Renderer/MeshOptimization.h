@@ -0,0 +1,63 @@
+#pragma once
+#include <span>
+
+#include "Renderer/ClusterCulling.h"
+#include "Renderer/Mesh.h"
+
+struct VertexCacheStats
+{
+    uint32 num_triangles = 0;
+    uint32 num_vertices = 0;    // Referenced by the indices
+    uint32 num_transforms = 0;  // Vertex shader invocations, i.e. misses of the simulated cache
+    float acmr = 0.0f;          // Average cache miss ratio, transforms per triangle. 3 is the worst case, around 0.6 is good.
+    float atvr = 0.0f;          // Average transform to vertex ratio, 1 is the best case
+};
+
+// Simulates a FIFO post transform cache with cache_size entries, like the one of the vertex shader stage.
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32> indices, uint32 num_vertices, uint32 cache_size = 16);
+
+// Points the indices of vertices whose attributes are equal within epsilon at the first one of them. Tangents are compared as well.
+// Vertices which are not referenced anymore stay in the streams until OptimizeVertexFetch(). Returns the number of unique vertices.
+uint32 WeldVertices(VertexData& data, float epsilon = 0.0f);
+
+// Reorders the triangles for the post transform cache with Tom Forsyth's linear-speed vertex cache optimization.
+// The scoring assumes an LRU cache with 32 entries, which also does well on the smaller FIFO caches of actual hardware.
+void OptimizeVertexCache(std::span<uint32> indices, uint32 num_vertices);
+
+/**
+ * Reorders clusters of triangles so the ones facing away from the center of the mesh are drawn first and occlude the rest,
+ * after Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+ *
+ * Expects cache optimized indices. Clusters end where all vertices of a triangle miss the cache anyway, or where the ACMR
+ * of the cluster on its own is within threshold of the ACMR of the whole mesh. So the reordering costs at most that much.
+ */
+void OptimizeOverdraw(std::span<uint32> indices, std::span<const Vec3> positions, float threshold = 1.05f);
+
+// Renumbers the vertices in the order the indices first reference them and reorders all streams to match,
+// so vertex fetch reads memory linearly. Unreferenced vertices are dropped. Returns the new number of vertices.
+uint32 OptimizeVertexFetch(VertexData& data);
+
+/**
+ * Splits the triangles into clusters of at most max_triangles for culling below the granularity of whole meshes, and reorders
+ * them so every cluster is a contiguous range of indices. Run OptimizeVertexFetch() afterwards.
+ *
+ * Clusters grow greedily from the first unassigned triangle in index order. The next triangle is the neighbor which adds the
+ * fewest new vertices, ties go to the one facing most like the cluster so far. That keeps most of the vertex cache order and
+ * gives narrow normal cones, which is what the cone test of CullClusters() needs to reject anything.
+ */
+std::vector<MeshCluster> BuildClusters(std::span<uint32> indices, std::span<const Vec3> positions, uint32 max_triangles = 128);
+
+/**
+ * Quadric error metric simplification after Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics".
+ * Returns indices with at most target_index_count indices, or as few as the collapses within max_error allow.
+ *
+ * Edges are collapsed onto one of their vertices instead of a new optimal position, so the simplified indices still reference
+ * the original vertices and a LOD can share the vertex buffers of the full detail mesh. Vertices on borders, which includes
+ * attribute seams, stay in place. out_error is the largest distance between the simplified and the original surface,
+ * estimated as the area weighted RMS distance to the planes of the original triangles around the collapsed vertices.
+ */
+std::vector<uint32> SimplifyMesh(std::span<const uint32> indices, std::span<const Vec3> positions, uint32 target_index_count,
+    float max_error, float& out_error);
+
+// Welding, vertex cache, overdraw and vertex fetch optimization in that order
+void OptimizeMesh(VertexData& data, float weld_epsilon = 0.0f, float overdraw_threshold = 1.05f);
@@ -0,0 +1,260 @@
+#include "Renderer/NullGraphicsBackend.h"
+
+#include <bit>
+
+namespace
+{
+    class NullBuffer final : public GpuBuffer
+    {
+    public:
+        NullBuffer(const GpuBufferDesc& desc, const void* initial_data)
+            : GpuBuffer(desc)
+            , data_(desc.size)
+        {
+            if (initial_data != nullptr)
+            {
+                std::memcpy(data_.data(), initial_data, data_.size());
+            }
+        }
+
+        uint8* GetData() { return data_.data(); }
+        uint32 GetSize() const { return GetDesc().size; }
+
+    private:
+        std::vector<uint8> data_;
+    };
+
+    NullBuffer* ToNullBuffer(GpuBuffer* buffer)
+    {
+        CHECK(buffer != nullptr);
+        return static_cast<NullBuffer*>(buffer);
+    }
+}
+
+SharedPtr<GpuBuffer> NullGraphicsBackend::CreateBuffer(const GpuBufferDesc& desc, const void* initial_data)
+{
+    CHECK(desc.size > 0);
+    CHECK_MSG(desc.usage != GpuUsage::Immutable || initial_data != nullptr, "Immutable buffers require initial data");
+
+    return MakeShared<NullBuffer>(desc, initial_data);
+}
+
+SharedPtr<GpuTexture> NullGraphicsBackend::CreateTexture2D(const GpuTextureDesc& desc, const void* initial_data, uint32 row_pitch)
+{
+    CHECK(desc.width > 0 && desc.height > 0 && desc.array_size > 0);
+    CHECK_MSG(desc.usage != GpuUsage::Immutable || initial_data != nullptr, "Immutable textures require initial data");
+
+    // Only the description, nothing is ever rendered into it
+    return MakeShared<GpuTexture>(desc);
+}
+
+SharedPtr<GpuShaderResourceView> NullGraphicsBackend::CreateShaderResourceView(GpuTexture* texture, const GpuViewDesc& desc)
+{
+    CHECK(texture != nullptr);
+    return MakeShared<GpuShaderResourceView>();
+}
+
+SharedPtr<GpuShaderResourceView> NullGraphicsBackend::CreateStructuredBufferView(GpuBuffer* buffer)
+{
+    CHECK(buffer != nullptr && buffer->GetDesc().structure_stride > 0);
+    return MakeShared<GpuShaderResourceView>();
+}
+
+SharedPtr<GpuRenderTargetView> NullGraphicsBackend::CreateRenderTargetView(GpuTexture* texture, const GpuViewDesc& desc)
+{
+    CHECK(texture != nullptr);
+    return MakeShared<GpuRenderTargetView>();
+}
+
+SharedPtr<GpuDepthStencilView> NullGraphicsBackend::CreateDepthStencilView(GpuTexture* texture, const GpuViewDesc& desc)
+{
+    CHECK(texture != nullptr);
+    return MakeShared<GpuDepthStencilView>();
+}
+
+SharedPtr<GpuVertexShader> NullGraphicsBackend::CreateVertexShader(std::span<const uint8> bytecode)
+{
+    CHECK(bytecode.empty() == false);
+    return MakeShared<GpuVertexShader>();
+}
+
+SharedPtr<GpuPixelShader> NullGraphicsBackend::CreatePixelShader(std::span<const uint8> bytecode)
+{
+    CHECK(bytecode.empty() == false);
+    return MakeShared<GpuPixelShader>();
+}
+
+SharedPtr<GpuInputLayout> NullGraphicsBackend::CreateInputLayout(std::span<const VertexElement> elements, std::span<const uint8> vs_bytecode)
+{
+    CHECK(vs_bytecode.empty() == false);
+    return MakeShared<GpuInputLayout>();
+}
+
+void* NullGraphicsBackend::Map(GpuBuffer* buffer, MapType map_type)
+{
+    NullBuffer* null_buffer = ToNullBuffer(buffer);
+    Record({ .type = RecordedCommandType::Map, .resource = buffer, .args = { (uint32) map_type, null_buffer->GetSize() } });
+    return null_buffer->GetData();
+}
+
+void NullGraphicsBackend::Unmap(GpuBuffer* buffer)
+{
+    CHECK(buffer != nullptr);
+}
+
+void NullGraphicsBackend::UpdateBuffer(GpuBuffer* buffer, const void* data)
+{
+    NullBuffer* null_buffer = ToNullBuffer(buffer);
+    CHECK(data != nullptr);
+
+    std::memcpy(null_buffer->GetData(), data, null_buffer->GetSize());
+    num_bytes_uploaded_ += null_buffer->GetSize();
+    Record({ .type = RecordedCommandType::UpdateBuffer, .resource = buffer, .args = { null_buffer->GetSize() } });
+}
+
+void NullGraphicsBackend::UpdateTexture(GpuTexture* texture, uint32 mip, const void* data, uint32 row_pitch)
+{
+    CHECK(texture != nullptr && data != nullptr);
+    Record({ .type = RecordedCommandType::UpdateTexture, .resource = texture, .args = { mip, row_pitch } });
+}
+
+void NullGraphicsBackend::CopyTextureMip(GpuTexture* dst, uint32 dst_mip, GpuTexture* src, uint32 src_mip)
+{
+    CHECK(dst != nullptr && src != nullptr);
+    Record({ .type = RecordedCommandType::CopyTexture, .resource = dst, .args = { dst_mip, src_mip } });
+}
+
+void NullGraphicsBackend::CopyTexture(GpuTexture* dst, GpuTexture* src)
+{
+    CHECK(dst != nullptr && src != nullptr);
+    Record({ .type = RecordedCommandType::CopyTexture, .resource = dst });
+}
+
+void NullGraphicsBackend::GenerateMips(GpuShaderResourceView* srv)
+{
+    CHECK(srv != nullptr);
+    Record({ .type = RecordedCommandType::GenerateMips, .resource = srv });
+}
+
+void NullGraphicsBackend::SetPrimitiveTopology(PrimitiveTopology primitive_topology)
+{
+    Record({ .type = RecordedCommandType::SetPrimitiveTopology, .args = { (uint32) primitive_topology } });
+}
+
+void NullGraphicsBackend::SetBlendState(BlendState state)
+{
+    Record({ .type = RecordedCommandType::SetBlendState, .args = { (uint32) state } });
+}
+
+void NullGraphicsBackend::SetDepthStencilState(DepthStencilState state)
+{
+    Record({ .type = RecordedCommandType::SetDepthStencilState, .args = { (uint32) state } });
+}
+
+void NullGraphicsBackend::SetRasterizerState(RasterizerState state)
+{
+    Record({ .type = RecordedCommandType::SetRasterizerState, .args = { (uint32) state } });
+}
+
+void NullGraphicsBackend::SetVertexShader(GpuVertexShader* shader)
+{
+    Record({ .type = RecordedCommandType::SetVertexShader, .resource = shader });
+}
+
+void NullGraphicsBackend::SetPixelShader(GpuPixelShader* shader)
+{
+    Record({ .type = RecordedCommandType::SetPixelShader, .resource = shader });
+}
+
+void NullGraphicsBackend::SetInputLayout(GpuInputLayout* input_layout)
+{
+    Record({ .type = RecordedCommandType::SetInputLayout, .resource = input_layout });
+}
+
+void NullGraphicsBackend::SetConstantBuffer(ShaderStage stage, uint32 slot, GpuBuffer* buffer, uint32 first_constant,
+    uint32 num_constants)
+{
+    Record({ .type = RecordedCommandType::SetConstantBuffer, .stage = stage, .slot = slot, .resource = buffer,
+        .args = { first_constant, num_constants } });
+}
+
+void NullGraphicsBackend::SetVertexBuffer(uint32 slot, GpuBuffer* buffer, uint32 stride, uint32 offset)
+{
+    Record({ .type = RecordedCommandType::SetVertexBuffer, .slot = slot, .resource = buffer, .args = { stride, offset } });
+}
+
+void NullGraphicsBackend::SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset)
+{
+    Record({ .type = RecordedCommandType::SetIndexBuffer, .resource = buffer, .args = { (uint32) format, offset } });
+}
+
+void NullGraphicsBackend::SetShaderResource(ShaderStage stage, uint32 slot, GpuShaderResourceView* srv)
+{
+    Record({ .type = RecordedCommandType::SetShaderResource, .stage = stage, .slot = slot, .resource = srv });
+}
+
+void NullGraphicsBackend::SetSampler(ShaderStage stage, uint32 slot, SamplerState state)
+{
+    Record({ .type = RecordedCommandType::SetSampler, .stage = stage, .slot = slot, .args = { (uint32) state } });
+}
+
+void NullGraphicsBackend::SetViewport(const Viewport& viewport)
+{
+    Record({ .type = RecordedCommandType::SetViewport, .args = { (uint32) viewport.width, (uint32) viewport.height } });
+}
+
+void NullGraphicsBackend::SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv)
+{
+    Record({ .type = RecordedCommandType::SetRenderTargets, .resource = rtv, .depth_stencil_view = dsv });
+}
+
+void NullGraphicsBackend::ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4])
+{
+    CHECK(rtv != nullptr);
+    Record({ .type = RecordedCommandType::ClearRenderTarget, .resource = rtv,
+        .args = { std::bit_cast<uint32>(color[0]), std::bit_cast<uint32>(color[1]), std::bit_cast<uint32>(color[2]),
+            std::bit_cast<uint32>(color[3]) } });
+}
+
+void NullGraphicsBackend::ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth, uint8 stencil)
+{
+    CHECK(dsv != nullptr);
+    Record({ .type = RecordedCommandType::ClearDepthStencil, .resource = dsv,
+        .args = { clear_flags, std::bit_cast<uint32>(depth), stencil } });
+}
+
+void NullGraphicsBackend::DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex)
+{
+    ++num_instances_;
+    Record({ .type = RecordedCommandType::DrawIndexed, .args = { num_indices, 1, start_idx, (uint32) base_vertex, 0 } });
+}
+
+void NullGraphicsBackend::DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex,
+    uint32 start_instance)
+{
+    num_instances_ += num_instances;
+    Record({ .type = RecordedCommandType::DrawIndexedInstanced, .args = { num_indices, num_instances, start_idx, (uint32) base_vertex,
+        start_instance } });
+}
+
+void NullGraphicsBackend::Reset()
+{
+    commands_.clear();
+    command_counts_ = {};
+    num_instances_ = 0;
+    num_bytes_uploaded_ = 0;
+}
+
+uint32 NullGraphicsBackend::GetNumDrawCalls() const
+{
+    return GetNumCommands(RecordedCommandType::DrawIndexed) + GetNumCommands(RecordedCommandType::DrawIndexedInstanced);
+}
+
+void NullGraphicsBackend::Record(const RecordedCommand& command)
+{
+    ++command_counts_[(size_t) command.type];
+    if (is_recording_)
+    {
+        commands_.push_back(command);
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+
+#include "Renderer/GraphicsBackend.h"
+
+enum class RecordedCommandType : uint8
+{
+    SetPrimitiveTopology,
+    SetBlendState,
+    SetDepthStencilState,
+    SetRasterizerState,
+    SetVertexShader,
+    SetPixelShader,
+    SetInputLayout,
+    SetConstantBuffer,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetShaderResource,
+    SetSampler,
+    SetViewport,
+    SetRenderTargets,
+    ClearRenderTarget,
+    ClearDepthStencil,
+    DrawIndexed,
+    DrawIndexedInstanced,
+    Map,
+    UpdateBuffer,
+    UpdateTexture,
+    CopyTexture,
+    GenerateMips,
+    Count
+};
+
+/**
+ * A single call which reached the backend.
+ * Resources are identified by their address, which stays the same as long as they are alive.
+ */
+struct RecordedCommand
+{
+    RecordedCommandType type = RecordedCommandType::Count;
+    ShaderStage stage = ShaderStage::VS;
+    uint32 slot = 0;
+    const void* resource = nullptr;
+    const void* depth_stencil_view = nullptr;   // Of SetRenderTargets, the render target view is the resource
+    // Depends on the type, e.g. num_indices, num_instances, start_idx, base_vertex and start_instance for draws.
+    // Signed values like base_vertex are stored as their bit pattern.
+    uint32 args[5] = {};
+};
+
+/**
+ * Backend without a device. Buffers are plain CPU allocations, every state change, upload and draw is recorded.
+ * Used by gfx::InitHeadless() for CPU side benchmarks and for checking the submission of the renderer on machines without a GPU.
+ *
+ * Textures, views, shaders and input layouts only exist to be bound, their address identifies them in the recorded commands.
+ * Only accepts resources which were created by itself.
+ */
+class NullGraphicsBackend final : public GraphicsBackend
+{
+public:
+    SharedPtr<GpuBuffer> CreateBuffer(const GpuBufferDesc& desc, const void* initial_data = nullptr) override;
+    SharedPtr<GpuTexture> CreateTexture2D(const GpuTextureDesc& desc, const void* initial_data = nullptr, uint32 row_pitch = 0) override;
+    SharedPtr<GpuShaderResourceView> CreateShaderResourceView(GpuTexture* texture, const GpuViewDesc& desc = {}) override;
+    SharedPtr<GpuShaderResourceView> CreateStructuredBufferView(GpuBuffer* buffer) override;
+    SharedPtr<GpuRenderTargetView> CreateRenderTargetView(GpuTexture* texture, const GpuViewDesc& desc = {}) override;
+    SharedPtr<GpuDepthStencilView> CreateDepthStencilView(GpuTexture* texture, const GpuViewDesc& desc = {}) override;
+
+    SharedPtr<GpuVertexShader> CreateVertexShader(std::span<const uint8> bytecode) override;
+    SharedPtr<GpuPixelShader> CreatePixelShader(std::span<const uint8> bytecode) override;
+    SharedPtr<GpuInputLayout> CreateInputLayout(std::span<const VertexElement> elements, std::span<const uint8> vs_bytecode) override;
+
+    bool SupportsConstantBufferOffsets() const override { return true; }
+    bool SupportsNoOverwriteOnShaderResources() const override { return true; }
+
+    void* Map(GpuBuffer* buffer, MapType map_type) override;
+    void Unmap(GpuBuffer* buffer) override;
+    void UpdateBuffer(GpuBuffer* buffer, const void* data) override;
+
+    void UpdateTexture(GpuTexture* texture, uint32 mip, const void* data, uint32 row_pitch) override;
+    void CopyTextureMip(GpuTexture* dst, uint32 dst_mip, GpuTexture* src, uint32 src_mip) override;
+    void CopyTexture(GpuTexture* dst, GpuTexture* src) override;
+    void GenerateMips(GpuShaderResourceView* srv) override;
+
+    void SetPrimitiveTopology(PrimitiveTopology primitive_topology) override;
+    void SetBlendState(BlendState state) override;
+    void SetDepthStencilState(DepthStencilState state) override;
+    void SetRasterizerState(RasterizerState state) override;
+    void SetVertexShader(GpuVertexShader* shader) override;
+    void SetPixelShader(GpuPixelShader* shader) override;
+    void SetInputLayout(GpuInputLayout* input_layout) override;
+    void SetConstantBuffer(ShaderStage stage, uint32 slot, GpuBuffer* buffer, uint32 first_constant, uint32 num_constants) override;
+    void SetVertexBuffer(uint32 slot, GpuBuffer* buffer, uint32 stride, uint32 offset) override;
+    void SetIndexBuffer(GpuBuffer* buffer, IndexFormat format, uint32 offset) override;
+    void SetShaderResource(ShaderStage stage, uint32 slot, GpuShaderResourceView* srv) override;
+    void SetSampler(ShaderStage stage, uint32 slot, SamplerState state) override;
+    void SetViewport(const Viewport& viewport) override;
+    void SetRenderTargets(GpuRenderTargetView* rtv, GpuDepthStencilView* dsv) override;
+
+    void ClearRenderTarget(GpuRenderTargetView* rtv, const float color[4]) override;
+    void ClearDepthStencil(GpuDepthStencilView* dsv, uint32 clear_flags, float depth, uint8 stencil) override;
+
+    void DrawIndexed(uint32 num_indices, uint32 start_idx, int32 base_vertex) override;
+    void DrawIndexedInstanced(uint32 num_indices, uint32 num_instances, uint32 start_idx, int32 base_vertex, uint32 start_instance) override;
+
+    // Nothing to present to
+    void Present() override {}
+
+    // If disabled, only the counters are updated. Keeps long benchmark runs from growing the command list.
+    void SetRecording(bool is_recording) { is_recording_ = is_recording; }
+
+    // Clears the recorded commands and counters
+    void Reset();
+
+    const std::vector<RecordedCommand>& GetCommands() const { return commands_; }
+    uint32 GetNumCommands(RecordedCommandType type) const { return command_counts_[(size_t) type]; }
+    uint32 GetNumDrawCalls() const;
+    uint64 GetNumInstances() const { return num_instances_; }
+    // Through UpdateBuffer(). Writes to mapped buffers are only counted as Map commands, their size isn't known.
+    uint64 GetNumBytesUploaded() const { return num_bytes_uploaded_; }
+
+private:
+    void Record(const RecordedCommand& command);
+
+    std::vector<RecordedCommand> commands_;
+    std::array<uint32, (size_t) RecordedCommandType::Count> command_counts_{};
+    uint64 num_instances_ = 0;
+    uint64 num_bytes_uploaded_ = 0;
+    bool is_recording_ = true;
+};
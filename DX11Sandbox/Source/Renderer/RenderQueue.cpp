@@ -1,39 +1,205 @@
 #include "RenderQueue.h"
 #include "Mesh.h"
 
+namespace
+{
+    constexpr uint64 MaskBits(uint64 value, uint32 num_bits)
+    {
+        return value & ((1ull << num_bits) - 1ull);
+    }
+
+    uint32 FoldPointer(const void* ptr, uint32 num_bits)
+    {
+        // Buffers are heap allocated, so the lowest bits don't carry any information.
+        uint64 value = reinterpret_cast<uint64>(ptr) >> 4;
+        value ^= value >> 21;
+        value ^= value >> 42;
+        return (uint32) MaskBits(value, num_bits);
+    }
+}
+
+uint64 RenderSortKey::MakeOpaque(uint32 layer, uint32 program, uint32 material, uint32 mesh, float depth)
+{
+    uint64 key = MaskBits(layer, NUM_LAYER_BITS);
+    key = (key << NUM_TRANSLUCENCY_BITS) | 0ull;
+    key = (key << NUM_PROGRAM_BITS) | MaskBits(program, NUM_PROGRAM_BITS);
+    key = (key << NUM_MATERIAL_BITS) | MaskBits(material, NUM_MATERIAL_BITS);
+    key = (key << NUM_MESH_BITS) | MaskBits(mesh, NUM_MESH_BITS);
+    key = (key << NUM_DEPTH_BITS) | QuantizeDepth(depth);
+    return key;
+}
+
+uint64 RenderSortKey::MakeTranslucent(uint32 layer, uint32 program, uint32 material, uint32 mesh, float depth)
+{
+    static constexpr uint32 MAX_DEPTH = (1u << NUM_DEPTH_BITS) - 1u;
+
+    uint64 key = MaskBits(layer, NUM_LAYER_BITS);
+    key = (key << NUM_TRANSLUCENCY_BITS) | 1ull;
+    key = (key << NUM_DEPTH_BITS) | (MAX_DEPTH - QuantizeDepth(depth));   // Inverted -> back to front
+    key = (key << NUM_PROGRAM_BITS) | MaskBits(program, NUM_PROGRAM_BITS);
+    key = (key << NUM_MATERIAL_BITS) | MaskBits(material, NUM_MATERIAL_BITS);
+    key = (key << NUM_MESH_BITS) | MaskBits(mesh, NUM_MESH_BITS);
+    return key;
+}
+
+uint32 RenderSortKey::QuantizeDepth(float depth)
+{
+    // The bit pattern of positive IEEE floats is monotonic. As the sign bit is always zero,
+    // dropping the lowest mantissa bits leaves exactly NUM_DEPTH_BITS bits.
+    static_assert(NUM_DEPTH_BITS == 21);
+    if (!(depth > 0.0f))  // Also catches NaN
+    {
+        return 0;
+    }
+
+    uint32 bits;
+    std::memcpy(&bits, &depth, sizeof(float));
+    return bits >> 10;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 void RenderQueue::Add(const RenderWorkItem& item)
 {
     item_indices_.push_back(items_.size());
     items_.push_back(item);
 }
 
-void RenderQueue::Sort()
+uint64 RenderQueue::MakeSortKey(const RenderWorkItem& item) const
 {
+    uint32 program = 0;
+    uint32 material_id = 0;
+    uint32 mesh_id = 0;
+
+    if (item.mesh != nullptr)
+    {
+        // Meshes of a scene share their buffers and only differ by their index range
+        const uint32 start_idx = item.mesh->start_idx;
+        mesh_id = FoldPointer(item.mesh->index_buffer.get(), RenderSortKey::NUM_MESH_BITS) ^
+            (uint32) MaskBits(start_idx ^ (start_idx >> RenderSortKey::NUM_MESH_BITS), RenderSortKey::NUM_MESH_BITS);
+
+        if (item.mesh->model != nullptr)
+        {
+            const Handle<Material> material_handle = item.mesh->model->materials_[item.mesh->material_slot];
+            material_id = material_handle.GetIndex();
+
+            if (const Material* material = gfx::resource_manager->materials.Get(material_handle))
+            {
+                program = (material->vs_.GetIndex() << (RenderSortKey::NUM_PROGRAM_BITS / 2)) ^ material->ps_.GetIndex();
+            }
+        }
+    }
+
     switch (sort_type_)
     {
     case RenderQueueSortType::FrontToBack:
-        std::sort(item_indices_.begin(), item_indices_.end(), [this](size_t& idx_a, size_t& idx_b) -> bool
-        {
-            const RenderWorkItem& a = items_[idx_a];
-            const RenderWorkItem& b = items_[idx_b];
-            return a.sort_key < b.sort_key;
-        });
-        break;
+        return RenderSortKey::MakeOpaque(item.layer, program, material_id, mesh_id, item.sort_key);
     case RenderQueueSortType::BackToFront:
-        std::sort(item_indices_.begin(), item_indices_.end(), [this](size_t& idx_a, size_t& idx_b) -> bool
-        {
-            const RenderWorkItem& a = items_[idx_a];
-            const RenderWorkItem& b = items_[idx_b];
-            return a.sort_key > b.sort_key;
-        });
-        break;
+        return RenderSortKey::MakeTranslucent(item.layer, program, material_id, mesh_id, item.sort_key);
     default:
         CHECK_NO_ENTRY();
     }
+
+    return 0;
+}
+
+void RenderQueue::Sort()
+{
+    const size_t num_items = items_.size();
+
+    keys_.resize(num_items);
+    indices_.resize(num_items);
+    for (size_t i = 0; i < num_items; ++i)
+    {
+        keys_[i] = MakeSortKey(items_[i]);
+        indices_[i] = (uint32) i;
+    }
+
+    RadixSort();
+
+    item_indices_.resize(num_items);
+    for (size_t i = 0; i < num_items; ++i)
+    {
+        item_indices_[i] = indices_[i];
+    }
+}
+
+void RenderQueue::RadixSort()
+{
+    // LSD radix sort, 8 passes with 8 bit digits. Each pass is a stable counting sort.
+    static constexpr uint32 NUM_DIGIT_BITS = 8;
+    static constexpr uint32 NUM_BUCKETS = 1 << NUM_DIGIT_BITS;
+    static constexpr uint32 NUM_PASSES = 64 / NUM_DIGIT_BITS;
+
+    const size_t num_items = keys_.size();
+    if (num_items < 2)
+    {
+        return;
+    }
+
+    keys_scratch_.resize(num_items);
+    indices_scratch_.resize(num_items);
+
+    // Build all histograms in a single sweep over the keys
+    uint32 histograms[NUM_PASSES][NUM_BUCKETS] = {};
+    for (uint64 key : keys_)
+    {
+        for (uint32 pass = 0; pass < NUM_PASSES; ++pass)
+        {
+            ++histograms[pass][(key >> (pass * NUM_DIGIT_BITS)) & (NUM_BUCKETS - 1)];
+        }
+    }
+
+    uint64* src_keys = keys_.data();
+    uint32* src_indices = indices_.data();
+    uint64* dst_keys = keys_scratch_.data();
+    uint32* dst_indices = indices_scratch_.data();
+
+    for (uint32 pass = 0; pass < NUM_PASSES; ++pass)
+    {
+        const uint32 shift = pass * NUM_DIGIT_BITS;
+        uint32* histogram = histograms[pass];
+
+        // All keys share this digit -> pass would not change the order
+        const uint32 first_digit = (src_keys[0] >> shift) & (NUM_BUCKETS - 1);
+        if (histogram[first_digit] == num_items)
+        {
+            continue;
+        }
+
+        // Exclusive prefix sum -> bucket offsets
+        uint32 offset = 0;
+        for (uint32 bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+        {
+            const uint32 count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < num_items; ++i)
+        {
+            const uint32 digit = (src_keys[i] >> shift) & (NUM_BUCKETS - 1);
+            const uint32 dst_idx = histogram[digit]++;
+            dst_keys[dst_idx] = src_keys[i];
+            dst_indices[dst_idx] = src_indices[i];
+        }
+
+        std::swap(src_keys, dst_keys);
+        std::swap(src_indices, dst_indices);
+    }
+
+    // Odd number of executed passes -> result lives in the scratch buffers
+    if (src_keys != keys_.data())
+    {
+        keys_.swap(keys_scratch_);
+        indices_.swap(indices_scratch_);
+    }
 }
 
 void RenderQueue::Clear()
 {
     items_.clear();
     item_indices_.clear();
+    keys_.clear();
+    indices_.clear();
 }
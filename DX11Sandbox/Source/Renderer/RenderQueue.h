@@ -9,15 +9,39 @@ enum RenderQueueSortType
     BackToFront
 };
 
+/**
+ * Packed 64 bit sort key. Higher bits take precedence when sorting.
+ *
+ * Opaque:      [layer:2][translucent:1][program:12][material:16][mesh:12][depth:21]
+ * Translucent: [layer:2][translucent:1][inverted depth:21][program:12][material:16][mesh:12]
+ *
+ * Opaque draws are grouped by state first and only use depth to break ties, translucent draws are strictly back to front.
+ * See: http://realtimecollisiondetection.net/blog/?p=86
+ */
+struct RenderSortKey
+{
+    static constexpr uint32 NUM_LAYER_BITS = 2;
+    static constexpr uint32 NUM_TRANSLUCENCY_BITS = 1;
+    static constexpr uint32 NUM_PROGRAM_BITS = 12;
+    static constexpr uint32 NUM_MATERIAL_BITS = 16;
+    static constexpr uint32 NUM_MESH_BITS = 12;
+    static constexpr uint32 NUM_DEPTH_BITS = 21;
+    static_assert(NUM_LAYER_BITS + NUM_TRANSLUCENCY_BITS + NUM_PROGRAM_BITS + NUM_MATERIAL_BITS + NUM_MESH_BITS + NUM_DEPTH_BITS == 64);
+
+    static uint64 MakeOpaque(uint32 layer, uint32 program, uint32 material, uint32 mesh, float depth);
+    static uint64 MakeTranslucent(uint32 layer, uint32 program, uint32 material, uint32 mesh, float depth);
+
+    // Maps any non-negative depth to 21 bits while preserving its order.
+    static uint32 QuantizeDepth(float depth);
+};
+
 struct RenderWorkItem
 {
-    // TODO: For now we only sort by depth.
-    // A better solution would be to generate a sort key which also considers materials, render states, etc.
-    // See: https://aras-p.info/blog/2014/01/16/rough-sorting-by-depth/
-    // http://realtimecollisiondetection.net/blog/?p=86
+    // Depth of the item, e.g. (squared) distance to the camera. Only has to be monotonic, it is quantized into the sort key.
     float sort_key = 0.0f;
     StaticMesh* mesh = nullptr; // TODO: handle?
     bool is_shadow_receiver = true;
+    uint8 layer = 0;
 };
 
 class RenderQueue
@@ -32,4 +56,15 @@ public:
     RenderQueueSortType sort_type_;
     std::vector<RenderWorkItem> items_;
     std::vector<size_t> item_indices_;
-};
\ No newline at end of file
+
+private:
+    uint64 MakeSortKey(const RenderWorkItem& item) const;
+    void RadixSort();
+
+    // Sort keys and item indices are sorted side by side. The scratch buffers keep their capacity between frames,
+    // so sorting does not allocate once the queue has warmed up.
+    std::vector<uint64> keys_;
+    std::vector<uint32> indices_;
+    std::vector<uint64> keys_scratch_;
+    std::vector<uint32> indices_scratch_;
+};
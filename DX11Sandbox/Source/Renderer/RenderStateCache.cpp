@@ -1,7 +1,7 @@
-#include "RenderState.h"
+#include "Renderer/RenderStateCache.h"
 
-#include "DX11Util.h"
-#include "GraphicsContext.h"
+#include "Renderer/D3D11Backend.h"
+#include "Renderer/DX11Util.h"
 
 RenderStateCache::RenderStateCache()
 {
@@ -1,53 +1,90 @@
 #pragma once
+#include <mutex>
+
+#include "Core/ConcurrentPool.h"
 #include "Core/Handle.h"
-#include "Core/Pool.h"
 
 #include "Renderer/Texture.h"
 #include "Renderer/Material.h"
+#include "Renderer/ShaderArchive.h"
+#include "Renderer/TextureStreaming.h"
 
+/**
+ * Maps resource descriptors to handles and owns the resources. Can be used from any thread.
+ *
+ * The descriptor map is split into shards with their own lock, so lookups of unrelated descriptors rarely contend.
+ * If several threads request the same descriptor at once, only the first one creates the resource. The others block until
+ * it is ready and receive the same handle.
+ *
+ * Note that this doesn't make the resources themselves thread safe to construct, e.g. textures use the immediate context.
+ */
 template<typename ResourceType, typename ResourceDescriptorType>
 class ResourceCache
 {
 public:
-    Handle<ResourceType> Create(const ResourceDescriptorType& desc)
+    // Always creates a new resource and makes it the one returned for this descriptor.
+    // Additional arguments are forwarded to the resource's constructor, e.g. to pass data which was prepared on another thread.
+    template<typename... Args>
+    Handle<ResourceType> Create(const ResourceDescriptorType& desc, Args&&... args)
     {
-        Handle<ResourceType> out_handle = resource_pool_.Create(desc);
-        ResourceType* resource = resource_pool_.Get(out_handle);
-        CHECK(resource != nullptr);
-        descriptor_to_handle_map_[desc] = out_handle;
+        Handle<ResourceType> out_handle = resource_pool_.Create(desc, std::forward<Args>(args)...);
+        CHECK(resource_pool_.Get(out_handle) != nullptr);
+
+        Shard& shard = GetShard(desc);
+        std::atomic<Handle<ResourceType>>* entry = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            entry = &shard.entries[desc];
+        }
+        entry->store(out_handle, std::memory_order_release);
+        entry->notify_all();
+
         return out_handle;
     }
 
     Handle<ResourceType> GetHandle(const ResourceDescriptorType& desc)
     {
-        Handle<ResourceType> handle;
+        Shard& shard = GetShard(desc);
 
-        auto it = descriptor_to_handle_map_.find(desc);
-        if (it != descriptor_to_handle_map_.end())
+        std::atomic<Handle<ResourceType>>* entry = nullptr;
+        bool is_owner = false;
         {
-            handle = it->second;
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto [it, is_inserted] = shard.entries.try_emplace(desc);
+            entry = &it->second;
+            is_owner = is_inserted;
         }
 
-        if (!handle.IsValid())
+        // Map nodes don't move on rehash, so the entry can be accessed without holding the lock
+        if (is_owner)
         {
-            handle = Create(desc);
+            entry->store(resource_pool_.Create(desc), std::memory_order_release);
+            entry->notify_all();
+        }
+        else
+        {
+            // An invalid handle means another thread is still creating the resource
+            entry->wait(Handle<ResourceType>(), std::memory_order_acquire);
         }
 
-        return handle;
+        return entry->load(std::memory_order_acquire);
     }
 
     ResourceType* Get(const ResourceDescriptorType& desc) const
     {
-        ResourceType* out = nullptr;
-
-        auto it = descriptor_to_handle_map_.find(desc);
-        if (it != descriptor_to_handle_map_.end())
+        Handle<ResourceType> handle;
         {
-            Handle<ResourceType> handle = it->second;
-            out = Get(handle);
+            const Shard& shard = GetShard(desc);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            auto it = shard.entries.find(desc);
+            if (it != shard.entries.end())
+            {
+                handle = it->second.load(std::memory_order_acquire);
+            }
         }
 
-        return out;
+        return Get(handle);
     }
 
     ResourceType* Get(Handle<ResourceType> handle) const
@@ -60,16 +97,44 @@ public:
         resource_pool_.Destroy(handle);
     }
 
+    // Visits every live resource of this type
+    template<typename Func>
+    void ForEach(Func&& func) const
+    {
+        resource_pool_.ForEach(std::forward<Func>(func));
+    }
+
+    size_t Size() const { return resource_pool_.Size(); }
+
 private:
-    std::unordered_map<ResourceDescriptorType, Handle<ResourceType>> descriptor_to_handle_map_;
-    Pool<ResourceType, ResourceType> resource_pool_;
+    static constexpr uint32 NUM_SHARDS = 16;
+
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<ResourceDescriptorType, std::atomic<Handle<ResourceType>>> entries;
+    };
+
+    Shard& GetShard(const ResourceDescriptorType& desc) const
+    {
+        // Mix the bits, the hashes of some descriptors are only as good as their low bits
+        const uint64 hash = std::hash<ResourceDescriptorType>()(desc) * 0x9E3779B97F4A7C15ull;
+        return shards_[(hash >> 32) % NUM_SHARDS];
+    }
+
+    mutable Shard shards_[NUM_SHARDS];
+    ConcurrentPool<ResourceType, ResourceType> resource_pool_;
 };
 
 struct ResourceManager
 {
     ResourceCache<Texture, TextureDesc> textures;
+    TextureStreamer texture_streamer{ textures };   // Declared after the textures, pending loads are finished before they go away
     ResourceCache<VertexShader, VertexShaderDesc> vertex_shaders;
     ResourceCache<PixelShader, PixelShaderDesc> pixel_shaders;
     ResourceCache<UncompiledShader, UncompiledShaderDesc> uncompiled_shaders;
     ResourceCache<Material, MaterialDesc> materials;
+
+    // Precompiled shader permutations. Shaders which are not part of it get compiled on demand.
+    ShaderArchive shader_archive;
 };
@@ -1,49 +1,14 @@
 #pragma once
 
-#include <d3d11shader.h>
+#include <span>
 
 #include "Core/FileIO.h"
 #include "Renderer/ConstantBuffer.h"
-#include "Renderer/DX11Types.h"
-#include "Renderer/DX11Util.h"
+#include "Renderer/ShaderCompiler.h"
 #include "Renderer/Vertex.h"
 
 class ConstantBuffer;
 
-struct ShaderMacro
-{
-    std::string name;
-    std::string value;
-
-    bool operator==(const ShaderMacro& other) const
-    {
-        return name == other.name && value == other.value;
-    }
-};
-MAKE_HASHABLE(ShaderMacro, t.name, t.value);
-
-struct ShaderCompiler
-{
-    static HRESULT Compile(const std::string& asset_path, const std::vector<uint8>& shader_bytes, const std::vector<ShaderMacro>& defines, const char* entry_point,
-        const char* shader_target, ComPtr<ID3DBlob>& out_shader_blob);
-};
-
-enum class EShaderType
-{
-    VS,
-    PS,
-    CS,
-    DS,
-    GS,
-    HS,
-};
-
-struct TextureBindingDesc
-{
-    std::string name;
-    UINT slot;
-};
-
 struct UncompiledShaderDesc
 {
     std::string path;
@@ -94,17 +59,22 @@ public:
 
     bool Compile(const std::vector<uint8>& bytes);
 
+    std::span<const uint8> GetBytecode() const
+    {
+        CHECK(bytecode_.empty() == false);
+        return bytecode_;
+    }
+
 protected:
     virtual void Reflect();
 
     EShaderType shader_type_;
     std::string asset_path_;
-    ComPtr<ID3DBlob> shader_blob_;
-    ComPtr<ID3D11ShaderReflection> shader_reflection_;
-    D3D11_SHADER_DESC shader_desc_;
+    std::vector<uint8> bytecode_;
 
     std::vector<CBufferBindingDesc> cbuffer_bindings_;
     std::vector<TextureBindingDesc> texture_bindings_;
+    std::vector<ShaderInputParameter> input_parameters_;
     std::vector<ShaderMacro> defines_;
 };
 
@@ -143,17 +113,20 @@ namespace std
 class VertexShader : public ShaderBase
 {
 public:
+    // Inputs with this semantic are read per instance from VertexBufferSlots::INSTANCE_INDEX
+    static constexpr const char* INSTANCE_INDEX_SEMANTIC = "INSTANCE_INDEX";
+
     VertexShader(const VertexShaderDesc& desc);
     virtual ~VertexShader() {};
 
     void Bind();
 
-    ComPtr<ID3D11VertexShader> GetNativePtr() const
+    const SharedPtr<GpuVertexShader>& GetNativePtr() const
     {
         return native_ptr_;
     }
 
-    ComPtr<ID3D11InputLayout> GetInputLayout() const
+    const SharedPtr<GpuInputLayout>& GetInputLayout() const
     {
         return input_layout_;
     }
@@ -161,10 +134,12 @@ public:
 protected:
     virtual void Reflect() override;
 
+    // One slot per input in declaration order, except for instance indices and the packed vertex formats (QUANTIZED_POSITION,
+    // PACKED_NORMAL, PACKED_TANGENT, PACKED_UV), which go to their fixed slots and offsets, see PackedVertexAttributes.
     void CreateInputLayoutFromReflection();
 
-    ComPtr<ID3D11VertexShader> native_ptr_;
-    ComPtr<ID3D11InputLayout> input_layout_;
+    SharedPtr<GpuVertexShader> native_ptr_;
+    SharedPtr<GpuInputLayout> input_layout_;
 };
 
 struct PixelShaderDesc
@@ -208,5 +183,5 @@ public:
     void Bind();
 
 protected:
-    ComPtr<ID3D11PixelShader> native_ptr_;
+    SharedPtr<GpuPixelShader> native_ptr_;
 };
@@ -0,0 +1,166 @@
+#include "Renderer/ShaderArchive.h"
+
+#include <fstream>
+
+uint64 ShaderArchive::ComputeKey(const std::string& path, const std::vector<ShaderMacro>& defines, EShaderType shader_type)
+{
+    std::vector<const ShaderMacro*> sorted_defines;
+    for (const ShaderMacro& define : defines)
+    {
+        sorted_defines.push_back(&define);
+    }
+    std::sort(sorted_defines.begin(), sorted_defines.end(), [](const ShaderMacro* a, const ShaderMacro* b) { return a->name < b->name; });
+
+    // Same file, different spelling (e.g. "./assets/shaders/../shaders/x.hlsl") -> same key
+    const std::string normalized_path = std::filesystem::path(path).lexically_normal().generic_string();
+
+    uint64 key = Hash::HashBytes(normalized_path.data(), normalized_path.size());
+    key = Hash::HashBytes(&shader_type, sizeof(shader_type), key);
+    for (const ShaderMacro* define : sorted_defines)
+    {
+        // Separators, so {"AB", ""} and {"A", "B"} don't collide
+        key = Hash::HashBytes(define->name.data(), define->name.size(), key);
+        key = Hash::HashBytes("=", 1, key);
+        key = Hash::HashBytes(define->value.data(), define->value.size(), key);
+        key = Hash::HashBytes(";", 1, key);
+    }
+
+    return key;
+}
+
+uint64 ShaderArchive::ComputeSourceHash(const std::string& shader_dir)
+{
+    std::vector<std::filesystem::path> files;
+    std::error_code error;
+    for (const auto& dir_entry : std::filesystem::directory_iterator(shader_dir, error))
+    {
+        const std::filesystem::path extension = dir_entry.path().extension();
+        if (dir_entry.is_regular_file() && (extension == ".hlsl" || extension == ".hlsli"))
+        {
+            files.push_back(dir_entry.path());
+        }
+    }
+
+    // Directory iteration order is unspecified
+    std::sort(files.begin(), files.end());
+
+    const uint64 num_files = files.size();
+    uint64 hash = Hash::HashBytes(&num_files, sizeof(num_files));
+    for (const std::filesystem::path& file_path : files)
+    {
+        const std::string file_name = file_path.filename().generic_string();
+        hash = Hash::HashBytes(file_name.data(), file_name.size(), hash);
+
+        MappedFile file;
+        if (file.Open(file_path.string()))
+        {
+            hash = Hash::HashBytes(file.GetData(), file.GetSize(), hash);
+        }
+    }
+
+    return hash;
+}
+
+bool ShaderArchive::Write(const std::string& path, std::vector<Bytecode>& bytecodes, uint32 compile_flags, uint64 source_hash)
+{
+    std::sort(bytecodes.begin(), bytecodes.end(), [](const Bytecode& a, const Bytecode& b) { return a.key < b.key; });
+
+    Header header;
+    header.compile_flags = compile_flags;
+    header.num_entries = (uint32) bytecodes.size();
+    header.source_hash = source_hash;
+
+    std::vector<Entry> entries;
+    uint64 offset = sizeof(Header) + sizeof(Entry) * bytecodes.size();
+    for (const Bytecode& bytecode : bytecodes)
+    {
+        if (entries.empty() == false && entries.back().key == bytecode.key)
+        {
+            LOG_ERROR("Duplicate shader permutation key {:016x}", bytecode.key);
+            return false;
+        }
+
+        entries.push_back({ .key = bytecode.key, .offset = offset, .size = bytecode.data.size() });
+        offset += bytecode.data.size();
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        return false;
+    }
+
+    file.write((const char*) &header, sizeof(Header));
+    file.write((const char*) entries.data(), sizeof(Entry) * entries.size());
+    for (const Bytecode& bytecode : bytecodes)
+    {
+        file.write((const char*) bytecode.data.data(), bytecode.data.size());
+    }
+
+    return file.good();
+}
+
+bool ShaderArchive::Load(const std::string& path)
+{
+    if (file_.Open(path) == false)
+    {
+        return false;
+    }
+
+    const auto fail = [this, &path](const char* reason)
+    {
+        LOG_WARN("Ignoring shader archive {}: {}", path, reason);
+        file_.Close();
+        entries_ = {};
+        return false;
+    };
+
+    if (file_.GetSize() < sizeof(Header))
+    {
+        return fail("truncated");
+    }
+
+    const Header& header = *(const Header*) file_.GetData();
+    if (header.magic != Header::MAGIC || header.version != Header::VERSION)
+    {
+        return fail("unknown format");
+    }
+
+    if (header.compile_flags != ShaderCompiler::GetCompileFlags())
+    {
+        return fail("built with different compile flags");
+    }
+
+    if (sizeof(Header) + sizeof(Entry) * (uint64) header.num_entries > file_.GetSize())
+    {
+        return fail("truncated");
+    }
+
+    entries_ = { (const Entry*) (file_.GetData() + sizeof(Header)), header.num_entries };
+    for (const Entry& entry : entries_)
+    {
+        if (entry.offset > file_.GetSize() || entry.size > file_.GetSize() - entry.offset)
+        {
+            return fail("truncated");
+        }
+    }
+
+    if (header.source_hash != ComputeSourceHash(SHADER_DIR))
+    {
+        return fail("shader sources changed since it was built");
+    }
+
+    LOG("Loaded shader archive {} with {} permutations", path, entries_.size());
+    return true;
+}
+
+std::span<const uint8> ShaderArchive::Find(uint64 key) const
+{
+    const auto it = std::lower_bound(entries_.begin(), entries_.end(), key, [](const Entry& entry, uint64 key) { return entry.key < key; });
+    if (it == entries_.end() || it->key != key)
+    {
+        return {};
+    }
+
+    return { file_.GetData() + it->offset, (size_t) it->size };
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <span>
+
+#include "Core/MappedFile.h"
+#include "Renderer/Shader.h"
+
+/**
+ * Packed archive of precompiled shader permutations, written by the ShaderPrecompiler tool.
+ *
+ * [header][entries sorted by key][bytecode]
+ *
+ * Entries are keyed by shader path, defines and target, so a VertexShaderDesc / PixelShaderDesc can be looked up directly.
+ * The archive is ignored as a whole if it was built with other compile flags or if any file in the shader directory changed since.
+ */
+class ShaderArchive
+{
+public:
+    static constexpr const char* DEFAULT_PATH = "assets/shaders/shaders.pak";
+    static constexpr const char* SHADER_DIR = "assets/shaders";
+
+    struct Header
+    {
+        static constexpr uint32 MAGIC = 0x41535844;    // "DXSA"
+        static constexpr uint32 VERSION = 1;
+
+        uint32 magic = MAGIC;
+        uint32 version = VERSION;
+        uint32 compile_flags = 0;
+        uint32 num_entries = 0;
+        uint64 source_hash = 0;
+    };
+
+    struct Entry
+    {
+        uint64 key = 0;
+        uint64 offset = 0;  // From the start of the file
+        uint64 size = 0;
+    };
+
+    struct Bytecode
+    {
+        uint64 key = 0;
+        std::vector<uint8> data;
+    };
+
+    // Defines are sorted by name first, so their order doesn't matter
+    static uint64 ComputeKey(const std::string& path, const std::vector<ShaderMacro>& defines, EShaderType shader_type);
+
+    // Hash of all .hlsl and .hlsli files in the directory
+    static uint64 ComputeSourceHash(const std::string& shader_dir);
+
+    static bool Write(const std::string& path, std::vector<Bytecode>& bytecodes, uint32 compile_flags, uint64 source_hash);
+
+    bool Load(const std::string& path);
+    bool IsValid() const { return file_.IsValid(); }
+
+    // Returns an empty span if the permutation is not part of the archive
+    std::span<const uint8> Find(uint64 key) const;
+
+    uint32 GetNumEntries() const { return (uint32) entries_.size(); }
+
+private:
+    MappedFile file_;
+    std::span<const Entry> entries_;
+};
@@ -0,0 +1,117 @@
+#include "Renderer/ShaderCache.h"
+
+#include <fstream>
+
+namespace
+{
+    struct CacheEntryHeader
+    {
+        static constexpr uint32 MAGIC = 0x48435844;    // "DXCH"
+        static constexpr uint32 VERSION = 1;
+
+        uint32 magic = MAGIC;
+        uint32 version = VERSION;
+        uint64 key = 0;
+        uint64 bytecode_size = 0;
+    };
+
+    std::filesystem::path GetEntryPath(uint64 key)
+    {
+        return std::filesystem::path(ShaderCache::CACHE_DIR) / fmt::format("{:016x}.cso", key);
+    }
+}
+
+uint64 ShaderCache::ComputeKey(const void* preprocessed_source, size_t preprocessed_size, const char* entry_point, const char* shader_target,
+    uint32 compile_flags, uint32 compiler_version)
+{
+    // Macros are already expanded in the preprocessed source. Defines which are never referenced don't change the key, which is fine.
+
+    uint64 key = Hash::HashBytes(preprocessed_source, preprocessed_size);
+    key = Hash::HashBytes(entry_point, std::strlen(entry_point), key);
+    key = Hash::HashBytes(shader_target, std::strlen(shader_target), key);
+    key = Hash::HashBytes(&compile_flags, sizeof(compile_flags), key);
+    key = Hash::HashBytes(&compiler_version, sizeof(compiler_version), key);
+    return key;
+}
+
+bool ShaderCache::Load(uint64 key, std::vector<uint8>& out_bytecode)
+{
+    std::ifstream file(GetEntryPath(key), std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return false;
+    }
+
+    CacheEntryHeader header;
+    if (file.read((char*) &header, sizeof(header)).good() == false ||
+        header.magic != CacheEntryHeader::MAGIC || header.version != CacheEntryHeader::VERSION || header.key != key || header.bytecode_size == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8> bytecode(header.bytecode_size);
+    if (file.read((char*) bytecode.data(), header.bytecode_size).good() == false)
+    {
+        // Truncated entry, e.g. the application was killed while writing it. Gets overwritten after recompiling.
+        return false;
+    }
+
+    out_bytecode = std::move(bytecode);
+    return true;
+}
+
+void ShaderCache::Store(uint64 key, std::span<const uint8> bytecode)
+{
+    CHECK(bytecode.empty() == false);
+
+    std::error_code error;
+    std::filesystem::create_directories(CACHE_DIR, error);
+
+    std::ofstream file(GetEntryPath(key), std::ios::binary | std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        LOG_WARN("Failed to write shader cache entry: {}", GetEntryPath(key).string());
+        return;
+    }
+
+    CacheEntryHeader header;
+    header.key = key;
+    header.bytecode_size = bytecode.size();
+    file.write((const char*) &header, sizeof(header));
+    file.write((const char*) bytecode.data(), bytecode.size());
+}
+
+void ShaderCache::RecordHit(double time_ms)
+{
+    std::scoped_lock lock(stats_mutex_);
+    stats_.num_hits++;
+    stats_.hit_time_ms += time_ms;
+}
+
+void ShaderCache::RecordMiss(double time_ms)
+{
+    std::scoped_lock lock(stats_mutex_);
+    stats_.num_misses++;
+    stats_.miss_time_ms += time_ms;
+}
+
+ShaderCacheStats ShaderCache::GetStats()
+{
+    std::scoped_lock lock(stats_mutex_);
+    return stats_;
+}
+
+void ShaderCache::LogStats()
+{
+    const ShaderCacheStats stats = GetStats();
+    const uint32 num_shaders = stats.num_hits + stats.num_misses;
+    if (num_shaders == 0)
+    {
+        return;
+    }
+
+    // All hits -> warm start, all misses -> cold start
+    LOG("Shader startup ({}): {} shaders in {:.1f} ms. {} cache hits ({:.1f} ms), {} compiled ({:.1f} ms)",
+        stats.num_misses == 0 ? "warm" : (stats.num_hits == 0 ? "cold" : "partially warm"), num_shaders, stats.hit_time_ms + stats.miss_time_ms,
+        stats.num_hits, stats.hit_time_ms, stats.num_misses, stats.miss_time_ms);
+}
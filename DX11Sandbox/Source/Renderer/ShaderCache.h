@@ -0,0 +1,39 @@
+#pragma once
+#include <mutex>
+#include <span>
+
+struct ShaderCacheStats
+{
+    uint32 num_hits = 0;
+    uint32 num_misses = 0;
+    double hit_time_ms = 0.0;   // Preprocessing + loading the bytecode
+    double miss_time_ms = 0.0;  // Preprocessing + compiling + storing the bytecode
+};
+
+/**
+ * On-disk cache for compiled shader bytecode.
+ * Entries are keyed by the preprocessed source, so changing any included file invalidates all shaders that include it.
+ * The key also covers macros, entry point, target, compile flags and compiler version. Stale entries are simply never looked up again.
+ */
+struct ShaderCache
+{
+    static constexpr const char* CACHE_DIR = "intermediate/shader_cache";
+
+    static uint64 ComputeKey(const void* preprocessed_source, size_t preprocessed_size, const char* entry_point, const char* shader_target,
+        uint32 compile_flags, uint32 compiler_version);
+
+    static bool Load(uint64 key, std::vector<uint8>& out_bytecode);
+    static void Store(uint64 key, std::span<const uint8> bytecode);
+
+    static void RecordHit(double time_ms);
+    static void RecordMiss(double time_ms);
+    static ShaderCacheStats GetStats();
+    static void LogStats();
+
+    static inline bool is_enabled = true;
+
+private:
+    // Shaders may be compiled from several threads, e.g. by the ShaderPrecompiler tool
+    static inline std::mutex stats_mutex_;
+    static inline ShaderCacheStats stats_;
+};
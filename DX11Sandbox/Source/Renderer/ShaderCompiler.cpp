@@ -0,0 +1,335 @@
+#pragma comment(lib, "dxguid.lib")
+
+#include "Renderer/ShaderCompiler.h"
+
+#include <chrono>
+#include <d3dcompiler.h>
+#include <d3d11shader.h>
+
+#include "Renderer/DX11Util.h"
+#include "Renderer/ShaderCache.h"
+
+namespace
+{
+    static const std::unordered_map<EShaderType, const char*> SHADER_TARGET_MAP =
+    {
+        { EShaderType::VS, "vs_5_0" },
+        { EShaderType::PS, "ps_5_0" }
+    };
+
+    static GpuFormat GetInputFormat(const D3D11_SIGNATURE_PARAMETER_DESC& parameter_desc)
+    {
+        BYTE component_mask = parameter_desc.Mask;
+        int num_components = 0;
+        while (component_mask)
+        {
+            if (component_mask & 0x01)
+            {
+                num_components++;
+            }
+
+            component_mask = component_mask >> 1;
+        }
+
+        if (parameter_desc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32)
+        {
+            switch (num_components)
+            {
+            case 1: return GpuFormat::R32_Float;
+            case 2: return GpuFormat::R32G32_Float;
+            case 3: return GpuFormat::R32G32B32_Float;
+            case 4: return GpuFormat::R32G32B32A32_Float;
+            default: CHECK_NO_ENTRY();
+            }
+        }
+        else if (parameter_desc.ComponentType == D3D_REGISTER_COMPONENT_SINT32)
+        {
+            switch (num_components)
+            {
+            case 1: return GpuFormat::R32_SInt;
+            case 2: return GpuFormat::R32G32_SInt;
+            case 3: return GpuFormat::R32G32B32_SInt;
+            case 4: return GpuFormat::R32G32B32A32_SInt;
+            default: CHECK_NO_ENTRY();
+            }
+        }
+        else if (parameter_desc.ComponentType == D3D_REGISTER_COMPONENT_UINT32)
+        {
+            switch (num_components)
+            {
+            case 1: return GpuFormat::R32_UInt;
+            case 2: return GpuFormat::R32G32_UInt;
+            case 3: return GpuFormat::R32G32B32_UInt;
+            case 4: return GpuFormat::R32G32B32A32_UInt;
+            default: CHECK_NO_ENTRY();
+            }
+        }
+        else
+        {
+            CHECK_NO_ENTRY();
+        }
+
+        return GpuFormat::Unknown;
+    }
+
+    static CBufferBindingDesc ReflectCBuffer(ID3D11ShaderReflectionConstantBuffer* cbuffer, const D3D11_SHADER_BUFFER_DESC& shader_buffer_desc,
+        uint32 slot)
+    {
+        CBufferBindingDesc cbuffer_desc;
+        cbuffer_desc.name = shader_buffer_desc.Name;
+        cbuffer_desc.slot = slot;
+
+        for (UINT var_idx = 0; var_idx < shader_buffer_desc.Variables; ++var_idx)
+        {
+            ID3D11ShaderReflectionVariable* var = cbuffer->GetVariableByIndex(var_idx);
+            CHECK(var != nullptr);
+
+            D3D11_SHADER_VARIABLE_DESC var_desc;
+            DX11_VERIFY(var->GetDesc(&var_desc));
+            LOG("-- Var: {}", var_desc.Name);
+
+            ID3D11ShaderReflectionType* var_type = var->GetType();
+            CHECK(var_type != nullptr);
+
+            D3D11_SHADER_TYPE_DESC var_type_desc;
+            DX11_VERIFY(var_type->GetDesc(&var_type_desc));
+
+            CBufferParam cbuffer_param;
+            cbuffer_param.offset = var_desc.StartOffset;
+
+            if (var_type_desc.Class == D3D_SHADER_VARIABLE_CLASS::D3D10_SVC_MATRIX_COLUMNS)
+            {
+                if (var_type_desc.Columns == 3)
+                {
+                    cbuffer_param.type = ParameterType::Mat3;
+                }
+                else if (var_type_desc.Columns == 4)
+                {
+                    cbuffer_param.type = ParameterType::Mat4;
+                }
+            }
+            else if (var_type_desc.Class == D3D_SHADER_VARIABLE_CLASS::D3D_SVC_VECTOR)
+            {
+                if (var_type_desc.Columns == 2)
+                {
+                    cbuffer_param.type = ParameterType::Vec2;
+                }
+                else if (var_type_desc.Columns == 3)
+                {
+                    cbuffer_param.type = ParameterType::Vec3;
+                }
+                else if (var_type_desc.Columns == 4)
+                {
+                    cbuffer_param.type = ParameterType::Vec4;
+                }
+            }
+            else if (var_type_desc.Class == D3D_SHADER_VARIABLE_CLASS::D3D_SVC_SCALAR)
+            {
+                // TODO: Check var_type_desc.Type for float / int etc
+                if(var_type_desc.Type == D3D_SHADER_VARIABLE_TYPE::D3D_SVT_FLOAT)
+                {
+                    cbuffer_param.type = ParameterType::Float;
+                }
+                else if(var_type_desc.Type == D3D_SHADER_VARIABLE_TYPE::D3D_SVT_INT ||
+                    var_type_desc.Type == D3D_SHADER_VARIABLE_TYPE::D3D_SVT_UINT)
+                {
+                    cbuffer_param.type = ParameterType::Int;
+                }
+            }
+            else
+            {
+                LOG("Unparsed parameter type");
+            }
+
+            cbuffer_desc.param_map[var_desc.Name] = cbuffer_param;
+        }
+
+        return cbuffer_desc;
+    }
+}
+
+uint32 ShaderCompiler::GetCompileFlags()
+{
+    // See https://docs.microsoft.com/en-us/windows/win32/direct3dhlsl/d3dcompile-constants
+    uint32 compile_flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifndef NDEBUG
+    compile_flags |= D3DCOMPILE_DEBUG;
+    compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    return compile_flags;
+}
+
+const char* ShaderCompiler::GetShaderTarget(EShaderType shader_type)
+{
+    const auto it = ::SHADER_TARGET_MAP.find(shader_type);
+    CHECK_MSG(it != ::SHADER_TARGET_MAP.end(), "Tried to compile unknown shader type");
+    return it != ::SHADER_TARGET_MAP.end() ? it->second : nullptr;
+}
+
+bool ShaderCompiler::Compile(const std::string& asset_path, const std::vector<uint8>& shader_bytes, const std::vector<ShaderMacro>& defines, const char* entry_point,
+    const char* shader_target, std::vector<uint8>& out_bytecode)
+{
+    CHECK(shader_bytes.size() > 0);
+
+    const uint32 compile_flags = GetCompileFlags();
+
+    std::vector<D3D_SHADER_MACRO> shader_macros;
+    for (const auto& d : defines)
+    {
+        shader_macros.push_back({
+            .Name = d.name.c_str(),
+            .Definition = d.value.c_str()
+        });
+    }
+
+    constexpr size_t NUM_DEFAULT_DEFINES = 1;
+    static const std::array<D3D_SHADER_MACRO, NUM_DEFAULT_DEFINES> DEFAULT_DEFINES = {
+        { nullptr, nullptr }
+    };
+    shader_macros.insert(shader_macros.end(), DEFAULT_DEFINES.begin(), DEFAULT_DEFINES.end());
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+    auto get_elapsed_ms = [&start_time]()
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+    };
+
+    // The preprocessed source contains all includes and expanded macros -> Hashing it catches changes in any included file
+    ComPtr<ID3DBlob> error_blob = nullptr;
+    ComPtr<ID3DBlob> preprocessed_blob = nullptr;
+    uint64 cache_key = 0;
+    bool use_cache = ShaderCache::is_enabled;
+    if (use_cache)
+    {
+        use_cache = SUCCEEDED(D3DPreprocess(shader_bytes.data(), shader_bytes.size(), asset_path.c_str(), shader_macros.data(),
+            D3D_COMPILE_STANDARD_FILE_INCLUDE, &preprocessed_blob, &error_blob));
+    }
+
+    if (use_cache)
+    {
+        cache_key = ShaderCache::ComputeKey(preprocessed_blob->GetBufferPointer(), preprocessed_blob->GetBufferSize(), entry_point, shader_target,
+            compile_flags, D3D_COMPILER_VERSION);
+
+        if (ShaderCache::Load(cache_key, out_bytecode))
+        {
+            const double elapsed_ms = get_elapsed_ms();
+            ShaderCache::RecordHit(elapsed_ms);
+            LOG("Loaded shader {} from cache in {:.2f} ms", asset_path, elapsed_ms);
+            return true;
+        }
+    }
+
+    // Preprocessing errors are reported by the compiler again
+    error_blob = nullptr;
+    ComPtr<ID3DBlob> shader_blob = nullptr;
+    HRESULT result = D3DCompile
+    (
+        shader_bytes.data(),    // src to compile
+        shader_bytes.size(),    // src size
+        asset_path.c_str(),                // src name
+        shader_macros.data(),
+        D3D_COMPILE_STANDARD_FILE_INCLUDE,                // includes
+        entry_point,
+        shader_target,
+        compile_flags,          // compile constants
+        0,                      // effect constants. ignored => 0
+        &shader_blob,           // the compiled shader
+        &error_blob             // error information
+    );
+
+    // Sanity Check
+    if (FAILED(result) && error_blob != nullptr)
+    {
+        char* error_str = static_cast<char*>(error_blob->GetBufferPointer());
+        LOG_ERROR("Shader compilation failed:\n{}", error_str);
+    }
+
+    if (SUCCEEDED(result))
+    {
+        const uint8* bytecode = static_cast<const uint8*>(shader_blob->GetBufferPointer());
+        out_bytecode.assign(bytecode, bytecode + shader_blob->GetBufferSize());
+
+        if (use_cache)
+        {
+            ShaderCache::Store(cache_key, out_bytecode);
+        }
+
+        const double elapsed_ms = get_elapsed_ms();
+        ShaderCache::RecordMiss(elapsed_ms);
+        LOG("Compiled shader {} in {:.2f} ms", asset_path, elapsed_ms);
+    }
+
+    return SUCCEEDED(result);
+}
+
+bool ShaderCompiler::Reflect(std::span<const uint8> bytecode, ShaderReflection& out_reflection)
+{
+    CHECK(bytecode.empty() == false);
+
+    ComPtr<ID3D11ShaderReflection> shader_reflection;
+    D3D11_SHADER_DESC shader_desc;
+    if (FAILED(D3DReflect(bytecode.data(), bytecode.size(), IID_ID3D11ShaderReflection, &shader_reflection)) ||
+        FAILED(shader_reflection->GetDesc(&shader_desc)))
+    {
+        LOG_ERROR("Shader reflection failed");
+        return false;
+    }
+
+    for (size_t i = 0; i < shader_desc.BoundResources; i++)
+    {
+        D3D11_SHADER_INPUT_BIND_DESC binding_desc;
+        shader_reflection->GetResourceBindingDesc(static_cast<uint32>(i), &binding_desc);
+
+        if(binding_desc.Type == D3D_SHADER_INPUT_TYPE::D3D_SIT_CBUFFER)
+        {
+            const std::string& cbuffer_name(binding_desc.Name);
+            if(cbuffer_name != ConstantBuffer::CBUFFER_NAME_PER_MATERIAL)
+            {
+                // Skip - These will be set from outside shaders / materials
+                continue;
+            }
+
+            ID3D11ShaderReflectionConstantBuffer* cbuffer = shader_reflection->GetConstantBufferByName(binding_desc.Name);
+            CHECK(cbuffer != nullptr);
+
+            D3D11_SHADER_BUFFER_DESC shader_buffer_desc;
+            DX11_VERIFY(cbuffer->GetDesc(&shader_buffer_desc));
+
+            if (shader_buffer_desc.Type == D3D11_CBUFFER_TYPE::D3D11_CT_CBUFFER)
+            {
+                LOG("Cbuffer: {}", shader_buffer_desc.Name);
+                out_reflection.cbuffer_bindings.push_back(ReflectCBuffer(cbuffer, shader_buffer_desc, static_cast<uint32>(binding_desc.BindPoint)));
+            }
+        }
+
+        if (binding_desc.Type == D3D_SHADER_INPUT_TYPE::D3D_SIT_TEXTURE)
+        {
+            LOG("Texture binding: {}", binding_desc.Name);
+            TextureBindingDesc desc
+            {
+                .name = binding_desc.Name,
+                .slot = binding_desc.BindPoint
+            };
+            out_reflection.texture_bindings.push_back(desc);
+        }
+
+        if (binding_desc.Type == D3D_SHADER_INPUT_TYPE::D3D_SIT_SAMPLER)
+        {
+            LOG("Sampler binding {}", binding_desc.Name);
+        }
+    }
+
+    for (UINT i = 0; i < shader_desc.InputParameters; ++i)
+    {
+        D3D11_SIGNATURE_PARAMETER_DESC param_desc;
+        DX11_VERIFY(shader_reflection->GetInputParameterDesc(i, &param_desc));
+
+        out_reflection.input_parameters.push_back({
+            .semantic_name = param_desc.SemanticName,
+            .semantic_index = param_desc.SemanticIndex,
+            .format = ::GetInputFormat(param_desc)
+        });
+    }
+
+    return true;
+}
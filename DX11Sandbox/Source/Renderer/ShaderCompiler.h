@@ -0,0 +1,66 @@
+#pragma once
+#include <span>
+
+#include "Renderer/ConstantBuffer.h"
+#include "Renderer/GraphicsTypes.h"
+
+struct ShaderMacro
+{
+    std::string name;
+    std::string value;
+
+    bool operator==(const ShaderMacro& other) const
+    {
+        return name == other.name && value == other.value;
+    }
+};
+MAKE_HASHABLE(ShaderMacro, t.name, t.value);
+
+enum class EShaderType
+{
+    VS,
+    PS,
+    CS,
+    DS,
+    GS,
+    HS,
+};
+
+struct TextureBindingDesc
+{
+    std::string name;
+    uint32 slot;
+};
+
+// Vertex shader input, in declaration order
+struct ShaderInputParameter
+{
+    std::string semantic_name;
+    uint32 semantic_index = 0;
+    GpuFormat format = GpuFormat::Unknown;  // Derived from the component type and mask, packed inputs show up as floats
+};
+
+struct ShaderReflection
+{
+    std::vector<CBufferBindingDesc> cbuffer_bindings;   // PerMaterialData only, the others are set from outside materials
+    std::vector<TextureBindingDesc> texture_bindings;
+    std::vector<ShaderInputParameter> input_parameters;
+};
+
+/**
+ * HLSL compilation and reflection through the D3D compiler. The only part of the shader code which includes the Windows SDK,
+ * shaders are created from the bytecode through the GraphicsBackend.
+ */
+struct ShaderCompiler
+{
+    static constexpr const char* ENTRY_POINT = "Main";
+
+    static uint32 GetCompileFlags();
+    static const char* GetShaderTarget(EShaderType shader_type);
+
+    // Thread safe. Looks up the on-disk ShaderCache first. Errors are logged.
+    static bool Compile(const std::string& asset_path, const std::vector<uint8>& shader_bytes, const std::vector<ShaderMacro>& defines, const char* entry_point,
+        const char* shader_target, std::vector<uint8>& out_bytecode);
+
+    static bool Reflect(std::span<const uint8> bytecode, ShaderReflection& out_reflection);
+};
@@ -0,0 +1,85 @@
+#include "Renderer/ShadowPass.h"
+
+#include "Renderer/ConstantBuffer.h"
+#include "Renderer/Mesh.h"
+#include "Renderer/RenderQueue.h"
+
+void EncodeShadowView(ShadowView& view, const ShadowPass& pass)
+{
+    static constexpr uint32 CBUFFER_SLOT_SHADOW_DATA = 1;
+
+    CommandList& commands = view.commands;
+    commands.Reset();
+
+    Viewport viewport;
+    viewport.width = (float) pass.shadow_map_size;
+    viewport.height = (float) pass.shadow_map_size;
+    commands.SetViewport(viewport);
+    commands.SetRasterizerState(view.rasterizer_state);
+
+    commands.SetRenderTarget(nullptr, view.dsv);
+    commands.ClearDepth(view.dsv);
+
+    // All views share the cbuffer. The data is copied into the list, so every view uploads its own matrix right before drawing.
+    GpuBuffer* cbuffer_light_view = pass.cbuffer_light_view->buffer_.get();
+    commands.UpdateBuffer(cbuffer_light_view, &view.light_view_data, sizeof(CBufferLightView));
+    commands.SetConstantBuffer(cbuffer_light_view, CBUFFER_SLOT_SHADOW_DATA);
+
+    uint32 depth_variant = 0;
+    commands.SetInputLayout(pass.depth_input_layouts[depth_variant]);
+    commands.SetVertexShader(pass.depth_vs[depth_variant]);
+    commands.SetPixelShader(nullptr);
+
+    view.view_cull_stats = {};
+    FrustumCull(view.frustum, *pass.caster_bounds, view.visibility, view.view_cull_stats, view.candidates);
+
+    // Depth only, so casters with different materials can still share a draw call
+    view.batches.Build(*pass.casters, pass.caster_world_matrices,
+        pass.is_instancing_enabled ? InstanceBatchMode::DepthOnly : InstanceBatchMode::Disabled, &view.visibility);
+
+    if (pass.is_instancing_enabled && view.batches.batches_.empty() == false)
+    {
+        commands.UploadInstances(pass.instance_buffer, view.batches.world_matrices_);
+    }
+
+    view.clusters.stats = {};
+    for (const InstanceBatch& batch : view.batches.batches_)
+    {
+        const std::span<const ClusterRange> ranges = CullBatchClusters(view.batches, batch, pass.is_cluster_culling_enabled,
+            view.clusters);
+        if (ranges.empty())
+        {
+            continue;
+        }
+
+        const StaticMesh& mesh = *batch.mesh;
+        const uint32 mesh_depth_variant = mesh.vertex_format == VertexFormat::PackedQuantized ? 1 : 0;
+        if (mesh_depth_variant != depth_variant)
+        {
+            depth_variant = mesh_depth_variant;
+            commands.SetInputLayout(pass.depth_input_layouts[depth_variant]);
+            commands.SetVertexShader(pass.depth_vs[depth_variant]);
+        }
+
+        commands.SetIndexBuffer(mesh.index_buffer->index_buffer_.get(), mesh.index_buffer->format_);
+        commands.SetVertexBuffer(mesh.pos->vertex_buffer_.get(), mesh.pos->slot_, mesh.pos->stride_);
+
+        if (batch.is_instanced == false)
+        {
+            commands.BindObjectConstants(mesh.model);
+        }
+
+        for (const ClusterRange& range : ranges)
+        {
+            if (batch.is_instanced)
+            {
+                commands.DrawIndexedInstanced(range.num_indices, batch.num_instances, mesh.start_idx + range.first_index, mesh.offset,
+                    batch.first_instance);
+            }
+            else
+            {
+                commands.DrawIndexed(range.num_indices, mesh.start_idx + range.first_index, mesh.offset);
+            }
+        }
+    }
+}
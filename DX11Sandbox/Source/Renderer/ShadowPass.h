@@ -0,0 +1,54 @@
+#pragma once
+#include <span>
+
+#include "Renderer/ClusterCulling.h"
+#include "Renderer/CommandList.h"
+#include "Renderer/ConstantBufferTypes.h"
+#include "Renderer/Culling.h"
+#include "Renderer/Instancing.h"
+#include "Renderer/RenderState.h"
+
+class ConstantBuffer;
+class RenderQueue;
+
+/**
+ * Cascade, spot light or cube face. Set up on the main thread, culled and encoded into its own command list by a job.
+ */
+struct ShadowView
+{
+    GpuDepthStencilView* dsv = nullptr;
+    RasterizerState rasterizer_state = RasterizerState::CullClockwise;
+    CBufferLightView light_view_data;
+    Frustum frustum;
+    const VisibilityBits* candidates = nullptr;     // Range of a point light, shared by all of its faces
+    CullStats* cull_stats = nullptr;                // Shared by views of the same kind, so it is only updated after encoding
+    ClusterCullStats* triangle_stats = nullptr;     // Likewise
+
+    VisibilityBits visibility;
+    CullStats view_cull_stats;
+    ClusterCullContext clusters;
+    InstanceBatchList batches;
+    CommandList commands;
+};
+
+/**
+ * Casters and GPU objects shared by all shadow views of a frame. Only read while encoding, so the views can be encoded by
+ * parallel jobs. Shaders are resolved up front, looking up (and compiling) them is not safe on the encoding jobs.
+ */
+struct ShadowPass
+{
+    const RenderQueue* casters = nullptr;
+    const BoundsSoA* caster_bounds = nullptr;       // World space, indexed like the items of the caster queue
+    std::span<const Mat4> caster_world_matrices;    // Likewise, transposed
+    ConstantBuffer* cbuffer_light_view = nullptr;   // Shared by all views, updated by the command list of each one
+    InstanceBuffer* instance_buffer = nullptr;
+    GpuVertexShader* depth_vs[2] = {};              // Float and quantized positions, see VertexFormat::PackedQuantized
+    GpuInputLayout* depth_input_layouts[2] = {};
+    uint32 shadow_map_size = 0;
+    bool is_instancing_enabled = true;
+    bool is_cluster_culling_enabled = true;
+};
+
+// Culls the casters against the view and records the depth only draws of the visible ones into the view's command list.
+// Doesn't touch the device, see CommandList.
+void EncodeShadowView(ShadowView& view, const ShadowPass& pass);
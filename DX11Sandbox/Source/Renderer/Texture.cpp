@@ -3,15 +3,199 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
 
-#include "Renderer/DX11Util.h"
+#include "Renderer/CookedTexture.h"
+#include "Renderer/GraphicsBackend.h"
 #include "Renderer/GraphicsContext.h"
+#include "Renderer/TextureCompression.h"
+
+namespace
+{
+    // Inputs are 8 bit, so the conversion to linear space is a lookup
+    const std::array<float, 256>& GetSrgbToLinearTable()
+    {
+        static const std::array<float, 256> table = []()
+        {
+            std::array<float, 256> out;
+            for (uint32 i = 0; i < 256; ++i)
+            {
+                const float c = (float) i / 255.0f;
+                out[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return out;
+        }();
+        return table;
+    }
+
+    uint8 LinearToSrgb(float c)
+    {
+        const float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return (uint8) std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f);
+    }
+
+    // 2x2 box filter. Odd sizes clamp to the last row / column. sRGB colors are averaged in linear space, like GenerateMips() does.
+    TextureMip Downsample(const TextureMip& src, TextureSpace texture_space)
+    {
+        TextureMip dst;
+        dst.width = std::max(src.width / 2, 1u);
+        dst.height = std::max(src.height / 2, 1u);
+        dst.pixels.resize((size_t) dst.width * dst.height * 4);
+
+        const std::array<float, 256>& to_linear = GetSrgbToLinearTable();
+        for (uint32 y = 0; y < dst.height; ++y)
+        {
+            const uint32 src_y0 = std::min(y * 2, src.height - 1);
+            const uint32 src_y1 = std::min(y * 2 + 1, src.height - 1);
+            for (uint32 x = 0; x < dst.width; ++x)
+            {
+                const uint32 src_x0 = std::min(x * 2, src.width - 1);
+                const uint32 src_x1 = std::min(x * 2 + 1, src.width - 1);
+                const uint8* texels[4] = {
+                    &src.pixels[((size_t) src_y0 * src.width + src_x0) * 4],
+                    &src.pixels[((size_t) src_y0 * src.width + src_x1) * 4],
+                    &src.pixels[((size_t) src_y1 * src.width + src_x0) * 4],
+                    &src.pixels[((size_t) src_y1 * src.width + src_x1) * 4]
+                };
+
+                uint8* out = &dst.pixels[((size_t) y * dst.width + x) * 4];
+                for (uint32 channel = 0; channel < 4; ++channel)
+                {
+                    if (texture_space == TextureSpace::SRGB && channel < 3)
+                    {
+                        const float sum = to_linear[texels[0][channel]] + to_linear[texels[1][channel]] +
+                            to_linear[texels[2][channel]] + to_linear[texels[3][channel]];
+                        out[channel] = LinearToSrgb(sum * 0.25f);
+                    }
+                    else
+                    {
+                        const uint32 sum = texels[0][channel] + texels[1][channel] + texels[2][channel] + texels[3][channel];
+                        out[channel] = (uint8) ((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        return dst;
+    }
+
+    // Replaces the full resolution pixels of the data with its mips [first_mip, end_mip)
+    void BuildMips(TextureData& data, TextureSpace texture_space, uint32 first_mip, uint32 end_mip)
+    {
+        end_mip = std::min(end_mip, Texture::CalcNumMipLevels(data.width, data.height));
+        CHECK(first_mip < end_mip);
+
+        TextureMip mip;
+        mip.width = (uint32) data.width;
+        mip.height = (uint32) data.height;
+        mip.pixels.assign(data.pixels.get(), data.pixels.get() + (size_t) mip.width * mip.height * 4);
+        data.pixels.reset();
+
+        data.first_mip = first_mip;
+        data.mips.clear();
+        data.mips.reserve(end_mip - first_mip);
+        for (uint32 mip_idx = 0; mip_idx < end_mip; ++mip_idx)
+        {
+            TextureMip next_mip = mip_idx + 1 < end_mip ? Downsample(mip, texture_space) : TextureMip();
+            if (mip_idx >= first_mip)
+            {
+                data.mips.push_back(std::move(mip));
+            }
+            mip = std::move(next_mip);
+        }
+    }
+}
+
+void TextureData::PixelDeleter::operator()(uint8* pixels) const
+{
+    stbi_image_free(pixels);
+}
+
+TextureData TextureData::Load(const String& file_path)
+{
+    TextureData data;
+    data.pixels.reset((uint8*) stbi_load(file_path.c_str(), &data.width, &data.height, &data.num_channels, STBI_rgb_alpha));
+    CHECK_MSG(data.IsValid(), "Failed to load texture: {}. Error: {}", file_path, stbi_failure_reason());
+    return data;
+}
+
+TextureData TextureData::Load(const TextureDesc& desc)
+{
+    if (desc.is_streamed)
+    {
+        return LoadMipTail(desc, TEXTURE_MIP_TAIL_SIZE);
+    }
+
+    return desc.compression != TextureCompression::None ? LoadMips(desc, 0) : Load(desc.file_path);
+}
+
+TextureData TextureData::LoadMips(const TextureDesc& desc, uint32 first_mip, uint32 end_mip)
+{
+    if (desc.compression != TextureCompression::None)
+    {
+        SharedPtr<const CookedTexture> cooked_texture = CookedTexture::Load(desc);
+        TextureData data = cooked_texture->GetMips(first_mip, end_mip);
+        data.cooked = std::move(cooked_texture);
+        return data;
+    }
+
+    TextureData data = Load(desc.file_path);
+    BuildMips(data, desc.texture_space, first_mip, end_mip);
+    return data;
+}
+
+TextureData TextureData::LoadMipTail(const TextureDesc& desc, uint32 max_size)
+{
+    if (desc.compression != TextureCompression::None)
+    {
+        SharedPtr<const CookedTexture> cooked_texture = CookedTexture::Load(desc);
+        const CookedTextureHeader& header = cooked_texture->GetHeader();
+        TextureData data = cooked_texture->GetMips(Texture::CalcTailMip(cooked_texture->GetFormat(), header.width, header.height, max_size), ~0u);
+        data.cooked = std::move(cooked_texture);
+        return data;
+    }
+
+    TextureData data = Load(desc.file_path);
+    BuildMips(data, desc.texture_space, Texture::CalcTailMip(GpuFormat::R8G8B8A8_UNorm, data.width, data.height, max_size), ~0u);
+    return data;
+}
 
 Texture::Texture(const TextureDesc& desc)
-    : file_path_(desc.file_path), texture_space_(desc.texture_space), hasMipMaps_(desc.generateMipMaps)
+    : Texture(desc, TextureData::Load(desc))
+{
+}
+
+Texture::Texture(const TextureDesc& desc, const TextureData& data)
+    : file_path_(desc.file_path), texture_space_(desc.texture_space), hasMipMaps_(desc.generateMipMaps),
+    num_channels_(data.num_channels), width_(data.width), height_(data.height),
+    compression_(desc.compression), first_channel_(desc.first_channel), is_streamed_(desc.is_streamed)
 {
-    stbi_uc* tex_data = stbi_load(file_path_.c_str(), &width_, &height_, &num_channels_, STBI_rgb_alpha);
-    Create((uint8*) tex_data);
-    stbi_image_free(tex_data);
+    const GpuFormat rgba_format = texture_space_ == TextureSpace::SRGB ? GpuFormat::R8G8B8A8_UNorm_SRGB : GpuFormat::R8G8B8A8_UNorm;
+    format_ = data.format != GpuFormat::Unknown ? data.format : rgba_format;
+
+    if (is_streamed_)
+    {
+        CHECK_MSG(hasMipMaps_, "Streamed textures require mips: {}", file_path_);
+        num_mips_ = CalcNumMipLevels(width_, height_);
+        tail_mip_ = CalcTailMip(format_, width_, height_, TEXTURE_MIP_TAIL_SIZE);
+        resident_mip_ = num_mips_;  // Nothing resident yet
+        cooked_ = data.cooked;
+
+        CHECK_MSG(data.mips.empty() == false && data.first_mip <= tail_mip_ && data.first_mip + data.mips.size() == num_mips_,
+            "Streamed textures are created from their mip tail, see TextureData::Load(const TextureDesc&): {}", file_path_);
+        StreamIn(data);
+    }
+    else if (data.mips.empty() == false)
+    {
+        // Cooked, the mips are uploaded as they are
+        CHECK(data.first_mip == 0);
+        num_mips_ = (uint32) data.mips.size();
+        resident_mip_ = num_mips_;
+        Reallocate(0, &data);
+    }
+    else
+    {
+        num_mips_ = hasMipMaps_ ? CalcNumMipLevels(width_, height_) : 1;
+        Create(data.pixels.get());
+    }
 }
 
 uint32 Texture::CalcNumMipLevels(uint32 width, uint32 height)
@@ -27,87 +211,154 @@ uint32 Texture::CalcNumMipLevels(uint32 width, uint32 height)
     return num_levels;
 }
 
+uint32 Texture::CalcTailMip(GpuFormat format, uint32 width, uint32 height, uint32 max_size)
+{
+    const bool is_block_compressed = GetBlockBytes(format) > 0;
+
+    uint32 mip = 0;
+    while (std::max(width, height) > max_size && (width > 1 || height > 1))
+    {
+        width = std::max(width / 2, uint32(1));
+        height = std::max(height / 2, uint32(1));
+        if (is_block_compressed && (width % 4 != 0 || height % 4 != 0))
+        {
+            break;
+        }
+        ++mip;
+    }
+
+    return mip;
+}
+
+uint64 Texture::CalcMipChainBytes(GpuFormat format, uint32 width, uint32 height, uint32 first_mip, uint32 num_mips)
+{
+    uint64 num_bytes = 0;
+    for (uint32 mip = first_mip; mip < num_mips; ++mip)
+    {
+        num_bytes += CalcMipBytes(format, std::max(width >> mip, uint32(1)), std::max(height >> mip, uint32(1)));
+    }
+
+    return num_bytes;
+}
+
+uint64 Texture::GetResidentBytes() const
+{
+    return handle_ != nullptr ? CalcMipChainBytes(format_, width_, height_, resident_mip_, num_mips_) : 0;
+}
+
+void Texture::StreamIn(const TextureData& data)
+{
+    CHECK(is_streamed_);
+    CHECK(data.width == width_ && data.height == height_);
+
+    // The new mips have to reach down to the resident ones
+    CHECK(data.first_mip < resident_mip_ && data.first_mip + data.mips.size() >= resident_mip_);
+
+    Reallocate(data.first_mip, &data);
+}
+
+void Texture::Evict(uint32 new_resident_mip)
+{
+    CHECK(is_streamed_);
+
+    new_resident_mip = std::min(new_resident_mip, tail_mip_);
+    if (new_resident_mip > resident_mip_)
+    {
+        Reallocate(new_resident_mip, nullptr);
+    }
+}
+
+void Texture::Reallocate(uint32 new_resident_mip, const TextureData* data)
+{
+    GpuTextureDesc texture_desc = {};
+    texture_desc.width = std::max((uint32) width_ >> new_resident_mip, uint32(1));
+    texture_desc.height = std::max((uint32) height_ >> new_resident_mip, uint32(1));
+    texture_desc.num_mips = num_mips_ - new_resident_mip;
+    texture_desc.format = format_;
+    texture_desc.usage = GpuUsage::Default;
+    texture_desc.bind_flags = GpuBind::ShaderResource;
+
+    SharedPtr<GpuTexture> texture = gfx::backend->CreateTexture2D(texture_desc);
+    texture->SetDebugName(file_path_);
+
+    for (uint32 mip = new_resident_mip; mip < num_mips_; ++mip)
+    {
+        const uint32 dst_mip = mip - new_resident_mip;
+        if (mip >= resident_mip_)
+        {
+            gfx::backend->CopyTextureMip(texture.get(), dst_mip, handle_.get(), mip - resident_mip_);
+        }
+        else
+        {
+            const TextureMip& src = data->mips[mip - data->first_mip];
+            gfx::backend->UpdateTexture(texture.get(), dst_mip, src.pixels.data(), CalcRowPitch(format_, src.width));
+        }
+    }
+
+    // Bound copies of the old view keep it alive until they are replaced
+    handle_ = texture;
+    srv_ = gfx::backend->CreateShaderResourceView(handle_.get());
+    resident_mip_ = new_resident_mip;
+}
+
 void Texture::Create(uint8* data)
 {
     CHECK(data != nullptr);
 
+    // GpuFormat::R8G8B8A8_UNorm_SRGB -> Texture in SRGB space, i.e. we have to convert to linear first!
+    // GpuFormat::R8G8B8A8_UNorm -> Texture already in linear color space
+    const GpuFormat format = texture_space_ == TextureSpace::SRGB ? GpuFormat::R8G8B8A8_UNorm_SRGB : GpuFormat::R8G8B8A8_UNorm;
+    const uint32 row_pitch = width_ * 4 * sizeof(uint8);
+
     if(hasMipMaps_)
     {
         // Create staging buffer where we'll create the mip chain
-        D3D11_TEXTURE2D_DESC staging_desc = {};
-        staging_desc.Width = width_;
-        staging_desc.Height = height_;
-        staging_desc.ArraySize = 1;
-        staging_desc.SampleDesc.Count = 1;
-        staging_desc.Format = texture_space_ == TextureSpace::SRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-        staging_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-        staging_desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+        GpuTextureDesc staging_desc = {};
+        staging_desc.width = width_;
+        staging_desc.height = height_;
+        staging_desc.num_mips = 0;
+        staging_desc.format = format;
+        staging_desc.bind_flags = GpuBind::ShaderResource | GpuBind::RenderTarget;
+        staging_desc.generates_mips = true;
         // Note: No initial data! We have to copy the first mipmap level over ourselves
 
-        ComPtr<ID3D11Texture2D> staging_handle = nullptr;
-        DX11_VERIFY(gfx::device->CreateTexture2D(&staging_desc, nullptr, &staging_handle));
-        SetDebugName(staging_handle.Get(), fmt::format("[Staging] {0}", file_path_));
+        SharedPtr<GpuTexture> staging_handle = gfx::backend->CreateTexture2D(staging_desc);
+        staging_handle->SetDebugName(fmt::format("[Staging] {0}", file_path_));
 
         // Copy first mip level of texture into staging buffer
-        gfx::device_context->UpdateSubresource(staging_handle.Get(), 0, nullptr, (void*) data, width_ * 4 * sizeof(uint8), 0);
-
-        D3D11_SHADER_RESOURCE_VIEW_DESC staging_srv_desc = {};
-        staging_srv_desc.Format = staging_desc.Format;
-        staging_srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        staging_srv_desc.Texture2D.MostDetailedMip = 0;
-        staging_srv_desc.Texture2D.MipLevels = -1;  // -1 => Create the entire mip chain
-
-        ComPtr<ID3D11ShaderResourceView> staging_srv = nullptr;
-        DX11_VERIFY(gfx::device->CreateShaderResourceView(staging_handle.Get(), &staging_srv_desc, &staging_srv));
+        gfx::backend->UpdateTexture(staging_handle.get(), 0, data, row_pitch);
 
         // Calculate mip maps on device
-        gfx::device_context->GenerateMips(staging_srv.Get());
+        SharedPtr<GpuShaderResourceView> staging_srv = gfx::backend->CreateShaderResourceView(staging_handle.get());
+        gfx::backend->GenerateMips(staging_srv.get());
 
         // Finally copy the generated mips into a buffer with default usage
         // (can't use immutable as CopyResource doesn't work...)
-        D3D11_TEXTURE2D_DESC texture_desc = {};
-        texture_desc.Width = width_;
-        texture_desc.Height = height_;
-        texture_desc.MipLevels = 0;
-        texture_desc.ArraySize = 1;
-
-        // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB -> Texture in SRGB space, i.e. we have to convert to linear first!
-        // DXGI_FORMAT_R8G8B8A8_UNORM -> Texture already in linear color space
-        texture_desc.Format = texture_space_ == TextureSpace::SRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-        texture_desc.SampleDesc.Count = 1;
-        texture_desc.SampleDesc.Quality = 0;
-        texture_desc.Usage = D3D11_USAGE_DEFAULT;
-        texture_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-        DX11_VERIFY(gfx::device->CreateTexture2D(&texture_desc, nullptr, &handle_));
-        SetDebugName(handle_.Get(), file_path_);
+        GpuTextureDesc texture_desc = {};
+        texture_desc.width = width_;
+        texture_desc.height = height_;
+        texture_desc.num_mips = 0;
+        texture_desc.format = format;
+        texture_desc.usage = GpuUsage::Default;
+        texture_desc.bind_flags = GpuBind::ShaderResource;
 
-        gfx::device_context->CopyResource(handle_.Get(), staging_handle.Get());
+        handle_ = gfx::backend->CreateTexture2D(texture_desc);
+        handle_->SetDebugName(file_path_);
 
-        DX11_VERIFY(gfx::device->CreateShaderResourceView(handle_.Get(), nullptr, &srv_));
+        gfx::backend->CopyTexture(handle_.get(), staging_handle.get());
     }
     else
     {
-        D3D11_TEXTURE2D_DESC texture_desc = {};
-        texture_desc.Width = width_;
-        texture_desc.Height = height_;
-        texture_desc.MipLevels = 1;
-        texture_desc.ArraySize = 1;
+        GpuTextureDesc texture_desc = {};
+        texture_desc.width = width_;
+        texture_desc.height = height_;
+        texture_desc.format = format;
+        texture_desc.usage = GpuUsage::Immutable;
+        texture_desc.bind_flags = GpuBind::ShaderResource;
 
-        // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB -> Texture in SRGB space, i.e. we have to convert to linear first!
-        // DXGI_FORMAT_R8G8B8A8_UNORM -> Texture already in linear color space
-        texture_desc.Format = texture_space_ == TextureSpace::SRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-        texture_desc.SampleDesc.Count = 1;
-        texture_desc.SampleDesc.Quality = 0;
-        texture_desc.Usage = D3D11_USAGE_IMMUTABLE;
-        texture_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-        D3D11_SUBRESOURCE_DATA texture_subresource_data = {};
-        texture_subresource_data.pSysMem = (void*) data;
-        texture_subresource_data.SysMemPitch = width_ * 4 * sizeof(uint8);
-
-        DX11_VERIFY(gfx::device->CreateTexture2D(&texture_desc, &texture_subresource_data, &handle_));
-        SetDebugName(handle_.Get(), file_path_);
-        DX11_VERIFY(gfx::device->CreateShaderResourceView(handle_.Get(), nullptr, &srv_));
+        handle_ = gfx::backend->CreateTexture2D(texture_desc, data, row_pitch);
+        handle_->SetDebugName(file_path_);
     }
+
+    srv_ = gfx::backend->CreateShaderResourceView(handle_.get());
 }
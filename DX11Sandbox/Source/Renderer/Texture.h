@@ -1,17 +1,37 @@
 #pragma once
+#include "Renderer/GraphicsTypes.h"
 #include "Renderer/RenderState.h"
 
+class CookedTexture;
+
+// Streamed textures keep all mips up to this size resident, higher mips are loaded on demand. See TextureStreamer.
+static inline constexpr uint32 TEXTURE_MIP_TAIL_SIZE = 64;
+
 enum class TextureSpace
 {
     Linear,
     SRGB
 };
 
+// Block compression applied by the texture cooker, see CookedTexture. BC4 and BC5 store linear values only.
+enum class TextureCompression : uint8
+{
+    None,   // RGBA8, decoded from the image on every load
+    BC1,    // RGB, 4 bits per texel. Alpha is dropped.
+    BC3,    // RGB with smooth alpha, 8 bits per texel
+    BC4,    // One channel, 4 bits per texel, e.g. roughness
+    BC5,    // Two channels, 8 bits per texel, e.g. the X and Y of tangent space normals
+    BC7     // RGBA, 8 bits per texel, best quality for color
+};
+
 struct TextureDesc
 {
     String file_path;
     TextureSpace texture_space = TextureSpace::SRGB;
     bool generateMipMaps = true;
+    bool is_streamed = false;   // Starts with the mip tail only, requires generateMipMaps
+    TextureCompression compression = TextureCompression::None;
+    uint8 first_channel = 0;    // BC4 / BC5 compress the source channels starting at this one into R (and G)
 
     bool operator==(const TextureDesc& other) const
     {
@@ -20,10 +40,55 @@ struct TextureDesc
 };
 MAKE_HASHABLE(TextureDesc, t.file_path);
 
+struct TextureMip
+{
+    uint32 width = 0;
+    uint32 height = 0;
+    std::vector<uint8> pixels;  // RGBA8 or 4x4 blocks, tightly packed
+};
+
+/**
+ * Decoded RGBA8 pixels of an image file, either the full resolution image or a range of its mips.
+ * Decoding doesn't touch the device, so it can run on any thread. Creating the texture from it has to happen on the main thread.
+ */
+struct TextureData
+{
+    struct PixelDeleter
+    {
+        void operator()(uint8* pixels) const;
+    };
+
+    static TextureData Load(const String& file_path);
+
+    // Streamed textures only keep their mip tail. Compressed textures are read from their cooked file, which is cooked first if needed.
+    static TextureData Load(const TextureDesc& desc);
+
+    // Only the mips [first_mip, end_mip) are kept, end_mip is clamped to the chain. Compressed textures copy them from the cooked file.
+    // Otherwise the image is decoded and downsampled on the CPU. Image files store the full resolution only,
+    // so even the smallest mips require decoding the whole image.
+    static TextureData LoadMips(const TextureDesc& desc, uint32 first_mip, uint32 end_mip = ~0u);
+
+    // Like LoadMips(), starting at the first mip which is not larger than max_size
+    static TextureData LoadMipTail(const TextureDesc& desc, uint32 max_size);
+
+    bool IsValid() const { return pixels != nullptr || mips.empty() == false; }
+
+    int32 num_channels = -1;
+    int32 width = -1;   // Full resolution, also if only mips are kept
+    int32 height = -1;
+    std::unique_ptr<uint8, PixelDeleter> pixels;
+
+    uint32 first_mip = 0;
+    std::vector<TextureMip> mips;   // Starting at first_mip, pixels is released once these are built
+    GpuFormat format = GpuFormat::Unknown;      // Of the mips, unknown means RGBA8 in the texture space of the texture
+    SharedPtr<const CookedTexture> cooked;      // The file the mips were copied from, if compressed
+};
+
 class Texture
 {
 public:
     Texture(const TextureDesc& desc);
+    Texture(const TextureDesc& desc, const TextureData& data);
     ~Texture() = default;
 
     inline bool operator==(const Texture& v) const
@@ -39,8 +104,22 @@ public:
 
     static uint32 CalcNumMipLevels(uint32 width, uint32 height);
 
+    // First mip which is not larger than max_size in either dimension. Block compressed textures stop at the last mip
+    // with a multiple of 4 as size, the most detailed mip of those has to be made of whole blocks.
+    static uint32 CalcTailMip(GpuFormat format, uint32 width, uint32 height, uint32 max_size);
+
+    // Size of the mips [first_mip, num_mips)
+    static uint64 CalcMipChainBytes(GpuFormat format, uint32 width, uint32 height, uint32 first_mip, uint32 num_mips);
+
     void Create(uint8* data);
 
+    // Streaming, main thread only. The GPU texture only holds the resident mips, so changing them reallocates it and the SRV.
+    // Mips which are resident before and after are copied on the GPU, new ones are uploaded from data.
+    void StreamIn(const TextureData& data);
+    void Evict(uint32 new_resident_mip);
+
+    uint64 GetResidentBytes() const;
+
     std::string file_path_;
     TextureSpace texture_space_ = TextureSpace::SRGB;
     bool hasMipMaps_ = false;
@@ -48,9 +127,25 @@ public:
     int32 width_ = -1;
     int32 height_ = -1;
 
+    GpuFormat format_ = GpuFormat::R8G8B8A8_UNorm_SRGB;
+    TextureCompression compression_ = TextureCompression::None;
+    uint8 first_channel_ = 0;
+
+    // Mips are indexed relative to the full resolution. Textures which are not streamed keep all of their mips resident.
+    bool is_streamed_ = false;
+    uint32 num_mips_ = 1;
+    uint32 resident_mip_ = 0;   // Most detailed mip on the GPU
+    uint32 tail_mip_ = 0;       // Streamed textures never evict the mips from here on
+
+    // Streamed compressed textures keep their cooked file mapped, so loading more mips skips checking it against the image
+    SharedPtr<const CookedTexture> cooked_;
+
     SamplerState sampler_state_ = SamplerState::LinearWrap;
 
-    ComPtr<ID3D11Texture2D> handle_ = nullptr;
-    ComPtr<ID3D11ShaderResourceView> srv_= nullptr;
+    SharedPtr<GpuTexture> handle_ = nullptr;
+    SharedPtr<GpuShaderResourceView> srv_= nullptr;
+
+private:
+    void Reallocate(uint32 new_resident_mip, const TextureData* data);
 };
 MAKE_HASHABLE(Texture, t.file_path_, t.num_channels_, t.width_, t.height_);
\ No newline at end of file
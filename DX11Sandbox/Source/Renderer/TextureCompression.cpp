@@ -0,0 +1,554 @@
+#include "Renderer/TextureCompression.h"
+
+#include <DirectXMath.h>
+
+#include "Core/JobSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+    constexpr uint32 BLOCK_SIZE = 4;
+    constexpr uint32 NUM_BLOCK_TEXELS = BLOCK_SIZE * BLOCK_SIZE;
+    constexpr uint32 BLOCK_ROWS_PER_JOB = 4;
+
+    // Interpolation weights of 4 bit BC7 indices, in 1/64
+    constexpr float BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Channel c of texel i is channels[c][i], so four texels of a channel load into one vector
+    struct Block
+    {
+        alignas(16) float channels[4][NUM_BLOCK_TEXELS];
+    };
+
+    struct BC7Mode6Block
+    {
+        uint8 endpoints[2][4] = {};     // 7 bits per channel
+        uint8 pbits[2] = {};            // Shared lowest bit of all channels of an endpoint
+        uint8 indices[NUM_BLOCK_TEXELS] = {};
+    };
+
+    // Writes bits from the least significant one on, the way the BC7 block layout is specified
+    struct BitWriter
+    {
+        void Write(uint32 value, uint32 num_bits)
+        {
+            for (uint32 bit = 0; bit < num_bits; ++bit, ++pos)
+            {
+                out[pos / 8] |= (uint8) (((value >> bit) & 1) << (pos % 8));
+            }
+        }
+
+        uint8* out = nullptr;
+        uint32 pos = 0;
+    };
+
+    void LoadBlock(const TextureMip& mip, uint32 block_x, uint32 block_y, Block& out_block)
+    {
+        for (uint32 y = 0; y < BLOCK_SIZE; ++y)
+        {
+            const uint32 src_y = std::min(block_y * BLOCK_SIZE + y, mip.height - 1);
+            for (uint32 x = 0; x < BLOCK_SIZE; ++x)
+            {
+                const uint32 src_x = std::min(block_x * BLOCK_SIZE + x, mip.width - 1);
+                const uint8* texel = &mip.pixels[((size_t) src_y * mip.width + src_x) * 4];
+                for (uint32 channel = 0; channel < 4; ++channel)
+                {
+                    out_block.channels[channel][y * BLOCK_SIZE + x] = (float) texel[channel];
+                }
+            }
+        }
+    }
+
+    XMVECTOR LoadTexels(const float* values)
+    {
+        return XMLoadFloat4A((const XMFLOAT4A*) values);
+    }
+
+    float HorizontalMin(XMVECTOR v)
+    {
+        v = XMVectorMin(v, XMVectorSwizzle<2, 3, 0, 1>(v));
+        v = XMVectorMin(v, XMVectorSwizzle<1, 0, 3, 2>(v));
+        return XMVectorGetX(v);
+    }
+
+    float HorizontalMax(XMVECTOR v)
+    {
+        v = XMVectorMax(v, XMVectorSwizzle<2, 3, 0, 1>(v));
+        v = XMVectorMax(v, XMVectorSwizzle<1, 0, 3, 2>(v));
+        return XMVectorGetX(v);
+    }
+
+    float HorizontalSum(XMVECTOR v)
+    {
+        return XMVectorGetX(XMVector4Dot(v, XMVectorSplatOne()));
+    }
+
+    void GetChannelRange(const float* values, float& out_min, float& out_max)
+    {
+        XMVECTOR min_values = LoadTexels(values);
+        XMVECTOR max_values = min_values;
+        for (uint32 i = 4; i < NUM_BLOCK_TEXELS; i += 4)
+        {
+            const XMVECTOR v = LoadTexels(values + i);
+            min_values = XMVectorMin(min_values, v);
+            max_values = XMVectorMax(max_values, v);
+        }
+
+        out_min = HorizontalMin(min_values);
+        out_max = HorizontalMax(max_values);
+    }
+
+    // Also the alpha block of BC3 and each channel of BC5
+    void EncodeBC4(const float* values, uint8* out)
+    {
+        float min_value = 0.0f;
+        float max_value = 0.0f;
+        GetChannelRange(values, min_value, max_value);
+
+        // Endpoint 0 above endpoint 1 selects the mode with 6 interpolated values instead of 4 plus 0 and 1
+        out[0] = (uint8) max_value;
+        out[1] = (uint8) min_value;
+
+        uint64 indices = 0;
+        if (max_value > min_value)
+        {
+            const XMVECTOR offset = XMVectorReplicate(min_value);
+            const XMVECTOR scale = XMVectorReplicate(7.0f / (max_value - min_value));
+            for (uint32 i = 0; i < NUM_BLOCK_TEXELS; i += 4)
+            {
+                // Steps on the ramp from endpoint 1 (0) to endpoint 0 (7)
+                const XMVECTOR steps = XMVectorRound(XMVectorMultiply(XMVectorSubtract(LoadTexels(values + i), offset), scale));
+                XMUINT4 lanes;
+                XMStoreUInt4(&lanes, XMConvertVectorFloatToUInt(steps, 0));
+
+                const uint32 lane_steps[4] = { lanes.x, lanes.y, lanes.z, lanes.w };
+                for (uint32 lane = 0; lane < 4; ++lane)
+                {
+                    const uint64 index = lane_steps[lane] == 7 ? 0 : lane_steps[lane] == 0 ? 1 : 8 - lane_steps[lane];
+                    indices |= index << (3 * (i + lane));
+                }
+            }
+        }
+
+        std::memcpy(out + 2, &indices, 6);
+    }
+
+    uint16 ToRGB565(const float color[3])
+    {
+        const uint32 r = (uint32) (color[0] * 31.0f / 255.0f + 0.5f);
+        const uint32 g = (uint32) (color[1] * 63.0f / 255.0f + 0.5f);
+        const uint32 b = (uint32) (color[2] * 31.0f / 255.0f + 0.5f);
+        return (uint16) ((r << 11) | (g << 5) | b);
+    }
+
+    XMFLOAT3 FromRGB565(uint16 color)
+    {
+        const uint32 r = (color >> 11) & 31;
+        const uint32 g = (color >> 5) & 63;
+        const uint32 b = color & 31;
+        return XMFLOAT3((float) ((r << 3) | (r >> 2)), (float) ((g << 2) | (g >> 4)), (float) ((b << 3) | (b >> 2)));
+    }
+
+    // Color block of BC1 and BC3, always in the mode with 4 colors
+    void EncodeBC1Color(const Block& block, uint8* out)
+    {
+        float min_color[3];
+        float max_color[3];
+        for (uint32 channel = 0; channel < 3; ++channel)
+        {
+            GetChannelRange(block.channels[channel], min_color[channel], max_color[channel]);
+
+            // The outermost palette colors are rarely hit exactly, so the box is inset by 1/16 of its size
+            const float inset = (max_color[channel] - min_color[channel]) / 16.0f;
+            min_color[channel] += inset;
+            max_color[channel] -= inset;
+        }
+
+        // The diagonal from min to max assumes that all channels rise together. Flip R and B if they fall with G instead.
+        const XMVECTOR center_r = XMVectorReplicate((min_color[0] + max_color[0]) * 0.5f);
+        const XMVECTOR center_g = XMVectorReplicate((min_color[1] + max_color[1]) * 0.5f);
+        const XMVECTOR center_b = XMVectorReplicate((min_color[2] + max_color[2]) * 0.5f);
+        XMVECTOR covariance_rg = XMVectorZero();
+        XMVECTOR covariance_bg = XMVectorZero();
+        for (uint32 i = 0; i < NUM_BLOCK_TEXELS; i += 4)
+        {
+            const XMVECTOR r = XMVectorSubtract(LoadTexels(block.channels[0] + i), center_r);
+            const XMVECTOR g = XMVectorSubtract(LoadTexels(block.channels[1] + i), center_g);
+            const XMVECTOR b = XMVectorSubtract(LoadTexels(block.channels[2] + i), center_b);
+            covariance_rg = XMVectorMultiplyAdd(r, g, covariance_rg);
+            covariance_bg = XMVectorMultiplyAdd(b, g, covariance_bg);
+        }
+
+        if (HorizontalSum(covariance_rg) < 0.0f)
+        {
+            std::swap(min_color[0], max_color[0]);
+        }
+
+        if (HorizontalSum(covariance_bg) < 0.0f)
+        {
+            std::swap(min_color[2], max_color[2]);
+        }
+
+        // Color 0 above color 1 selects the mode with 4 colors instead of 3 plus transparent black
+        uint16 color0 = ToRGB565(max_color);
+        uint16 color1 = ToRGB565(min_color);
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        uint32 indices = 0;
+        if (color0 != color1)
+        {
+            const XMFLOAT3 endpoint0 = FromRGB565(color0);
+            const XMFLOAT3 endpoint1 = FromRGB565(color1);
+            const XMFLOAT3 palette[4] =
+            {
+                endpoint0,
+                endpoint1,
+                XMFLOAT3((2.0f * endpoint0.x + endpoint1.x) / 3.0f, (2.0f * endpoint0.y + endpoint1.y) / 3.0f, (2.0f * endpoint0.z + endpoint1.z) / 3.0f),
+                XMFLOAT3((endpoint0.x + 2.0f * endpoint1.x) / 3.0f, (endpoint0.y + 2.0f * endpoint1.y) / 3.0f, (endpoint0.z + 2.0f * endpoint1.z) / 3.0f)
+            };
+
+            for (uint32 i = 0; i < NUM_BLOCK_TEXELS; i += 4)
+            {
+                const XMVECTOR r = LoadTexels(block.channels[0] + i);
+                const XMVECTOR g = LoadTexels(block.channels[1] + i);
+                const XMVECTOR b = LoadTexels(block.channels[2] + i);
+
+                XMVECTOR best_distance = XMVectorReplicate(FLT_MAX);
+                XMVECTOR best_index = XMVectorZero();
+                for (uint32 palette_idx = 0; palette_idx < 4; ++palette_idx)
+                {
+                    const XMVECTOR dr = XMVectorSubtract(r, XMVectorReplicate(palette[palette_idx].x));
+                    const XMVECTOR dg = XMVectorSubtract(g, XMVectorReplicate(palette[palette_idx].y));
+                    const XMVECTOR db = XMVectorSubtract(b, XMVectorReplicate(palette[palette_idx].z));
+                    const XMVECTOR distance = XMVectorMultiplyAdd(dr, dr, XMVectorMultiplyAdd(dg, dg, XMVectorMultiply(db, db)));
+
+                    const XMVECTOR is_closer = XMVectorLess(distance, best_distance);
+                    best_distance = XMVectorSelect(best_distance, distance, is_closer);
+                    best_index = XMVectorSelect(best_index, XMVectorReplicate((float) palette_idx), is_closer);
+                }
+
+                XMUINT4 lanes;
+                XMStoreUInt4(&lanes, XMConvertVectorFloatToUInt(best_index, 0));
+                indices |= (lanes.x << (2 * i)) | (lanes.y << (2 * (i + 1))) | (lanes.z << (2 * (i + 2))) | (lanes.w << (2 * (i + 3)));
+            }
+        }
+
+        std::memcpy(out, &color0, sizeof(uint16));
+        std::memcpy(out + 2, &color1, sizeof(uint16));
+        std::memcpy(out + 4, &indices, sizeof(uint32));
+    }
+
+    // Quantizes the endpoints with every combination of p-bits and picks the indices. Returns the squared error of the best one.
+    float QuantizeBC7Mode6(const XMVECTOR texels[NUM_BLOCK_TEXELS], FXMVECTOR endpoint0, FXMVECTOR endpoint1, BC7Mode6Block& out_block)
+    {
+        XMFLOAT4 endpoints[2];
+        XMStoreFloat4(&endpoints[0], endpoint0);
+        XMStoreFloat4(&endpoints[1], endpoint1);
+
+        float best_error = FLT_MAX;
+        for (uint32 pbits = 0; pbits < 4; ++pbits)
+        {
+            BC7Mode6Block candidate;
+            XMVECTOR decoded[2];
+            for (uint32 endpoint_idx = 0; endpoint_idx < 2; ++endpoint_idx)
+            {
+                const uint8 pbit = (uint8) ((pbits >> endpoint_idx) & 1);
+                const float values[4] = { endpoints[endpoint_idx].x, endpoints[endpoint_idx].y, endpoints[endpoint_idx].z, endpoints[endpoint_idx].w };
+
+                float decoded_values[4];
+                for (uint32 channel = 0; channel < 4; ++channel)
+                {
+                    const uint8 quantized = (uint8) std::clamp((values[channel] - pbit) * 0.5f + 0.5f, 0.0f, 127.0f);
+                    candidate.endpoints[endpoint_idx][channel] = quantized;
+                    decoded_values[channel] = (float) ((quantized << 1) | pbit);
+                }
+
+                candidate.pbits[endpoint_idx] = pbit;
+                decoded[endpoint_idx] = XMLoadFloat4((const XMFLOAT4*) decoded_values);
+            }
+
+            XMVECTOR palette[16];
+            for (uint32 palette_idx = 0; palette_idx < 16; ++palette_idx)
+            {
+                const XMVECTOR weighted = XMVectorMultiplyAdd(decoded[0], XMVectorReplicate(64.0f - BC7_WEIGHTS[palette_idx]),
+                    XMVectorMultiply(decoded[1], XMVectorReplicate(BC7_WEIGHTS[palette_idx])));
+                palette[palette_idx] = XMVectorFloor(XMVectorScale(XMVectorAdd(weighted, XMVectorReplicate(32.0f)), 1.0f / 64.0f));
+            }
+
+            // Project onto the line between the endpoints. The weights are not quite uniform, so the neighbors can be closer.
+            const XMVECTOR direction = XMVectorSubtract(decoded[1], decoded[0]);
+            const float length_sq = XMVectorGetX(XMVector4LengthSq(direction));
+
+            float error = 0.0f;
+            for (uint32 i = 0; i < NUM_BLOCK_TEXELS; ++i)
+            {
+                int32 index = 0;
+                if (length_sq > 0.0f)
+                {
+                    const float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(texels[i], decoded[0]), direction)) / length_sq;
+                    index = std::clamp((int32) (t * 15.0f + 0.5f), 0, 15);
+                }
+
+                float texel_error = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(texels[i], palette[index])));
+                for (int32 neighbor : { index - 1, index + 1 })
+                {
+                    if (neighbor >= 0 && neighbor < 16)
+                    {
+                        const float neighbor_error = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(texels[i], palette[neighbor])));
+                        if (neighbor_error < texel_error)
+                        {
+                            texel_error = neighbor_error;
+                            index = neighbor;
+                        }
+                    }
+                }
+
+                candidate.indices[i] = (uint8) index;
+                error += texel_error;
+            }
+
+            if (error < best_error)
+            {
+                best_error = error;
+                out_block = candidate;
+            }
+        }
+
+        return best_error;
+    }
+
+    // Least squares fit of the endpoints to the weights the indices selected. Returns false if the weights can't separate them.
+    bool RefineBC7Endpoints(const XMVECTOR texels[NUM_BLOCK_TEXELS], const BC7Mode6Block& block, XMVECTOR& out_endpoint0, XMVECTOR& out_endpoint1)
+    {
+        float a = 0.0f;
+        float b = 0.0f;
+        float c = 0.0f;
+        XMVECTOR x0 = XMVectorZero();
+        XMVECTOR x1 = XMVectorZero();
+        for (uint32 i = 0; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            const float w = BC7_WEIGHTS[block.indices[i]] / 64.0f;
+            a += (1.0f - w) * (1.0f - w);
+            b += (1.0f - w) * w;
+            c += w * w;
+            x0 = XMVectorMultiplyAdd(texels[i], XMVectorReplicate(1.0f - w), x0);
+            x1 = XMVectorMultiplyAdd(texels[i], XMVectorReplicate(w), x1);
+        }
+
+        const float determinant = a * c - b * b;
+        if (std::abs(determinant) < 1e-6f)
+        {
+            return false;
+        }
+
+        const XMVECTOR max_value = XMVectorReplicate(255.0f);
+        out_endpoint0 = XMVectorClamp(XMVectorScale(XMVectorSubtract(XMVectorScale(x0, c), XMVectorScale(x1, b)), 1.0f / determinant), XMVectorZero(), max_value);
+        out_endpoint1 = XMVectorClamp(XMVectorScale(XMVectorSubtract(XMVectorScale(x1, a), XMVectorScale(x0, b)), 1.0f / determinant), XMVectorZero(), max_value);
+        return true;
+    }
+
+    void EncodeBC7(const Block& block, uint8* out)
+    {
+        XMVECTOR texels[NUM_BLOCK_TEXELS];
+        XMVECTOR mean = XMVectorZero();
+        XMVECTOR min_texel = XMVectorReplicate(FLT_MAX);
+        XMVECTOR max_texel = XMVectorZero();
+        for (uint32 i = 0; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            texels[i] = XMVectorSet(block.channels[0][i], block.channels[1][i], block.channels[2][i], block.channels[3][i]);
+            mean = XMVectorAdd(mean, texels[i]);
+            min_texel = XMVectorMin(min_texel, texels[i]);
+            max_texel = XMVectorMax(max_texel, texels[i]);
+        }
+        mean = XMVectorScale(mean, 1.0f / NUM_BLOCK_TEXELS);
+
+        // Rows of the covariance matrix of the RGBA values
+        XMVECTOR covariance[4] = { XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero() };
+        for (uint32 i = 0; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            const XMVECTOR d = XMVectorSubtract(texels[i], mean);
+            covariance[0] = XMVectorMultiplyAdd(d, XMVectorSplatX(d), covariance[0]);
+            covariance[1] = XMVectorMultiplyAdd(d, XMVectorSplatY(d), covariance[1]);
+            covariance[2] = XMVectorMultiplyAdd(d, XMVectorSplatZ(d), covariance[2]);
+            covariance[3] = XMVectorMultiplyAdd(d, XMVectorSplatW(d), covariance[3]);
+        }
+
+        // Principal axis by power iteration, starting with the diagonal of the bounding box
+        XMVECTOR axis = XMVector4Normalize(XMVectorSubtract(max_texel, min_texel));
+        for (uint32 iteration = 0; iteration < 8; ++iteration)
+        {
+            XMVECTOR next_axis = XMVectorMultiply(covariance[0], XMVectorSplatX(axis));
+            next_axis = XMVectorMultiplyAdd(covariance[1], XMVectorSplatY(axis), next_axis);
+            next_axis = XMVectorMultiplyAdd(covariance[2], XMVectorSplatZ(axis), next_axis);
+            next_axis = XMVectorMultiplyAdd(covariance[3], XMVectorSplatW(axis), next_axis);
+            if (XMVectorGetX(XMVector4LengthSq(next_axis)) < 1e-12f)
+            {
+                break;
+            }
+            axis = XMVector4Normalize(next_axis);
+        }
+
+        float min_t = 0.0f;
+        float max_t = 0.0f;
+        for (uint32 i = 0; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            const float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(texels[i], mean), axis));
+            min_t = std::min(min_t, t);
+            max_t = std::max(max_t, t);
+        }
+
+        const XMVECTOR max_value = XMVectorReplicate(255.0f);
+        XMVECTOR endpoint0 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(min_t), mean), XMVectorZero(), max_value);
+        XMVECTOR endpoint1 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(max_t), mean), XMVectorZero(), max_value);
+
+        BC7Mode6Block mode6_block;
+        const float error = QuantizeBC7Mode6(texels, endpoint0, endpoint1, mode6_block);
+
+        BC7Mode6Block refined_block;
+        if (RefineBC7Endpoints(texels, mode6_block, endpoint0, endpoint1) &&
+            QuantizeBC7Mode6(texels, endpoint0, endpoint1, refined_block) < error)
+        {
+            mode6_block = refined_block;
+        }
+
+        // The most significant bit of the first index is implicitly 0, flip the endpoints if it would be set
+        if (mode6_block.indices[0] >= 8)
+        {
+            std::swap(mode6_block.endpoints[0], mode6_block.endpoints[1]);
+            std::swap(mode6_block.pbits[0], mode6_block.pbits[1]);
+            for (uint8& index : mode6_block.indices)
+            {
+                index = 15 - index;
+            }
+        }
+
+        std::memset(out, 0, 16);
+        BitWriter writer{ .out = out };
+        writer.Write(1 << 6, 7);    // Mode 6
+        for (uint32 channel = 0; channel < 4; ++channel)
+        {
+            writer.Write(mode6_block.endpoints[0][channel], 7);
+            writer.Write(mode6_block.endpoints[1][channel], 7);
+        }
+        writer.Write(mode6_block.pbits[0], 1);
+        writer.Write(mode6_block.pbits[1], 1);
+
+        writer.Write(mode6_block.indices[0], 3);
+        for (uint32 i = 1; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            writer.Write(mode6_block.indices[i], 4);
+        }
+    }
+
+    void EncodeBlock(const Block& block, TextureCompression compression, uint32 first_channel, uint8* out)
+    {
+        switch (compression)
+        {
+            case TextureCompression::BC1:
+                EncodeBC1Color(block, out);
+                break;
+            case TextureCompression::BC3:
+                EncodeBC4(block.channels[3], out);
+                EncodeBC1Color(block, out + 8);
+                break;
+            case TextureCompression::BC4:
+                EncodeBC4(block.channels[first_channel], out);
+                break;
+            case TextureCompression::BC5:
+                EncodeBC4(block.channels[first_channel], out);
+                EncodeBC4(block.channels[first_channel + 1], out + 8);
+                break;
+            case TextureCompression::BC7:
+                EncodeBC7(block, out);
+                break;
+            default:
+                CHECK_NO_ENTRY();
+        }
+    }
+}
+
+GpuFormat GetCompressedFormat(TextureCompression compression, TextureSpace texture_space)
+{
+    const bool is_srgb = texture_space == TextureSpace::SRGB;
+    switch (compression)
+    {
+        case TextureCompression::None:
+            return is_srgb ? GpuFormat::R8G8B8A8_UNorm_SRGB : GpuFormat::R8G8B8A8_UNorm;
+        case TextureCompression::BC1:
+            return is_srgb ? GpuFormat::BC1_UNorm_SRGB : GpuFormat::BC1_UNorm;
+        case TextureCompression::BC3:
+            return is_srgb ? GpuFormat::BC3_UNorm_SRGB : GpuFormat::BC3_UNorm;
+        case TextureCompression::BC4:
+            return GpuFormat::BC4_UNorm;
+        case TextureCompression::BC5:
+            return GpuFormat::BC5_UNorm;
+        case TextureCompression::BC7:
+            return is_srgb ? GpuFormat::BC7_UNorm_SRGB : GpuFormat::BC7_UNorm;
+        default:
+            CHECK_NO_ENTRY();
+            return GpuFormat::Unknown;
+    }
+}
+
+uint32 GetBlockBytes(GpuFormat format)
+{
+    switch (format)
+    {
+        case GpuFormat::BC1_UNorm:
+        case GpuFormat::BC1_UNorm_SRGB:
+        case GpuFormat::BC4_UNorm:
+            return 8;
+        case GpuFormat::BC3_UNorm:
+        case GpuFormat::BC3_UNorm_SRGB:
+        case GpuFormat::BC5_UNorm:
+        case GpuFormat::BC7_UNorm:
+        case GpuFormat::BC7_UNorm_SRGB:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+uint32 CalcRowPitch(GpuFormat format, uint32 width)
+{
+    const uint32 block_bytes = GetBlockBytes(format);
+    return block_bytes > 0 ? (width + BLOCK_SIZE - 1) / BLOCK_SIZE * block_bytes : width * 4;
+}
+
+uint64 CalcMipBytes(GpuFormat format, uint32 width, uint32 height)
+{
+    const uint32 block_bytes = GetBlockBytes(format);
+    const uint32 num_rows = block_bytes > 0 ? (height + BLOCK_SIZE - 1) / BLOCK_SIZE : height;
+    return (uint64) CalcRowPitch(format, width) * num_rows;
+}
+
+std::vector<uint8> CompressMip(const TextureMip& mip, TextureCompression compression, uint32 first_channel)
+{
+    CHECK(compression != TextureCompression::None);
+    CHECK(first_channel + (compression == TextureCompression::BC5 ? 1 : 0) < 4);
+    CHECK(mip.pixels.size() == (size_t) mip.width * mip.height * 4);
+
+    const uint32 block_bytes = GetBlockBytes(GetCompressedFormat(compression, TextureSpace::Linear));
+    const uint32 num_blocks_x = (mip.width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const uint32 num_blocks_y = (mip.height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<uint8> blocks((size_t) num_blocks_x * num_blocks_y * block_bytes);
+
+    jobs::ParallelFor(num_blocks_y, BLOCK_ROWS_PER_JOB, [&](uint32 begin, uint32 end)
+    {
+        Block block;
+        for (uint32 block_y = begin; block_y < end; ++block_y)
+        {
+            for (uint32 block_x = 0; block_x < num_blocks_x; ++block_x)
+            {
+                LoadBlock(mip, block_x, block_y, block);
+                EncodeBlock(block, compression, first_channel, &blocks[((size_t) block_y * num_blocks_x + block_x) * block_bytes]);
+            }
+        }
+    });
+
+    return blocks;
+}
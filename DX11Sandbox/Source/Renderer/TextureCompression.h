@@ -0,0 +1,22 @@
+#pragma once
+#include "Renderer/Texture.h"
+
+// BC4 and BC5 ignore the texture space, there are no sRGB variants of them
+GpuFormat GetCompressedFormat(TextureCompression compression, TextureSpace texture_space);
+
+// Size of a 4x4 block, 0 for formats which are not block compressed
+uint32 GetBlockBytes(GpuFormat format);
+
+// Formats are either RGBA8 or block compressed
+uint32 CalcRowPitch(GpuFormat format, uint32 width);
+uint64 CalcMipBytes(GpuFormat format, uint32 width, uint32 height);
+
+/**
+ * Compresses an RGBA8 mip into 4x4 blocks. Blocks along the edges of mips which are not a multiple of 4 repeat the last texel.
+ * Rows of blocks are spread over the job system. Within a block, the encoders work on four texels at once with DirectXMath.
+ *
+ * BC1 and BC3 fit the endpoints to the inset bounding box of the colors, BC4 and BC5 to the range of each channel.
+ * BC7 only uses mode 6 (one subset, RGBA endpoints with 4 bit indices), fit along the principal axis and refined once
+ * with least squares. That's not as good as a full BC7 encoder with partitions, but it doesn't show the blocky artifacts of BC1.
+ */
+std::vector<uint8> CompressMip(const TextureMip& mip, TextureCompression compression, uint32 first_channel = 0);
@@ -0,0 +1,250 @@
+#include "Renderer/TextureStreaming.h"
+
+#include "Renderer/CookedTexture.h"
+#include "Renderer/ResourceManager.h"
+
+TextureStreamer::TextureStreamer(ResourceCache<Texture, TextureDesc>& textures)
+    : textures_(textures)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // The jobs write into the pending loads
+    for (const UniquePtr<PendingLoad>& load : pending_loads_)
+    {
+        jobs::Wait(load->counter);
+    }
+}
+
+void TextureStreamer::Request(Handle<Texture> handle, uint32 mip)
+{
+    const Texture* texture = textures_.Get(handle);
+    if (texture == nullptr || texture->is_streamed_ == false)
+    {
+        return;
+    }
+
+    const uint32 handle_idx = handle.GetIndex();
+    if (handle_idx >= streamed_texture_indices_.size())
+    {
+        streamed_texture_indices_.resize(handle_idx + 1, -1);
+    }
+
+    int32& texture_idx = streamed_texture_indices_[handle_idx];
+    if (texture_idx < 0)
+    {
+        texture_idx = (int32) streamed_textures_.size();
+        streamed_textures_.push_back({ .handle = handle });
+    }
+
+    StreamedTexture& streamed = streamed_textures_[texture_idx];
+    streamed.requested_mip = streamed.last_requested_frame == frame_idx_ ? std::min(streamed.requested_mip, mip) : mip;
+    streamed.last_requested_frame = frame_idx_;
+}
+
+void TextureStreamer::Request(const Material& material, float screen_size)
+{
+    for (const auto& [name, param] : material.texture_parameters_)
+    {
+        const Texture* texture = textures_.Get(param.tex);
+        if (texture != nullptr && texture->is_streamed_)
+        {
+            Request(param.tex, CalcRequiredMip(*texture, screen_size));
+        }
+    }
+}
+
+uint32 TextureStreamer::CalcRequiredMip(const Texture& texture, float screen_size)
+{
+    // Tiling UVs would need more detail. Large meshes request the top mips anyway, so this mostly errs on the blurry side for small ones.
+    const float texels_per_pixel = (float) std::max(texture.width_, texture.height_) / std::max(screen_size, 1.0f);
+    const uint32 mip = texels_per_pixel > 1.0f ? (uint32) std::log2(texels_per_pixel) : 0;
+    return std::min(mip, texture.tail_mip_);
+}
+
+void TextureStreamer::Update()
+{
+    FinishLoads();
+
+    uint64 resident_bytes = 0;
+    uint64 loading_bytes = 0;
+    for (const StreamedTexture& streamed : streamed_textures_)
+    {
+        resident_bytes += textures_.Get(streamed.handle)->GetResidentBytes();
+        loading_bytes += streamed.loading_bytes;
+    }
+
+    // Textures which lack the most mips first
+    load_order_.clear();
+    for (uint32 texture_idx = 0; texture_idx < (uint32) streamed_textures_.size(); ++texture_idx)
+    {
+        const StreamedTexture& streamed = streamed_textures_[texture_idx];
+        const Texture& texture = *textures_.Get(streamed.handle);
+        if (streamed.loading_bytes == 0 && GetRequiredMip(streamed, texture) < texture.resident_mip_)
+        {
+            load_order_.push_back(texture_idx);
+        }
+    }
+
+    auto get_missing_mips = [this](uint32 texture_idx)
+    {
+        const StreamedTexture& streamed = streamed_textures_[texture_idx];
+        const Texture& texture = *textures_.Get(streamed.handle);
+        return texture.resident_mip_ - GetRequiredMip(streamed, texture);
+    };
+    std::sort(load_order_.begin(), load_order_.end(), [&get_missing_mips](uint32 a, uint32 b)
+    {
+        return get_missing_mips(a) > get_missing_mips(b);
+    });
+
+    for (uint32 texture_idx : load_order_)
+    {
+        if (pending_loads_.size() >= MAX_PENDING_LOADS)
+        {
+            break;
+        }
+
+        StreamedTexture& streamed = streamed_textures_[texture_idx];
+        const Texture& texture = *textures_.Get(streamed.handle);
+        const uint32 required_mip = GetRequiredMip(streamed, texture);
+
+        // Make room by dropping mips other textures don't need anymore
+        auto calc_load_bytes = [&texture](uint32 first_mip)
+        {
+            return Texture::CalcMipChainBytes(texture.format_, texture.width_, texture.height_, first_mip, texture.resident_mip_);
+        };
+
+        const uint64 required_bytes = calc_load_bytes(required_mip);
+        if (resident_bytes + loading_bytes + required_bytes > budget_bytes_)
+        {
+            resident_bytes -= Evict(resident_bytes + loading_bytes + required_bytes - budget_bytes_, false, texture_idx);
+        }
+
+        // If that wasn't enough, only load the mips next to the resident ones which still fit
+        uint32 first_mip = required_mip;
+        while (first_mip < texture.resident_mip_ && resident_bytes + loading_bytes + calc_load_bytes(first_mip) > budget_bytes_)
+        {
+            ++first_mip;
+        }
+
+        if (first_mip == texture.resident_mip_)
+        {
+            continue;
+        }
+
+        UniquePtr<PendingLoad> load = MakeUnique<PendingLoad>();
+        load->texture_idx = texture_idx;
+        load->desc = TextureDesc{ .file_path = texture.file_path_, .texture_space = texture.texture_space_, .is_streamed = true,
+            .compression = texture.compression_, .first_channel = texture.first_channel_ };
+        load->cooked = texture.cooked_;
+        load->first_mip = first_mip;
+        load->end_mip = texture.resident_mip_;
+
+        streamed.loading_bytes = calc_load_bytes(first_mip);
+        loading_bytes += streamed.loading_bytes;
+
+        PendingLoad* pending_load = load.get();
+        jobs::Run([pending_load]()
+            {
+                pending_load->data = pending_load->cooked != nullptr
+                    ? pending_load->cooked->GetMips(pending_load->first_mip, pending_load->end_mip)
+                    : TextureData::LoadMips(pending_load->desc, pending_load->first_mip, pending_load->end_mip);
+            }, &pending_load->counter);
+        pending_loads_.push_back(std::move(load));
+    }
+
+    // Still over budget, e.g. because it was lowered. Requested mips have to go as well, least recently used first.
+    if (resident_bytes + loading_bytes > budget_bytes_)
+    {
+        resident_bytes -= Evict(resident_bytes + loading_bytes - budget_bytes_, true);
+    }
+
+    stats_.num_textures = (uint32) streamed_textures_.size();
+    stats_.num_requested = 0;
+    stats_.num_pending_loads = (uint32) pending_loads_.size();
+    stats_.resident_bytes = resident_bytes;
+    stats_.requested_bytes = 0;
+    stats_.budget_bytes = budget_bytes_;
+    for (const StreamedTexture& streamed : streamed_textures_)
+    {
+        const Texture& texture = *textures_.Get(streamed.handle);
+        stats_.num_requested += streamed.last_requested_frame == frame_idx_ ? 1 : 0;
+        stats_.requested_bytes += Texture::CalcMipChainBytes(texture.format_, texture.width_, texture.height_, GetRequiredMip(streamed, texture),
+            texture.num_mips_);
+    }
+
+    ++frame_idx_;
+}
+
+void TextureStreamer::FinishLoads()
+{
+    for (size_t load_idx = 0; load_idx < pending_loads_.size();)
+    {
+        PendingLoad& load = *pending_loads_[load_idx];
+        if (load.counter.IsDone() == false)
+        {
+            ++load_idx;
+            continue;
+        }
+
+        // Textures aren't evicted while loading, so the loaded mips still reach down to the resident ones
+        StreamedTexture& streamed = streamed_textures_[load.texture_idx];
+        textures_.Get(streamed.handle)->StreamIn(load.data);
+        streamed.loading_bytes = 0;
+        stats_.num_loaded_mips += load.end_mip - load.first_mip;
+
+        pending_loads_[load_idx] = std::move(pending_loads_.back());
+        pending_loads_.pop_back();
+    }
+}
+
+uint64 TextureStreamer::Evict(uint64 num_bytes, bool evict_requested, uint32 skip_texture_idx)
+{
+    lru_order_.clear();
+    for (uint32 texture_idx = 0; texture_idx < (uint32) streamed_textures_.size(); ++texture_idx)
+    {
+        if (texture_idx != skip_texture_idx && streamed_textures_[texture_idx].loading_bytes == 0)
+        {
+            lru_order_.push_back(texture_idx);
+        }
+    }
+
+    std::stable_sort(lru_order_.begin(), lru_order_.end(), [this](uint32 a, uint32 b)
+    {
+        return streamed_textures_[a].last_requested_frame < streamed_textures_[b].last_requested_frame;
+    });
+
+    uint64 freed_bytes = 0;
+    for (uint32 texture_idx : lru_order_)
+    {
+        if (freed_bytes >= num_bytes)
+        {
+            break;
+        }
+
+        const StreamedTexture& streamed = streamed_textures_[texture_idx];
+        Texture& texture = *textures_.Get(streamed.handle);
+        const uint32 max_resident_mip = evict_requested ? texture.tail_mip_ : GetRequiredMip(streamed, texture);
+
+        uint32 new_resident_mip = texture.resident_mip_;
+        while (new_resident_mip < max_resident_mip && freed_bytes < num_bytes)
+        {
+            freed_bytes += Texture::CalcMipChainBytes(texture.format_, texture.width_, texture.height_, new_resident_mip, new_resident_mip + 1);
+            ++new_resident_mip;
+        }
+
+        if (new_resident_mip > texture.resident_mip_)
+        {
+            stats_.num_evicted_mips += new_resident_mip - texture.resident_mip_;
+            texture.Evict(new_resident_mip);
+        }
+    }
+
+    return freed_bytes;
+}
+
+uint32 TextureStreamer::GetRequiredMip(const StreamedTexture& streamed, const Texture& texture) const
+{
+    return streamed.last_requested_frame == frame_idx_ ? std::min(streamed.requested_mip, texture.tail_mip_) : texture.tail_mip_;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "Core/Handle.h"
+#include "Core/JobSystem.h"
+
+#include "Renderer/Texture.h"
+
+template<typename ResourceType, typename ResourceDescriptorType>
+class ResourceCache;
+
+class Material;
+
+struct TextureStreamingStats
+{
+    uint32 num_textures = 0;        // Streamed textures which were requested at least once
+    uint32 num_requested = 0;       // Requested during the last frame
+    uint32 num_pending_loads = 0;
+    uint64 resident_bytes = 0;
+    uint64 requested_bytes = 0;     // If every texture had the mips it was requested with
+    uint64 budget_bytes = 0;
+    uint64 num_loaded_mips = 0;     // Since startup
+    uint64 num_evicted_mips = 0;
+};
+
+/**
+ * Streams the mips of textures created with TextureDesc::is_streamed, which start out with their mip tail only.
+ *
+ * The renderer requests the mip each texture needs for the size of the meshes on screen. Update() loads missing mips as jobs
+ * and uploads them once they are ready. Textures which were not requested for the longest time lose their top mips first
+ * once the resident mips and the pending loads exceed the budget. Mips of the tail are never evicted.
+ *
+ * Main thread only, the jobs only decode and downsample the images or copy the mips of cooked textures.
+ */
+class TextureStreamer
+{
+public:
+    static constexpr uint64 DEFAULT_BUDGET_BYTES = 256ull * 1024 * 1024;
+    static constexpr uint32 MAX_PENDING_LOADS = 4;
+
+    TextureStreamer(ResourceCache<Texture, TextureDesc>& textures);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // The most detailed mip requested during a frame is streamed in by the next Update(). Textures which are not streamed are ignored.
+    void Request(Handle<Texture> handle, uint32 mip);
+
+    // Requests the textures of the material for a mesh which covers screen_size pixels
+    void Request(const Material& material, float screen_size);
+
+    // Mip at which one texel covers about one pixel, assuming the texture is mapped once across the mesh
+    static uint32 CalcRequiredMip(const Texture& texture, float screen_size);
+
+    // Once per frame, before rendering. Uploads finished loads, evicts over budget and schedules new loads.
+    void Update();
+
+    void SetBudget(uint64 budget_bytes) { budget_bytes_ = budget_bytes; }
+    uint64 GetBudget() const { return budget_bytes_; }
+
+    const TextureStreamingStats& GetStats() const { return stats_; }
+
+private:
+    struct StreamedTexture
+    {
+        Handle<Texture> handle;
+        uint32 requested_mip = 0;
+        uint64 last_requested_frame = 0;
+        uint64 loading_bytes = 0;   // Size of the pending load, 0 if there is none
+    };
+
+    struct PendingLoad
+    {
+        uint32 texture_idx = 0;
+        TextureDesc desc;
+        SharedPtr<const CookedTexture> cooked;  // Compressed textures copy their mips from it instead of loading it again
+        uint32 first_mip = 0;
+        uint32 end_mip = 0;
+        TextureData data;
+        JobCounter counter;
+    };
+
+    void FinishLoads();
+
+    // Evicts top mips in LRU order until num_bytes were freed. Returns the number of freed bytes.
+    // Unless evict_requested is set, only mips which are more detailed than the ones requested are evicted.
+    uint64 Evict(uint64 num_bytes, bool evict_requested, uint32 skip_texture_idx = ~0u);
+
+    // Tail mip if the texture wasn't requested during the last frame
+    uint32 GetRequiredMip(const StreamedTexture& streamed, const Texture& texture) const;
+
+    ResourceCache<Texture, TextureDesc>& textures_;
+    std::vector<StreamedTexture> streamed_textures_;
+    std::vector<int32> streamed_texture_indices_;   // By handle index, -1 if the texture was never requested
+    std::vector<UniquePtr<PendingLoad>> pending_loads_;
+    std::vector<uint32> load_order_;                // Scratch memory, reused between frames
+    std::vector<uint32> lru_order_;
+
+    uint64 budget_bytes_ = DEFAULT_BUDGET_BYTES;
+    uint64 frame_idx_ = 1;
+    TextureStreamingStats stats_;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "Renderer/GraphicsTypes.h"
 
 struct VertexPos
 {
@@ -20,21 +21,20 @@ struct VertexPos
 
     Vec3 pos;
 
-    static inline const D3D11_INPUT_ELEMENT_DESC LAYOUT[] =
+    static inline const VertexElement LAYOUT[] =
     {
         {
             "POSITION", // Just a name for the layout element. Used for mapping in the VS
             0,          // Additional index for mapping. Here we'll actually have POSITION0
-            DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT,    // Format of the element -> this will be a vec3f
+            GpuFormat::R32G32B32_Float,    // Format of the element -> this will be a vec3f
             0,  // input slot index, range 0-15.
             0,  // Memory offset (bytes). Position is at the start of the memory block -> 0.
                 // If we add color in same input slot, its offset would be sizeof(vec3f) = 12 bytes
-            D3D11_INPUT_PER_VERTEX_DATA,    // InputSlotClass - Used for instancing (?)
-            0   // InstanceDataStepRate - Also used for instancing (?)
+            false   // Per vertex, not per instance
         },
     };
 
-    static inline const uint32 NUM_ELEMENTS = ARRAYSIZE(LAYOUT);
+    static inline const uint32 NUM_ELEMENTS = static_cast<uint32>(std::size(LAYOUT));
 };
 MAKE_HASHABLE(VertexPos, t.pos);
 
@@ -48,13 +48,13 @@ struct VertexPosUV
     Vec3 pos;
     Vec2 uv;
 
-    static inline const D3D11_INPUT_ELEMENT_DESC LAYOUT[] =
+    static inline const VertexElement LAYOUT[] =
     {
-        { "POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0 /*input slot*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "UV", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32_FLOAT, 1 /*input slot*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "POSITION", 0, GpuFormat::R32G32B32_Float, 0 /*input slot*/, 0 },
+        { "UV", 0, GpuFormat::R32G32_Float, 1 /*input slot*/, 0 },
     };
 
-    static inline const uint32 NUM_ELEMENTS = ARRAYSIZE(LAYOUT);
+    static inline const uint32 NUM_ELEMENTS = static_cast<uint32>(std::size(LAYOUT));
 };
 MAKE_HASHABLE(VertexPosUV, t.pos, t.uv);
 
@@ -69,14 +69,14 @@ struct VertexPosUVNormals
     Vec3 normal;
     Vec2 uv;
 
-    static inline const D3D11_INPUT_ELEMENT_DESC LAYOUT[] =
+    static inline const VertexElement LAYOUT[] =
     {
-        { "POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "NORMAL", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 1 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "UV", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32_FLOAT, 2 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "POSITION", 0, GpuFormat::R32G32B32_Float, 0 /*slot_idx*/, 0 },
+        { "NORMAL", 0, GpuFormat::R32G32B32_Float, 1 /*slot_idx*/, 0 },
+        { "UV", 0, GpuFormat::R32G32_Float, 2 /*slot_idx*/, 0 },
     };
 
-    static inline const uint32 NUM_ELEMENTS = ARRAYSIZE(LAYOUT);
+    static inline const uint32 NUM_ELEMENTS = static_cast<uint32>(std::size(LAYOUT));
 };
 MAKE_HASHABLE(VertexPosUVNormals, t.pos, t.normal, t.uv);
 
@@ -84,7 +84,7 @@ struct VertexPosUVNormalsTangents
 {
     bool operator==(VertexPosUVNormalsTangents const& other) const
     {
-        return pos == other.pos && uv == other.uv && normal == other.normal;
+        return pos == other.pos && uv == other.uv && normal == other.normal && tangent == other.tangent;
     }
 
     Vec3 pos;
@@ -92,15 +92,15 @@ struct VertexPosUVNormalsTangents
     Vec2 uv;
     Vec3 tangent;
 
-    static inline const D3D11_INPUT_ELEMENT_DESC LAYOUT[] =
+    static inline const VertexElement LAYOUT[] =
     {
-        { "POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "NORMAL", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 1 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "UV", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32_FLOAT, 2 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "TANGENT", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 3 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "POSITION", 0, GpuFormat::R32G32B32_Float, 0 /*slot_idx*/, 0 },
+        { "NORMAL", 0, GpuFormat::R32G32B32_Float, 1 /*slot_idx*/, 0 },
+        { "UV", 0, GpuFormat::R32G32_Float, 2 /*slot_idx*/, 0 },
+        { "TANGENT", 0, GpuFormat::R32G32B32_Float, 3 /*slot_idx*/, 0 },
     };
 
-    static inline const uint32 NUM_ELEMENTS = ARRAYSIZE(LAYOUT);
+    static inline const uint32 NUM_ELEMENTS = static_cast<uint32>(std::size(LAYOUT));
 };
 MAKE_HASHABLE(VertexPosUVNormalsTangents, t.pos, t.normal, t.uv, t.tangent);
 
@@ -114,12 +114,12 @@ struct VertexPosColor
         return pos == other.pos && color == other.color;
     }
 
-    static inline const D3D11_INPUT_ELEMENT_DESC LAYOUT[] =
+    static inline const VertexElement LAYOUT[] =
     {
-        { "POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        { "COLOR", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 1 /*slot_idx*/, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "POSITION", 0, GpuFormat::R32G32B32_Float, 0 /*slot_idx*/, 0 },
+        { "COLOR", 0, GpuFormat::R32G32B32_Float, 1 /*slot_idx*/, 0 },
     };
 
-    static inline const uint32 NUM_ELEMENTS = ARRAYSIZE(LAYOUT);
+    static inline const uint32 NUM_ELEMENTS = static_cast<uint32>(std::size(LAYOUT));
 };
 MAKE_HASHABLE(VertexPosColor, t.pos, t.color);
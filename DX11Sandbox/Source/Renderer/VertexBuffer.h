@@ -1,7 +1,5 @@
 #pragma once
-#include <d3d11.h>
-
-#include "Renderer/DX11Types.h"
+#include "Renderer/GraphicsTypes.h"
 
 struct VertexBufferSlots
 {
@@ -9,21 +7,31 @@ struct VertexBufferSlots
     static constexpr uint32 NORMALS = 1;
     static constexpr uint32 TEX_COORD = 2;
     static constexpr uint32 TANGENTS = 3;
+    static constexpr uint32 INSTANCE_INDEX = 4;     // Stepped per instance, see InstanceBuffer
+    static constexpr uint32 ATTRIBUTES = 5;         // Normals, tangents and uvs interleaved, see PackedVertexAttributes
+};
+
+// Layout of the vertex streams of a mesh. The packed formats select the PACKED_ATTRIBUTES and QUANTIZED_POSITIONS shader variants.
+enum class VertexFormat : uint8
+{
+    Float,              // One float stream per attribute
+    Packed,             // Float positions, the other attributes packed into one interleaved stream
+    PackedQuantized,    // Packed, and 16 bit positions within the bounds of the mesh
 };
 
 class VertexBuffer
 {
 public:
-    VertexBuffer(void* data, uint32 size, size_t bytes_per_element, uint32 slot);
+    VertexBuffer(const void* data, uint32 size, size_t bytes_per_element, uint32 slot);
 
     void Bind();
 
-    const ComPtr<ID3D11Buffer>& GetNativePtr() const
+    const SharedPtr<GpuBuffer>& GetNativePtr() const
     {
         return vertex_buffer_;
     }
 
     uint32 slot_ = 0;
     uint32 stride_ = 0;
-    ComPtr<ID3D11Buffer> vertex_buffer_;
+    SharedPtr<GpuBuffer> vertex_buffer_;
 };
@@ -0,0 +1,103 @@
+#include "Renderer/VertexQuantization.h"
+
+#include <DirectXPackedVector.h>
+
+namespace
+{
+    constexpr float SNORM16_MAX = 32767.0f;
+    constexpr float UNORM16_MAX = 65535.0f;
+
+    float SignNotZero(float f)
+    {
+        return f >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    int16 ToSnorm16(float f)
+    {
+        return (int16) std::round(std::clamp(f, -1.0f, 1.0f) * SNORM16_MAX);
+    }
+
+    uint16 ToUnorm16(float f)
+    {
+        return (uint16) std::round(std::clamp(f, 0.0f, 1.0f) * UNORM16_MAX);
+    }
+}
+
+uint32 GetVertexBytes(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Float:
+        return 3 * sizeof(Vec3) + sizeof(Vec2);
+    case VertexFormat::Packed:
+        return sizeof(Vec3) + sizeof(PackedVertexAttributes);
+    case VertexFormat::PackedQuantized:
+        return sizeof(QuantizedPosition) + sizeof(PackedVertexAttributes);
+    default:
+        CHECK_NO_ENTRY();
+    }
+
+    return 0;
+}
+
+uint32 GetPositionBytes(VertexFormat format)
+{
+    return format == VertexFormat::PackedQuantized ? sizeof(QuantizedPosition) : sizeof(Vec3);
+}
+
+Vec2 EncodeOctahedral(const Vec3& v)
+{
+    const float l1_norm = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    if (l1_norm == 0.0f)
+    {
+        return Vec2(0.0f, 0.0f);
+    }
+
+    const float x = v.x / l1_norm;
+    const float y = v.y / l1_norm;
+    if (v.z >= 0.0f)
+    {
+        return Vec2(x, y);
+    }
+
+    // Fold the lower hemisphere over the diagonals
+    return Vec2((1.0f - std::abs(y)) * SignNotZero(x), (1.0f - std::abs(x)) * SignNotZero(y));
+}
+
+PackedVertexAttributes PackVertexAttributes(const Vec3& normal, const Vec3& tangent, const Vec2& uv)
+{
+    using namespace DirectX::PackedVector;
+
+    const Vec2 normal_oct = EncodeOctahedral(normal);
+    const Vec2 tangent_oct = EncodeOctahedral(tangent);
+    return PackedVertexAttributes
+    {
+        .normal = { ToSnorm16(normal_oct.x), ToSnorm16(normal_oct.y) },
+        .tangent = { ToSnorm16(tangent_oct.x), ToSnorm16(tangent_oct.y) },
+        .uv = { XMConvertFloatToHalf(uv.x), XMConvertFloatToHalf(uv.y) }
+    };
+}
+
+Mat4 QuantizePositions(std::span<const Vec3> positions, const Vec3& bounds_min, const Vec3& bounds_max, std::span<QuantizedPosition> out_positions)
+{
+    CHECK(positions.size() == out_positions.size());
+
+    const float max_extent = std::max({ bounds_max.x - bounds_min.x, bounds_max.y - bounds_min.y, bounds_max.z - bounds_min.z });
+    const float scale = max_extent > 0.0f ? max_extent : 1.0f;
+    const float inv_scale = 1.0f / scale;
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        const Vec3& pos = positions[i];
+        out_positions[i] = QuantizedPosition
+        {
+            .x = ToUnorm16((pos.x - bounds_min.x) * inv_scale),
+            .y = ToUnorm16((pos.y - bounds_min.y) * inv_scale),
+            .z = ToUnorm16((pos.z - bounds_min.z) * inv_scale),
+            .w = 0
+        };
+    }
+
+    // Row vectors, so the scaling is applied first
+    return Mat4::Scaling(scale) * Mat4::Translation(bounds_min);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <span>
+
+#include "Renderer/VertexBuffer.h"
+
+// Interleaved in VertexBufferSlots::ATTRIBUTES by the packed vertex formats
+struct PackedVertexAttributes
+{
+    int16 normal[2];    // Octahedral, R16G16_SNORM
+    int16 tangent[2];   // Octahedral, R16G16_SNORM
+    uint16 uv[2];       // R16G16_FLOAT
+};
+static_assert(sizeof(PackedVertexAttributes) == 12);
+
+// R16G16B16A16_UNORM within a cube around the bounds of the mesh, w is padding
+struct QuantizedPosition
+{
+    uint16 x;
+    uint16 y;
+    uint16 z;
+    uint16 w;
+};
+static_assert(sizeof(QuantizedPosition) == 8);
+
+// Bytes per vertex of all streams the forward pass reads, and of the position stream the depth passes read
+uint32 GetVertexBytes(VertexFormat format);
+uint32 GetPositionBytes(VertexFormat format);
+
+// Maps the unit sphere onto an octahedron unfolded into [-1, 1]^2, DecodeOctahedral() in common.hlsli is the inverse.
+// Zero vectors map to (0, 0), which decodes to +Z.
+Vec2 EncodeOctahedral(const Vec3& v);
+
+PackedVertexAttributes PackVertexAttributes(const Vec3& normal, const Vec3& tangent, const Vec2& uv);
+
+/**
+ * Quantizes positions to 16 bits within the cube spanned by bounds_min and the largest extent of the bounds.
+ * Returns the matrix which maps the unorm positions back to model space. It is meant to be applied in front of the world matrix.
+ *
+ * The scale is uniform on purpose: then normals and tangents can still be transformed with the combined matrix, they only get
+ * longer or shorter and are renormalized anyway. The cost is some precision on the shorter axes, a 30 m mesh still gets 0.5 mm steps.
+ */
+Mat4 QuantizePositions(std::span<const Vec3> positions, const Vec3& bounds_min, const Vec3& bounds_max, std::span<QuantizedPosition> out_positions);
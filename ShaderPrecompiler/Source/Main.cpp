@@ -0,0 +1,182 @@
+#include "Core/JobSystem.h"
+#include "Renderer/Shader.h"
+#include "Renderer/ShaderArchive.h"
+#include "Renderer/ShaderCache.h"
+
+#include <chrono>
+#include <fstream>
+
+namespace
+{
+    constexpr const char* DEFAULT_MANIFEST_PATH = "assets/shaders/permutations.manifest";
+
+    // 2^8 permutations per shader is already a lot, more is most likely a typo in the manifest
+    constexpr uint32 MAX_DEFINES_PER_SHADER = 8;
+
+    struct ShaderPermutation
+    {
+        std::string path;
+        EShaderType shader_type;
+        std::vector<ShaderMacro> defines;
+    };
+
+    bool ParseManifest(const std::string& manifest_path, std::vector<ShaderPermutation>& out_permutations)
+    {
+        std::ifstream file(manifest_path);
+        if (file.is_open() == false)
+        {
+            LOG_ERROR("Failed to open manifest: {}", manifest_path);
+            return false;
+        }
+
+        const std::filesystem::path shader_dir = std::filesystem::path(manifest_path).parent_path();
+
+        std::string line;
+        uint32 line_number = 0;
+        while (std::getline(file, line))
+        {
+            ++line_number;
+
+            std::istringstream tokens(line.substr(0, line.find('#')));
+            std::string file_name;
+            std::string type;
+            if (!(tokens >> file_name))
+            {
+                continue;   // Empty line or comment
+            }
+
+            if (!(tokens >> type) || (type != "vs" && type != "ps"))
+            {
+                LOG_ERROR("{}({}): Expected shader type 'vs' or 'ps' after {}", manifest_path, line_number, file_name);
+                return false;
+            }
+
+            std::vector<std::string> define_names;
+            for (std::string define_name; tokens >> define_name;)
+            {
+                define_names.push_back(define_name);
+            }
+
+            if (define_names.size() > MAX_DEFINES_PER_SHADER)
+            {
+                LOG_ERROR("{}({}): Too many defines, at most {} are supported", manifest_path, line_number, MAX_DEFINES_PER_SHADER);
+                return false;
+            }
+
+            const std::string path = (shader_dir / file_name).generic_string();
+            const EShaderType shader_type = type == "vs" ? EShaderType::VS : EShaderType::PS;
+
+            // One permutation per subset of the defines. The order of the defines matches the manifest, e.g. ALPHA_CUTOFF before
+            // LIGHTING_ENABLED like Material does, but the archive key doesn't depend on it anyway.
+            const uint32 num_permutations = 1u << define_names.size();
+            for (uint32 mask = 0; mask < num_permutations; ++mask)
+            {
+                ShaderPermutation permutation{ .path = path, .shader_type = shader_type };
+                for (size_t i = 0; i < define_names.size(); ++i)
+                {
+                    if (mask & (1u << i))
+                    {
+                        permutation.defines.push_back({ .name = define_names[i], .value = "1" });
+                    }
+                }
+                out_permutations.push_back(permutation);
+            }
+        }
+
+        return true;
+    }
+
+    std::string ToString(const std::vector<ShaderMacro>& defines)
+    {
+        std::string out;
+        for (const ShaderMacro& define : defines)
+        {
+            out += (out.empty() ? "" : " ") + define.name;
+        }
+        return out.empty() ? "<none>" : out;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Log::Init();
+
+    const std::string manifest_path = argc > 1 ? argv[1] : DEFAULT_MANIFEST_PATH;
+    const std::string output_path = argc > 2 ? argv[2] : ShaderArchive::DEFAULT_PATH;
+    LOG("Precompiling shader permutations from {} into {}", manifest_path, output_path);
+
+    const auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::vector<ShaderPermutation> permutations;
+    if (ParseManifest(manifest_path, permutations) == false)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Permutations with unused defines preprocess to the same source. Compiling them concurrently must not race on the same cache file.
+    ShaderCache::is_enabled = false;
+
+    // Read every source file once up front, the compile jobs only share them read-only
+    std::unordered_map<std::string, std::vector<uint8>> sources;
+    for (const ShaderPermutation& permutation : permutations)
+    {
+        if (sources.contains(permutation.path) == false)
+        {
+            try
+            {
+                sources[permutation.path] = FileIO::ReadFile(permutation.path);
+            }
+            catch (const std::exception& e)
+            {
+                LOG_ERROR("{}", e.what());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    jobs::Init();
+    const uint32 num_threads = jobs::GetNumThreads();
+
+    std::vector<ShaderArchive::Bytecode> bytecodes(permutations.size());
+    std::atomic<uint32> num_failed = 0;
+    jobs::ParallelFor((uint32) permutations.size(), 1, [&](uint32 begin, uint32 end)
+        {
+            for (uint32 i = begin; i < end; ++i)
+            {
+                const ShaderPermutation& permutation = permutations[i];
+
+                std::vector<uint8> bytecode;
+                if (ShaderCompiler::Compile(permutation.path, sources.at(permutation.path), permutation.defines,
+                    ShaderCompiler::ENTRY_POINT, ShaderCompiler::GetShaderTarget(permutation.shader_type), bytecode) == false)
+                {
+                    LOG_ERROR("Failed to compile {} [{}]", permutation.path, ToString(permutation.defines));
+                    num_failed++;
+                    continue;
+                }
+
+                bytecodes[i].key = ShaderArchive::ComputeKey(permutation.path, permutation.defines, permutation.shader_type);
+                bytecodes[i].data = std::move(bytecode);
+            }
+        });
+
+    jobs::Shutdown();
+
+    if (num_failed > 0)
+    {
+        LOG_ERROR("{} of {} permutations failed to compile, no archive written", num_failed.load(), permutations.size());
+        return EXIT_FAILURE;
+    }
+
+    const std::string shader_dir = std::filesystem::path(manifest_path).parent_path().generic_string();
+    if (ShaderArchive::Write(output_path, bytecodes, ShaderCompiler::GetCompileFlags(), ShaderArchive::ComputeSourceHash(shader_dir)) == false)
+    {
+        LOG_ERROR("Failed to write shader archive: {}", output_path);
+        return EXIT_FAILURE;
+    }
+
+    const auto end_time = std::chrono::high_resolution_clock::now();
+    LOG("Wrote {} permutations to {} in {:.1f} ms using {} threads", bytecodes.size(), output_path,
+        std::chrono::duration<double, std::milli>(end_time - start_time).count(), num_threads);
+
+    return EXIT_SUCCESS;
+}
@@ -28,6 +28,17 @@ float3 Max3Component(float3 v)
     return float3(v.x >= max_val ? 1.0f : 0.0f, v.y >= max_val ? 1.0f : 0.0f, v.z >= max_val ? 1.0f : 0.0f);
 }
 
+// Vertex Decoding
+
+// Inverse of EncodeOctahedral() in VertexQuantization.h
+float3 DecodeOctahedral(float2 e)
+{
+    float3 v = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    const float t = saturate(-v.z);
+    v.xy += v.xy >= 0.0f ? -t : t;
+    return normalize(v);
+}
+
 // Space Transformations
 
 float4 WorldToNDC(float4 v, float4x4 view_projection)
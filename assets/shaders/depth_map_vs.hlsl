@@ -9,14 +9,26 @@ cbuffer LightViewData : register(b1)
     float4x4 mat_view_projection;
 };
 
+#ifdef INSTANCED
+// Transposed world matrices of all instances drawn this pass, indexed through the per instance vertex stream
+StructuredBuffer<float4x4> instance_world_matrices : register(t8);
+#else
 cbuffer PerObjectData : register(b2)
 {
     float4x4 mat_world;
 };
+#endif
 
 struct VSInput
 {
+#ifdef QUANTIZED_POSITIONS
+    float4 pos : QUANTIZED_POSITION0;   // [0, 1] within the mesh bounds, the world matrix maps them back to model space
+#else
     float3 pos : POSITION0;
+#endif
+#ifdef INSTANCED
+    uint instance_idx : INSTANCE_INDEX0;
+#endif
 };
 
 struct VSOutput
@@ -26,7 +38,11 @@ struct VSOutput
 
 VSOutput Main(VSInput input)
 {
+#ifdef INSTANCED
+    const float4x4 mat_world = instance_world_matrices[input.instance_idx];
+#endif
+
     VSOutput output;
-    output.pos = mul(float4(input.pos, 1.0f), mul(mat_world, mat_view_projection));
+    output.pos = mul(float4(input.pos.xyz, 1.0f), mul(mat_world, mat_view_projection));
     return output;
 }
@@ -92,7 +92,10 @@ void Main(PSInput input, out float4 out_color : SV_Target0)
 
     if (IsBitSet(bound_texture_bits, NORMAL_TEX_BIT))
     {
-        float3 surface_normal_ts = (tex_normal.Sample(sampler_anisotropic_wrap, input.uv).xyz) * 2.0f - 1.0f;
+        // Only X and Y are stored for block compressed normal maps (BC5)
+        float3 surface_normal_ts;
+        surface_normal_ts.xy = tex_normal.Sample(sampler_anisotropic_wrap, input.uv).xy * 2.0f - 1.0f;
+        surface_normal_ts.z = sqrt(saturate(1.0f - dot(surface_normal_ts.xy, surface_normal_ts.xy)));
         float3 surface_bitangent_ws = cross(surface_tangent_ws, surface_normal_ws);
         float3x3 mat_tbn = float3x3(surface_tangent_ws, surface_bitangent_ws, surface_normal_ws);
         surface_normal_ws = mul(surface_normal_ts, mat_tbn);
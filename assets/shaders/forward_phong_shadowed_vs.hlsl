@@ -1,3 +1,4 @@
+#include <common.hlsli>
 
 cbuffer PerFrameData : register(b0)
 {
@@ -12,17 +13,35 @@ cbuffer PerViewData : register(b1)
     float4 pos_camera_ws;
 };
 
+#ifdef INSTANCED
+// Transposed world matrices of all instances drawn this pass, indexed through the per instance vertex stream
+StructuredBuffer<float4x4> instance_world_matrices : register(t8);
+#else
 cbuffer PerObjectData : register(b2)
 {
     float4x4 mat_world;
 };
+#endif
 
 struct VSInput
 {
+#ifdef QUANTIZED_POSITIONS
+    float4 pos : QUANTIZED_POSITION0;   // [0, 1] within the mesh bounds, the world matrix maps them back to model space
+#else
     float3 pos : POSITION0;
+#endif
+#ifdef PACKED_ATTRIBUTES
+    float2 normal : PACKED_NORMAL0;     // Octahedral
+    float2 uv : PACKED_UV0;
+    float2 tangents : PACKED_TANGENT0;  // Octahedral
+#else
     float3 normal : NORMAL0;
     float2 uv : UV0;
     float3 tangents : TANGENTS0;
+#endif
+#ifdef INSTANCED
+    uint instance_idx : INSTANCE_INDEX0;
+#endif
 };
 
 struct VSOutput
@@ -37,19 +56,31 @@ struct VSOutput
 
 VSOutput Main(VSInput input)
 {
+#ifdef INSTANCED
+    const float4x4 mat_world = instance_world_matrices[input.instance_idx];
+#endif
+
+#ifdef PACKED_ATTRIBUTES
+    const float3 normal = DecodeOctahedral(input.normal);
+    const float3 tangents = DecodeOctahedral(input.tangents);
+#else
+    const float3 normal = input.normal;
+    const float3 tangents = input.tangents;
+#endif
+
     VSOutput output;
     float4x4 mat_world_view = mul(mat_world, mat_view);
     float4x4 mat_world_view_projection = mul(mat_world, mat_view_projection);
 
-    output.pos_ws = mul(float4(input.pos, 1.0f), mat_world);
+    output.pos_ws = mul(float4(input.pos.xyz, 1.0f), mat_world);
 
     output.pos_cs = mul(float4(output.pos_ws.xyz, 1.0f), mat_view_projection);
 
     output.depth_cs = output.pos_cs.w;
 
-    output.normal_ws = mul(float4(input.normal, 0.0f), mat_world);  // If we want to support non-uniform scalings we'll need a normal matrix.
-                                                                    // Or: https://lxjk.github.io/2017/10/01/Stop-Using-Normal-Matrix.html
-    output.tangents_ws = mul(float4(input.tangents, 0.0f), mat_world);
+    output.normal_ws = mul(float4(normal, 0.0f), mat_world);  // If we want to support non-uniform scalings we'll need a normal matrix.
+                                                              // Or: https://lxjk.github.io/2017/10/01/Stop-Using-Normal-Matrix.html
+    output.tangents_ws = mul(float4(tangents, 0.0f), mat_world);
     output.uv = input.uv;
     return output;
 }
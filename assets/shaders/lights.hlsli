@@ -23,7 +23,7 @@ struct PointLight
     float attenuation;
     float4x4 view_projection[6];
     float brightness;
-    float padding_0;
+    float range;
     float padding_1;
     float padding_2;
 };
@@ -394,6 +394,84 @@ project_name = "08_ShadowMapping"
     
         filter {}
 
+project_name = "ShaderPrecompiler"
+print("Generating Project: " .. project_name)
+project (project_name)
+    location (project_dir)
+    targetdir (build_dir)
+    objdir (intermediate_dir)
+    kind "ConsoleApp"
+
+    -- Run from the solution directory: ShaderPrecompiler [manifest] [output archive]
+    links { (baseproject_name) }
+    includedirs { ("./" .. baseproject_name .. "/Source/") }
+
+    AddSourceFiles(project_name)
+    includedirs { "$(ProjectDir)" }
+    includedirs { ("$(SolutionDir)/" .. project_name .. "/Source/") }
+
+    pchheader ("AppCore.h")
+    pchsource ("./" .. project_name .. "/Source/Core/AppCore.cpp")
+    forceincludes  { "AppCore.h" }
+
+    disablewarnings
+    {
+        "4100", -- unreferenced formal parameter
+        "4189"  -- local variable initalized but not referenced
+    }
+
+    includedirs "$(SolutionDir)/ThirdParty/Assimp/include/"
+    AddAssimp()
+    AddSTB()
+    AddSpdlog()
+    AddSDL2()
+    AddImGui()
+
+    filter "files:**/ThirdParty/**.*"
+        flags "NoPCH"
+        disablewarnings { "4100" }
+
+    filter {}
+
+project_name = "Benchmarks"
+print("Generating Project: " .. project_name)
+project (project_name)
+    location (project_dir)
+    targetdir (build_dir)
+    objdir (intermediate_dir)
+    kind "ConsoleApp"
+
+    -- CPU side benchmarks, run from the solution directory: Benchmarks [max entities]
+    links { (baseproject_name) }
+    includedirs { ("./" .. baseproject_name .. "/Source/") }
+
+    AddSourceFiles(project_name)
+    includedirs { "$(ProjectDir)" }
+    includedirs { ("$(SolutionDir)/" .. project_name .. "/Source/") }
+
+    pchheader ("AppCore.h")
+    pchsource ("./" .. project_name .. "/Source/Core/AppCore.cpp")
+    forceincludes  { "AppCore.h" }
+
+    disablewarnings
+    {
+        "4100", -- unreferenced formal parameter
+        "4189"  -- local variable initalized but not referenced
+    }
+
+    includedirs "$(SolutionDir)/ThirdParty/Assimp/include/"
+    AddAssimp()
+    AddSTB()
+    AddSpdlog()
+    AddSDL2()
+    AddImGui()
+
+    filter "files:**/ThirdParty/**.*"
+        flags "NoPCH"
+        disablewarnings { "4100" }
+
+    filter {}
+
 project_name = "Shaders"
 print("Generating Project: " .. project_name)
 project (project_name)